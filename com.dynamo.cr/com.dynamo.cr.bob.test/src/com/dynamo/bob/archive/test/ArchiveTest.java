@@ -202,7 +202,7 @@ public class ArchiveTest {
 	        archiveIndex = new RandomAccessFile(outputIndex, "r");
 	        
 	        archiveIndex.readInt();  					// Version
-	        archiveIndex.readInt();  					// Padding
+	        int hashIndexOffset = archiveIndex.readInt(); // HashIndexOffset
 	        archiveIndex.readLong(); 					// UserData
 	        int entrySize   = archiveIndex.readInt();	// EntrySize
 	        int entryOffset = archiveIndex.readInt();	// EntryOffset
@@ -215,6 +215,8 @@ public class ArchiveTest {
 	        assertEquals(48 + entrySize * ArchiveBuilder.HASH_MAX_LENGTH, entryOffset);
 	        assertTrue(entryOffset % 4 == 0);
 	        assertTrue(hashOffset % 4 == 0);
+	        assertEquals(entryOffset + entrySize * 16, hashIndexOffset);
+	        assertTrue(hashIndexOffset % 4 == 0);
     	}
     }
 
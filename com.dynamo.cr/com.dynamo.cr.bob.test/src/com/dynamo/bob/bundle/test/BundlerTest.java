@@ -322,7 +322,7 @@ public class BundlerTest {
         // Read the path entries in the resulting archive
         RandomAccessFile archiveIndex = new RandomAccessFile(root + "/build/game.arci", "r");
         archiveIndex.readInt();  // Version
-        archiveIndex.readInt();  // Pad
+        archiveIndex.readInt();  // HashIndexOffset
         archiveIndex.readLong(); // Userdata
         int entryCount  = archiveIndex.readInt();
         int entryOffset = archiveIndex.readInt();
@@ -168,7 +168,7 @@ public class ArchiveBuilder {
     public void write(RandomAccessFile archiveIndex, RandomAccessFile archiveData, Path resourcePackDirectory, List<String> excludedResources) throws IOException {
         // INDEX
         archiveIndex.writeInt(VERSION); // Version
-        archiveIndex.writeInt(0); // Pad
+        archiveIndex.writeInt(0); // HashIndexOffset
         archiveIndex.writeLong(0); // UserData, used in runtime to distinguish between if the index and resources are memory mapped or loaded from disk
         archiveIndex.writeInt(0); // EntryCount
         archiveIndex.writeInt(0); // EntryOffset
@@ -251,6 +251,11 @@ public class ArchiveBuilder {
             archiveIndex.writeInt(entry.flags);
         }
 
+        // Write hash index, used by the runtime to find entries without a binary search
+        alignBuffer(archiveIndex, 4);
+        int hashIndexOffset = (int) archiveIndex.getFilePointer();
+        writeHashIndex(archiveIndex, entries);
+
         try {
             // Calc index file MD5 hash
             archiveIndex.seek(archiveIndexHeaderOffset);
@@ -266,7 +271,7 @@ public class ArchiveBuilder {
         // Update index header with offsets
         archiveIndex.seek(0);
         archiveIndex.writeInt(VERSION);
-        archiveIndex.writeInt(0); // Pad
+        archiveIndex.writeInt(hashIndexOffset);
         archiveIndex.writeLong(0); // UserData
         archiveIndex.writeInt(entries.size());
         archiveIndex.writeInt(entryOffset);
@@ -275,6 +280,44 @@ public class ArchiveBuilder {
         archiveIndex.write(this.archiveIndexMD5);
     }
 
+    // Must match GetHashIndexKey in resource_archive.cpp
+    private static long hashIndexKey(byte[] hash) {
+        long key = 0;
+        for (int i = 0; i < 8; ++i) {
+            key = (key << 8) | (hash[i] & 0xFF);
+        }
+        key ^= key >>> 33;
+        key *= 0xff51afd7ed558ccdL;
+        key ^= key >>> 33;
+        return key;
+    }
+
+    // Open addressing (linear probing) table of {tag, entry index + 1} pairs, 0 marks an empty bucket
+    private static void writeHashIndex(RandomAccessFile outFile, List<ArchiveEntry> entries) throws IOException {
+        int bucketCount = 2;
+        while (bucketCount < entries.size() * 2) {
+            bucketCount <<= 1;
+        }
+        int mask = bucketCount - 1;
+        int[] buckets = new int[bucketCount * 2];
+        for (int i = 0; i < entries.size(); ++i) {
+            long key = hashIndexKey(entries.get(i).hash);
+            int bucket = (int) key & mask;
+            while (buckets[bucket * 2 + 1] != 0) {
+                bucket = (bucket + 1) & mask;
+            }
+            buckets[bucket * 2 + 0] = (int) (key >>> 32);
+            buckets[bucket * 2 + 1] = i + 1;
+        }
+
+        ByteBuffer buffer = ByteBuffer.allocate(4 + buckets.length * 4); // big endian by default
+        buffer.putInt(bucketCount);
+        for (int value : buckets) {
+            buffer.putInt(value);
+        }
+        outFile.write(buffer.array());
+    }
+
     private void alignBuffer(RandomAccessFile outFile, int align) throws IOException {
         int pos = (int) outFile.getFilePointer();
         int newPos = (int) (outFile.getFilePointer() + (align - 1));
@@ -87,7 +87,7 @@ public class ArchiveReader {
 
     private void readArchiveData() throws IOException {
         // INDEX
-        archiveIndexFile.readInt(); // Pad
+        archiveIndexFile.readInt(); // HashIndexOffset
         archiveIndexFile.readLong(); // UserData, should be 0
         entryCount = archiveIndexFile.readInt();
         entryOffset = archiveIndexFile.readInt();
@@ -0,0 +1,89 @@
+# Copyright 2020 The Defold Foundation
+# Licensed under the Defold License version 1.0 (the "License"); you may not use
+# this file except in compliance with the License.
+#
+# You may obtain a copy of the License, together with FAQs at
+# https://www.defold.com/license
+#
+# Unless required by applicable law or agreed to in writing, software distributed
+# under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+# CONDITIONS OF ANY KIND, either express or implied. See the License for the
+# specific language governing permissions and limitations under the License.
+
+import json, struct, sys
+
+# Converts a profile capture, see dmProfile::StartCapture, to the Chrome trace-event
+# JSON format. The output can be opened in chrome://tracing or https://ui.perfetto.dev
+#
+# usage: profile_capture_to_trace.py capture.dmcapture trace.json
+
+RECORD_STRING = 1
+RECORD_FRAME = 2
+
+def read(f, fmt):
+    size = struct.calcsize(fmt)
+    data = f.read(size)
+    if len(data) != size:
+        raise EOFError()
+    return struct.unpack(fmt, data)
+
+def convert(capture, out):
+    magic = capture.read(4)
+    if magic != b'DMPC':
+        raise Exception('Not a profile capture')
+    version, ticks_per_second = read(capture, '<IQ')
+    if version != 1:
+        raise Exception('Unsupported capture version %d' % version)
+
+    us_per_tick = 1000000.0 / ticks_per_second
+    strings = {}
+    first_tick = None
+    frames = 0
+    events = 0
+
+    out.write('{"displayTimeUnit":"ms","traceEvents":[\n')
+    def write_event(event):
+        if events > 0:
+            out.write(',\n')
+        out.write(json.dumps(event, separators=(',', ':')))
+
+    while True:
+        record = capture.read(1)
+        if not record:
+            break
+        record = ord(record)
+        if record == RECORD_STRING:
+            name_hash, length = read(capture, '<IH')
+            strings[name_hash] = capture.read(length).decode('utf-8', 'replace')
+        elif record == RECORD_FRAME:
+            begin, sample_count, counter_count = read(capture, '<QII')
+            if first_tick is None:
+                first_tick = begin
+            frame_ts = (begin - first_tick) * us_per_tick
+            for i in range(sample_count):
+                name_hash, scope_hash, start, elapsed, thread_id = read(capture, '<IIIIH')
+                write_event({'name': strings.get(name_hash, '?'), 'cat': strings.get(scope_hash, '?'), 'ph': 'X',
+                             'ts': frame_ts + start * us_per_tick, 'dur': elapsed * us_per_tick,
+                             'pid': 0, 'tid': thread_id})
+                events += 1
+            for i in range(counter_count):
+                name_hash, value = read(capture, '<Ii')
+                write_event({'name': strings.get(name_hash, '?'), 'ph': 'C', 'ts': frame_ts,
+                             'pid': 0, 'args': {'value': value}})
+                events += 1
+            frames += 1
+        else:
+            raise Exception('Corrupt capture, unknown record type %d' % record)
+
+    out.write('\n]}\n')
+    return frames, events
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        print('usage: %s capture.dmcapture trace.json' % sys.argv[0])
+        sys.exit(1)
+
+    with open(sys.argv[1], 'rb') as capture:
+        with open(sys.argv[2], 'w') as out:
+            frames, events = convert(capture, out)
+    print('Wrote %d frames, %d events to %s' % (frames, events, sys.argv[2]))
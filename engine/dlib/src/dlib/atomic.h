@@ -119,4 +119,35 @@ inline int32_t dmAtomicCompareStore32(int32_atomic_t *ptr, int32_t value, int32_
 #endif
 }
 
+/**
+ * Atomic exchange of a pointer.
+ * @param ptr Pointer to the pointer to store into.
+ * @param value Value to store.
+ * @return Previous value.
+ */
+inline void* dmAtomicStorePtr(void* volatile* ptr, void* value)
+{
+#if defined(_MSC_VER)
+	return InterlockedExchangePointer((volatile PVOID*) ptr, value);
+#else
+	return __sync_lock_test_and_set(ptr, value);
+#endif
+}
+
+/**
+ * Atomic exchange of a pointer if comparand is equal to the value of #ptr
+ * @param ptr Pointer to the pointer to store into.
+ * @param value Value to store.
+ * @param comparand Value to compare to.
+ * @return Previous value
+ */
+inline void* dmAtomicCompareStorePtr(void* volatile* ptr, void* value, void* comparand)
+{
+#if defined(_MSC_VER)
+	return InterlockedCompareExchangePointer((volatile PVOID*) ptr, value, comparand);
+#else
+	return __sync_val_compare_and_swap(ptr, comparand, value);
+#endif
+}
+
 #endif //DM_ATOMIC_H
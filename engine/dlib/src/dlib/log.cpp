@@ -18,8 +18,9 @@
 #include "array.h"
 #include "dstrings.h"
 #include "log.h"
+#include "atomic.h"
+#include "mutex.h"
 #include "socket.h"
-#include "message.h"
 #include "thread.h"
 #include "math.h"
 #include "time.h"
@@ -46,23 +47,62 @@ struct dmLogConnection
 
 static const uint32_t DLIB_MAX_LOG_CONNECTIONS = 16;
 
+// While the log server is running, dmLogInternal only copies the formatted
+// message into a ring buffer. The log thread drains the buffer and writes the
+// records in batches to stderr, the log file and the connected clients.
+// The ring size must be a power of two.
+static const uint32_t DLIB_LOG_RING_BUFFER_SIZE = 256 * 1024;
+static const uint32_t DLIB_LOG_BATCH_SIZE = 32 * 1024;
+
+struct dmLogRecord
+{
+    // Total size of the record, including this header. Zero until the record is committed
+    int32_atomic_t m_Size;
+    uint16_t       m_Length;
+    uint8_t        m_Severity;
+    // Padding up to the end of the ring buffer, no message
+    uint8_t        m_Skip;
+};
+
 struct dmLogServer
 {
-    dmLogServer(dmSocket::Socket server_socket, uint16_t port,
-                 dmMessage::HSocket message_socket)
+    dmLogServer(dmSocket::Socket server_socket, uint16_t port)
     {
         m_Connections.SetCapacity(DLIB_MAX_LOG_CONNECTIONS);
         m_ServerSocket = server_socket;
         m_Port = port;
-        m_MessgeSocket = message_socket;
         m_Thread = 0;
+        m_Ring = (char*) calloc(1, DLIB_LOG_RING_BUFFER_SIZE);
+        m_Batch = (char*) malloc(DLIB_LOG_BATCH_SIZE);
+        m_WritePos = 0;
+        m_ReadPos = 0;
+        m_Dropped = 0;
+        m_DroppedReported = 0;
+        m_Run = 1;
+        m_FileMutex = dmMutex::New();
+    }
+
+    ~dmLogServer()
+    {
+        dmMutex::Delete(m_FileMutex);
+        free(m_Batch);
+        free(m_Ring);
     }
 
     dmArray<dmLogConnection> m_Connections;
     dmSocket::Socket         m_ServerSocket;
     uint16_t                 m_Port;
-    dmMessage::HSocket       m_MessgeSocket;
     dmThread::Thread         m_Thread;
+    char*                    m_Ring;
+    char*                    m_Batch;
+    // Monotonic positions into the ring buffer, wrapping at 2^32
+    int32_atomic_t           m_WritePos;
+    int32_atomic_t           m_ReadPos;
+    int32_atomic_t           m_Dropped;
+    uint32_t                 m_DroppedReported;
+    int32_atomic_t           m_Run;
+    // Guards g_LogFile while the log thread is writing to it
+    dmMutex::HMutex          m_FileMutex;
 };
 
 static dmLogServer* g_dmLogServer = 0;
@@ -221,19 +261,8 @@ static void dmLogUpdateNetwork()
     }
 }
 
-static void dmLogDispatch(dmMessage::Message *message, void* user_ptr)
+static void dmLogSendToConnections(dmLogServer* self, const char* buffer, int length)
 {
-    dmLogServer* self = g_dmLogServer;
-
-    bool* run = (bool*) user_ptr;
-    dmLogMessage* log_message = (dmLogMessage*) &message->m_Data[0];
-    if (log_message->m_Type == dmLogMessage::SHUTDOWN)
-    {
-        *run = false;
-        return;
-    }
-    int msg_len = (int) strlen(log_message->m_Message);
-
     // NOTE: Keep i as signed! See --i below after EraseSwap
     int n = (int) self->m_Connections.Size();
     for (int i = 0; i < n; ++i)
@@ -244,7 +273,7 @@ static void dmLogDispatch(dmMessage::Message *message, void* user_ptr)
         int total_sent = 0;
         do
         {
-            r = dmSocket::Send(c->m_Socket, log_message->m_Message + total_sent, msg_len - total_sent, &sent_bytes);
+            r = dmSocket::Send(c->m_Socket, buffer + total_sent, length - total_sent, &sent_bytes);
             if (r == dmSocket::RESULT_OK)
             {
                 total_sent += sent_bytes;
@@ -262,24 +291,153 @@ static void dmLogDispatch(dmMessage::Message *message, void* user_ptr)
                 --i;
                 break;
             }
-        } while (total_sent < msg_len);
+        } while (total_sent < length);
+    }
+}
+
+static inline uint32_t dmLogLoadPos(int32_atomic_t* pos)
+{
+    return (uint32_t) dmAtomicAdd32(pos, 0);
+}
+
+static void dmLogWriteFile(dmLogServer* self, const char* buffer, uint32_t length)
+{
+    DM_MUTEX_SCOPED_LOCK(self->m_FileMutex);
+    if (g_LogFile && g_TotalBytesLogged < DM_LOG_MAX_LOG_FILE_SIZE) {
+        fwrite(buffer, 1, length, g_LogFile);
+        fflush(g_LogFile);
+    }
+    g_TotalBytesLogged += length;
+}
+
+static void dmLogWriteBatch(dmLogServer* self, const char* buffer, uint32_t length)
+{
+#if !defined(ANDROID)
+    fwrite(buffer, 1, length, stderr);
+#endif
+    dmLogWriteFile(self, buffer, length);
+    dmLogSendToConnections(self, buffer, (int) length);
+}
+
+// Copies a message into the ring buffer. Safe to call from any number of threads.
+// Returns false, and counts the record as dropped, if the ring buffer is full
+static bool dmLogPushRecord(dmLogServer* self, dmLogSeverity severity, const char* str, uint32_t length)
+{
+    const uint32_t mask = DLIB_LOG_RING_BUFFER_SIZE - 1;
+    uint32_t size = (sizeof(dmLogRecord) + length + 1 + 7) & ~7U;
+    uint32_t start;
+    uint32_t skip;
+    while (true)
+    {
+        // Read position first, it never passes the write position
+        uint32_t read_pos = dmLogLoadPos(&self->m_ReadPos);
+        uint32_t write_pos = dmLogLoadPos(&self->m_WritePos);
+
+        // Records are contiguous, pad to the start of the ring buffer if needed
+        uint32_t offset = write_pos & mask;
+        skip = offset + size > DLIB_LOG_RING_BUFFER_SIZE ? DLIB_LOG_RING_BUFFER_SIZE - offset : 0;
+        if (write_pos + skip + size - read_pos > DLIB_LOG_RING_BUFFER_SIZE)
+        {
+            dmAtomicIncrement32(&self->m_Dropped);
+            return false;
+        }
+
+        if ((uint32_t) dmAtomicCompareStore32(&self->m_WritePos, (int32_t) (write_pos + skip + size), (int32_t) write_pos) == write_pos)
+        {
+            start = write_pos;
+            break;
+        }
+    }
+
+    if (skip > 0)
+    {
+        dmLogRecord* pad = (dmLogRecord*) &self->m_Ring[start & mask];
+        pad->m_Skip = 1;
+        dmAtomicCompareStore32(&pad->m_Size, (int32_t) skip, 0);
+    }
+
+    dmLogRecord* record = (dmLogRecord*) &self->m_Ring[(start + skip) & mask];
+    record->m_Length = (uint16_t) length;
+    record->m_Severity = (uint8_t) severity;
+    record->m_Skip = 0;
+    memcpy(record + 1, str, length + 1);
+    // Publish the record, acts as a full barrier
+    dmAtomicCompareStore32(&record->m_Size, (int32_t) size, 0);
+    return true;
+}
+
+// Writes all committed records. Only called from a single thread at a time.
+// Returns the number of bytes consumed from the ring buffer
+static uint32_t dmLogDrain(dmLogServer* self)
+{
+    const uint32_t mask = DLIB_LOG_RING_BUFFER_SIZE - 1;
+    uint32_t read_pos = dmLogLoadPos(&self->m_ReadPos);
+    uint32_t write_pos = dmLogLoadPos(&self->m_WritePos);
+    uint32_t consumed = 0;
+    uint32_t batch_size = 0;
+
+    while (read_pos != write_pos)
+    {
+        dmLogRecord* record = (dmLogRecord*) &self->m_Ring[read_pos & mask];
+        uint32_t size = dmLogLoadPos(&record->m_Size);
+        if (size == 0)
+        {
+            // Reserved but not yet committed
+            break;
+        }
+
+        if (!record->m_Skip)
+        {
+            if (batch_size + record->m_Length > DLIB_LOG_BATCH_SIZE)
+            {
+                dmLogWriteBatch(self, self->m_Batch, batch_size);
+                batch_size = 0;
+            }
+            memcpy(self->m_Batch + batch_size, record + 1, record->m_Length);
+            batch_size += record->m_Length;
+        }
+
+        // Producers rely on unused memory being zero when committing
+        memset(record, 0, size);
+        read_pos += size;
+        consumed += size;
+        dmAtomicAdd32(&self->m_ReadPos, (int32_t) size);
+    }
+
+    uint32_t dropped = dmLogLoadPos(&self->m_Dropped);
+    if (dropped != self->m_DroppedReported)
+    {
+        const uint32_t max_message = 128;
+        if (batch_size + max_message > DLIB_LOG_BATCH_SIZE)
+        {
+            dmLogWriteBatch(self, self->m_Batch, batch_size);
+            batch_size = 0;
+        }
+        batch_size += dmSnPrintf(self->m_Batch + batch_size, max_message, "WARNING:DLIB: %u log messages dropped\n", dropped - self->m_DroppedReported);
+        self->m_DroppedReported = dropped;
+    }
+
+    if (batch_size > 0)
+    {
+        dmLogWriteBatch(self, self->m_Batch, batch_size);
     }
+    return consumed;
 }
 
 static void dmLogThread(void* args)
 {
     dmLogServer* self = g_dmLogServer;
 
-    volatile bool run = true;
-    while (run)
+    while (dmLogLoadPos(&self->m_Run))
     {
-        // NOTE: We have support for blocking dispatch in dmMessage
-        // but we have to wait for both new messages and on sockets.
-        // Currently no support for that and hence the sleep here
-        dmTime::Sleep(1000 * 30);
         dmLogUpdateNetwork();
-        dmMessage::Dispatch(self->m_MessgeSocket, dmLogDispatch, (void*) &run);
+        uint32_t consumed = dmLogDrain(self);
+
+        // NOTE: We have to wait for both new records and on sockets.
+        // Poll again sooner when there is a burst of logging to avoid dropping records
+        dmTime::Sleep(consumed > DLIB_LOG_RING_BUFFER_SIZE / 4 ? 1000 : 1000 * 30);
     }
+    dmLogDrain(self);
 }
 
 void dmLogInitialize(const dmLogParams* params)
@@ -305,23 +463,8 @@ void dmLogInitialize(const dmLogParams* params)
     }
     dmSocket::GetName(server_socket, &address, &port);
 
-    dmMessage::HSocket message_socket = 0;
-    dmMessage::Result mr;
-    dmThread::Thread thread = 0;
-
-    mr = dmMessage::NewSocket("@log", &message_socket);
-    if (mr != dmMessage::RESULT_OK)
-    {
-        fprintf(stderr, "ERROR:DLIB: Unable to create @log message socket\n");
-        if (message_socket != 0)
-            dmMessage::DeleteSocket(message_socket);
-        dmSocket::Delete(server_socket);
-        return;
-    }
-
-    g_dmLogServer = new dmLogServer(server_socket, port, message_socket);
-    thread = dmThread::New(dmLogThread, 0x80000, 0, "log");
-    g_dmLogServer->m_Thread = thread;
+    g_dmLogServer = new dmLogServer(server_socket, port);
+    g_dmLogServer->m_Thread = dmThread::New(dmLogThread, 0x80000, 0, "log");
 
     /*
      * This message is parsed by editor 2 - don't remove or change without
@@ -347,15 +490,13 @@ void dmLogFinalize()
     }
     dmLogServer* self = g_dmLogServer;
 
-    dmLogMessage msg;
-    msg.m_Type = dmLogMessage::SHUTDOWN;
-    dmMessage::URL receiver;
-    receiver.m_Socket = self->m_MessgeSocket;
-    receiver.m_Path = 0;
-    receiver.m_Fragment = 0;
-    dmMessage::Post(0, &receiver, 0, 0, 0, &msg, sizeof(msg), 0);
+    dmAtomicStore32(&self->m_Run, 0);
     dmThread::Join(self->m_Thread);
 
+    // Write anything logged while the thread was shutting down
+    g_dmLogServer = 0;
+    dmLogDrain(self);
+
     uint32_t n = self->m_Connections.Size();
     for (uint32_t i = 0; i < n; ++i)
     {
@@ -369,14 +510,30 @@ void dmLogFinalize()
         dmSocket::Delete(self->m_ServerSocket);
     }
 
-    if (self->m_MessgeSocket != 0)
+    delete self;
+    CloseLogFile();
+}
+
+void dmLogFlush()
+{
+    dmLogServer* self = g_dmLogServer;
+    if (!self || dmThread::GetCurrentThread() == self->m_Thread)
+        return;
+
+    uint32_t target = dmLogLoadPos(&self->m_WritePos);
+    while ((int32_t) (dmLogLoadPos(&self->m_ReadPos) - target) < 0 && dmLogLoadPos(&self->m_Run))
     {
-        dmMessage::DeleteSocket(self->m_MessgeSocket);
+        dmTime::Sleep(1000);
     }
+}
 
-    delete self;
-    g_dmLogServer = 0;
-    CloseLogFile();
+uint32_t dmLogGetDroppedCount()
+{
+    dmLogServer* self = g_dmLogServer;
+    if (!self)
+        return 0;
+
+    return dmLogLoadPos(&self->m_Dropped);
 }
 
 uint16_t dmLogGetPort()
@@ -458,9 +615,7 @@ void dmLogInternal(dmLogSeverity severity, const char* domain, const char* forma
             break;
     }
 
-    char tmp_buf[sizeof(dmLogMessage) + DM_LOG_MAX_STRING_SIZE];
-    dmLogMessage* msg = (dmLogMessage*) &tmp_buf[0];
-    char* str_buf = &tmp_buf[sizeof(dmLogMessage)];
+    char str_buf[DM_LOG_MAX_STRING_SIZE];
 
     int n = 0;
     n += dmSnPrintf(str_buf + n, DM_LOG_MAX_STRING_SIZE - n, "%s:%s: ", severity_str, domain);
@@ -482,8 +637,6 @@ void dmLogInternal(dmLogSeverity severity, const char* domain, const char* forma
     str_buf[DM_LOG_MAX_STRING_SIZE-1] = '\0';
     int actual_n = dmMath::Min(n, (int)(DM_LOG_MAX_STRING_SIZE-1));
 
-    g_TotalBytesLogged += actual_n;
-
     va_end(lst);
 
     if (g_CustomLogCallback != 0x0)
@@ -500,6 +653,30 @@ void dmLogInternal(dmLogSeverity severity, const char* domain, const char* forma
     __ios_log_print(severity, str_buf);
 #endif
 
+    dmLogServer* self = g_dmLogServer;
+    if (self)
+    {
+        // stderr, the log file and the clients are written by the log thread
+        bool pushed = dmLogPushRecord(self, severity, str_buf, (uint32_t) actual_n);
+        if (severity == DM_LOG_SEVERITY_FATAL)
+        {
+            if (pushed)
+            {
+                dmLogFlush();
+            }
+            else
+            {
+#if !defined(ANDROID)
+                fwrite(str_buf, 1, actual_n, stderr);
+#endif
+                dmLogWriteFile(self, str_buf, actual_n);
+            }
+        }
+        return;
+    }
+
+    g_TotalBytesLogged += actual_n;
+
 #ifdef __EMSCRIPTEN__
     //Emscripten maps stderr to console.error and stdout to console.log.
     if (severity == DM_LOG_SEVERITY_ERROR || severity == DM_LOG_SEVERITY_FATAL){
@@ -518,26 +695,25 @@ void dmLogInternal(dmLogSeverity severity, const char* domain, const char* forma
         fwrite(str_buf, 1, actual_n, g_LogFile);
         fflush(g_LogFile);
     }
-
-    dmLogServer* self = g_dmLogServer;
-    if (self)
-    {
-        msg->m_Type = dmLogMessage::MESSAGE;
-        dmMessage::URL receiver;
-        receiver.m_Socket = self->m_MessgeSocket;
-        receiver.m_Path = 0;
-        receiver.m_Fragment = 0;
-        dmMessage::Post(0, &receiver, 0, 0, 0, msg, dmMath::Min(sizeof(dmLogMessage) + actual_n + 1, sizeof(tmp_buf)), 0);
-    }
 }
 
 void dmSetLogFile(const char* path)
 {
+    // Pending records belong to the previous file
+    dmLogFlush();
+    dmLogServer* self = g_dmLogServer;
+    if (self)
+        dmMutex::Lock(self->m_FileMutex);
+
     if (g_LogFile) {
         fclose(g_LogFile);
         g_LogFile = 0;
     }
     g_LogFile = fopen(path, "wb");
+
+    if (self)
+        dmMutex::Unlock(self->m_FileMutex);
+
     if (g_LogFile) {
         dmLogInfo("Writing log to: %s", path);
     } else {
@@ -32,19 +32,9 @@
  * No other messages with semantic meaning is sent.
  */
 
-struct dmLogMessage
-{
-    enum Type
-    {
-        MESSAGE = 0,
-        SHUTDOWN = 1,
-    };
+/// Max size of a formatted log message, including the null terminator. Longer messages are truncated.
+const uint32_t DM_LOG_MAX_STRING_SIZE = 4096;
 
-    uint8_t m_Type;
-    char    m_Message[0];
-};
-
-const uint32_t DM_LOG_MAX_STRING_SIZE = dmMessage::DM_MESSAGE_MAX_DATA_SIZE - sizeof(dmLogMessage);
 struct dmLogParams
 {
     dmLogParams()
@@ -54,6 +44,7 @@ struct dmLogParams
 
 /**
  * Initialize logging system. Running this function is only required in order to start the log-server.
+ * While the log-server is running messages are written in batches by a separate thread.
  * The function will never fail even if the log-server can't be started. Any errors will be reported to stderr though
  * @param params log parameters
  */
@@ -71,6 +62,20 @@ void dmLogFinalize();
  */
 uint16_t dmLogGetPort();
 
+/**
+ * Wait until all messages logged before the call are written to stderr, the log file
+ * and the log clients. While the log server is running the messages are written
+ * asynchronously by the log thread. Fatal messages are always flushed.
+ */
+void dmLogFlush();
+
+/**
+ * Get the number of messages dropped since the log server was started, due to
+ * the log buffer being full
+ * @return number of dropped messages. 0 if the server isn't started.
+ */
+uint32_t dmLogGetDroppedCount();
+
 
 /**
  * Set log level
@@ -23,30 +23,63 @@
 #include <dlib/mutex.h>
 #include <dlib/static_assert.h>
 #include <dlib/spinlock.h>
+#include <dlib/thread.h>
 
 namespace dmMessage
 {
     // Alignment of allocations
     const uint32_t DM_MESSAGE_ALIGNMENT = 16U;
 
+    // Every message is prefixed with a hidden header pointing back to the page it was allocated from.
+    // The header size is a multiple of the alignment so that the message itself stays aligned.
+    const uint32_t DM_MESSAGE_HEADER_SIZE = DM_MESSAGE_ALIGNMENT;
+
+    // Usable page memory. Room for the largest possible message, including the header
+    const uint32_t DM_MESSAGE_PAGE_CAPACITY = DM_MESSAGE_PAGE_SIZE + DM_MESSAGE_HEADER_SIZE;
+
+    // Max number of recycled pages kept by an arena. Surplus pages are freed.
+    const uint32_t DM_MESSAGE_MAX_FREE_PAGES = 4U;
+
+    struct MemoryArena;
+
     struct MemoryPage
     {
-        uint8_t     m_Memory[DM_MESSAGE_PAGE_SIZE];
-        uint32_t    m_Current;
-        MemoryPage* m_NextPage;
+        uint8_t         m_Memory[DM_MESSAGE_PAGE_CAPACITY];
+        MemoryArena*    m_Arena;
+        MemoryPage*     m_NextPage;
+        // Number of live messages in the page, plus one while the page is the current page of the arena
+        int32_atomic_t  m_RefCount;
+        // Only touched by the thread owning the arena
+        uint32_t        m_Current;
+    };
+
+    struct MessageHeader
+    {
+        MemoryPage* m_Page;
     };
 
-    struct MemoryAllocator
+    // Per thread message allocator.
+    // Messages are bump-allocated from the current page by the owning thread only, i.e. no locking.
+    // Any thread may release a message, and the last release of a retired page pushes the page
+    // to m_ReturnedPages (multiple producers). The owning thread grabs all returned pages in one
+    // atomic swap when it runs out of free pages, which makes the list safe without locks.
+    struct MemoryArena
     {
-        MemoryAllocator()
+        MemoryArena()
         {
             m_CurrentPage = 0;
             m_FreePages = 0;
-            m_FullPages = 0;
-        }
-        MemoryPage* m_CurrentPage;
-        MemoryPage* m_FreePages;
-        MemoryPage* m_FullPages;
+            m_FreePageCount = 0;
+            m_ReturnedPages = 0;
+            m_Next = 0;
+            m_NextFree = 0;
+        }
+        MemoryPage*             m_CurrentPage;
+        MemoryPage*             m_FreePages;
+        uint32_t                m_FreePageCount;
+        MemoryPage* volatile    m_ReturnedPages;
+        MemoryArena*            m_Next; // Protected by "g_MessageContext->m_Spinlock"
+        MemoryArena*            m_NextFree; // Protected by "g_MessageContext->m_Spinlock"
     };
 
     struct GlobalInit
@@ -54,68 +87,136 @@ namespace dmMessage
         GlobalInit() {
             // Make sure the struct sizes are in sync! Think of potential save files!
             DM_STATIC_ASSERT(sizeof(dmMessage::URL) == 32, Invalid_Struct_Size);
+            DM_STATIC_ASSERT(sizeof(MessageHeader) <= DM_MESSAGE_HEADER_SIZE, Invalid_Struct_Size);
         }
 
     } g_MessageInit;
 
-    static void AllocateNewPage(MemoryAllocator* allocator)
+    static void DeletePages(MemoryPage* p)
+    {
+        while (p)
+        {
+            MemoryPage* next = p->m_NextPage;
+            delete p;
+            p = next;
+        }
+    }
+
+    static void PutFreePage(MemoryArena* arena, MemoryPage* page)
     {
-        if (allocator->m_CurrentPage)
+        if (arena->m_FreePageCount >= DM_MESSAGE_MAX_FREE_PAGES)
         {
-            // Link current page to full pages
-            allocator->m_CurrentPage->m_NextPage = allocator->m_FullPages;
-            allocator->m_FullPages = allocator->m_CurrentPage;
+            delete page;
+            return;
+        }
+        page->m_NextPage = arena->m_FreePages;
+        arena->m_FreePages = page;
+        ++arena->m_FreePageCount;
+    }
+
+    // Called by any thread when the last reference to a page is gone
+    static void ReturnPage(MemoryPage* page)
+    {
+        MemoryArena* arena = page->m_Arena;
+        void* volatile* head = (void* volatile*) &arena->m_ReturnedPages;
+        void* prev;
+        do
+        {
+            prev = *head;
+            page->m_NextPage = (MemoryPage*) prev;
+        } while (dmAtomicCompareStorePtr(head, page, prev) != prev);
+    }
+
+    static void AllocateNewPage(MemoryArena* arena)
+    {
+        MemoryPage* current = arena->m_CurrentPage;
+        if (current)
+        {
+            // Retire the current page. If all messages in it are already dispatched we can reuse it directly
+            if (dmAtomicDecrement32(&current->m_RefCount) == 1)
+            {
+                PutFreePage(arena, current);
+            }
+            arena->m_CurrentPage = 0;
+        }
+
+        if (arena->m_FreePages == 0 && arena->m_ReturnedPages != 0)
+        {
+            MemoryPage* p = (MemoryPage*) dmAtomicStorePtr((void* volatile*) &arena->m_ReturnedPages, 0);
+            while (p)
+            {
+                MemoryPage* next = p->m_NextPage;
+                PutFreePage(arena, p);
+                p = next;
+            }
         }
 
         MemoryPage* new_page = 0;
 
-        if (allocator->m_FreePages)
+        if (arena->m_FreePages)
         {
             // Free page to use
-            new_page = allocator->m_FreePages;
-            allocator->m_FreePages = new_page->m_NextPage;
+            new_page = arena->m_FreePages;
+            arena->m_FreePages = new_page->m_NextPage;
+            --arena->m_FreePageCount;
         }
         else
         {
             // Allocate new page
             new_page = new MemoryPage;
+            new_page->m_Arena = arena;
         }
 
         new_page->m_Current = 0;
         new_page->m_NextPage = 0;
+        new_page->m_RefCount = 1;
 
-        allocator->m_CurrentPage = new_page;
+        arena->m_CurrentPage = new_page;
     }
 
-    static void* AllocateMessage(MemoryAllocator* allocator, uint32_t size)
+    static void* AllocateMessage(MemoryArena* arena, uint32_t size)
     {
+        size += DM_MESSAGE_HEADER_SIZE;
         // At least ALIGNMENT bytes alignment of size in order to ensure that the next allocation is aligned
         size += DM_MESSAGE_ALIGNMENT-1;
         size &= ~(DM_MESSAGE_ALIGNMENT-1);
-        assert(size <= DM_MESSAGE_PAGE_SIZE);
+        assert(size <= DM_MESSAGE_PAGE_CAPACITY);
 
-        if (allocator->m_CurrentPage == 0 || (DM_MESSAGE_PAGE_SIZE-allocator->m_CurrentPage->m_Current) < size)
+        if (arena->m_CurrentPage == 0 || (DM_MESSAGE_PAGE_CAPACITY-arena->m_CurrentPage->m_Current) < size)
         {
             // No current page or allocation didn't fit.
-            AllocateNewPage(allocator);
+            AllocateNewPage(arena);
         }
 
-        MemoryPage* page = allocator->m_CurrentPage;
-        void* ret = (void*) ((uintptr_t) &page->m_Memory[0] + page->m_Current);
+        MemoryPage* page = arena->m_CurrentPage;
+        MessageHeader* header = (MessageHeader*) ((uintptr_t) &page->m_Memory[0] + page->m_Current);
+        header->m_Page = page;
         page->m_Current += size;
-        return ret;
+        dmAtomicIncrement32(&page->m_RefCount);
+        return (void*) ((uintptr_t) header + DM_MESSAGE_HEADER_SIZE);
+    }
+
+    static void FreeMessage(Message* message)
+    {
+        MessageHeader* header = (MessageHeader*) ((uintptr_t) message - DM_MESSAGE_HEADER_SIZE);
+        MemoryPage* page = header->m_Page;
+        if (dmAtomicDecrement32(&page->m_RefCount) == 1)
+        {
+            ReturnPage(page);
+        }
     }
 
     struct MessageSocket
     {
         uint32_t        m_RefCount; // Is protected by "g_MessageContext->m_Spinlock"
         dmhash_t        m_NameHash;
-        Message*        m_Header;
-        Message*        m_Tail;
+        // Lock free stack of posted messages, newest first. Reversed into post order on dispatch
+        Message* volatile m_Head;
         const char*     m_Name;
+        // Only used to wake up a blocking dispatch
         dmMutex::HMutex m_Mutex;
         dmConditionVariable::HConditionVariable m_Condition;
-        MemoryAllocator m_Allocator;
+        int32_atomic_t  m_Waiting;
     };
 
     const uint32_t MAX_SOCKETS = 256;
@@ -124,18 +225,96 @@ namespace dmMessage
     {
         dmHashTable64<MessageSocket> m_Sockets;
         dmSpinlock::lock_t m_Spinlock;
+        dmThread::TlsKey m_ArenaKey;
+        // All arenas, and the arenas of exited threads that can be reused
+        MemoryArena* m_Arenas;
+        MemoryArena* m_FreeArenas;
     };
 
     MessageContext* g_MessageContext = 0;
 
+    // Called when a thread that has posted messages exits. The arena is handed to the next thread that
+    // posts. Pages still referenced by messages in flight are returned to the arena as usual when consumed.
+    static void ReleaseThreadArena(void* value)
+    {
+        MemoryArena* arena = (MemoryArena*) value;
+        MemoryPage* current = arena->m_CurrentPage;
+        if (current)
+        {
+            if (dmAtomicDecrement32(&current->m_RefCount) == 1)
+            {
+                delete current;
+            }
+            arena->m_CurrentPage = 0;
+        }
+        DeletePages(arena->m_FreePages);
+        arena->m_FreePages = 0;
+        arena->m_FreePageCount = 0;
+        DeletePages((MemoryPage*) dmAtomicStorePtr((void* volatile*) &arena->m_ReturnedPages, 0));
+
+        DM_SPINLOCK_SCOPED_LOCK(g_MessageContext->m_Spinlock);
+        arena->m_NextFree = g_MessageContext->m_FreeArenas;
+        g_MessageContext->m_FreeArenas = arena;
+    }
+
     static MessageContext* Create(uint32_t max_sockets)
     {
         MessageContext* ctx = new MessageContext;
         ctx->m_Sockets.SetCapacity(max_sockets, max_sockets);
         dmSpinlock::Init(&ctx->m_Spinlock);
+        ctx->m_ArenaKey = dmThread::AllocTls(ReleaseThreadArena);
+        ctx->m_Arenas = 0;
+        ctx->m_FreeArenas = 0;
         return ctx;
     }
 
+    static void Destroy(MessageContext* ctx)
+    {
+        MemoryArena* arena = ctx->m_Arenas;
+        while (arena)
+        {
+            MemoryArena* next = arena->m_Next;
+            DeletePages(arena->m_FreePages);
+            DeletePages(arena->m_ReturnedPages);
+            if (arena->m_CurrentPage)
+            {
+                delete arena->m_CurrentPage;
+            }
+            delete arena;
+            arena = next;
+        }
+        dmThread::FreeTls(ctx->m_ArenaKey);
+        delete ctx;
+    }
+
+    static MemoryArena* GetThreadArena()
+    {
+        MemoryArena* arena = (MemoryArena*) dmThread::GetTlsValue(g_MessageContext->m_ArenaKey);
+        if (arena == 0)
+        {
+            // First post from this thread. Arenas are kept until the context is destroyed,
+            // as pages may still be referenced by messages in flight when a thread exits.
+            // The arenas of exited threads are reused, see ReleaseThreadArena
+            {
+                DM_SPINLOCK_SCOPED_LOCK(g_MessageContext->m_Spinlock);
+                arena = g_MessageContext->m_FreeArenas;
+                if (arena)
+                {
+                    g_MessageContext->m_FreeArenas = arena->m_NextFree;
+                    arena->m_NextFree = 0;
+                }
+                else
+                {
+                    arena = new MemoryArena;
+                    arena->m_Next = g_MessageContext->m_Arenas;
+                    g_MessageContext->m_Arenas = arena;
+                }
+            }
+            dmThread::SetTlsValue(g_MessageContext->m_ArenaKey, arena);
+        }
+        return arena;
+    }
+
     // Until the Create/Destroy functions are exposed:
     // The context is created on demand, and we also need to destroy it automatically
     struct ContextDestroyer
@@ -144,7 +323,7 @@ namespace dmMessage
         {
             if (g_MessageContext)
             {
-                delete g_MessageContext;
+                Destroy(g_MessageContext);
                 g_MessageContext = 0;
             }
         }
@@ -178,8 +357,8 @@ namespace dmMessage
 
         MessageSocket s;
         s.m_RefCount = 1;
-        s.m_Header = 0;
-        s.m_Tail = 0;
+        s.m_Head = 0;
+        s.m_Waiting = 0;
         s.m_NameHash = name_hash;
         s.m_Name = strdup(name);
         s.m_Mutex = dmMutex::New();
@@ -191,39 +370,37 @@ namespace dmMessage
         return RESULT_OK;
     }
 
+    // Takes all posted messages from the socket, in the order they were posted
+    static Message* TakeMessages(MessageSocket* s)
+    {
+        Message* message_object = (Message*) dmAtomicStorePtr((void* volatile*) &s->m_Head, 0);
+        Message* reversed = 0;
+        while (message_object)
+        {
+            Message* next = message_object->m_Next;
+            message_object->m_Next = reversed;
+            reversed = message_object;
+            message_object = next;
+        }
+        return reversed;
+    }
+
     static void DisposeSocket(MessageSocket* s)
     {
-        Message *message_object = s->m_Header;
+        Message *message_object = TakeMessages(s);
         while (message_object)
         {
+            Message* next = message_object->m_Next;
             if (message_object->m_DestroyCallback)
             {
                 message_object->m_DestroyCallback(message_object);
             }
-            message_object = message_object->m_Next;
+            FreeMessage(message_object);
+            message_object = next;
         }
 
         free((void*) s->m_Name);
 
-        MemoryPage* p = s->m_Allocator.m_FreePages;
-        while (p)
-        {
-            MemoryPage* next = p->m_NextPage;
-            delete p;
-            p = next;
-        }
-        p = s->m_Allocator.m_FullPages;
-        while (p)
-        {
-            MemoryPage* next = p->m_NextPage;
-            delete p;
-            p = next;
-        }
-        if (s->m_Allocator.m_CurrentPage)
-        {
-            delete s->m_Allocator.m_CurrentPage;
-        }
-
         dmConditionVariable::Delete(s->m_Condition);
 
         dmMutex::Delete(s->m_Mutex);
@@ -343,11 +520,7 @@ namespace dmMessage
         MessageSocket* s = AcquireSocket(socket);
         if (s != 0)
         {
-            bool has_messages;
-            {
-                DM_MUTEX_SCOPED_LOCK(s->m_Mutex);
-                has_messages = s->m_Header != 0;
-            }
+            bool has_messages = s->m_Head != 0;
             ReleaseSocket(s);
             return has_messages;
         }
@@ -375,11 +548,8 @@ namespace dmMessage
             return RESULT_SOCKET_NOT_FOUND;
         }
 
-        dmMutex::Lock(s->m_Mutex);
-
-        MemoryAllocator* allocator = &s->m_Allocator;
         uint32_t data_size = sizeof(Message) + message_data_size;
-        Message *new_message = (Message *) AllocateMessage(allocator, data_size);
+        Message *new_message = (Message *) AllocateMessage(GetThreadArena(), data_size);
         if (sender != 0x0)
         {
             new_message->m_Sender = *sender;
@@ -397,24 +567,20 @@ namespace dmMessage
         new_message->m_DestroyCallback = destroy_callback;
         memcpy(&new_message->m_Data[0], message_data, message_data_size);
 
-        bool is_first_message = !s->m_Header;
-
-        if (!s->m_Header)
-        {
-            s->m_Header = new_message;
-            s->m_Tail = new_message;
-        }
-        else
+        void* volatile* head = (void* volatile*) &s->m_Head;
+        void* prev;
+        do
         {
-            s->m_Tail->m_Next = new_message;
-            s->m_Tail = new_message;
-        }
+            prev = *head;
+            new_message->m_Next = (Message*) prev;
+        } while (dmAtomicCompareStorePtr(head, new_message, prev) != prev);
 
-        if (is_first_message)
+        // The mutex is only taken when a blocking dispatch is waiting for messages
+        if (prev == 0 && dmAtomicAdd32(&s->m_Waiting, 0) != 0)
         {
+            DM_MUTEX_SCOPED_LOCK(s->m_Mutex);
             dmConditionVariable::Signal(s->m_Condition);
         }
-        dmMutex::Unlock(s->m_Mutex);
 
         ReleaseSocket(s);
 
@@ -461,16 +627,17 @@ namespace dmMessage
             return 0;
         }
 
-        dmMutex::Lock(s->m_Mutex);
-
-        MemoryAllocator* allocator = &s->m_Allocator;
-
-        if (!s->m_Header)
+        if (!s->m_Head)
         {
             if (blocking) {
-                dmConditionVariable::Wait(s->m_Condition, s->m_Mutex);
+                DM_MUTEX_SCOPED_LOCK(s->m_Mutex);
+                dmAtomicIncrement32(&s->m_Waiting);
+                while (!s->m_Head)
+                {
+                    dmConditionVariable::Wait(s->m_Condition, s->m_Mutex);
+                }
+                dmAtomicDecrement32(&s->m_Waiting);
             } else {
-                dmMutex::Unlock(s->m_Mutex);
                 ReleaseSocket(s);
                 return 0;
             }
@@ -482,38 +649,20 @@ namespace dmMessage
 
         uint32_t dispatch_count = 0;
 
-        Message *message_object = s->m_Header;
-        s->m_Header = 0;
-        s->m_Tail = 0;
-
-        // Unlink full pages
-        MemoryPage* full_pages = allocator->m_FullPages;
-        allocator->m_FullPages = 0;
-
-        dmMutex::Unlock(s->m_Mutex);
+        Message *message_object = TakeMessages(s);
 
         while (message_object)
         {
+            Message* next = message_object->m_Next;
             dispatch_callback(message_object, user_ptr);
             if (message_object->m_DestroyCallback) {
                 message_object->m_DestroyCallback(message_object);
             }
-            message_object = message_object->m_Next;
+            FreeMessage(message_object);
+            message_object = next;
             dispatch_count++;
         }
 
-        // Reclaim all full pages active when dispatch started
-        dmMutex::Lock(s->m_Mutex);
-        MemoryPage* p = full_pages;
-        while (p)
-        {
-            MemoryPage* next = p->m_NextPage;
-            p->m_NextPage = allocator->m_FreePages;
-            allocator->m_FreePages = p;
-            p = next;
-        }
-        dmMutex::Unlock(s->m_Mutex);
-
         ReleaseSocket(s);
 
         return dispatch_count;
@@ -13,6 +13,7 @@
 #include "profile.h"
 
 #include <algorithm>
+#include <stdio.h>
 #include <string.h>
 
 #if defined(_WIN32)
@@ -52,6 +53,8 @@ namespace dmProfile
         dmArray<ScopeData>   m_ScopesData;
         uint32_t             m_ScopeCount;
         uint32_t             m_CounterCount;
+        // Absolute tick when the profile became active
+        uint64_t             m_BeginTime;
     };
 
     // Default profile if not dmProfile::Initialize is invoked
@@ -79,7 +82,38 @@ namespace dmProfile
     bool g_Paused = false;
     dmSpinlock::lock_t g_ProfileLock;
 
-    dmThread::TlsKey g_TlsKey = dmThread::AllocTls();
+    // Capture of all released profiles, see StartCapture
+    const uint32_t CAPTURE_VERSION = 1;
+    const uint8_t CAPTURE_RECORD_STRING = 1;
+    const uint8_t CAPTURE_RECORD_FRAME = 2;
+    FILE* g_CaptureFile = 0;
+    // Name hashes already written to the capture
+    dmHashTable32<uint8_t> g_CaptureStrings;
+
+    // Samples are allocated by each thread from its own block in the active profile,
+    // so that g_ProfileLock is only taken once per block rather than once per sample.
+    // Slots left unused when the profile is swapped out get a null m_Scope.
+    const uint32_t SAMPLE_BLOCK_SIZE = 64;
+    const int32_t SAMPLE_BLOCK_CLOSED = 0x40000000;
+
+    struct ThreadSamples
+    {
+        // Written by the owning thread, with g_ProfileLock held
+        Profile*       m_Profile;
+        uint32_t       m_Begin;
+        uint32_t       m_Size;
+        // Next free slot in the block. Set to SAMPLE_BLOCK_CLOSED by Begin()
+        int32_atomic_t m_Next;
+        uint16_t       m_ThreadId;
+    };
+
+    // All threads that have allocated samples, guarded by g_ProfileLock
+    dmArray<ThreadSamples*> g_ThreadSamples;
+
+    static void FreeThreadSamples(void* value);
+
+    // Stores the ThreadSamples* of the calling thread, freed when the thread exits
+    dmThread::TlsKey g_TlsKey = dmThread::AllocTls(FreeThreadSamples);
     int32_atomic_t g_ThreadCount = 0;
 
     // Used when out of scopes in order to remove conditional branches
@@ -96,6 +130,49 @@ namespace dmProfile
 
     InitSpinLocks g_InitSpinlocks;
 
+    // Called with g_ProfileLock held
+    static void CloseSampleBlock(ThreadSamples* thread_samples, Profile* profile)
+    {
+        uint32_t used = (uint32_t) dmAtomicStore32(&thread_samples->m_Next, SAMPLE_BLOCK_CLOSED);
+        if (profile == 0 || thread_samples->m_Profile != profile)
+            return;
+
+        // A block that was already closed reports more than m_Size used slots
+        used = dmMath::Min(used, thread_samples->m_Size);
+        for (uint32_t j = used; j < thread_samples->m_Size; ++j)
+        {
+            profile->m_Samples[thread_samples->m_Begin + j].m_Scope = 0;
+        }
+    }
+
+    // Called with g_ProfileLock held
+    static void CloseSampleBlocks(Profile* profile)
+    {
+        uint32_t n = g_ThreadSamples.Size();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            CloseSampleBlock(g_ThreadSamples[i], profile);
+        }
+    }
+
+    static void FreeThreadSamples(void* value)
+    {
+        ThreadSamples* thread_samples = (ThreadSamples*) value;
+
+        DM_SPINLOCK_SCOPED_LOCK(g_ProfileLock)
+        CloseSampleBlock(thread_samples, g_ActiveProfile);
+        uint32_t n = g_ThreadSamples.Size();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            if (g_ThreadSamples[i] == thread_samples)
+            {
+                g_ThreadSamples.EraseSwap(i);
+                break;
+            }
+        }
+        delete thread_samples;
+    }
+
     void Initialize(uint32_t max_scopes, uint32_t max_samples, uint32_t max_counters)
     {
         if (!dLib::IsDebugMode())
@@ -119,6 +196,11 @@ namespace dmProfile
             g_Scopes.SetSize(0);
         }
 
+        {
+            DM_SPINLOCK_SCOPED_LOCK(g_ProfileLock)
+            CloseSampleBlocks(0);
+        }
+
         g_FreeProfiles.SetCapacity(PROFILE_BUFFER_COUNT);
         g_FreeProfiles.SetSize(0); // Could be > 0 if Initialized is called again after Finalize
 
@@ -143,6 +225,7 @@ namespace dmProfile
 
         g_ActiveProfile = g_FreeProfiles[0];
         g_FreeProfiles.EraseSwap(0);
+        g_ActiveProfile->m_BeginTime = GetNowTicks();
 
         /*
           Set up initial scope-data for the active profile as scope-data
@@ -184,10 +267,17 @@ namespace dmProfile
 
     void Finalize()
     {
+        StopCapture();
+
         // NOTE: We do not clear g_Scopes here
         // Might be dangerous as we have static references to Scope* in functions due to DM_PROFILE
         // See Initialize. It's not even valid to change the number of scopes
 
+        {
+            DM_SPINLOCK_SCOPED_LOCK(g_ProfileLock)
+            CloseSampleBlocks(0);
+        }
+
         for (uint32_t i = 0; i < PROFILE_BUFFER_COUNT; ++i)
         {
             Profile* p = &g_AllProfiles[i];
@@ -224,6 +314,8 @@ namespace dmProfile
         for (uint32_t i = 0; i < n_samples; ++i)
         {
             Sample* sample = &profile->m_Samples[i];
+            if (sample->m_Scope == 0)
+                continue;
 
             if (g_StringTable.Get((uintptr_t)sample->m_Name) == 0)
             {
@@ -327,6 +419,9 @@ namespace dmProfile
         for (uint32_t i = 0; i < n_samples; ++i)
         {
             Sample* sample = &profile->m_Samples[i];
+            if (sample->m_Scope == 0)
+                continue;
+
             if (!active_threads.Get(sample->m_ThreadId))
             {
                 if (active_threads.Full())
@@ -351,12 +446,6 @@ namespace dmProfile
 
         dmSpinlock::Lock(&g_ProfileLock);
 
-        CalculateScopeProfile(g_ActiveProfile);
-
-        Profile* ret = g_ActiveProfile;
-        ret->m_ScopeCount = g_Scopes.Size();
-        ret->m_CounterCount = g_Counters.Size();
-
         int wait_count = 0;
         while (g_FreeProfiles.Size() == 0)
         {
@@ -372,6 +461,15 @@ namespace dmProfile
             dmSpinlock::Lock(&g_ProfileLock);
         }
 
+        // Close the blocks while holding the lock, right before the swap. Otherwise threads
+        // could allocate new blocks in the active profile while we are waiting above
+        CloseSampleBlocks(g_ActiveProfile);
+        CalculateScopeProfile(g_ActiveProfile);
+
+        Profile* ret = g_ActiveProfile;
+        ret->m_ScopeCount = g_Scopes.Size();
+        ret->m_CounterCount = g_Counters.Size();
+
         Profile* profile = g_FreeProfiles[0];
         g_FreeProfiles.EraseSwap(0);
         g_ActiveProfile = profile;
@@ -394,7 +492,8 @@ namespace dmProfile
 
         profile->m_Samples.SetSize(0);
 
-        g_BeginTime = GetNowTicks();
+        profile->m_BeginTime = GetNowTicks();
+        g_BeginTime = (uint32_t) profile->m_BeginTime;
 
         g_OutOfScopes = false;
         g_OutOfSamples = false;
@@ -409,6 +508,117 @@ namespace dmProfile
         g_Paused = pause;
     }
 
+    static void WriteCapture(const void* data, uint32_t size)
+    {
+        fwrite(data, 1, size, g_CaptureFile);
+    }
+
+    static void WriteCaptureString(uint32_t name_hash, const char* name)
+    {
+        if (g_CaptureStrings.Get(name_hash))
+            return;
+
+        if (g_CaptureStrings.Full())
+        {
+            uint32_t capacity = g_CaptureStrings.Capacity() + 1024;
+            g_CaptureStrings.SetCapacity(capacity / 2, capacity);
+        }
+        g_CaptureStrings.Put(name_hash, 1);
+
+        uint16_t length = (uint16_t) dmMath::Min(strlen(name), (size_t) 0xffff);
+        WriteCapture(&CAPTURE_RECORD_STRING, 1);
+        WriteCapture(&name_hash, 4);
+        WriteCapture(&length, 2);
+        WriteCapture(name, length);
+    }
+
+    static void WriteCaptureFrame(Profile* profile)
+    {
+        uint32_t n_samples = profile->m_Samples.Size();
+        uint32_t sample_count = 0;
+        uint32_t counter_count = profile->m_CounterCount;
+
+        for (uint32_t i = 0; i < n_samples; ++i)
+        {
+            const Sample* sample = &profile->m_Samples[i];
+            if (sample->m_Scope == 0)
+                continue;
+            ++sample_count;
+            WriteCaptureString(sample->m_NameHash, sample->m_Name);
+            WriteCaptureString(sample->m_Scope->m_NameHash, sample->m_Scope->m_Name);
+        }
+        for (uint32_t i = 0; i < counter_count; ++i)
+        {
+            const Counter* counter = profile->m_CountersData[i].m_Counter;
+            WriteCaptureString(counter->m_NameHash, counter->m_Name);
+        }
+
+        WriteCapture(&CAPTURE_RECORD_FRAME, 1);
+        WriteCapture(&profile->m_BeginTime, 8);
+        WriteCapture(&sample_count, 4);
+        WriteCapture(&counter_count, 4);
+        for (uint32_t i = 0; i < n_samples; ++i)
+        {
+            const Sample* sample = &profile->m_Samples[i];
+            if (sample->m_Scope == 0)
+                continue;
+            WriteCapture(&sample->m_NameHash, 4);
+            WriteCapture(&sample->m_Scope->m_NameHash, 4);
+            WriteCapture(&sample->m_Start, 4);
+            WriteCapture(&sample->m_Elapsed, 4);
+            WriteCapture(&sample->m_ThreadId, 2);
+        }
+        for (uint32_t i = 0; i < counter_count; ++i)
+        {
+            const CounterData* counter_data = &profile->m_CountersData[i];
+            WriteCapture(&counter_data->m_Counter->m_NameHash, 4);
+            WriteCapture((const void*) &counter_data->m_Value, 4);
+        }
+    }
+
+    bool StartCapture(const char* path)
+    {
+        if (!g_IsInitialized)
+        {
+            dmLogError("dmProfile is not initialized");
+            return false;
+        }
+
+        StopCapture();
+
+        g_CaptureFile = fopen(path, "wb");
+        if (!g_CaptureFile)
+        {
+            dmLogError("Failed to open profile capture file '%s'", path);
+            return false;
+        }
+        setvbuf(g_CaptureFile, 0, _IOFBF, 1024 * 1024);
+
+        g_CaptureStrings.SetCapacity(512, 1024);
+        g_CaptureStrings.Clear();
+
+        WriteCapture("DMPC", 4);
+        WriteCapture(&CAPTURE_VERSION, 4);
+        WriteCapture(&g_TicksPerSecond, 8);
+        dmLogInfo("Capturing profile to: %s", path);
+        return true;
+    }
+
+    void StopCapture()
+    {
+        if (!g_CaptureFile)
+            return;
+
+        fclose(g_CaptureFile);
+        g_CaptureFile = 0;
+        g_CaptureStrings.Clear();
+    }
+
+    bool IsCapturing()
+    {
+        return g_CaptureFile != 0;
+    }
+
     void Release(HProfile profile)
     {
         if (!g_IsInitialized)
@@ -419,6 +629,12 @@ namespace dmProfile
         if (!profile)
             return;
 
+        // The profile isn't written to anymore, no need to hold the lock while writing
+        if (g_CaptureFile)
+        {
+            WriteCaptureFrame(profile);
+        }
+
         DM_SPINLOCK_SCOPED_LOCK(g_ProfileLock)
         g_FreeProfiles.Push(profile);
     }
@@ -461,7 +677,53 @@ namespace dmProfile
     // Used when out of samples in order to remove conditional branches
     Sample g_DummySample = { "OUT_OF_SAMPLES", 0, 0, 0, 0 };
 
-    static Sample* AllocateNewSample()
+    static ThreadSamples* GetThreadSamples()
+    {
+        ThreadSamples* thread_samples = (ThreadSamples*) dmThread::GetTlsValue(g_TlsKey);
+        if (thread_samples == 0)
+        {
+            thread_samples = new ThreadSamples;
+            thread_samples->m_Profile = 0;
+            thread_samples->m_Begin = 0;
+            thread_samples->m_Size = 0;
+            thread_samples->m_Next = SAMPLE_BLOCK_CLOSED;
+            thread_samples->m_ThreadId = (uint16_t) dmAtomicIncrement32(&g_ThreadCount);
+            dmThread::SetTlsValue(g_TlsKey, thread_samples);
+
+            DM_SPINLOCK_SCOPED_LOCK(g_ProfileLock)
+            if (g_ThreadSamples.Full())
+            {
+                g_ThreadSamples.OffsetCapacity(16);
+            }
+            g_ThreadSamples.Push(thread_samples);
+        }
+        return thread_samples;
+    }
+
+    static Sample* AllocateSampleBlock(ThreadSamples* thread_samples)
+    {
+        DM_SPINLOCK_SCOPED_LOCK(g_ProfileLock)
+        Profile* profile = g_ActiveProfile;
+
+        uint32_t size = profile->m_Samples.Size();
+        uint32_t block_size = dmMath::Min(SAMPLE_BLOCK_SIZE, profile->m_Samples.Capacity() - size);
+        if (block_size == 0)
+        {
+            g_OutOfSamples = true;
+            dmAtomicStore32(&thread_samples->m_Next, SAMPLE_BLOCK_CLOSED);
+            return &g_DummySample;
+        }
+        profile->m_Samples.SetSize(size + block_size);
+
+        thread_samples->m_Profile = profile;
+        thread_samples->m_Begin = size;
+        thread_samples->m_Size = block_size;
+        // The first slot is returned
+        dmAtomicStore32(&thread_samples->m_Next, 1);
+        return &profile->m_Samples[size];
+    }
+
+    static Sample* AllocateNewSample(ThreadSamples* thread_samples)
     {
         // NOTE: We can't take the spinlock if paused
         // as it might already been taken in dmProfile:Begin()
@@ -472,41 +734,25 @@ namespace dmProfile
             return &g_DummySample;
         }
 
-        DM_SPINLOCK_SCOPED_LOCK(g_ProfileLock)
-        Profile* profile = g_ActiveProfile;
-
-        bool full = profile->m_Samples.Full();
-        if (full)
+        // Only the owning thread changes the block, Begin() can only close it
+        uint32_t index = (uint32_t) dmAtomicIncrement32(&thread_samples->m_Next);
+        if (index < thread_samples->m_Size)
         {
-            g_OutOfSamples = true;
-            return &g_DummySample;
+            return &thread_samples->m_Profile->m_Samples[thread_samples->m_Begin + index];
         }
-        profile->m_Samples.SetSize(profile->m_Samples.Size() + 1);
-        Sample* ret = profile->m_Samples.End() - 1;
-        return ret;
+        return AllocateSampleBlock(thread_samples);
     }
 
     Sample* AllocateSample()
     {
-        Sample* ret = AllocateNewSample();
+        ThreadSamples* thread_samples = GetThreadSamples();
+        Sample* ret = AllocateNewSample(thread_samples);
         if (ret == &g_DummySample)
         {
             return ret;
         }
 
-        void* tls_data = dmThread::GetTlsValue(g_TlsKey);
-        if (tls_data == 0)
-        {
-            // NOTE: We store thread_id + 1. Otherwise we can't differentiate between thread-id 0 and not initialized
-            int32_t next_thread_id = dmAtomicIncrement32(&g_ThreadCount) + 1;
-            void* thread_id = (void*)((uintptr_t)next_thread_id);
-            dmThread::SetTlsValue(g_TlsKey, thread_id);
-            tls_data = thread_id;
-        }
-        intptr_t thread_id = ((intptr_t)tls_data) - 1;
-        assert(thread_id >= 0);
-
-        ret->m_ThreadId = thread_id;
+        ret->m_ThreadId = thread_samples->m_ThreadId;
         return ret;
     }
 
@@ -622,9 +868,9 @@ namespace dmProfile
             return;
         }
 
-        DM_SPINLOCK_SCOPED_LOCK(g_ProfileLock)
+        // No lock needed, the counter data is only reset in Begin() for the next profile
         Profile* profile = g_ActiveProfile;
-        profile->m_CountersData[counter_index].m_Value += amount;
+        dmAtomicAdd32(&profile->m_CountersData[counter_index].m_Value, (int32_t) amount);
     }
 
     float GetFrameTime()
@@ -741,15 +987,19 @@ namespace dmProfile
         {
             for (uint32_t i = 0; i < n; ++i)
             {
-                call_back(context, &profile->m_Samples[i]);
+                if (profile->m_Samples[i].m_Scope != 0)
+                    call_back(context, &profile->m_Samples[i]);
             }
             return;
         }
         uint32_t* sorted_samples = (uint32_t*)alloca(sizeof(uint32_t) * n);
+        uint32_t n_sorted = 0;
         for (uint32_t i = 0; i < n; ++i)
         {
-            sorted_samples[i] = i;
+            if (profile->m_Samples[i].m_Scope != 0)
+                sorted_samples[n_sorted++] = i;
         }
+        n = n_sorted;
         std::sort(sorted_samples, &sorted_samples[n], SampleSorter(profile));
 
         for (uint32_t i = 0; i < n; ++i)
@@ -210,6 +210,35 @@ namespace dmProfile
      */
     void Release(HProfile profile);
 
+    /**
+     * Start writing every released profile, with all samples and counters, to a capture file.
+     * A capture already in progress is stopped. The capture is stopped by #Finalize.
+     * Use dlib/scripts/profile_capture_to_trace.py to convert the capture to the Chrome
+     * trace-event format, viewable in chrome://tracing or Perfetto.
+     *
+     * The format is little endian:
+     *  header: "DMPC", uint32_t version, uint64_t ticks per second
+     *  string record: uint8_t 1, uint32_t name hash, uint16_t length, char[length]
+     *  frame record: uint8_t 2, uint64_t begin tick, uint32_t sample count, uint32_t counter count,
+     *    per sample: uint32_t name hash, uint32_t scope name hash, uint32_t start (ticks since begin), uint32_t elapsed, uint16_t thread id
+     *    per counter: uint32_t name hash, int32_t value
+     * Strings are written once, before the first frame that references them.
+     * @param path Capture file path. The file is created and truncated.
+     * @return True if the capture was started
+     */
+    bool StartCapture(const char* path);
+
+    /**
+     * Stop the capture started with #StartCapture and close the file
+     */
+    void StopCapture();
+
+    /**
+     * Check if a capture is in progress
+     * @return True if capturing
+     */
+    bool IsCapturing();
+
     /**
      * Get ticks per second
      * @return Ticks per second
@@ -11,11 +11,12 @@
 // specific language governing permissions and limitations under the License.
 
 #include <assert.h>
-#include <dmsdk/dlib/thread.h>
+#include "thread.h"
 
 #if defined(_WIN32)
 #include <stdlib.h>
 #include <wchar.h>
+#include "spinlock.h"
 #endif
 
 namespace dmThread
@@ -91,9 +92,14 @@ namespace dmThread
     }
 
     TlsKey AllocTls()
+    {
+        return AllocTls(0);
+    }
+
+    TlsKey AllocTls(TlsDestructor destructor)
     {
         pthread_key_t key;
-        int ret = pthread_key_create(&key, 0);
+        int ret = pthread_key_create(&key, destructor);
         assert(ret == 0);
         return key;
     }
@@ -159,12 +165,49 @@ namespace dmThread
     #endif
     }
 
+    // Windows TLS has no destructors, so they are called when a thread created with New exits
+    const uint32_t MAX_TLS_DESTRUCTORS = 16;
+    static dmSpinlock::lock_t g_TlsDestructorLock;
+    static TlsKey g_TlsDestructorKeys[MAX_TLS_DESTRUCTORS];
+    static TlsDestructor g_TlsDestructors[MAX_TLS_DESTRUCTORS];
+
+    struct ThreadData
+    {
+        ThreadStart m_Start;
+        void*       m_Arg;
+    };
+
+    static DWORD WINAPI ThreadStartProxy(LPVOID arg)
+    {
+        ThreadData* data = (ThreadData*) arg;
+        data->m_Start(data->m_Arg);
+        delete data;
+
+        DM_SPINLOCK_SCOPED_LOCK(g_TlsDestructorLock);
+        for (uint32_t i = 0; i < MAX_TLS_DESTRUCTORS; ++i)
+        {
+            if (g_TlsDestructors[i] == 0)
+                continue;
+            void* value = TlsGetValue(g_TlsDestructorKeys[i]);
+            if (value)
+            {
+                TlsSetValue(g_TlsDestructorKeys[i], 0);
+                g_TlsDestructors[i](value);
+            }
+        }
+        return 0;
+    }
+
     Thread New(ThreadStart thread_start, uint32_t stack_size, void* arg, const char* name)
     {
+        ThreadData* thread_data = new ThreadData;
+        thread_data->m_Start = thread_start;
+        thread_data->m_Arg = arg;
+
         DWORD thread_id;
         HANDLE thread = CreateThread(NULL, stack_size,
-                                     (LPTHREAD_START_ROUTINE) thread_start,
-                                     arg, 0, &thread_id);
+                                     ThreadStartProxy,
+                                     thread_data, 0, &thread_id);
         assert(thread);
 
         SetThreadName((Thread)thread, name);
@@ -183,8 +226,32 @@ namespace dmThread
         return TlsAlloc();
     }
 
+    TlsKey AllocTls(TlsDestructor destructor)
+    {
+        TlsKey key = TlsAlloc();
+        if (destructor)
+        {
+            DM_SPINLOCK_SCOPED_LOCK(g_TlsDestructorLock);
+            uint32_t i = 0;
+            while (i < MAX_TLS_DESTRUCTORS && g_TlsDestructors[i] != 0)
+                ++i;
+            assert(i < MAX_TLS_DESTRUCTORS);
+            g_TlsDestructorKeys[i] = key;
+            g_TlsDestructors[i] = destructor;
+        }
+        return key;
+    }
+
     void FreeTls(TlsKey key)
     {
+        {
+            DM_SPINLOCK_SCOPED_LOCK(g_TlsDestructorLock);
+            for (uint32_t i = 0; i < MAX_TLS_DESTRUCTORS; ++i)
+            {
+                if (g_TlsDestructors[i] != 0 && g_TlsDestructorKeys[i] == key)
+                    g_TlsDestructors[i] = 0;
+            }
+        }
         BOOL ret = TlsFree(key);
         assert(ret);
     }
@@ -15,4 +15,18 @@
 
 #include <dmsdk/dlib/thread.h>
 
+namespace dmThread
+{
+    typedef void (*TlsDestructor)(void* value);
+
+    /**
+     * Allocate thread local storage key with a destructor. When a thread exits, the destructor
+     * is called with the value of the key, unless it is null.
+     * On Windows, the destructor is only called for threads created with dmThread::New
+     * @param destructor Destructor
+     * @return Key
+     */
+    TlsKey AllocTls(TlsDestructor destructor);
+}
+
 #endif // DM_THREAD_H
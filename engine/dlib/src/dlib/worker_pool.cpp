@@ -0,0 +1,186 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+// 
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+// 
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <assert.h>
+#include "array.h"
+#include "condition_variable.h"
+#include "dstrings.h"
+#include "math.h"
+#include "mutex.h"
+#include "thread.h"
+#include "worker_pool.h"
+
+namespace dmWorkerPool
+{
+    const uint32_t MAX_WORKER_COUNT = 32;
+
+    // One ParallelFor call, lives on the stack of the calling thread
+    struct Job
+    {
+        RangeFunction m_Function;
+        void*         m_Context;
+        uint32_t      m_Count;
+        uint32_t      m_BatchSize;
+        uint32_t      m_BatchCount;
+        uint32_t      m_NextBatch;
+        uint32_t      m_DoneBatches;
+    };
+
+    struct WorkerPool
+    {
+        dmArray<dmThread::Thread>               m_Threads;
+        // dmThread::New doesn't copy the name, so it must outlive the thread start
+        char                                    m_ThreadNames[MAX_WORKER_COUNT][16];
+        // Protects all members below
+        dmMutex::HMutex                         m_Mutex;
+        dmConditionVariable::HConditionVariable m_WorkCondition;
+        dmConditionVariable::HConditionVariable m_DoneCondition;
+        // Jobs with batches left to start. Several threads may call ParallelFor at once
+        dmArray<Job*>                           m_Jobs;
+        uint32_t                                m_Quit : 1;
+    };
+
+    // Called with m_Mutex locked, returns with m_Mutex locked
+    static void RunBatch(WorkerPool* pool, Job* job)
+    {
+        uint32_t batch = job->m_NextBatch++;
+        if (job->m_NextBatch == job->m_BatchCount)
+        {
+            for (uint32_t i = 0; i < pool->m_Jobs.Size(); ++i)
+            {
+                if (pool->m_Jobs[i] == job)
+                {
+                    pool->m_Jobs.EraseSwap(i);
+                    break;
+                }
+            }
+        }
+        uint32_t begin = batch * job->m_BatchSize;
+        uint32_t end = dmMath::Min(begin + job->m_BatchSize, job->m_Count);
+
+        dmMutex::Unlock(pool->m_Mutex);
+        job->m_Function(job->m_Context, begin, end);
+        dmMutex::Lock(pool->m_Mutex);
+
+        if (++job->m_DoneBatches == job->m_BatchCount)
+        {
+            dmConditionVariable::Broadcast(pool->m_DoneCondition);
+        }
+    }
+
+    static void Worker(void* arg)
+    {
+        WorkerPool* pool = (WorkerPool*) arg;
+        dmMutex::Lock(pool->m_Mutex);
+        while (true)
+        {
+            while (!pool->m_Quit && pool->m_Jobs.Empty())
+            {
+                dmConditionVariable::Wait(pool->m_WorkCondition, pool->m_Mutex);
+            }
+            if (pool->m_Quit)
+                break;
+            RunBatch(pool, pool->m_Jobs[0]);
+        }
+        dmMutex::Unlock(pool->m_Mutex);
+    }
+
+    HWorkerPool New(uint32_t worker_count, const char* name)
+    {
+#if defined(__EMSCRIPTEN__)
+        worker_count = 0;
+#endif
+        worker_count = dmMath::Min(worker_count, MAX_WORKER_COUNT);
+
+        WorkerPool* pool = new WorkerPool;
+        pool->m_Mutex = dmMutex::New();
+        pool->m_WorkCondition = dmConditionVariable::New();
+        pool->m_DoneCondition = dmConditionVariable::New();
+        pool->m_Jobs.SetCapacity(4);
+        pool->m_Quit = 0;
+
+        pool->m_Threads.SetCapacity(worker_count);
+        for (uint32_t i = 0; i < worker_count; ++i)
+        {
+            char* thread_name = pool->m_ThreadNames[i];
+            dmSnPrintf(thread_name, sizeof(pool->m_ThreadNames[i]), "%s_%u", name, i);
+            pool->m_Threads.Push(dmThread::New(Worker, 0x80000, pool, thread_name));
+        }
+        return pool;
+    }
+
+    void Delete(HWorkerPool pool)
+    {
+        dmMutex::Lock(pool->m_Mutex);
+        pool->m_Quit = 1;
+        dmConditionVariable::Broadcast(pool->m_WorkCondition);
+        dmMutex::Unlock(pool->m_Mutex);
+
+        for (uint32_t i = 0; i < pool->m_Threads.Size(); ++i)
+        {
+            dmThread::Join(pool->m_Threads[i]);
+        }
+
+        dmConditionVariable::Delete(pool->m_DoneCondition);
+        dmConditionVariable::Delete(pool->m_WorkCondition);
+        dmMutex::Delete(pool->m_Mutex);
+        delete pool;
+    }
+
+    uint32_t GetWorkerCount(HWorkerPool pool)
+    {
+        return pool ? pool->m_Threads.Size() : 0;
+    }
+
+    void ParallelFor(HWorkerPool pool, RangeFunction function, void* context, uint32_t count, uint32_t batch_size)
+    {
+        if (count == 0)
+            return;
+
+        assert(batch_size > 0);
+        if (pool == 0 || pool->m_Threads.Empty() || count <= batch_size)
+        {
+            function(context, 0, count);
+            return;
+        }
+
+        Job job;
+        job.m_Function = function;
+        job.m_Context = context;
+        job.m_Count = count;
+        job.m_BatchSize = batch_size;
+        job.m_BatchCount = (count + batch_size - 1) / batch_size;
+        job.m_NextBatch = 0;
+        job.m_DoneBatches = 0;
+
+        dmMutex::Lock(pool->m_Mutex);
+        if (pool->m_Jobs.Full())
+        {
+            pool->m_Jobs.OffsetCapacity(4);
+        }
+        pool->m_Jobs.Push(&job);
+        dmConditionVariable::Broadcast(pool->m_WorkCondition);
+
+        // The calling thread takes part in its own work only, so a long job
+        // submitted from another thread never delays this call more than one batch per worker
+        while (job.m_NextBatch < job.m_BatchCount)
+        {
+            RunBatch(pool, &job);
+        }
+
+        while (job.m_DoneBatches < job.m_BatchCount)
+        {
+            dmConditionVariable::Wait(pool->m_DoneCondition, pool->m_Mutex);
+        }
+        dmMutex::Unlock(pool->m_Mutex);
+    }
+}
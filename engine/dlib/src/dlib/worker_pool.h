@@ -0,0 +1,76 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+// 
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+// 
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef DM_WORKER_POOL_H
+#define DM_WORKER_POOL_H
+
+#include <stdint.h>
+
+/**
+ * Fork-join worker pool. A range of work items is split into batches that are
+ * processed by the worker threads and the calling thread. The call blocks until
+ * all batches are done. ParallelFor may be called from several threads at once,
+ * e.g. the main thread and the resource loader thread, and the workers share
+ * the batches of all pending calls.
+ * @note ParallelFor must not be called from within a range function.
+ */
+namespace dmWorkerPool
+{
+    /**
+     * Worker pool handle
+     */
+    typedef struct WorkerPool* HWorkerPool;
+
+    /**
+     * Range function. Called once per batch with the half-open range [begin, end)
+     * @param context User context
+     * @param begin First item in batch
+     * @param end One past the last item in batch
+     */
+    typedef void (*RangeFunction)(void* context, uint32_t begin, uint32_t end);
+
+    /**
+     * Create a new worker pool. With a worker count of zero, or on platforms
+     * without thread support, all work is done on the calling thread.
+     * @param worker_count Number of worker threads
+     * @param name Thread name prefix
+     * @return New worker pool
+     */
+    HWorkerPool New(uint32_t worker_count, const char* name);
+
+    /**
+     * Delete worker pool. Joins all worker threads.
+     * @param pool Worker pool
+     */
+    void Delete(HWorkerPool pool);
+
+    /**
+     * Get the number of worker threads, not counting the calling thread
+     * @param pool Worker pool. Null is allowed.
+     * @return Worker count
+     */
+    uint32_t GetWorkerCount(HWorkerPool pool);
+
+    /**
+     * Process the range [0, count) in batches of batch_size items.
+     * The function is called on the calling thread if the pool is null, has no
+     * workers or the range fits in a single batch.
+     * @param pool Worker pool. Null is allowed.
+     * @param function Range function
+     * @param context User context
+     * @param count Number of items
+     * @param batch_size Number of items per batch
+     */
+    void ParallelFor(HWorkerPool pool, RangeFunction function, void* context, uint32_t count, uint32_t batch_size);
+}
+
+#endif // DM_WORKER_POOL_H
@@ -120,6 +120,101 @@ TEST(dmLog, LogFile)
     dmSys::Unlink(path);
 }
 
+TEST(dmLog, FatalFlush)
+{
+    if (!dLib::FeaturesSupported(DM_FEATURE_BIT_SOCKET_SERVER_TCP))
+    {
+        printf("Test disabled due to platform not supporting TCP");
+        return;
+    }
+
+    char path[DMPATH_MAX_PATH];
+    dmSys::GetLogPath(path, sizeof(path));
+    dmStrlCat(path, "log_fatal.txt", sizeof(path));
+
+    dmLogParams params;
+    dmLogInitialize(&params);
+    dmSetLogFile(path);
+    dmLogFatal("TESTING_FATAL");
+
+    // Must be in the file before the log system is finalized
+    char tmp[1024] = {0};
+    FILE* f = fopen(path, "rb");
+    ASSERT_NE((FILE*) 0, f);
+    fread(tmp, 1, sizeof(tmp) - 1, f);
+    fclose(f);
+    ASSERT_TRUE(strstr(tmp, "TESTING_FATAL") != 0);
+
+    dmLogFinalize();
+    dmSys::Unlink(path);
+}
+
+static const int LOG_BURST_THREADS = 4;
+static const int LOG_BURST_MESSAGES = 1000;
+
+static void LogBurstThread(void* arg)
+{
+    int thread_index = (int) (uintptr_t) arg;
+    uint64_t start = dmTime::GetTime();
+    for (int i = 0; i < LOG_BURST_MESSAGES; ++i)
+    {
+        dmLogInfo("BURST %d %d", thread_index, i);
+    }
+    uint64_t end = dmTime::GetTime();
+    printf("Thread %d: %.2f us per message\n", thread_index, (end - start) / (float) LOG_BURST_MESSAGES);
+}
+
+TEST(dmLog, Burst)
+{
+    if (!dLib::FeaturesSupported(DM_FEATURE_BIT_SOCKET_SERVER_TCP))
+    {
+        printf("Test disabled due to platform not supporting TCP");
+        return;
+    }
+
+    char path[DMPATH_MAX_PATH];
+    dmSys::GetLogPath(path, sizeof(path));
+    dmStrlCat(path, "log_burst.txt", sizeof(path));
+
+    dmLogParams params;
+    dmLogInitialize(&params);
+    dmSetLogFile(path);
+
+    dmThread::Thread threads[LOG_BURST_THREADS];
+    for (int i = 0; i < LOG_BURST_THREADS; ++i)
+    {
+        threads[i] = dmThread::New(LogBurstThread, 0x80000, (void*) (uintptr_t) i, "test");
+    }
+    for (int i = 0; i < LOG_BURST_THREADS; ++i)
+    {
+        dmThread::Join(threads[i]);
+    }
+    uint32_t dropped = dmLogGetDroppedCount();
+    dmLogFinalize();
+
+    // Every message is either written, in order per thread, or counted as dropped
+    int next[LOG_BURST_THREADS] = {0};
+    int written = 0;
+    char line[256];
+    FILE* f = fopen(path, "rb");
+    ASSERT_NE((FILE*) 0, f);
+    while (fgets(line, sizeof(line), f))
+    {
+        int thread_index, i;
+        const char* msg = strstr(line, "BURST ");
+        if (!msg || sscanf(msg, "BURST %d %d", &thread_index, &i) != 2)
+            continue;
+        ASSERT_TRUE(thread_index >= 0 && thread_index < LOG_BURST_THREADS);
+        ASSERT_LE(next[thread_index], i);
+        next[thread_index] = i + 1;
+        ++written;
+    }
+    fclose(f);
+    dmSys::Unlink(path);
+
+    ASSERT_EQ(LOG_BURST_THREADS * LOG_BURST_MESSAGES, written + (int) dropped);
+}
+
 static void TestLogCaptureCallback(void* user_data, const char* log)
 {
     dmArray<char>* log_output = (dmArray<char>*)user_data;
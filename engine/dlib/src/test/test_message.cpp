@@ -355,6 +355,150 @@ TEST(dmMessage, ThreadTest2)
     ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::DeleteSocket(receiver.m_Socket));
 }
 
+// Messages posted by exited threads must stay valid while their arenas are reused by new threads
+TEST(dmMessage, ShortLivedThreads)
+{
+    dmMessage::URL receiver;
+    dmMessage::ResetURL(receiver);
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::NewSocket("my_socket", &receiver.m_Socket));
+
+    uint32_t count = 0;
+    for (int round = 0; round < 8; ++round)
+    {
+        dmThread::Thread threads[4];
+        for (int i = 0; i < 4; ++i)
+            threads[i] = dmThread::New(&PostThread, 0xf0000, (void*) &receiver, "post");
+        for (int i = 0; i < 4; ++i)
+            dmThread::Join(threads[i]);
+
+        // Dispatch every other round so that pages outlive the threads that allocated them
+        if (round % 2 == 1)
+            count += dmMessage::Dispatch(receiver.m_Socket, HandleMessage, 0);
+    }
+    ASSERT_EQ(1024U * 4U * 8U, count);
+
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::DeleteSocket(receiver.m_Socket));
+}
+
+struct BenchPostContext
+{
+    dmMessage::URL* m_Receiver;
+    uint32_t        m_Count;
+};
+
+void BenchPostThread(void* arg)
+{
+    BenchPostContext* ctx = (BenchPostContext*) arg;
+    CustomMessageData1 data;
+    for (uint32_t i = 0; i < ctx->m_Count; ++i)
+    {
+        data.m_MyValue = i;
+        ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(0x0, ctx->m_Receiver, m_HashMessage1, 0, 0x0, &data, sizeof(data), 0));
+    }
+}
+
+TEST(dmMessage, BenchThreaded)
+{
+    const uint32_t max_thread_count = 8;
+    const uint32_t message_count = 1024 * 64;
+
+    dmMessage::URL receiver;
+    dmMessage::ResetURL(receiver);
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::NewSocket("my_socket", &receiver.m_Socket));
+
+    for (uint32_t thread_count = 1; thread_count <= max_thread_count; thread_count *= 2)
+    {
+        BenchPostContext ctx;
+        ctx.m_Receiver = &receiver;
+        ctx.m_Count = message_count;
+
+        dmThread::Thread threads[max_thread_count];
+        uint64_t start = dmTime::GetTime();
+        for (uint32_t i = 0; i < thread_count; ++i)
+        {
+            char name[32];
+            dmSnPrintf(name, sizeof(name), "post%u", i);
+            threads[i] = dmThread::New(&BenchPostThread, 0x80000, (void*) &ctx, name);
+        }
+
+        uint32_t total = message_count * thread_count;
+        uint32_t count = 0;
+        while (count < total)
+        {
+            count += dmMessage::Dispatch(receiver.m_Socket, HandleMessage, 0);
+        }
+        uint64_t end = dmTime::GetTime();
+
+        for (uint32_t i = 0; i < thread_count; ++i)
+        {
+            dmThread::Join(threads[i]);
+        }
+        ASSERT_EQ(total, count);
+        ASSERT_EQ(0u, dmMessage::Dispatch(receiver.m_Socket, HandleMessage, 0));
+
+        printf("Bench threaded %u producers: %f ms (%f messages/ms)\n", thread_count, (end-start) / 1000.0f, total / ((end-start) / 1000.0f));
+    }
+
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::DeleteSocket(receiver.m_Socket));
+}
+
+struct OrderContext
+{
+    uint32_t m_Next[4];
+};
+
+void HandleOrderMessage(dmMessage::Message *message_object, void *user_ptr)
+{
+    OrderContext* ctx = (OrderContext*) user_ptr;
+    uint32_t producer = (uint32_t) message_object->m_UserData;
+    uint32_t value = *(uint32_t*) message_object->m_Data;
+    assert(ctx->m_Next[producer] == value);
+    ctx->m_Next[producer] = value + 1;
+}
+
+void OrderPostThread(void* arg)
+{
+    dmMessage::URL* receiver = (dmMessage::URL*) ((uintptr_t*) arg)[0];
+    uintptr_t producer = ((uintptr_t*) arg)[1];
+    for (uint32_t i = 0; i < 1024 * 16; ++i)
+    {
+        ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(0x0, receiver, m_HashMessage1, producer, 0x0, &i, sizeof(i), 0));
+    }
+}
+
+// Messages from each thread must be dispatched in the order they were posted
+TEST(dmMessage, ThreadOrder)
+{
+    dmMessage::URL receiver;
+    dmMessage::ResetURL(receiver);
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::NewSocket("my_socket", &receiver.m_Socket));
+
+    uintptr_t args[4][2];
+    dmThread::Thread threads[4];
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        args[i][0] = (uintptr_t) &receiver;
+        args[i][1] = i;
+        threads[i] = dmThread::New(&OrderPostThread, 0x80000, (void*) args[i], "post");
+    }
+
+    OrderContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    uint32_t count = 0;
+    while (count < 1024 * 16 * 4)
+    {
+        count += dmMessage::Dispatch(receiver.m_Socket, HandleOrderMessage, &ctx);
+    }
+
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        dmThread::Join(threads[i]);
+        ASSERT_EQ(1024u * 16u, ctx.m_Next[i]);
+    }
+
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::DeleteSocket(receiver.m_Socket));
+}
+
 void HandleIntegrityMessage(dmMessage::Message *message_object, void *user_ptr)
 {
     dmhash_t hash = dmHashBuffer64(message_object->m_Data, message_object->m_DataSize);
@@ -388,6 +388,89 @@ TEST(dmProfile, ThreadProfile)
     dmProfile::Finalize();
 }
 
+static void ShortProfileThread(void* arg)
+{
+    for (int i = 0; i < 10; ++i)
+    {
+        DM_PROFILE(Short, "a")
+    }
+}
+
+// Threads that exit with a partially used sample block
+TEST(dmProfile, ShortLivedThreads)
+{
+    dmProfile::Initialize(128, 1024 * 1024, 16);
+
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        for (int i = 0; i < 64; ++i)
+        {
+            dmThread::Thread t = dmThread::New(ShortProfileThread, 0xf0000, 0, "short");
+            dmThread::Join(t);
+        }
+
+        std::vector<dmProfile::Sample> samples;
+        std::map<std::string, const dmProfile::ScopeData*> scopes;
+
+        dmProfile::HProfile profile = dmProfile::Begin();
+        dmProfile::IterateSamples(profile, &samples, false, &ProfileSampleCallback);
+        dmProfile::IterateScopeData(profile, &scopes, false, &ProfileScopeCallback);
+        dmProfile::Release(profile);
+
+        ASSERT_EQ(64U * 10U, samples.size());
+        ASSERT_EQ(64U * 10U, scopes["Short"]->m_Count);
+    }
+
+    dmProfile::Finalize();
+}
+
+static const uint32_t OVERHEAD_SCOPES_PER_THREAD = 20000;
+
+static void ProfileOverheadThread(void* arg)
+{
+    uint64_t* elapsed = (uint64_t*) arg;
+    uint64_t start = dmTime::GetTime();
+    for (uint32_t i = 0; i < OVERHEAD_SCOPES_PER_THREAD; ++i)
+    {
+        DM_PROFILE(Overhead, "overhead")
+    }
+    *elapsed = dmTime::GetTime() - start;
+}
+
+// Per-scope cost when several threads are profiling at the same time
+TEST(dmProfile, ThreadOverhead)
+{
+    const uint32_t thread_counts[] = {1, 8};
+    for (uint32_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); ++t)
+    {
+        uint32_t thread_count = thread_counts[t];
+        dmProfile::Initialize(128, 1024 * 1024, 16);
+        dmProfile::Release(dmProfile::Begin());
+
+        dmThread::Thread threads[8];
+        uint64_t elapsed[8];
+        for (uint32_t i = 0; i < thread_count; ++i)
+        {
+            threads[i] = dmThread::New(ProfileOverheadThread, 0xf0000, &elapsed[i], "overhead");
+        }
+        uint64_t total = 0;
+        for (uint32_t i = 0; i < thread_count; ++i)
+        {
+            dmThread::Join(threads[i]);
+            total += elapsed[i];
+        }
+
+        std::vector<dmProfile::Sample> samples;
+        dmProfile::HProfile profile = dmProfile::Begin();
+        dmProfile::IterateSamples(profile, &samples, false, &ProfileSampleCallback);
+        dmProfile::Release(profile);
+        dmProfile::Finalize();
+
+        printf("%u threads: %.1f ns per scope\n", thread_count, (total * 1000.0) / (thread_count * OVERHEAD_SCOPES_PER_THREAD));
+        ASSERT_EQ(thread_count * OVERHEAD_SCOPES_PER_THREAD, samples.size());
+    }
+}
+
 TEST(dmProfile, DynamicScope)
 {
     const char* FUNCTION_NAMES[] = {
@@ -481,6 +564,91 @@ TEST(dmProfile, DynamicScope)
     dmProfile::Finalize();
 }
 
+template <typename T>
+static T ReadCapture(FILE* f)
+{
+    T value = 0;
+    fread(&value, sizeof(T), 1, f);
+    return value;
+}
+
+TEST(dmProfile, Capture)
+{
+    const char* path = "tmp_profile_capture.dmcapture";
+    dmProfile::Initialize(128, 1024, 16);
+    ASSERT_TRUE(dmProfile::StartCapture(path));
+    ASSERT_TRUE(dmProfile::IsCapturing());
+
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        dmProfile::HProfile profile = dmProfile::Begin();
+        dmProfile::Release(profile);
+        for (int i = 0; i < 10; ++i)
+        {
+            DM_PROFILE(CaptureScope, "CaptureSample");
+            DM_COUNTER("CaptureCounter", 2);
+        }
+    }
+    dmProfile::Release(dmProfile::Begin());
+    dmProfile::StopCapture();
+    ASSERT_FALSE(dmProfile::IsCapturing());
+    dmProfile::Finalize();
+
+    FILE* f = fopen(path, "rb");
+    ASSERT_NE((FILE*) 0, f);
+    char magic[5] = {0};
+    fread(magic, 1, 4, f);
+    ASSERT_STREQ("DMPC", magic);
+    ASSERT_EQ(1U, ReadCapture<uint32_t>(f));
+    ASSERT_EQ(dmProfile::GetTicksPerSecond(), ReadCapture<uint64_t>(f));
+
+    std::map<uint32_t, std::string> strings;
+    uint32_t frames = 0;
+    uint32_t samples = 0;
+    int32_t counter_total = 0;
+    uint8_t type;
+    while (fread(&type, 1, 1, f) == 1)
+    {
+        if (type == 1)
+        {
+            uint32_t hash = ReadCapture<uint32_t>(f);
+            uint16_t length = ReadCapture<uint16_t>(f);
+            std::string name(length, ' ');
+            fread(&name[0], 1, length, f);
+            ASSERT_EQ(0U, strings.count(hash));
+            strings[hash] = name;
+        }
+        else
+        {
+            ASSERT_EQ(2, type);
+            ++frames;
+            ReadCapture<uint64_t>(f);
+            uint32_t sample_count = ReadCapture<uint32_t>(f);
+            uint32_t counter_count = ReadCapture<uint32_t>(f);
+            for (uint32_t i = 0; i < sample_count; ++i)
+            {
+                ASSERT_EQ("CaptureSample", strings[ReadCapture<uint32_t>(f)]);
+                ASSERT_EQ("CaptureScope", strings[ReadCapture<uint32_t>(f)]);
+                ReadCapture<uint32_t>(f);
+                ReadCapture<uint32_t>(f);
+                ReadCapture<uint16_t>(f);
+                ++samples;
+            }
+            for (uint32_t i = 0; i < counter_count; ++i)
+            {
+                ASSERT_EQ("CaptureCounter", strings[ReadCapture<uint32_t>(f)]);
+                counter_total += ReadCapture<int32_t>(f);
+            }
+        }
+    }
+    fclose(f);
+    remove(path);
+
+    ASSERT_EQ(4U, frames);
+    ASSERT_EQ(3U * 10U, samples);
+    ASSERT_EQ(3 * 10 * 2, counter_total);
+}
+
 #else
 #endif
 
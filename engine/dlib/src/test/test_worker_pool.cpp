@@ -0,0 +1,129 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+// 
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+// 
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <stdint.h>
+#define JC_TEST_IMPLEMENTATION
+#include <jc_test/jc_test.h>
+#include <dlib/array.h>
+#include <dlib/atomic.h>
+#include <dlib/thread.h>
+#include <dlib/worker_pool.h>
+
+struct RangeContext
+{
+    dmArray<uint32_t> m_Values;
+    int32_atomic_t    m_CallCount;
+};
+
+static void Square(void* _ctx, uint32_t begin, uint32_t end)
+{
+    RangeContext* ctx = (RangeContext*) _ctx;
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        ctx->m_Values[i] = i * i;
+    }
+    dmAtomicIncrement32(&ctx->m_CallCount);
+}
+
+static void RunSquare(dmWorkerPool::HWorkerPool pool, uint32_t count, uint32_t batch_size, uint32_t expected_calls)
+{
+    RangeContext ctx;
+    ctx.m_Values.SetCapacity(count);
+    ctx.m_Values.SetSize(count);
+    ctx.m_CallCount = 0;
+    for (uint32_t i = 0; i < count; ++i)
+        ctx.m_Values[i] = 0xffffffff;
+
+    dmWorkerPool::ParallelFor(pool, Square, &ctx, count, batch_size);
+
+    ASSERT_EQ(expected_calls, (uint32_t) ctx.m_CallCount);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        ASSERT_EQ(i * i, ctx.m_Values[i]);
+    }
+}
+
+TEST(dmWorkerPool, NullPool)
+{
+    ASSERT_EQ(0u, dmWorkerPool::GetWorkerCount(0));
+    RunSquare(0, 1000, 16, 1);
+}
+
+TEST(dmWorkerPool, NoWorkers)
+{
+    dmWorkerPool::HWorkerPool pool = dmWorkerPool::New(0, "test_pool");
+    ASSERT_EQ(0u, dmWorkerPool::GetWorkerCount(pool));
+    RunSquare(pool, 1000, 16, 1);
+    dmWorkerPool::Delete(pool);
+}
+
+TEST(dmWorkerPool, Batches)
+{
+    dmWorkerPool::HWorkerPool pool = dmWorkerPool::New(4, "test_pool");
+#if !defined(__EMSCRIPTEN__)
+    ASSERT_EQ(4u, dmWorkerPool::GetWorkerCount(pool));
+#endif
+    uint32_t expected = dmWorkerPool::GetWorkerCount(pool) ? 63 : 1;
+    RunSquare(pool, 1000, 16, expected);
+    // Single batch, run on the calling thread
+    RunSquare(pool, 16, 16, 1);
+    // Empty range
+    RunSquare(pool, 0, 16, 0);
+    dmWorkerPool::Delete(pool);
+}
+
+TEST(dmWorkerPool, Repeated)
+{
+    dmWorkerPool::HWorkerPool pool = dmWorkerPool::New(3, "test_pool");
+    for (uint32_t i = 0; i < 500; ++i)
+    {
+        uint32_t count = 1 + (i * 37) % 2000;
+        uint32_t batch_size = 1 + i % 64;
+        uint32_t expected = (dmWorkerPool::GetWorkerCount(pool) && count > batch_size) ? (count + batch_size - 1) / batch_size : 1;
+        RunSquare(pool, count, batch_size, expected);
+    }
+    dmWorkerPool::Delete(pool);
+}
+
+static void RepeatedSquare(void* arg)
+{
+    dmWorkerPool::HWorkerPool pool = (dmWorkerPool::HWorkerPool) arg;
+    uint32_t expected = dmWorkerPool::GetWorkerCount(pool) ? 63 : 1;
+    for (uint32_t i = 0; i < 200; ++i)
+    {
+        RunSquare(pool, 1000, 16, expected);
+    }
+}
+
+TEST(dmWorkerPool, ConcurrentCallers)
+{
+    dmWorkerPool::HWorkerPool pool = dmWorkerPool::New(2, "test_pool");
+#if !defined(__EMSCRIPTEN__)
+    dmThread::Thread threads[3];
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        threads[i] = dmThread::New(RepeatedSquare, 0x80000, pool, "test");
+    }
+    RepeatedSquare(pool);
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        dmThread::Join(threads[i]);
+    }
+#endif
+    dmWorkerPool::Delete(pool);
+}
+
+int main(int argc, char **argv)
+{
+    jc_test_init(&argc, argv);
+    return jc_test_run_all();
+}
@@ -204,6 +204,7 @@ namespace dmEngine
     Engine::Engine(dmEngineService::HEngineService engine_service)
     : m_Config(0)
     , m_Alive(true)
+    , m_WorkerPool(0)
     , m_MainCollection(0)
     , m_LastReloadMTime(0)
     , m_MouseSensitivity(1.0f)
@@ -324,6 +325,12 @@ namespace dmEngine
             dmResource::DeleteFactory(engine->m_Factory);
         }
 
+        // Deleted after the factory since the resource loader thread decodes textures on the pool
+        if (engine->m_WorkerPool)
+        {
+            dmWorkerPool::Delete(engine->m_WorkerPool);
+        }
+
         if (engine->m_GraphicsContext)
         {
             dmGraphics::CloseWindow(engine->m_GraphicsContext);
@@ -544,6 +551,7 @@ namespace dmEngine
         const char verify_graphics_calls_arg[] = "--verify-graphics-calls=";
         const char renderdoc_support_arg[] = "--renderdoc";
         const char validation_layers_support_arg[] = "--use-validation-layers";
+        const char profile_capture_arg[] = "--profile-capture=";
         for (int i = 0; i < argc; ++i)
         {
             const char* arg = argv[i];
@@ -566,6 +574,13 @@ namespace dmEngine
             {
                 use_validation_layers = true;
             }
+            else if (strncmp(profile_capture_arg, arg, sizeof(profile_capture_arg)-1) == 0)
+            {
+                // Records every frame until the engine shuts down, see dmProfile::StartCapture
+                // Keep the capture running over reboots
+                if (!dmProfile::IsCapturing())
+                    dmProfile::StartCapture(arg + sizeof(profile_capture_arg)-1);
+            }
         }
 
         dmBuffer::NewContext();
@@ -705,6 +720,9 @@ namespace dmEngine
         dmResource::NewFactoryParams params;
         params.m_MaxResources = max_resources;
         params.m_Flags = 0;
+        params.m_LoadQueueThreadCount = dmConfigFile::GetInt(engine->m_Config, "resource.load_thread_count", params.m_LoadQueueThreadCount);
+        params.m_LoadQueueSize = dmConfigFile::GetInt(engine->m_Config, "resource.load_queue_size", params.m_LoadQueueSize);
+        params.m_LoadQueueMaxPendingData = dmConfigFile::GetInt(engine->m_Config, "resource.load_max_pending_data", params.m_LoadQueueMaxPendingData);
 
         if (dLib::IsDebugMode())
         {
@@ -812,6 +830,9 @@ namespace dmEngine
         }
         dmGameObject::SetInputStackDefaultCapacity(engine->m_Register, dmConfigFile::GetInt(engine->m_Config, dmGameObject::COLLECTION_MAX_INPUT_STACK_ENTRIES_KEY, dmGameObject::DEFAULT_MAX_INPUT_STACK_CAPACITY));
 
+        engine->m_WorkerPool = dmWorkerPool::New(dmConfigFile::GetInt(engine->m_Config, "engine.worker_thread_count", 0), "worker");
+        dmGameObject::SetWorkerPool(engine->m_Register, engine->m_WorkerPool);
+
         dmRender::RenderContextParams render_params;
         render_params.m_MaxRenderTypes = 16;
         render_params.m_MaxInstances = (uint32_t) dmConfigFile::GetInt(engine->m_Config, "graphics.max_draw_calls", 1024);
@@ -894,6 +915,8 @@ namespace dmEngine
         }
         physics_params.m_ContactImpulseLimit = dmConfigFile::GetFloat(engine->m_Config, "physics.contact_impulse_limit", 0.0f);
         physics_params.m_AllowDynamicTransforms = dmConfigFile::GetInt(engine->m_Config, "physics.allow_dynamic_transforms", 0) ? 1 : 0;
+        physics_params.m_ParallelIslands2D = dmConfigFile::GetInt(engine->m_Config, "physics.parallel_islands", 0) ? 1 : 0;
+        physics_params.m_WorkerPool = engine->m_WorkerPool;
         if (dmStrCaseCmp(physics_type, "3D") == 0)
         {
             engine->m_PhysicsContext.m_3D = true;
@@ -937,6 +960,7 @@ namespace dmEngine
         engine->m_ModelContext.m_RenderContext = engine->m_RenderContext;
         engine->m_ModelContext.m_Factory = engine->m_Factory;
         engine->m_ModelContext.m_MaxModelCount = max_model_count;
+        engine->m_ModelContext.m_WorkerPool = engine->m_WorkerPool;
 
         engine->m_MeshContext.m_RenderContext = engine->m_RenderContext;
         engine->m_MeshContext.m_Factory       = engine->m_Factory;
@@ -945,6 +969,7 @@ namespace dmEngine
         engine->m_SpineModelContext.m_RenderContext = engine->m_RenderContext;
         engine->m_SpineModelContext.m_Factory = engine->m_Factory;
         engine->m_SpineModelContext.m_MaxSpineModelCount = max_spine_count;
+        engine->m_SpineModelContext.m_WorkerPool = engine->m_WorkerPool;
 
         engine->m_LabelContext.m_RenderContext      = engine->m_RenderContext;
         engine->m_LabelContext.m_MaxLabelCount      = dmConfigFile::GetInt(engine->m_Config, "label.max_count", 64);
@@ -981,7 +1006,9 @@ namespace dmEngine
         fact_result = dmGameObject::RegisterResourceTypes(engine->m_Factory, engine->m_Register, engine->m_GOScriptContext, &engine->m_ModuleContext);
         if (fact_result != dmResource::RESULT_OK)
             goto bail;
-        fact_result = dmGameSystem::RegisterResourceTypes(engine->m_Factory, engine->m_RenderContext, &engine->m_GuiContext, engine->m_InputContext, &engine->m_PhysicsContext);
+        engine->m_TextureContext.m_GraphicsContext = engine->m_GraphicsContext;
+        engine->m_TextureContext.m_WorkerPool = engine->m_WorkerPool;
+        fact_result = dmGameSystem::RegisterResourceTypes(engine->m_Factory, engine->m_RenderContext, &engine->m_GuiContext, engine->m_InputContext, &engine->m_PhysicsContext, &engine->m_TextureContext);
         if (fact_result != dmResource::RESULT_OK)
             goto bail;
 
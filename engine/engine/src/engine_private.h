@@ -18,6 +18,7 @@
 #include <dlib/configfile.h>
 #include <dlib/hashtable.h>
 #include <dlib/message.h>
+#include <dlib/worker_pool.h>
 
 #include <resource/resource.h>
 
@@ -115,6 +116,8 @@ namespace dmEngine
         bool                                        m_Alive;
 
         dmGameObject::HRegister                     m_Register;
+        /// Shared worker pool for parallel engine work, e.g. transform updates of large collections
+        dmWorkerPool::HWorkerPool                   m_WorkerPool;
         dmGameObject::HCollection                   m_MainCollection;
         dmArray<dmGameObject::InputAction>          m_InputBuffer;
 
@@ -126,6 +129,7 @@ namespace dmEngine
         dmRender::HRenderContext                    m_RenderContext;
         dmGameSystem::PhysicsContext                m_PhysicsContext;
         dmGameSystem::ParticleFXContext             m_ParticleFXContext;
+        dmGameSystem::TextureContext                m_TextureContext;
         /// If the shared context is set, the three environment specific contexts below will point to the same context
         dmScript::HContext                          m_SharedScriptContext;
         dmScript::HContext                          m_GOScriptContext;
@@ -20,6 +20,7 @@
 #include <dlib/ssdp.h>
 #include <dlib/socket.h>
 #include <dlib/sys.h>
+#include <dlib/path.h>
 #include <dlib/template.h>
 #include <dlib/profile.h>
 #include <ddf/ddf.h>
@@ -861,6 +862,48 @@ namespace dmEngineService
     }
 
 
+    // Starts or stops a dmProfile capture to disk
+    //   /profile_capture/start - writes to profile.dmcapture in the log directory
+    //   /profile_capture/stop
+    static void HttpProfileCapture(void* user_ctx, dmWebServer::Request* request)
+    {
+        char response[DMPATH_MAX_PATH + 64];
+        const char* command = request->m_Resource + sizeof("/profile_capture/") - 1;
+        if (strcmp(command, "start") == 0)
+        {
+            char sys_path[DMPATH_MAX_PATH];
+            char path[DMPATH_MAX_PATH];
+            if (dmSys::GetLogPath(sys_path, sizeof(sys_path)) != dmSys::RESULT_OK)
+            {
+                dmStrlCpy(sys_path, ".", sizeof(sys_path));
+            }
+            dmPath::Concat(sys_path, "profile.dmcapture", path, sizeof(path));
+            if (dmProfile::StartCapture(path))
+            {
+                dmSnPrintf(response, sizeof(response), "Capturing profile to %s", path);
+            }
+            else
+            {
+                dmWebServer::SetStatusCode(request, 500);
+                dmSnPrintf(response, sizeof(response), "Error. Failed to start profile capture to %s", path);
+            }
+        }
+        else if (strcmp(command, "stop") == 0)
+        {
+            dmProfile::StopCapture();
+            dmStrlCpy(response, "Profile capture stopped", sizeof(response));
+        }
+        else
+        {
+            dmWebServer::SetStatusCode(request, 404);
+            dmStrlCpy(response, "Unknown command. Use /profile_capture/start or /profile_capture/stop", sizeof(response));
+        }
+
+        dmWebServer::SendAttribute(request, "Access-Control-Allow-Origin", "*");
+        dmWebServer::SendAttribute(request, "Cache-Control", "no-store");
+        dmWebServer::Send(request, response, strlen(response));
+    }
+
 #undef CHECK_RESULT_BOOL
 
     //
@@ -897,6 +940,11 @@ namespace dmEngineService
         frame_params.m_Userdata = engine_service;
         dmWebServer::AddHandler(engine_service->m_WebServer, "/profile_frame", &frame_params);
 
+        dmWebServer::HandlerParams capture_params;
+        capture_params.m_Handler = HttpProfileCapture;
+        capture_params.m_Userdata = engine_service;
+        dmWebServer::AddHandler(engine_service->m_WebServer, "/profile_capture/", &capture_params);
+
         // The entry point to the engine service profiler
         dmWebServer::HandlerParams profile_params;
         profile_params.m_Handler = ProfileHandler;
@@ -126,7 +126,7 @@ namespace dmGameObject
 
             {
                 uint32_t profiler_hash = 0;
-                const char* profiler_string = dmScript::GetProfilerString(L, 0, script->m_LuaModule->m_Source.m_Filename, SCRIPT_FUNCTION_NAMES[script_function], 0, &profiler_hash);
+                const char* profiler_string = GetProfilerString(script, script_function, &profiler_hash);
                 DM_PROFILE_DYN(Script, profiler_string, profiler_hash);
                 if (dmScript::PCall(L, arg_count, 0) != 0)
                 {
@@ -316,7 +316,16 @@ namespace dmGameObject
             // An on_message function shouldn't return anything.
             {
                 uint32_t profiler_hash = 0;
-                const char* profiler_string = dmScript::GetProfilerString(L, is_callback ? -5 : 0, script_instance->m_Script->m_LuaModule->m_Source.m_Filename, SCRIPT_FUNCTION_NAMES[SCRIPT_FUNCTION_ONMESSAGE], message_name, &profiler_hash);
+                const char* profiler_string;
+                if (is_callback)
+                {
+                    // Callback names depend on the function and are not cached
+                    profiler_string = dmScript::GetProfilerString(L, -5, script_instance->m_Script->m_LuaModule->m_Source.m_Filename, SCRIPT_FUNCTION_NAMES[SCRIPT_FUNCTION_ONMESSAGE], message_name, &profiler_hash);
+                }
+                else
+                {
+                    profiler_string = GetMessageProfilerString(script_instance->m_Script, params.m_Message->m_Id, message_name, &profiler_hash);
+                }
                 DM_PROFILE_DYN(Script, profiler_string, profiler_hash);
                 if (dmScript::PCall(L, 4, 0) != 0)
                 {
@@ -530,7 +539,7 @@ namespace dmGameObject
             int ret;
             {
                 uint32_t profiler_hash = 0;
-                const char* profiler_string = dmScript::GetProfilerString(L, 0, script_instance->m_Script->m_LuaModule->m_Source.m_Filename, SCRIPT_FUNCTION_NAMES[SCRIPT_FUNCTION_ONINPUT], 0, &profiler_hash);
+                const char* profiler_string = GetProfilerString(script_instance->m_Script, SCRIPT_FUNCTION_ONINPUT, &profiler_hash);
                 DM_PROFILE_DYN(Message, profiler_string, profiler_hash);
                 ret = dmScript::PCall(L, arg_count, LUA_MULTRET);
             }
@@ -13,6 +13,8 @@
 #include <new>
 #include <algorithm>
 #include <stdio.h>
+#include <stdlib.h>
+#include <dlib/align.h>
 #include <dlib/dstrings.h>
 #include <dlib/log.h>
 #include <dlib/hashtable.h>
@@ -160,6 +162,7 @@ namespace dmGameObject
         m_ComponentTypeCount = 0;
         m_DefaultCollectionCapacity = DEFAULT_MAX_COLLECTION_CAPACITY;
         m_DefaultInputStackCapacity = DEFAULT_MAX_INPUT_STACK_CAPACITY;
+        m_WorkerPool = 0;
         m_Mutex = dmMutex::New();
         m_SocketToCollection.SetCapacity(15, 17);
     }
@@ -194,6 +197,7 @@ namespace dmGameObject
         m_InstanceIndices.SetCapacity(max_instances);
         m_WorldTransforms.SetCapacity(max_instances);
         m_WorldTransforms.SetSize(max_instances);
+        m_DirtyTransformIndices.SetCapacity(max_instances);
         m_IDToInstance.SetCapacity(dmMath::Max(1U, max_instances/3), max_instances);
         m_InputFocusStack.SetCapacity(max_input_stack_entries);
         m_NameHash = 0;
@@ -244,6 +248,12 @@ namespace dmGameObject
         regist->m_DefaultInputStackCapacity = capacity;
     }
 
+    void SetWorkerPool(HRegister regist, dmWorkerPool::HWorkerPool pool)
+    {
+        assert(regist != 0x0);
+        regist->m_WorkerPool = pool;
+    }
+
     static uint32_t GetInputStackDefaultCapacity(HRegister regist)
     {
         assert(regist != 0x0);
@@ -300,6 +310,11 @@ namespace dmGameObject
             if (regist->m_ComponentTypes[i].m_DeleteWorldFunction)
                 regist->m_ComponentTypes[i].m_DeleteWorldFunction(params);
         }
+        dmArray<void*>& blocks = collection->m_InstanceAllocator.m_Blocks;
+        for (uint32_t i = 0; i < blocks.Size(); ++i)
+        {
+            free(blocks[i]);
+        }
         dmMutex::Delete(collection->m_Mutex);
         delete collection;
     }
@@ -574,6 +589,17 @@ namespace dmGameObject
         if (ret != dmResource::RESULT_OK)
             return ret;
 
+        // These preload functions only parse the message and hint its dependencies, they don't touch their context
+        dmResource::SetPreloadThreadSafe(factory, "goc", true);
+        dmResource::SetPreloadThreadSafe(factory, "scriptc", true);
+        dmResource::SetPreloadThreadSafe(factory, "collectionc", true);
+
+        // These only describe other resources, load them first so that their dependencies are hinted early
+        dmResource::SetLoadPriority(factory, "goc", dmResource::LOAD_PRIORITY_HIGH);
+        dmResource::SetLoadPriority(factory, "scriptc", dmResource::LOAD_PRIORITY_HIGH);
+        dmResource::SetLoadPriority(factory, "luac", dmResource::LOAD_PRIORITY_HIGH);
+        dmResource::SetLoadPriority(factory, "collectionc", dmResource::LOAD_PRIORITY_HIGH);
+
         return ret;
     }
 
@@ -583,12 +609,12 @@ namespace dmGameObject
          * Remove instance from m_LevelIndices using an erase-swap operation
          */
 
-        dmArray<uint16_t>& level = collection->m_LevelIndices[instance->m_Depth];
+        dmArray<uint32_t>& level = collection->m_LevelIndices[instance->m_Depth];
         assert(level.Size() > 0);
         assert(instance->m_LevelIndex < level.Size());
 
-        uint16_t level_index = instance->m_LevelIndex;
-        uint16_t swap_in_index = level.EraseSwap(level_index);
+        uint32_t level_index = instance->m_LevelIndex;
+        uint32_t swap_in_index = level.EraseSwap(level_index);
         HInstance swap_in_instance = collection->m_Instances[swap_in_index];
         assert(swap_in_instance->m_Index == swap_in_index);
         swap_in_instance->m_LevelIndex = level_index;
@@ -600,7 +626,7 @@ namespace dmGameObject
      * ** 10 elements as min
      * ** Up to max_instances as max
      */
-    static void ExpandLevel(dmArray<uint16_t>& level, uint32_t max_instances)
+    static void ExpandLevel(dmArray<uint32_t>& level, uint32_t max_instances)
     {
         const uint32_t min_offset = 10;
         const uint32_t max_offset = max_instances - level.Capacity();
@@ -613,18 +639,57 @@ namespace dmGameObject
         /*
          * Insert instance in m_LevelIndices at level set in instance->m_Depth
          */
-        dmArray<uint16_t>& level = collection->m_LevelIndices[instance->m_Depth];
+        dmArray<uint32_t>& level = collection->m_LevelIndices[instance->m_Depth];
         if (level.Full())
             ExpandLevel(level, collection->m_MaxInstances);
         assert(!level.Full());
 
-        uint16_t level_index = (uint16_t)level.Size();
+        uint32_t level_index = (uint32_t)level.Size();
         level.SetSize(level_index + 1);
         level[level_index] = instance->m_Index;
         instance->m_LevelIndex = level_index;
     }
 
-    static HInstance AllocInstance(Prototype* proto, const char* prototype_name) {
+    static void* AllocInstanceMemory(InstanceAllocator& allocator, uint32_t user_data_count)
+    {
+        dmArray<void*>& free_lists = allocator.m_FreeLists;
+        if (free_lists.Size() <= user_data_count)
+        {
+            uint32_t size = free_lists.Size();
+            free_lists.SetCapacity(user_data_count + 1);
+            free_lists.SetSize(user_data_count + 1);
+            memset(&free_lists[size], 0, sizeof(void*) * (user_data_count + 1 - size));
+        }
+
+        void* memory = free_lists[user_data_count];
+        if (!memory)
+        {
+            // Keep every instance in the block aligned as if allocated with operator new
+            const uint32_t stride = DM_ALIGN(sizeof(Instance) + user_data_count * sizeof(((Instance*)0)->m_ComponentInstanceUserData[0]), 16);
+            const uint32_t count = InstanceAllocator::BLOCK_INSTANCE_COUNT;
+            uint8_t* block = (uint8_t*)malloc(stride * count);
+            if (allocator.m_Blocks.Full())
+                allocator.m_Blocks.OffsetCapacity(16);
+            allocator.m_Blocks.Push(block);
+
+            for (uint32_t i = 0; i < count - 1; ++i)
+            {
+                *(void**)(block + i * stride) = block + (i + 1) * stride;
+            }
+            *(void**)(block + (count - 1) * stride) = 0;
+            memory = block;
+        }
+        free_lists[user_data_count] = *(void**)memory;
+        return memory;
+    }
+
+    static void FreeInstanceMemory(InstanceAllocator& allocator, void* memory, uint32_t user_data_count)
+    {
+        *(void**)memory = allocator.m_FreeLists[user_data_count];
+        allocator.m_FreeLists[user_data_count] = memory;
+    }
+
+    static HInstance AllocInstance(Collection* collection, Prototype* proto, const char* prototype_name) {
         // Count number of component userdata fields required
         uint32_t component_instance_userdata_count = 0;
         for (uint32_t i = 0; i < proto->m_ComponentCount; ++i)
@@ -640,15 +705,15 @@ namespace dmGameObject
                 component_instance_userdata_count++;
         }
 
-        uint32_t component_userdata_size = sizeof(((Instance*)0)->m_ComponentInstanceUserData[0]);
         // NOTE: Allocate actual Instance with *all* component instance user-data accounted
-        void* instance_memory = ::operator new (sizeof(Instance) + component_instance_userdata_count * component_userdata_size);
+        void* instance_memory = AllocInstanceMemory(collection->m_InstanceAllocator, component_instance_userdata_count);
         Instance* instance = new(instance_memory) Instance(proto);
         instance->m_ComponentInstanceUserDataCount = component_instance_userdata_count;
         return instance;
     }
 
-    static void DeallocInstance(HInstance instance) {
+    static void DeallocInstance(Collection* collection, HInstance instance) {
+        uint32_t component_instance_userdata_count = instance->m_ComponentInstanceUserDataCount;
         instance->~Instance();
         void* instance_memory = (void*) instance;
 
@@ -656,7 +721,7 @@ namespace dmGameObject
         // TODO: #ifdef on something...?
         // Clear all memory excluding ComponentInstanceUserData
         memset(instance_memory, 0xcc, sizeof(Instance));
-        operator delete (instance_memory);
+        FreeInstanceMemory(collection->m_InstanceAllocator, instance_memory, component_instance_userdata_count);
     }
 
     HInstance NewInstance(Collection* collection, Prototype* proto, const char* prototype_name) {
@@ -665,15 +730,16 @@ namespace dmGameObject
             dmLogError("The game object instance could not be created since the buffer is full (%d).", collection->m_InstanceIndices.Capacity());
             return 0;
         }
-        HInstance instance = AllocInstance(proto, prototype_name);
+        HInstance instance = AllocInstance(collection, proto, prototype_name);
         instance->m_Collection = collection;
         instance->m_ScaleAlongZ = collection->m_ScaleAlongZ;
-        uint16_t instance_index = collection->m_InstanceIndices.Pop();
+        uint32_t instance_index = collection->m_InstanceIndices.Pop();
         instance->m_Index = instance_index;
         assert(collection->m_Instances[instance_index] == 0);
         collection->m_Instances[instance_index] = instance;
 
         InsertInstanceInLevelIndex(collection, instance);
+        SetTransformDirty(instance);
 
         return instance;
     }
@@ -693,8 +759,8 @@ namespace dmGameObject
             Unlink(collection, instance);
         }
 
-        uint16_t instance_index = instance->m_Index;
-        operator delete ((void*)instance);
+        uint32_t instance_index = instance->m_Index;
+        FreeInstanceMemory(collection->m_InstanceAllocator, instance, instance->m_ComponentInstanceUserDataCount);
         collection->m_Instances[instance_index] = 0x0;
         collection->m_InstanceIndices.Push(instance_index);
         assert(collection->m_IDToInstance.Size() <= collection->m_InstanceIndices.Size());
@@ -787,6 +853,122 @@ namespace dmGameObject
         return CreateComponents(hcollection->m_Collection, instance);
     }
 
+    static void DestroyComponentBatch(Collection* collection, Prototype::Component* component, HInstance* instances, uintptr_t** user_data, uint32_t count)
+    {
+        ComponentType* component_type = component->m_Type;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            collection->m_ComponentInstanceCount[component->m_TypeIndex]--;
+            ComponentDestroyParams params;
+            params.m_Collection = collection->m_HCollection;
+            params.m_Instance = instances[i];
+            params.m_World = collection->m_ComponentWorlds[component->m_TypeIndex];
+            params.m_Context = component_type->m_Context;
+            params.m_UserData = user_data[i];
+            component_type->m_DestroyFunction(params);
+        }
+    }
+
+    // Creates the components of the instances one component at a time, all the instances share the same prototype
+    static bool CreateComponentsBatch(Collection* collection, HInstance* instances, uint32_t count)
+    {
+        DM_PROFILE(GameObject, "CreateComponentsBatch");
+
+        Prototype* proto = instances[0]->m_Prototype;
+        if (proto->m_ComponentCount > 0xFFFF ) {
+            dmLogWarning("Too many components in game object: %u (max is 65536)", proto->m_ComponentCount);
+            return false;
+        }
+
+        // The user data pointers of all the instances, per component
+        dmArray<uintptr_t*> user_data;
+        user_data.SetCapacity(proto->m_ComponentCount * count);
+        user_data.SetSize(proto->m_ComponentCount * count);
+
+        uint32_t next_component_instance_data = 0;
+        uint32_t components_created = 0;
+        bool ok = true;
+        for (uint32_t i = 0; i < proto->m_ComponentCount; ++i)
+        {
+            Prototype::Component* component = &proto->m_Components[i];
+            ComponentType* component_type = component->m_Type;
+            assert(component_type);
+
+            DM_PROFILE_DYN(GameObjectCreateComponents, component_type->m_Name, component_type->m_NameHash);
+
+            uintptr_t** component_user_data = &user_data[i * count];
+            for (uint32_t j = 0; j < count; ++j)
+            {
+                component_user_data[j] = 0;
+                if (component_type->m_InstanceHasUserData)
+                {
+                    component_user_data[j] = &instances[j]->m_ComponentInstanceUserData[next_component_instance_data];
+                    *component_user_data[j] = 0;
+                }
+            }
+            if (component_type->m_InstanceHasUserData)
+                ++next_component_instance_data;
+            assert(next_component_instance_data <= instances[0]->m_ComponentInstanceUserDataCount);
+
+            if (component_type->m_CreateBatchFunction)
+            {
+                ComponentCreateBatchParams params;
+                params.m_Instances = instances;
+                params.m_UserData = component_user_data;
+                params.m_Count = count;
+                params.m_Position = component->m_Position;
+                params.m_Rotation = component->m_Rotation;
+                params.m_ComponentIndex = i;
+                params.m_Resource = component->m_Resource;
+                params.m_World = collection->m_ComponentWorlds[component->m_TypeIndex];
+                params.m_Context = component_type->m_Context;
+                params.m_PropertySet = component->m_PropertySet;
+                if (component_type->m_CreateBatchFunction(params) != CREATE_RESULT_OK)
+                {
+                    ok = false;
+                    break;
+                }
+                collection->m_ComponentInstanceCount[component->m_TypeIndex] += count;
+            }
+            else
+            {
+                ComponentCreateParams params;
+                params.m_Position = component->m_Position;
+                params.m_Rotation = component->m_Rotation;
+                params.m_ComponentIndex = i;
+                params.m_Resource = component->m_Resource;
+                params.m_World = collection->m_ComponentWorlds[component->m_TypeIndex];
+                params.m_Context = component_type->m_Context;
+                params.m_PropertySet = component->m_PropertySet;
+                for (uint32_t j = 0; j < count; ++j)
+                {
+                    params.m_Instance = instances[j];
+                    params.m_UserData = component_user_data[j];
+                    if (component_type->m_CreateFunction(params) != CREATE_RESULT_OK)
+                    {
+                        DestroyComponentBatch(collection, component, instances, component_user_data, j);
+                        ok = false;
+                        break;
+                    }
+                    collection->m_ComponentInstanceCount[component->m_TypeIndex]++;
+                }
+                if (!ok)
+                    break;
+            }
+            components_created++;
+        }
+
+        if (!ok)
+        {
+            for (uint32_t i = 0; i < components_created; ++i)
+            {
+                DestroyComponentBatch(collection, &proto->m_Components[i], instances, &user_data[i * count], count);
+            }
+        }
+
+        return ok;
+    }
+
     static void DestroyComponents(Collection* collection, HInstance instance) {
         DM_PROFILE(GameObject, "DestroyComponents");
 
@@ -942,8 +1124,8 @@ namespace dmGameObject
             return;
         }
         instance->m_ToBeAdded = 1;
-        uint16_t index = instance->m_Index;
-        uint16_t tail = collection->m_InstancesToAddTail;
+        uint32_t index = instance->m_Index;
+        uint32_t tail = collection->m_InstancesToAddTail;
         if (tail != INVALID_INSTANCE_INDEX) {
             HInstance tail_instance = collection->m_Instances[tail];
             tail_instance->m_NextToAdd = index;
@@ -1002,7 +1184,7 @@ namespace dmGameObject
             dmLogError("Instances can not be added to update during the update.");
             return false;
         }
-        uint16_t index = collection->m_InstancesToAddHead;
+        uint32_t index = collection->m_InstancesToAddHead;
         bool result = true;
         while (index != INVALID_INSTANCE_INDEX) {
             HInstance instance = collection->m_Instances[index];
@@ -1056,6 +1238,63 @@ namespace dmGameObject
         return true;
     }
 
+    // Deserializes the properties once per script component and hands a copy to each of the instances
+    static bool SetScriptPropertiesFromBufferBatch(HInstance* instances, uint32_t count, const char *prototype_name, uint8_t* property_buffer, uint32_t property_buffer_size)
+    {
+        uint32_t next_component_instance_data = 0;
+        Prototype::Component* components = instances[0]->m_Prototype->m_Components;
+        uint32_t component_count = instances[0]->m_Prototype->m_ComponentCount;
+        for (uint32_t i = 0; i < component_count; ++i) {
+            Prototype::Component& component = components[i];
+            ComponentType* component_type = component.m_Type;
+            uint32_t component_instance_data_index = next_component_instance_data;
+            if (component_type->m_InstanceHasUserData)
+            {
+                ++next_component_instance_data;
+            }
+
+            if (strcmp(component.m_Type->m_Name, "scriptc") != 0 || component.m_Type->m_SetPropertiesFunction == 0x0)
+            {
+                continue;
+            }
+
+            HPropertyContainer container = CreatePropertyContainerFromLua(component_type->m_Context, property_buffer, property_buffer_size);
+            if (container == 0x0)
+            {
+                dmLogError("Could not load properties parameters when spawning '%s'.", prototype_name);
+                return false;
+            }
+
+            for (uint32_t j = 0; j < count; ++j)
+            {
+                // The last instance takes the original
+                HPropertyContainer properties = j + 1 < count ? ClonePropertyContainer(container) : container;
+                if (properties == 0x0)
+                {
+                    dmLogError("Could not load properties parameters when spawning '%s'.", prototype_name);
+                    DestroyPropertyContainer(container);
+                    return false;
+                }
+
+                ComponentSetPropertiesParams params;
+                params.m_Instance = instances[j];
+                params.m_UserData = component_type->m_InstanceHasUserData ? &instances[j]->m_ComponentInstanceUserData[component_instance_data_index] : 0;
+                params.m_PropertySet.m_UserData = (uintptr_t)properties;
+                params.m_PropertySet.m_GetPropertyCallback = PropertyContainerGetPropertyCallback;
+                params.m_PropertySet.m_FreeUserDataCallback = DestroyPropertyContainerCallback;
+                PropertyResult result = component.m_Type->m_SetPropertiesFunction(params);
+                if (result != PROPERTY_RESULT_OK)
+                {
+                    dmLogError("Could not load properties when spawning '%s'.", prototype_name);
+                    if (properties != container)
+                        DestroyPropertyContainer(container);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
     // Supplied 'proto' will be released after this function is done.
     static HInstance SpawnInternal(Collection* collection, Prototype *proto, const char *prototype_name, dmhash_t id, uint8_t* property_buffer, uint32_t property_buffer_size, const Point3& position, const Quat& rotation, const Vector3& scale)
     {
@@ -1451,6 +1690,96 @@ namespace dmGameObject
         return instance;
     }
 
+    bool SpawnBatch(HCollection hcollection, HPrototype proto, const char* prototype_name, const dmhash_t* ids, uint8_t* property_buffer, uint32_t property_buffer_size,
+                    const Point3* positions, const Quat* rotations, const Vector3* scales, uint32_t count, HInstance* out_instances)
+    {
+        DM_PROFILE(GameObject, "SpawnBatch");
+
+        if (proto == 0x0) {
+            dmLogError("No prototype to spawn from.");
+            return false;
+        }
+        if (count == 0) {
+            return true;
+        }
+
+        Collection* collection = hcollection->m_Collection;
+        if (collection->m_ToBeDeleted) {
+            dmLogWarning("Spawning is not allowed when the collection is being deleted.");
+            return false;
+        }
+        if (collection->m_InstanceIndices.Remaining() < count)
+        {
+            dmLogError("Could not spawn %u instances of prototype %s since the buffer is full (%d).", count, prototype_name, collection->m_InstanceIndices.Capacity());
+            return false;
+        }
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            HInstance instance = dmGameObject::NewInstance(collection, proto, prototype_name);
+            assert(instance != 0);
+
+            dmResource::IncRef(collection->m_Factory, proto);
+
+            SetPosition(instance, positions[i]);
+            SetRotation(instance, rotations[i]);
+            SetScale(instance, scales[i]);
+            collection->m_WorldTransforms[instance->m_Index] = dmTransform::ToMatrix4(instance->m_Transform);
+
+            dmHashInit64(&instance->m_CollectionPathHashState, true);
+            dmHashUpdateBuffer64(&instance->m_CollectionPathHashState, ID_SEPARATOR, strlen(ID_SEPARATOR));
+
+            Result result = SetIdentifier(collection, instance, ids[i]);
+            if (result == RESULT_IDENTIFIER_IN_USE)
+            {
+                dmLogError("The identifier '%s' is already in use.", dmHashReverseSafe64(ids[i]));
+                UndoNewInstance(collection, instance);
+                for (uint32_t j = 0; j < i; ++j)
+                {
+                    ReleaseIdentifier(collection, out_instances[j]);
+                    UndoNewInstance(collection, out_instances[j]);
+                }
+                return false;
+            }
+            out_instances[i] = instance;
+        }
+
+        if (!CreateComponentsBatch(collection, out_instances, count))
+        {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                ReleaseIdentifier(collection, out_instances[i]);
+                UndoNewInstance(collection, out_instances[i]);
+            }
+            dmLogError("Could not spawn %u instances of prototype %s.", count, prototype_name);
+            return false;
+        }
+
+        bool success = SetScriptPropertiesFromBufferBatch(out_instances, count, prototype_name, property_buffer, property_buffer_size);
+
+        for (uint32_t i = 0; success && i < count; ++i)
+        {
+            if (!InitInstance(collection, out_instances[i]))
+            {
+                dmLogError("Could not initialize when spawning %s.", prototype_name);
+                success = false;
+            }
+        }
+
+        if (!success)
+        {
+            for (uint32_t i = 0; i < count; ++i)
+                Delete(collection, out_instances[i], false);
+            return false;
+        }
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            AddToUpdate(collection, out_instances[i]);
+        }
+        return true;
+    }
+
     static void Unlink(Collection* collection, Instance* instance)
     {
         // Unlink "me" from parent
@@ -1768,8 +2097,8 @@ namespace dmGameObject
         // Delete instance
         instance->m_ToBeDeleted = 1;
 
-        uint16_t index = instance->m_Index;
-        uint16_t tail = collection->m_InstancesToDeleteTail;
+        uint32_t index = instance->m_Index;
+        uint32_t tail = collection->m_InstancesToDeleteTail;
         if (tail != INVALID_INSTANCE_INDEX) {
             HInstance tail_instance = collection->m_Instances[tail];
             tail_instance->m_NextToDelete = index;
@@ -1786,10 +2115,10 @@ namespace dmGameObject
 
     static void RemoveFromAddToUpdate(Collection* collection, HInstance instance)
     {
-        uint16_t index = instance->m_Index;
+        uint32_t index = instance->m_Index;
         assert(collection->m_InstancesToAddTail == index || instance->m_NextToAdd != INVALID_INSTANCE_INDEX);
-        uint16_t* prev_index_ptr = &collection->m_InstancesToAddHead;
-        uint16_t prev_index = *prev_index_ptr;
+        uint32_t* prev_index_ptr = &collection->m_InstancesToAddHead;
+        uint32_t prev_index = *prev_index_ptr;
         while (prev_index != index) {
             prev_index_ptr = &collection->m_Instances[prev_index]->m_NextToAdd;
             if (collection->m_InstancesToAddTail == *prev_index_ptr) {
@@ -1840,6 +2169,7 @@ namespace dmGameObject
             Instance* child = collection->m_Instances[index];
             assert(child->m_Parent == instance->m_Index);
             child->m_Parent = instance->m_Parent;
+            SetTransformDirty(child);
             index = collection->m_Instances[index]->m_SiblingIndex;
         }
 
@@ -1899,7 +2229,7 @@ namespace dmGameObject
             collection->m_InputFocusStack.Pop();
         }
 
-        DeallocInstance(instance);
+        DeallocInstance(collection, instance);
 
         assert(collection->m_IDToInstance.Size() <= collection->m_InstanceIndices.Size());
     }
@@ -2010,11 +2340,11 @@ namespace dmGameObject
         return instance->m_Bone;
     }
 
-    static uint32_t DoSetBoneTransforms(HCollection hcollection, dmTransform::Transform* component_transform, uint16_t first_index, dmTransform::Transform* transforms, uint32_t transform_count)
+    static uint32_t DoSetBoneTransforms(HCollection hcollection, dmTransform::Transform* component_transform, uint32_t first_index, dmTransform::Transform* transforms, uint32_t transform_count)
     {
         if (transform_count == 0)
             return 0;
-        uint16_t current_index = first_index;
+        uint32_t current_index = first_index;
         uint32_t count = 0;
         Collection* collection = hcollection->m_Collection;
         while (current_index != INVALID_INSTANCE_INDEX)
@@ -2026,6 +2356,7 @@ namespace dmGameObject
                 if (component_transform && count == 1) {
                     instance->m_Transform = dmTransform::Mul(*component_transform, instance->m_Transform);
                 }
+                SetTransformDirty(instance);
                 if (count < transform_count)
                 {
                     count += DoSetBoneTransforms(hcollection, 0x0, instance->m_FirstChildIndex, &transforms[count], transform_count - count);
@@ -2045,8 +2376,8 @@ namespace dmGameObject
         return DoSetBoneTransforms(instance->m_Collection->m_HCollection, &component_transform, instance->m_Index, transforms, transform_count);
     }
 
-    static void DeleteBones(Collection* collection, uint16_t first_index) {
-        uint16_t current_index = first_index;
+    static void DeleteBones(Collection* collection, uint32_t first_index) {
+        uint32_t current_index = first_index;
         while (current_index != INVALID_INSTANCE_INDEX) {
             HInstance instance = collection->m_Instances[current_index];
             if (instance->m_Bone && instance->m_ToBeDeleted == 0) {
@@ -2171,6 +2502,8 @@ namespace dmGameObject
                     {
                         world = dmTransform::MulNoScaleZ(parent_t, dmTransform::ToMatrix4(instance->m_Transform));
                     }
+                    // The world transform was written directly, make sure it is recalculated even if the reparenting fails
+                    SetTransformDirty(instance);
                 }
                 else
                 {
@@ -2351,66 +2684,175 @@ namespace dmGameObject
         }
     }
 
-    void UpdateTransforms(Collection* collection)
+    // Levels with fewer instances than this are updated on the calling thread
+    static const uint32_t PARALLEL_TRANSFORM_LEVEL_SIZE = 1024;
+    static const uint32_t PARALLEL_TRANSFORM_BATCH_SIZE = 256;
+
+    static inline void CalculateWorldTransform(Instance** instances, Matrix4* world_transforms, bool scale_along_z, Instance* instance)
     {
-        DM_PROFILE(GameObject, "UpdateTransforms");
+        CheckEuler(instance);
 
-        // Calculate world transforms
-        // First root-level instances
-        dmArray<uint16_t>& root_level = collection->m_LevelIndices[0];
-        uint32_t root_count = root_level.Size();
-        for (uint32_t i = 0; i < root_count; ++i)
+        uint32_t index = instance->m_Index;
+        uint32_t parent_index = instance->m_Parent;
+        Matrix4 own = dmTransform::ToMatrix4(instance->m_Transform);
+        if (parent_index == INVALID_INSTANCE_INDEX)
+        {
+            world_transforms[index] = own;
+        }
+        else if (scale_along_z)
+        {
+            world_transforms[index] = world_transforms[parent_index] * own;
+        }
+        else
         {
-            uint16_t index = root_level[i];
-            Instance* instance = collection->m_Instances[index];
-            CheckEuler(instance);
-            collection->m_WorldTransforms[index] = dmTransform::ToMatrix4(instance->m_Transform);
-            uint16_t parent_index = instance->m_Parent;
-            assert(parent_index == INVALID_INSTANCE_INDEX);
+            world_transforms[index] = dmTransform::MulNoScaleZ(world_transforms[parent_index], own);
         }
+    }
+
+    struct UpdateLevelTransformsContext
+    {
+        Collection*     m_Collection;
+        const uint32_t* m_Level;
+    };
+
+    // Calculate the world transforms of the instances in [begin, end) of a level.
+    // The world transform is only recalculated if the instance is flagged dirty or the world transform
+    // of its parent was recalculated, otherwise the one from the last update is kept.
+    static void UpdateLevelTransforms(void* _ctx, uint32_t begin, uint32_t end)
+    {
+        UpdateLevelTransformsContext* ctx = (UpdateLevelTransformsContext*) _ctx;
+        Collection* collection = ctx->m_Collection;
+        const uint32_t* level = ctx->m_Level;
+        Instance** instances = collection->m_Instances.Begin();
+        Matrix4* world_transforms = collection->m_WorldTransforms.Begin();
+        bool scale_along_z = collection->m_ScaleAlongZ;
+
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            Instance* instance = instances[level[i]];
+            uint32_t parent_index = instance->m_Parent;
+            bool parent_changed = parent_index != INVALID_INSTANCE_INDEX && instances[parent_index]->m_WorldTransformChanged;
+            bool changed = instance->m_TransformDirty || parent_changed;
+            instance->m_WorldTransformChanged = changed;
+            if (!changed)
+                continue;
 
+            instance->m_TransformDirty = 0;
+            CalculateWorldTransform(instances, world_transforms, scale_along_z, instance);
+        }
+    }
 
-        if (collection->m_ScaleAlongZ) {
-            for (uint32_t level_i = 1; level_i < MAX_HIERARCHICAL_DEPTH; ++level_i)
+    static void UpdateAllLevelTransforms(Collection* collection, dmWorkerPool::HWorkerPool pool)
+    {
+        // Calculate world transforms level by level, starting with the root-level instances.
+        // All instances of a level only depend on the previous level, so each level can be split across the worker pool.
+        UpdateLevelTransformsContext ctx;
+        ctx.m_Collection = collection;
+        for (uint32_t level_i = 0; level_i < MAX_HIERARCHICAL_DEPTH; ++level_i)
+        {
+            dmArray<uint32_t>& level = collection->m_LevelIndices[level_i];
+            uint32_t instance_count = level.Size();
+            // A level can only be populated if the previous one is
+            if (instance_count == 0)
+                break;
+
+            ctx.m_Level = level.Begin();
+            if (instance_count >= PARALLEL_TRANSFORM_LEVEL_SIZE)
             {
-                dmArray<uint16_t>& level = collection->m_LevelIndices[level_i];
-                uint32_t instance_count = level.Size();
-                for (uint32_t i = 0; i < instance_count; ++i)
-                {
-                    uint16_t index = level[i];
-                    Instance* instance = collection->m_Instances[index];
-                    CheckEuler(instance);
-                    Matrix4* trans = &collection->m_WorldTransforms[index];
+                dmWorkerPool::ParallelFor(pool, UpdateLevelTransforms, &ctx, instance_count, PARALLEL_TRANSFORM_BATCH_SIZE);
+            }
+            else
+            {
+                UpdateLevelTransforms(&ctx, 0, instance_count);
+            }
+        }
+    }
 
-                    uint16_t parent_index = instance->m_Parent;
-                    assert(parent_index != INVALID_INSTANCE_INDEX);
+    static inline bool HasDirtyAncestor(Instance** instances, Instance* instance)
+    {
+        uint32_t parent_index = instance->m_Parent;
+        while (parent_index != INVALID_INSTANCE_INDEX)
+        {
+            Instance* parent = instances[parent_index];
+            if (parent->m_TransformDirty)
+                return true;
+            parent_index = parent->m_Parent;
+        }
+        return false;
+    }
 
-                    Matrix4* parent_trans = &collection->m_WorldTransforms[parent_index];
-                    Matrix4 own = dmTransform::ToMatrix4(instance->m_Transform);
-                    *trans = *parent_trans * own;
-                }
+    // Calculate the world transforms of an instance and all its descendants, parents before children
+    static void UpdateSubtreeTransforms(Collection* collection, Instance* root)
+    {
+        Instance** instances = collection->m_Instances.Begin();
+        Matrix4* world_transforms = collection->m_WorldTransforms.Begin();
+        bool scale_along_z = collection->m_ScaleAlongZ;
+
+        Instance* instance = root;
+        while (true)
+        {
+            instance->m_TransformDirty = 0;
+            CalculateWorldTransform(instances, world_transforms, scale_along_z, instance);
+
+            if (instance->m_FirstChildIndex != INVALID_INSTANCE_INDEX)
+            {
+                instance = instances[instance->m_FirstChildIndex];
+                continue;
             }
-        } else {
-            for (uint32_t level_i = 1; level_i < MAX_HIERARCHICAL_DEPTH; ++level_i)
+            // Move up until there is a sibling to continue with, without leaving the subtree
+            while (instance != root && instance->m_SiblingIndex == INVALID_INSTANCE_INDEX)
             {
-                dmArray<uint16_t>& level = collection->m_LevelIndices[level_i];
-                uint32_t instance_count = level.Size();
-                for (uint32_t i = 0; i < instance_count; ++i)
-                {
-                    uint16_t index = level[i];
-                    Instance* instance = collection->m_Instances[index];
-                    CheckEuler(instance);
-                    Matrix4* trans = &collection->m_WorldTransforms[index];
+                instance = instances[instance->m_Parent];
+            }
+            if (instance == root)
+                break;
+            instance = instances[instance->m_SiblingIndex];
+        }
+    }
+
+    void SetTransformDirty(HInstance instance)
+    {
+        if (instance->m_TransformDirty)
+            return;
+        instance->m_TransformDirty = 1;
 
-                    uint16_t parent_index = instance->m_Parent;
-                    assert(parent_index != INVALID_INSTANCE_INDEX);
+        dmArray<uint32_t>& dirty = instance->m_Collection->m_DirtyTransformIndices;
+        if (dirty.Full())
+        {
+            // Entries of instances deleted while dirty are kept until the next update
+            dirty.OffsetCapacity(64);
+        }
+        dirty.Push(instance->m_Index);
+    }
 
-                    Matrix4* parent_trans = &collection->m_WorldTransforms[parent_index];
-                    Matrix4 own = dmTransform::ToMatrix4(instance->m_Transform);
-                    *trans = dmTransform::MulNoScaleZ(*parent_trans, own);
-                }
+    void UpdateTransforms(Collection* collection)
+    {
+        DM_PROFILE(GameObject, "UpdateTransforms");
+
+        dmArray<uint32_t>& dirty = collection->m_DirtyTransformIndices;
+        uint32_t dirty_count = dirty.Size();
+        dmWorkerPool::HWorkerPool pool = collection->m_Register->m_WorkerPool;
+        if (pool != 0 && dirty_count >= PARALLEL_TRANSFORM_LEVEL_SIZE)
+        {
+            UpdateAllLevelTransforms(collection, pool);
+        }
+        else
+        {
+            // Only the subtrees of the dirty instances closest to the root need to be recalculated,
+            // the dirty instances below them are updated as part of their subtree
+            Instance** instances = collection->m_Instances.Begin();
+            for (uint32_t i = 0; i < dirty_count; ++i)
+            {
+                Instance* instance = instances[dirty[i]];
+                // Deleted, or already updated as part of a subtree
+                if (instance == 0 || !instance->m_TransformDirty)
+                    continue;
+                if (HasDirtyAncestor(instances, instance))
+                    continue;
+                UpdateSubtreeTransforms(collection, instance);
             }
         }
+        dirty.SetSize(0);
 
         collection->m_DirtyTransforms = false;
     }
@@ -2563,11 +3005,11 @@ namespace dmGameObject
             while (collection->m_InstancesToDeleteHead != INVALID_INSTANCE_INDEX && pass_count < max_pass_count) {
                 ++pass_count;
                 // Save the list and clear the head and tail
-                uint16_t head = collection->m_InstancesToDeleteHead;
+                uint32_t head = collection->m_InstancesToDeleteHead;
                 collection->m_InstancesToDeleteHead = INVALID_INSTANCE_INDEX;
                 collection->m_InstancesToDeleteTail = INVALID_INSTANCE_INDEX;
 
-                uint16_t index = head;
+                uint32_t index = head;
                 while (index != INVALID_INSTANCE_INDEX) {
                     Instance* instance = collection->m_Instances[index];
 
@@ -2809,6 +3251,7 @@ namespace dmGameObject
     void SetPosition(HInstance instance, Point3 position)
     {
         instance->m_Transform.SetTranslation(Vector3(position));
+        SetTransformDirty(instance);
     }
 
     Point3 GetPosition(HInstance instance)
@@ -2819,6 +3262,7 @@ namespace dmGameObject
     void SetRotation(HInstance instance, Quat rotation)
     {
         instance->m_Transform.SetRotation(rotation);
+        SetTransformDirty(instance);
     }
 
     Quat GetRotation(HInstance instance)
@@ -2829,11 +3273,13 @@ namespace dmGameObject
     void SetScale(HInstance instance, float scale)
     {
         instance->m_Transform.SetUniformScale(scale);
+        SetTransformDirty(instance);
     }
 
     void SetScale(HInstance instance, Vector3 scale)
     {
         instance->m_Transform.SetScale(scale);
+        SetTransformDirty(instance);
     }
 
     float GetUniformScale(HInstance instance)
@@ -2946,6 +3392,7 @@ namespace dmGameObject
         }
 
         int original_child_depth = child->m_Depth;
+        SetTransformDirty(child);
         if (parent != 0)
         {
             child->m_Parent = parent->m_Index;
@@ -3222,6 +3669,7 @@ namespace dmGameObject
             return PROPERTY_RESULT_INVALID_INSTANCE;
         if (component_id == 0)
         {
+            SetTransformDirty(instance);
             float* position = instance->m_Transform.GetPositionPtr();
             float* rotation = instance->m_Transform.GetRotationPtr();
             float* scale = instance->m_Transform.GetScalePtr();
@@ -3418,12 +3866,12 @@ namespace dmGameObject
     //  - patch data structures for identification and input stack
     //  - copy the rest of the fields
     // The old instance is destroyed.
-    static void RecreateInstance(Collection* collection, uint16_t index, Prototype* old_proto, Prototype* new_proto, const char* new_proto_name) {
+    static void RecreateInstance(Collection* collection, uint32_t index, Prototype* old_proto, Prototype* new_proto, const char* new_proto_name) {
         HInstance instance = collection->m_Instances[index];
         // We don't support recreating instances that are 'transitioning'
         assert(instance->m_ToBeAdded == 0);
         assert(instance->m_ToBeDeleted == 0);
-        HInstance new_instance = AllocInstance(new_proto, new_proto_name);
+        HInstance new_instance = AllocInstance(collection, new_proto, new_proto_name);
         if (!new_instance) {
             return;
         }
@@ -3441,6 +3889,7 @@ namespace dmGameObject
         new_instance->m_EulerRotation = instance->m_EulerRotation;
         new_instance->m_PrevEulerRotation = instance->m_PrevEulerRotation;
         new_instance->m_ScaleAlongZ = instance->m_ScaleAlongZ;
+        new_instance->m_TransformDirty = instance->m_TransformDirty;
         // id-related
         new_instance->m_Identifier = instance->m_Identifier;
         new_instance->m_IdentifierIndex = instance->m_IdentifierIndex;
@@ -3450,7 +3899,7 @@ namespace dmGameObject
         bool res = CreateComponents(hcollection, new_instance);
         if (!res) {
             dmHashRelease64(&new_instance->m_CollectionPathHashState);
-            DeallocInstance(new_instance);
+            DeallocInstance(collection, new_instance);
             return;
         }
         if (instance->m_Initialized) {
@@ -3476,7 +3925,7 @@ namespace dmGameObject
                 break;
             }
         }
-        DeallocInstance(instance);
+        DeallocInstance(collection, instance);
         DoAddToUpdate(collection, new_instance);
     }
 
@@ -3485,11 +3934,11 @@ namespace dmGameObject
         Collection* collection = (Collection*) params.m_UserData;
         for (uint32_t level_i = 0; level_i < MAX_HIERARCHICAL_DEPTH; ++level_i)
         {
-            dmArray<uint16_t>& level = collection->m_LevelIndices[level_i];
+            dmArray<uint32_t>& level = collection->m_LevelIndices[level_i];
             uint32_t instance_count = level.Size();
             for (uint32_t i = 0; i < instance_count; ++i)
             {
-                uint16_t index = level[i];
+                uint32_t index = level[i];
                 Instance* instance = collection->m_Instances[index];
                 if (instance->m_Prototype == params.m_Resource->m_Resource) {
                     RecreateInstance(collection, index, (Prototype*)params.m_Resource->m_PrevResource, (Prototype*)params.m_Resource->m_Resource, params.m_Name);
@@ -3532,7 +3981,7 @@ namespace dmGameObject
     {
         Collection* collection = hcollection->m_Collection;
         uint32_t count = 0;
-        uint16_t index = collection->m_InstancesToAddHead;
+        uint32_t index = collection->m_InstancesToAddHead;
         while (index != INVALID_INSTANCE_INDEX) {
             index = collection->m_Instances[index]->m_NextToAdd;
             ++count;
@@ -3544,7 +3993,7 @@ namespace dmGameObject
     {
         Collection* collection = hcollection->m_Collection;
         uint32_t count = 0;
-        uint16_t index = collection->m_InstancesToDeleteHead;
+        uint32_t index = collection->m_InstancesToDeleteHead;
         while (index != INVALID_INSTANCE_INDEX) {
             index = collection->m_Instances[index]->m_NextToDelete;
             ++count;
@@ -21,6 +21,7 @@
 #include <dlib/hashtable.h>
 #include <dlib/message.h>
 #include <dlib/transform.h>
+#include <dlib/worker_pool.h>
 
 #include <ddf/ddf.h>
 
@@ -345,6 +346,41 @@ namespace dmGameObject
      */
     typedef CreateResult (*ComponentCreate)(const ComponentCreateParams& params);
 
+    /**
+     * Parameters to ComponentCreateBatch callback.
+     */
+    struct ComponentCreateBatchParams
+    {
+        /// Game object instances, one component is created for each
+        HInstance* m_Instances;
+        /// User data storage pointer for each instance
+        uintptr_t** m_UserData;
+        /// Number of instances
+        uint32_t  m_Count;
+        /// Local component position
+        Point3    m_Position;
+        /// Local component rotation
+        Quat      m_Rotation;
+        PropertySet m_PropertySet;
+        /// Component resource
+        void* m_Resource;
+        /// Component world, as created in the ComponentNewWorld callback
+        void* m_World;
+        /// User context
+        void* m_Context;
+        /// Index of the component being created
+        uint16_t m_ComponentIndex;
+    };
+
+    /**
+     * Optional component create function for creating the same component in a number of instances at once,
+     * see SpawnBatch. The instances are in the same state as for ComponentCreate.
+     * Either all the components are created or, on failure, none of them.
+     * @param params Input parameters
+     * @return CREATE_RESULT_OK on success
+     */
+    typedef CreateResult (*ComponentCreateBatch)(const ComponentCreateBatchParams& params);
+
     /**
      * Parameters to ComponentDestroy callback.
      */
@@ -676,6 +712,7 @@ namespace dmGameObject
         ComponentNewWorld       m_NewWorldFunction;
         ComponentDeleteWorld    m_DeleteWorldFunction;
         ComponentCreate         m_CreateFunction;
+        ComponentCreateBatch    m_CreateBatchFunction;
         ComponentDestroy        m_DestroyFunction;
         ComponentInit           m_InitFunction;
         ComponentFinal          m_FinalFunction;
@@ -712,7 +749,7 @@ namespace dmGameObject
     /**
      * Set default capacity of collections in this register. This does not affect existing collections.
      * @param regist Register
-     * @param capacity Default capacity of collections in this register (0-32766).
+     * @param capacity Default capacity of collections in this register (0-2147483645).
      * @return RESULT_OK on success or RESULT_INVALID_OPERATION if max_count is not within range
      */
     Result SetCollectionDefaultCapacity(HRegister regist, uint32_t capacity);
@@ -731,6 +768,14 @@ namespace dmGameObject
      */
     void SetInputStackDefaultCapacity(HRegister regist, uint32_t capacity);
 
+    /**
+     * Set worker pool used by the collections in this register, e.g. when updating transforms of large hierarchies.
+     * The pool is not owned by the register and must outlive it.
+     * @param regist Register
+     * @param pool Worker pool, 0 to do all work on the calling thread
+     */
+    void SetWorkerPool(HRegister regist, dmWorkerPool::HWorkerPool pool);
+
     /**
      * Delete a component type register
      * @param regist Register to delete
@@ -844,6 +889,26 @@ namespace dmGameObject
      */
     HInstance Spawn(HCollection collection, HPrototype prototype, const char* prototype_name, dmhash_t id, uint8_t* property_buffer, uint32_t property_buffer_size, const Point3& position, const Quat& rotation, const Vector3& scale);
 
+    /**
+     * Spawns a number of gameobject instances from the same prototype. The components are created one component
+     * type at a time for all the instances, using ComponentType::m_CreateBatchFunction when the type has one.
+     * Either all the instances are spawned or, on failure, none of them.
+     * @param collection Gameobject collection
+     * @param prototype Prototype to spawn from
+     * @param prototype_name Prototype file name
+     * @param ids Ids of the spawned instances, count entries
+     * @param property_buffer Buffer with serialized properties, shared by all the instances
+     * @param property_buffer_size Size of property buffer
+     * @param positions Positions of the spawned objects, count entries
+     * @param rotations Rotations of the spawned objects, count entries
+     * @param scales Scales of the spawned objects, count entries
+     * @param count Number of instances to spawn
+     * @param out_instances Receives the spawned instances, count entries
+     * @return true on success
+     */
+    bool SpawnBatch(HCollection collection, HPrototype prototype, const char* prototype_name, const dmhash_t* ids, uint8_t* property_buffer, uint32_t property_buffer_size,
+                    const Point3* positions, const Quat* rotations, const Vector3* scales, uint32_t count, HInstance* out_instances);
+
     struct InstancePropertyBuffer
     {
         uint8_t *property_buffer;
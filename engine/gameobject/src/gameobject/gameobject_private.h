@@ -82,8 +82,8 @@ namespace dmGameObject
         dmArray<void*> m_PropertyResources;
     };
 
-    // Invalid instance index. Implies that maximum number of instances is 32766 (ie 0x7fff - 1)
-    const uint32_t INVALID_INSTANCE_INDEX = 0x7fff;
+    // Invalid instance index. Implies that maximum number of instances is 0x7fffffff - 1
+    const uint32_t INVALID_INSTANCE_INDEX = 0x7fffffff;
 
     // NOTE: Actual size of Instance is sizeof(Instance) + sizeof(uintptr_t) * m_UserDataCount
     struct Instance
@@ -103,6 +103,8 @@ namespace dmGameObject
             m_ScaleAlongZ = 0;
             m_Bone = 0;
             m_Generated = 0;
+            m_TransformDirty = 0;
+            m_WorldTransformChanged = 0;
             m_Parent = INVALID_INSTANCE_INDEX;
             m_Index = INVALID_INSTANCE_INDEX;
             m_LevelIndex = INVALID_INSTANCE_INDEX;
@@ -146,22 +148,26 @@ namespace dmGameObject
         uint16_t        m_Bone : 1;
         // If this is a generated instance, i.e. if the instance id is uniquely generated
         uint16_t        m_Generated : 1;
+        // If the world transform of this instance and its children must be recalculated. Set by SetTransformDirty
+        uint16_t        m_TransformDirty : 1;
+        // If the world transform was recalculated in the last UpdateTransforms. Read by the children on the next level
+        uint16_t        m_WorldTransformChanged : 1;
         // Padding
-        uint16_t        m_Pad : 4;
+        uint16_t        m_Pad : 2;
 
         // Index to parent
-        uint16_t        m_Parent : 16;
+        uint32_t        m_Parent;
 
         // Index to Collection::m_Instances
-        uint16_t        m_Index : 15;
+        uint32_t        m_Index : 31;
         // Used for deferred deletion
-        uint16_t        m_ToBeDeleted : 1;
+        uint32_t        m_ToBeDeleted : 1;
 
         // Index to Collection::m_LevelIndex. Index is relative to current level (m_Depth), eg first object in level L always has level-index 0
         // Level-index is used to reorder Collection::m_LevelIndex entries in O(1). Given an instance we need to find where the
         // instance index is located in Collection::m_LevelIndex
-        uint16_t        m_LevelIndex : 15;
-        uint16_t        m_Pad2 : 1;
+        uint32_t        m_LevelIndex : 31;
+        uint32_t        m_Pad2 : 1;
 
 #ifdef __EMSCRIPTEN__
         // TODO: FIX!! Workaround for LLVM/Clang bug when compiling with any optimization level > 0.
@@ -177,18 +183,18 @@ namespace dmGameObject
 #endif
 
         // Index to next instance to delete or INVALID_INSTANCE_INDEX
-        uint16_t        m_NextToDelete : 16;
+        uint32_t        m_NextToDelete;
 
         // Index to next instance to add-to-update or INVALID_INSTANCE_INDEX
-        uint16_t        m_NextToAdd;
+        uint32_t        m_NextToAdd;
 
         // Next sibling index. Index to Collection::m_Instances
-        uint16_t        m_SiblingIndex : 15;
-        uint16_t        m_ToBeAdded : 1;
+        uint32_t        m_SiblingIndex : 31;
+        uint32_t        m_ToBeAdded : 1;
 
         // First child index. Index to Collection::m_Instances
-        uint16_t        m_FirstChildIndex : 15;
-        uint16_t        m_Pad4 : 1;
+        uint32_t        m_FirstChildIndex : 31;
+        uint32_t        m_Pad4 : 1;
 
         uint32_t        m_ComponentInstanceUserDataCount;
         uintptr_t       m_ComponentInstanceUserData[0];
@@ -214,10 +220,26 @@ namespace dmGameObject
 
         dmHashTable64<Collection*>  m_SocketToCollection;
 
+        // Optional worker pool for parallel transform updates. Not owned by the register
+        dmWorkerPool::HWorkerPool   m_WorkerPool;
+
         Register();
         ~Register();
     };
 
+    // Instance memory for a collection. Instances of the same size, i.e. with the same number of
+    // component instance user data slots, are allocated in blocks and recycled through a free list.
+    // The blocks are kept until the collection is deleted
+    struct InstanceAllocator
+    {
+        // Number of instances per block
+        static const uint32_t BLOCK_INSTANCE_COUNT = 32;
+
+        dmArray<void*>  m_Blocks;
+        // Free instance memory, indexed by the user data count. Linked through the first word of each free instance
+        dmArray<void*>  m_FreeLists;
+    };
+
     // Max hierarchical depth
     // depth is interpreted as up to <depth> levels of child nodes including root-nodes
     // Must be greater than zero
@@ -249,7 +271,10 @@ namespace dmGameObject
         dmArray<Instance*>       m_Instances;
 
         // Index pool for mapping Instance::m_Index to m_Instances
-        dmIndexPool16            m_InstanceIndices;
+        dmIndexPool32            m_InstanceIndices;
+
+        // Memory for the instances in m_Instances
+        InstanceAllocator        m_InstanceAllocator;
 
         // Resources referenced through property overrides inside the collection
         dmArray<void*>         m_PropertyResources;
@@ -259,11 +284,14 @@ namespace dmGameObject
         // Two dimensional table of indices with stride "max_instances"
         // Level 0 contains root-nodes in [0..m_LevelIndices[0].Size()-1]
         // Level 1 contains level 1 indices in [0..m_LevelIndices[1].Size()-1]
-        dmArray<uint16_t>        m_LevelIndices[MAX_HIERARCHICAL_DEPTH];
+        dmArray<uint32_t>        m_LevelIndices[MAX_HIERARCHICAL_DEPTH];
 
         // Array of world transforms. Calculated using m_LevelIndices above
         dmArray<Matrix4>         m_WorldTransforms;
 
+        // Indices of the instances flagged with m_TransformDirty since the last UpdateTransforms
+        dmArray<uint32_t>        m_DirtyTransformIndices;
+
         // Identifier to Instance mapping
         dmHashTable64<Instance*> m_IDToInstance;
 
@@ -286,14 +314,14 @@ namespace dmGameObject
         dmIndexPool32            m_InstanceIdPool;
 
         // Head of linked list of instances scheduled for deferred deletion
-        uint16_t                 m_InstancesToDeleteHead;
+        uint32_t                 m_InstancesToDeleteHead;
         // Tail of the same list, for O(1) appending
-        uint16_t                 m_InstancesToDeleteTail;
+        uint32_t                 m_InstancesToDeleteTail;
 
         // Head of linked list of instances scheduled to be added to update
-        uint16_t                 m_InstancesToAddHead;
+        uint32_t                 m_InstancesToAddHead;
         // Tail of the same list, for O(1) appending
-        uint16_t                 m_InstancesToAddTail;
+        uint32_t                 m_InstancesToAddTail;
 
         // Set to 1 if in update-loop
         uint32_t                 m_InUpdate : 1;
@@ -322,6 +350,9 @@ namespace dmGameObject
     bool CreateComponents(Collection* collection, HInstance instance);
     void Delete(Collection* collection, HInstance instance, bool recursive);
     void UpdateTransforms(Collection* collection);
+    // Flag the world transform of the instance and its children to be recalculated in the next UpdateTransforms.
+    // Must be called after modifying the local transform directly, e.g. through a property value pointer
+    void SetTransformDirty(HInstance instance);
     void DeleteCollection(Collection* collection);
     bool IsCollectionInitialized(Collection* collection);
     Result AttachCollection(Collection* collection, const char* name, dmResource::HFactory factory, HRegister regist, HCollection hcollection);
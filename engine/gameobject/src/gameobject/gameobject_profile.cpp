@@ -64,7 +64,7 @@ static bool IterateGameObject(Collection* collection, HInstance instance, FGameO
 bool IterateGameObjects(HCollection hcollection, FGameObjectIterator callback, void* user_ctx)
 {
     Collection* collection = hcollection->m_Collection;
-    const dmArray<uint16_t>& root_level = collection->m_LevelIndices[0];
+    const dmArray<uint32_t>& root_level = collection->m_LevelIndices[0];
     for (uint32_t j = 0; j < root_level.Size(); ++j)
     {
         if (!IterateGameObject(collection, collection->m_Instances[root_level[j]], callback, user_ctx))
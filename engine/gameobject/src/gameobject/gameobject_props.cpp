@@ -456,6 +456,28 @@ namespace dmGameObject
         return CreatePropertyContainer(builder);
     }
 
+    HPropertyContainer ClonePropertyContainer(HPropertyContainer container)
+    {
+        PropertyContainerParameters params;
+        for (uint32_t i = 0; i < container->m_Count; ++i)
+        {
+            CountEntry(params, container, i);
+        }
+
+        HPropertyContainerBuilder builder = CreatePropertyContainerBuilder(params);
+        if (builder == 0x0)
+        {
+            return 0x0;
+        }
+
+        for (uint32_t i = 0; i < container->m_Count; ++i)
+        {
+            PushEntry(builder, container, i);
+        }
+
+        return CreatePropertyContainer(builder);
+    }
+
     static bool ResolveURL(Properties* properties, const char* url, dmMessage::URL* out_url)
     {
         dmMessage::URL default_url;
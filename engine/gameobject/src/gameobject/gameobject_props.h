@@ -111,6 +111,7 @@ namespace dmGameObject
     HPropertyContainer CreatePropertyContainer(HPropertyContainerBuilder builder);
 
     HPropertyContainer MergePropertyContainers(HPropertyContainer container, HPropertyContainer overrides);
+    HPropertyContainer ClonePropertyContainer(HPropertyContainer container);
 
     PropertyResult PropertyContainerGetPropertyCallback(const HProperties properties, uintptr_t user_data, dmhash_t id, PropertyVar& out_var);
     void DestroyPropertyContainer(HPropertyContainer container);
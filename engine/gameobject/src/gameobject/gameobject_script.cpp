@@ -1973,11 +1973,72 @@ namespace dmGameObject
         assert(top == lua_gettop(L));
     }
 
+    // Upper bound of cached on_message profiler names per script, other messages are formatted on each receive
+    static const uint32_t MAX_MESSAGE_PROFILER_NAMES = 256;
+
+    static void InitProfilerNames(lua_State* L, Script* script, const char* filename)
+    {
+        if (!script->m_MessageProfilerNames.Empty())
+            script->m_MessageProfilerNames.Clear();
+        for (uint32_t i = 0; i < MAX_SCRIPT_FUNCTION_COUNT; ++i)
+        {
+            ScriptProfilerName& name = script->m_ProfilerNames[i];
+            name.m_Hash = 0;
+            name.m_Name = dmScript::GetProfilerString(L, 0, filename, SCRIPT_FUNCTION_NAMES[i], 0, &name.m_Hash);
+        }
+    }
+
+    const char* GetProfilerString(HScript script, ScriptFunction script_function, uint32_t* out_profiler_hash)
+    {
+        ScriptProfilerName& name = script->m_ProfilerNames[script_function];
+        if (name.m_Name == 0 && dmProfile::g_IsInitialized)
+        {
+            // The profiler was initialized after the script was loaded
+            name.m_Name = dmScript::GetProfilerString(script->m_LuaState, 0, script->m_LuaModule->m_Source.m_Filename, SCRIPT_FUNCTION_NAMES[script_function], 0, &name.m_Hash);
+        }
+        *out_profiler_hash = name.m_Hash;
+        return name.m_Name;
+    }
+
+    const char* GetMessageProfilerString(HScript script, dmhash_t message_id, const char* message_name, uint32_t* out_profiler_hash)
+    {
+        if (!dmProfile::g_IsInitialized)
+        {
+            return 0;
+        }
+
+        ScriptProfilerName* cached = script->m_MessageProfilerNames.Get(message_id);
+        if (cached)
+        {
+            *out_profiler_hash = cached->m_Hash;
+            return cached->m_Name;
+        }
+
+        ScriptProfilerName name;
+        name.m_Hash = 0;
+        name.m_Name = dmScript::GetProfilerString(script->m_LuaState, 0, script->m_LuaModule->m_Source.m_Filename, SCRIPT_FUNCTION_NAMES[SCRIPT_FUNCTION_ONMESSAGE], message_name, &name.m_Hash);
+
+        dmHashTable64<ScriptProfilerName>& table = script->m_MessageProfilerNames;
+        if (table.Full() && table.Capacity() < MAX_MESSAGE_PROFILER_NAMES)
+        {
+            uint32_t capacity = table.Capacity() + 16;
+            table.SetCapacity(capacity / 2 + 1, capacity);
+        }
+        if (!table.Full())
+        {
+            table.Put(message_id, name);
+        }
+        *out_profiler_hash = name.m_Hash;
+        return name.m_Name;
+    }
+
     static bool LoadScript(lua_State* L, dmLuaDDF::LuaSource *source, Script* script)
     {
         for (uint32_t i = 0; i < MAX_SCRIPT_FUNCTION_COUNT; ++i)
             script->m_FunctionReferences[i] = LUA_NOREF;
 
+        InitProfilerNames(L, script, source->m_Filename);
+
         bool result = false;
         int top = lua_gettop(L);
         (void) top;
@@ -14,6 +14,7 @@
 #define __GAMEOBJECTSCRIPT_H__
 
 #include <dlib/array.h>
+#include <dlib/hashtable.h>
 
 #include <script/script.h>
 
@@ -53,6 +54,12 @@ namespace dmGameObject
 
     extern const char* SCRIPT_FUNCTION_NAMES[MAX_SCRIPT_FUNCTION_COUNT];
 
+    struct ScriptProfilerName
+    {
+        const char* m_Name;
+        uint32_t    m_Hash;
+    };
+
     struct Script
     {
         lua_State*              m_LuaState;
@@ -62,6 +69,10 @@ namespace dmGameObject
         int                     m_InstanceReference;
         // Resources referenced through property values in the script
         dmArray<void*>          m_PropertyResources;
+        // Interned "function@file" profiler names, built at load so the update/input path never formats strings
+        ScriptProfilerName      m_ProfilerNames[MAX_SCRIPT_FUNCTION_COUNT];
+        // Interned "on_message[name]@file" profiler names, keyed by message id and filled on first receive
+        dmHashTable64<ScriptProfilerName> m_MessageProfilerNames;
     };
 
     typedef Script* HScript;
@@ -94,6 +105,26 @@ namespace dmGameObject
     bool    ReloadScript(HScript script, dmLuaDDF::LuaModule* lua_module);
     void    DeleteScript(HScript script);
 
+    /**
+     * Get the profiler sample name for a script function, interned at load time.
+     * @param script script
+     * @param script_function function
+     * @param out_profiler_hash hash of the returned name
+     * @return the name, or 0 when the profiler is not initialized
+     */
+    const char* GetProfilerString(HScript script, ScriptFunction script_function, uint32_t* out_profiler_hash);
+
+    /**
+     * Get the profiler sample name for on_message with a specific message. The name is
+     * built on the first receive of each message id and cached in the script.
+     * @param script script
+     * @param message_id message id
+     * @param message_name message name, may be 0
+     * @param out_profiler_hash hash of the returned name
+     * @return the name, or 0 when the profiler is not initialized
+     */
+    const char* GetMessageProfilerString(HScript script, dmhash_t message_id, const char* message_name, uint32_t* out_profiler_hash);
+
     HScriptInstance NewScriptInstance(CompScriptWorld* script_world, HScript script, HInstance instance, uint16_t component_index);
     void            DeleteScriptInstance(HScriptInstance script_instance);
 
@@ -888,6 +888,154 @@ TEST_F(HierarchyTest, TestEmptyInstance)
     dmGameObject::Delete(m_Collection, go, false);
 }
 
+TEST_F(HierarchyTest, TestIncrementalTransforms)
+{
+    dmGameObject::HInstance parent = dmGameObject::New(m_Collection, 0x0);
+    dmGameObject::HInstance child = dmGameObject::New(m_Collection, 0x0);
+    dmGameObject::HInstance grand_child = dmGameObject::New(m_Collection, 0x0);
+    dmGameObject::HInstance other = dmGameObject::New(m_Collection, 0x0);
+
+    dmGameObject::SetPosition(parent, Point3(1, 0, 0));
+    dmGameObject::SetPosition(child, Point3(0, 2, 0));
+    dmGameObject::SetPosition(grand_child, Point3(0, 0, 3));
+    dmGameObject::SetPosition(other, Point3(4, 0, 0));
+    ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetParent(child, parent));
+    ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetParent(grand_child, child));
+
+    dmGameObject::Collection* collection = m_Collection->m_Collection;
+    dmGameObject::UpdateTransforms(collection);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(grand_child) - Point3(1, 2, 3)), EPSILON);
+
+    // Moving the parent through the setter propagates to the whole subtree
+    dmGameObject::SetPosition(parent, Point3(10, 0, 0));
+    dmGameObject::UpdateTransforms(collection);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(child) - Point3(10, 2, 0)), EPSILON);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(grand_child) - Point3(10, 2, 3)), EPSILON);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(other) - Point3(4, 0, 0)), EPSILON);
+
+    // Writing through the property value pointer, like animations do, requires the instance to be flagged
+    dmGameObject::PropertyDesc desc;
+    ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::GetProperty(child, 0, dmHashString64("position"), desc));
+    ASSERT_NE((float*) 0, desc.m_ValuePtr);
+    desc.m_ValuePtr[1] = 5.0f;
+    dmGameObject::SetTransformDirty(child);
+    dmGameObject::UpdateTransforms(collection);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(parent) - Point3(10, 0, 0)), EPSILON);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(grand_child) - Point3(10, 5, 3)), EPSILON);
+
+    // Clean subtrees are not recalculated
+    collection->m_WorldTransforms[grand_child->m_Index] = Matrix4::identity();
+    dmGameObject::SetPosition(other, Point3(5, 0, 0));
+    dmGameObject::UpdateTransforms(collection);
+    ASSERT_NEAR(0.0f, length(Vector3(dmGameObject::GetWorldPosition(grand_child))), EPSILON);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(other) - Point3(5, 0, 0)), EPSILON);
+
+    // Flagging both a parent and its child updates the child once, after the parent
+    dmGameObject::SetPosition(grand_child, Point3(0, 0, 4));
+    dmGameObject::SetPosition(parent, Point3(10, 0, 0));
+    ASSERT_EQ(2u, collection->m_DirtyTransformIndices.Size());
+    dmGameObject::UpdateTransforms(collection);
+    ASSERT_EQ(0u, collection->m_DirtyTransformIndices.Size());
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(grand_child) - Point3(10, 5, 4)), EPSILON);
+    dmGameObject::SetPosition(grand_child, Point3(0, 0, 3));
+    dmGameObject::SetPosition(other, Point3(4, 0, 0));
+
+    // Scale is inherited by children
+    dmGameObject::SetScale(parent, 2.0f);
+    dmGameObject::UpdateTransforms(collection);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(grand_child) - Point3(10, 10, 3)), EPSILON);
+
+    // Reparenting with an unchanged local transform
+    ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetParent(grand_child, other));
+    dmGameObject::UpdateTransforms(collection);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(grand_child) - Point3(4, 0, 3)), EPSILON);
+
+    // Deleting the parent moves the child up to the root level
+    dmGameObject::Delete(m_Collection, other, false);
+    ASSERT_TRUE(dmGameObject::PostUpdate(m_Collection));
+    dmGameObject::UpdateTransforms(collection);
+    ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(grand_child) - Point3(0, 0, 3)), EPSILON);
+
+    dmGameObject::Delete(m_Collection, parent, true);
+    dmGameObject::Delete(m_Collection, grand_child, false);
+    ASSERT_TRUE(dmGameObject::PostUpdate(m_Collection));
+}
+
+static void BenchmarkUpdateTransforms(dmGameObject::HCollection hcollection, const char* name, uint32_t moved_root_count)
+{
+    dmGameObject::Collection* collection = hcollection->m_Collection;
+    const dmArray<uint32_t>& roots = collection->m_LevelIndices[0];
+    const uint32_t iterations = 50;
+
+    dmGameObject::UpdateTransforms(collection);
+    uint64_t start = dmTime::GetTime();
+    for (uint32_t iter = 0; iter < iterations; ++iter)
+    {
+        for (uint32_t i = 0; i < moved_root_count; ++i)
+        {
+            dmGameObject::HInstance root = collection->m_Instances[roots[i]];
+            dmGameObject::SetPosition(root, Point3((float) iter, (float) i, 0.0f));
+        }
+        dmGameObject::UpdateTransforms(collection);
+    }
+    uint64_t end = dmTime::GetTime();
+    printf("%s: %u of %u roots moved, %u instances: %f ms per update\n", name, moved_root_count, roots.Size(), collection->m_InstanceIndices.Size(), (end - start) / (1000.0f * iterations));
+}
+
+static void VerifyBenchmarkTransforms(dmGameObject::HCollection hcollection)
+{
+    dmGameObject::Collection* collection = hcollection->m_Collection;
+    const dmArray<uint32_t>& leaves = collection->m_LevelIndices[2];
+    for (uint32_t i = 0; i < leaves.Size(); ++i)
+    {
+        dmGameObject::HInstance leaf = collection->m_Instances[leaves[i]];
+        dmGameObject::HInstance child = dmGameObject::GetParent(leaf);
+        dmGameObject::HInstance root = dmGameObject::GetParent(child);
+        Point3 expected = dmGameObject::GetPosition(root) + Vector3(dmGameObject::GetPosition(child)) + Vector3(dmGameObject::GetPosition(leaf));
+        ASSERT_NEAR(0.0f, length(dmGameObject::GetWorldPosition(leaf) - expected), 0.001f);
+    }
+}
+
+// Compares updating the world transforms of all instances to only updating the few that moved,
+// single threaded and on a worker pool
+TEST_F(HierarchyTest, BenchmarkUpdateTransforms)
+{
+    const uint32_t root_count = 2048;
+    const uint32_t child_count = 3;
+    dmGameObject::HCollection collection = dmGameObject::NewCollection("bench_collection", m_Factory, m_Register, 16000);
+
+    for (uint32_t i = 0; i < root_count; ++i)
+    {
+        dmGameObject::HInstance root = dmGameObject::New(collection, 0x0);
+        ASSERT_NE((void*) 0, (void*) root);
+        for (uint32_t j = 0; j < child_count; ++j)
+        {
+            dmGameObject::HInstance child = dmGameObject::New(collection, 0x0);
+            dmGameObject::HInstance leaf = dmGameObject::New(collection, 0x0);
+            dmGameObject::SetPosition(child, Point3(1.0f, (float) j, 0.0f));
+            dmGameObject::SetPosition(leaf, Point3(0.0f, 0.0f, (float) j));
+            ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetParent(child, root));
+            ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetParent(leaf, child));
+        }
+    }
+
+    BenchmarkUpdateTransforms(collection, "Full", root_count);
+    VerifyBenchmarkTransforms(collection);
+    BenchmarkUpdateTransforms(collection, "Incremental", 8);
+    VerifyBenchmarkTransforms(collection);
+
+    dmWorkerPool::HWorkerPool pool = dmWorkerPool::New(4, "transforms");
+    dmGameObject::SetWorkerPool(m_Register, pool);
+    BenchmarkUpdateTransforms(collection, "Full (parallel)", root_count);
+    VerifyBenchmarkTransforms(collection);
+    BenchmarkUpdateTransforms(collection, "Incremental (parallel)", 8);
+    VerifyBenchmarkTransforms(collection);
+    dmGameObject::SetWorkerPool(m_Register, 0);
+    dmWorkerPool::Delete(pool);
+
+    dmGameObject::DeleteCollection(collection);
+}
+
 #undef EPSILON
 
 int main(int argc, char **argv)
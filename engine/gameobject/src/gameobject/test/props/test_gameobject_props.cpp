@@ -725,6 +725,48 @@ TEST(GameObjectProps, TestMergePropertyContainer)
     dmGameObject::DestroyPropertyContainer(m);
 }
 
+TEST(GameObjectProps, TestClonePropertyContainer)
+{
+    const float NUMBER = 1.f;
+    const char URL[] = "/url";
+    float VECTOR3[3] = {1, 2, 3};
+
+    dmGameObject::PropertyContainerParameters params;
+    params.m_NumberCount = 1;
+    params.m_URLStringCount = 1;
+    params.m_Vector3Count = 1;
+    params.m_URLStringSize += strlen(URL) + 1;
+    dmGameObject::HPropertyContainerBuilder builder = dmGameObject::CreatePropertyContainerBuilder(params);
+    ASSERT_NE(builder, (dmGameObject::HPropertyContainerBuilder)0x0);
+    dmGameObject::PushFloatType(builder, dmHashString64("number"), dmGameObject::PROPERTY_TYPE_NUMBER, &NUMBER);
+    dmGameObject::PushURLString(builder, dmHashString64("url"), URL);
+    dmGameObject::PushFloatType(builder, dmHashString64("vector3"), dmGameObject::PROPERTY_TYPE_VECTOR3, VECTOR3);
+
+    dmGameObject::HPropertyContainer c = dmGameObject::CreatePropertyContainer(builder);
+    ASSERT_NE(c, (dmGameObject::HPropertyContainer)0x0);
+
+    dmGameObject::HPropertyContainer clone = dmGameObject::ClonePropertyContainer(c);
+    ASSERT_NE(clone, (dmGameObject::HPropertyContainer)0x0);
+    ASSERT_NE(clone, c);
+    dmGameObject::DestroyPropertyContainer(c);
+
+    dmGameObject::PropertyVar var;
+
+    ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::PropertyContainerGetPropertyCallback(0x0, (uintptr_t)clone, dmHashString64("number"), var));
+    ASSERT_EQ(dmGameObject::PROPERTY_TYPE_NUMBER, var.m_Type);
+    ASSERT_EQ(NUMBER, var.m_Number);
+
+    ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::PropertyContainerGetPropertyCallback(0x0, (uintptr_t)clone, dmHashString64("vector3"), var));
+    ASSERT_EQ(dmGameObject::PROPERTY_TYPE_VECTOR3, var.m_Type);
+    ASSERT_EQ(VECTOR3[0], var.m_V4[0]);
+    ASSERT_EQ(VECTOR3[1], var.m_V4[1]);
+    ASSERT_EQ(VECTOR3[2], var.m_V4[2]);
+
+    ASSERT_EQ(dmGameObject::PROPERTY_RESULT_NOT_FOUND, dmGameObject::PropertyContainerGetPropertyCallback(0x0, (uintptr_t)clone, dmHashString64("missing"), var));
+
+    dmGameObject::DestroyPropertyContainer(clone);
+}
+
 int main(int argc, char **argv)
 {
     dmDDF::RegisterAllTypes();
@@ -21,9 +21,11 @@
 #include <dlib/time.h>
 #include <dlib/log.h>
 #include <dlib/sys.h>
+#include <dlib/profile.h>
 #include <resource/resource.h>
 #include "../gameobject.h"
 #include "../gameobject_private.h"
+#include "../gameobject_script.h"
 #include "gameobject/test/script/test_gameobject_script_ddf.h"
 #include "../proto/gameobject/gameobject_ddf.h"
 #include "../proto/gameobject/lua_ddf.h"
@@ -550,10 +552,91 @@ TEST_F(ScriptTest, TestInstanceContext)
     dmGameObject::PostUpdate(m_Collection);
 }
 
+TEST_F(ScriptTest, ProfilerNamesMany)
+{
+    const uint32_t script_count = 5000;
+    const uint32_t frame_count = 10;
+
+    dmGameObject::HCollection collection = dmGameObject::NewCollection("profiler_names", m_Factory, m_Register, script_count);
+    ASSERT_NE((void*) 0, (void*) collection);
+
+    dmArray<dmGameObject::HInstance> instances;
+    instances.SetCapacity(script_count);
+    char name[64];
+    for (uint32_t i = 0; i < script_count; ++i)
+    {
+        dmGameObject::HInstance go = dmGameObject::New(collection, "/profiler_names.goc");
+        ASSERT_NE((void*) 0, (void*) go);
+        dmSnPrintf(name, sizeof(name), "go%d", i);
+        ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetIdentifier(collection, go, name));
+        instances.Push(go);
+    }
+    ASSERT_TRUE(dmGameObject::Init(collection));
+
+    dmMessage::URL receiver;
+    dmMessage::ResetURL(receiver);
+    receiver.m_Socket = dmGameObject::GetMessageSocket(collection);
+    dmhash_t message_id = dmHashString64("profiler_names");
+
+    uint64_t start = dmTime::GetTime();
+    for (uint32_t frame = 0; frame < frame_count; ++frame)
+    {
+        dmProfile::HProfile profile = dmProfile::Begin();
+        for (uint32_t i = 0; i < script_count; ++i)
+        {
+            receiver.m_Path = dmGameObject::GetIdentifier(instances[i]);
+            ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(0, &receiver, message_id, 0, 0, 0, 0, 0));
+        }
+        ASSERT_TRUE(dmGameObject::Update(collection, &m_UpdateContext));
+        dmProfile::Release(profile);
+    }
+    uint64_t update_time = dmTime::GetTime() - start;
+
+    // Compare the interned lookup with formatting the name on every call, as RunScript used to do
+    dmGameObject::HScript script;
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::Get(m_Factory, "/profiler_names.scriptc", (void**) &script));
+    lua_State* L = script->m_LuaState;
+    const char* filename = script->m_LuaModule->m_Source.m_Filename;
+    const char* function_name = dmGameObject::SCRIPT_FUNCTION_NAMES[dmGameObject::SCRIPT_FUNCTION_UPDATE];
+
+    uint32_t formatted_hash = 0;
+    const char* formatted = 0;
+    start = dmTime::GetTime();
+    for (uint32_t i = 0; i < script_count * frame_count; ++i)
+    {
+        formatted = dmScript::GetProfilerString(L, 0, filename, function_name, 0, &formatted_hash);
+    }
+    uint64_t format_time = dmTime::GetTime() - start;
+
+    uint32_t interned_hash = 0;
+    const char* interned = 0;
+    start = dmTime::GetTime();
+    for (uint32_t i = 0; i < script_count * frame_count; ++i)
+    {
+        interned = dmGameObject::GetProfilerString(script, dmGameObject::SCRIPT_FUNCTION_UPDATE, &interned_hash);
+    }
+    uint64_t interned_time = dmTime::GetTime() - start;
+
+    ASSERT_NE((const char*) 0, interned);
+    ASSERT_EQ(formatted, interned);
+    ASSERT_EQ(formatted_hash, interned_hash);
+
+    printf("%u scripts, %u frames: update+on_message %.2f ms/frame\n", script_count, frame_count, update_time / (1000.0 * frame_count));
+    printf("profiler names: formatted %.3f ms/frame, interned %.3f ms/frame\n", format_time / (1000.0 * frame_count), interned_time / (1000.0 * frame_count));
+
+    dmResource::Release(m_Factory, script);
+    ASSERT_TRUE(dmGameObject::Final(collection));
+    dmGameObject::DeleteCollection(collection);
+    dmGameObject::PostUpdate(m_Register);
+}
+
 int main(int argc, char **argv)
 {
+    // The script profiler names are only built while profiling
+    dmProfile::Initialize(256, 1024 * 16, 128);
     dmDDF::RegisterAllTypes();
     jc_test_init(&argc, argv);
     int ret = jc_test_run_all();
+    dmProfile::Finalize();
     return ret;
 }
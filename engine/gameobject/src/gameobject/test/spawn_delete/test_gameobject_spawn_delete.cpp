@@ -98,6 +98,7 @@ protected:
         a_type.m_ResourceType = resource_type;
         a_type.m_Context = this;
         a_type.m_CreateFunction = AComponentCreate;
+        a_type.m_CreateBatchFunction = AComponentCreateBatch;
         a_type.m_InitFunction = AComponentInit;
         a_type.m_AddToUpdateFunction = AComponentAddToUpdate;
         a_type.m_FinalFunction = AComponentFinal;
@@ -128,6 +129,7 @@ protected:
     static dmResource::FResourceCreate          ACreate;
     static dmResource::FResourceDestroy         ADestroy;
     static dmGameObject::ComponentCreate        AComponentCreate;
+    static dmGameObject::ComponentCreateBatch   AComponentCreateBatch;
     static dmGameObject::ComponentInit          AComponentInit;
     static dmGameObject::ComponentFinal         AComponentFinal;
     static dmGameObject::ComponentDestroy       AComponentDestroy;
@@ -144,6 +146,7 @@ public:
     dmScript::HContext m_ScriptContext;
     dmGameObject::ModuleContext m_ModuleContext;
 
+    std::map<uint64_t, uint32_t> m_ComponentCreateBatchCountMap;
     std::map<uint64_t, uint32_t> m_ComponentInitCountMap;
     std::map<uint64_t, uint32_t> m_ComponentFinalCountMap;
     std::map<uint64_t, uint32_t> m_ComponentUpdateCountMap;
@@ -210,6 +213,18 @@ static dmGameObject::CreateResult GenericComponentCreate(const dmGameObject::Com
     return dmGameObject::CREATE_RESULT_OK;
 }
 
+template <typename T>
+static dmGameObject::CreateResult GenericComponentCreateBatch(const dmGameObject::ComponentCreateBatchParams& params)
+{
+    SpawnDeleteTest* game_object_test = (SpawnDeleteTest*) params.m_Context;
+    game_object_test->m_ComponentCreateBatchCountMap[T::m_DDFHash]++;
+    for (uint32_t i = 0; i < params.m_Count; ++i)
+    {
+        *params.m_UserData[i] = (uintptr_t)1;
+    }
+    return dmGameObject::CREATE_RESULT_OK;
+}
+
 template <typename T>
 static dmGameObject::CreateResult GenericComponentInit(const dmGameObject::ComponentInitParams& params)
 {
@@ -254,6 +269,7 @@ static dmGameObject::CreateResult GenericComponentDestroy(const dmGameObject::Co
 dmResource::FResourceCreate SpawnDeleteTest::ACreate                      = GenericDDFCreate<TestGameObjectDDF::AResource>;
 dmResource::FResourceDestroy SpawnDeleteTest::ADestroy                    = GenericDDFDestory<TestGameObjectDDF::AResource>;
 dmGameObject::ComponentCreate SpawnDeleteTest::AComponentCreate           = GenericComponentCreate<TestGameObjectDDF::AResource>;
+dmGameObject::ComponentCreateBatch SpawnDeleteTest::AComponentCreateBatch = GenericComponentCreateBatch<TestGameObjectDDF::AResource>;
 dmGameObject::ComponentInit SpawnDeleteTest::AComponentInit               = GenericComponentInit<TestGameObjectDDF::AResource>;
 dmGameObject::ComponentFinal SpawnDeleteTest::AComponentFinal             = GenericComponentFinal<TestGameObjectDDF::AResource>;
 dmGameObject::ComponentDestroy SpawnDeleteTest::AComponentDestroy         = GenericComponentDestroy<TestGameObjectDDF::AResource>;
@@ -630,6 +646,193 @@ TEST_F(SpawnDeleteTest, CollectionUpdate_SpawnDeleteMulti2)
     PostUpdate();
 }
 
+// More instances than fit in the old 15 bit indices
+TEST_F(SpawnDeleteTest, ManyInstances)
+{
+    const uint32_t count = 40000;
+    dmGameObject::HCollection old_collection = m_Collection;
+    m_Collection = dmGameObject::NewCollection("collection2", m_Factory, m_Register, count);
+    ASSERT_NE((void*) 0, m_Collection);
+
+    dmGameObject::HInstance first = 0;
+    dmGameObject::HInstance last = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        last = Spawn(m_Factory, m_Collection, "/a.goc", i + 1, 0x0, 0, Point3(0.0f, 0.0f, 0.0f), Quat(0.0f, 0.0f, 0.0f, 1.0f), Vector3(1, 1, 1));
+        NotNull(last);
+        if (i == 0)
+            first = last;
+    }
+    ASSERT_EQ(count - 1, last->m_Index);
+
+    // Parent the last instance to the first to have the transforms go through the level indices
+    ASSERT_EQ(dmGameObject::RESULT_OK, dmGameObject::SetParent(last, first));
+    dmGameObject::SetPosition(first, Point3(1.0f, 2.0f, 3.0f));
+    dmGameObject::SetPosition(last, Point3(1.0f, 0.0f, 0.0f));
+    Update();
+    ASSERT_EQ(2.0f, dmGameObject::GetWorldPosition(last).getX());
+    ASSERT_EQ(3.0f, dmGameObject::GetWorldPosition(last).getZ());
+
+    dmGameObject::DeleteCollection(m_Collection);
+    dmGameObject::PostUpdate(m_Register);
+    m_Collection = old_collection;
+}
+
+TEST_F(SpawnDeleteTest, SpawnDeleteThroughput)
+{
+    const uint32_t batch = 512;
+    const uint32_t frames = 200;
+    dmGameObject::HCollection old_collection = m_Collection;
+    m_Collection = dmGameObject::NewCollection("collection2", m_Factory, m_Register, batch);
+
+    dmGameObject::HPrototype prototype = 0x0;
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::Get(m_Factory, "/a.goc", (void**) &prototype));
+
+    dmGameObject::HInstance instances[batch];
+    uint64_t spawn_time = 0;
+    uint64_t delete_time = 0;
+    for (uint32_t frame = 0; frame < frames; ++frame)
+    {
+        uint64_t start = dmTime::GetTime();
+        for (uint32_t i = 0; i < batch; ++i)
+        {
+            instances[i] = dmGameObject::Spawn(m_Collection, prototype, "/a.goc", frame * batch + i + 1, 0x0, 0, Point3(0.0f, 0.0f, 0.0f), Quat(0.0f, 0.0f, 0.0f, 1.0f), Vector3(1, 1, 1));
+        }
+        uint64_t end = dmTime::GetTime();
+        spawn_time += end - start;
+
+        Update();
+
+        start = dmTime::GetTime();
+        for (uint32_t i = 0; i < batch; ++i)
+        {
+            ASSERT_NE((void*) 0, instances[i]);
+            Delete(instances[i]);
+        }
+        PostUpdate();
+        end = dmTime::GetTime();
+        delete_time += end - start;
+    }
+    printf("Spawn: %.3f us, delete: %.3f us per instance\n", spawn_time / (float) (batch * frames), delete_time / (float) (batch * frames));
+
+    dmResource::Release(m_Factory, prototype);
+    dmGameObject::DeleteCollection(m_Collection);
+    dmGameObject::PostUpdate(m_Register);
+    m_Collection = old_collection;
+}
+
+
+TEST_F(SpawnDeleteTest, SpawnBatch)
+{
+    const uint32_t count = 100;
+    dmGameObject::HCollection old_collection = m_Collection;
+    m_Collection = dmGameObject::NewCollection("collection2", m_Factory, m_Register, count);
+
+    dmGameObject::HPrototype prototype = 0x0;
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::Get(m_Factory, "/a.goc", (void**) &prototype));
+
+    dmhash_t ids[count];
+    Point3 positions[count];
+    Quat rotations[count];
+    Vector3 scales[count];
+    dmGameObject::HInstance instances[count];
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        ids[i] = i + 1;
+        positions[i] = Point3((float) i, 0.0f, 0.0f);
+        rotations[i] = Quat::identity();
+        scales[i] = Vector3(1, 1, 1);
+    }
+
+    // Too many for the collection, or ids in use, spawns nothing
+    ASSERT_FALSE(dmGameObject::SpawnBatch(m_Collection, prototype, "/a.goc", ids, 0x0, 0, positions, rotations, scales, count + 1, instances));
+    ids[count - 1] = 1;
+    ASSERT_FALSE(dmGameObject::SpawnBatch(m_Collection, prototype, "/a.goc", ids, 0x0, 0, positions, rotations, scales, count, instances));
+    ids[count - 1] = count;
+    ASSERT_EQ(0u, m_ComponentCreateBatchCountMap[TestGameObjectDDF::AResource::m_DDFHash]);
+
+    ASSERT_TRUE(dmGameObject::SpawnBatch(m_Collection, prototype, "/a.goc", ids, 0x0, 0, positions, rotations, scales, count, instances));
+    ASSERT_EQ(1u, m_ComponentCreateBatchCountMap[TestGameObjectDDF::AResource::m_DDFHash]);
+    ASSERT_INIT(count);
+    ASSERT_ADD_TO_UPDATE(0u);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        ASSERT_EQ(instances[i], dmGameObject::GetInstanceFromIdentifier(m_Collection, ids[i]));
+        ASSERT_EQ((float) i, dmGameObject::GetWorldPosition(instances[i]).getX());
+    }
+
+    Update();
+    ASSERT_ADD_TO_UPDATE(count);
+
+    for (uint32_t i = 0; i < count; ++i)
+        Delete(instances[i]);
+    PostUpdate();
+    ASSERT_FINAL(count);
+
+    dmResource::Release(m_Factory, prototype);
+    dmGameObject::DeleteCollection(m_Collection);
+    dmGameObject::PostUpdate(m_Register);
+    m_Collection = old_collection;
+}
+
+TEST_F(SpawnDeleteTest, SpawnBatchThroughput)
+{
+    const uint32_t count = 1000;
+    const uint32_t frames = 50;
+    dmGameObject::HCollection old_collection = m_Collection;
+    m_Collection = dmGameObject::NewCollection("collection2", m_Factory, m_Register, count);
+
+    dmGameObject::HPrototype prototype = 0x0;
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::Get(m_Factory, "/a.goc", (void**) &prototype));
+
+    dmhash_t ids[count];
+    Point3 positions[count];
+    Quat rotations[count];
+    Vector3 scales[count];
+    dmGameObject::HInstance instances[count];
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        positions[i] = Point3((float) i, 0.0f, 0.0f);
+        rotations[i] = Quat::identity();
+        scales[i] = Vector3(1, 1, 1);
+    }
+
+    uint64_t single_time = 0;
+    uint64_t batch_time = 0;
+    for (uint32_t frame = 0; frame < frames; ++frame)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+            ids[i] = frame * count + i + 1;
+
+        bool batch = (frame & 1) != 0;
+        uint64_t start = dmTime::GetTime();
+        if (batch)
+        {
+            ASSERT_TRUE(dmGameObject::SpawnBatch(m_Collection, prototype, "/a.goc", ids, 0x0, 0, positions, rotations, scales, count, instances));
+        }
+        else
+        {
+            for (uint32_t i = 0; i < count; ++i)
+                instances[i] = dmGameObject::Spawn(m_Collection, prototype, "/a.goc", ids[i], 0x0, 0, positions[i], rotations[i], scales[i]);
+        }
+        uint64_t end = dmTime::GetTime();
+        (batch ? batch_time : single_time) += end - start;
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            ASSERT_NE((void*) 0, instances[i]);
+            Delete(instances[i]);
+        }
+        PostUpdate();
+    }
+    printf("Spawn: %.1f instances/ms, SpawnBatch: %.1f instances/ms\n", count * (frames / 2) * 1000.0f / single_time, count * (frames / 2) * 1000.0f / batch_time);
+
+    dmResource::Release(m_Factory, prototype);
+    dmGameObject::DeleteCollection(m_Collection);
+    dmGameObject::PostUpdate(m_Register);
+    m_Collection = old_collection;
+}
 
 #undef ASSERT_INIT
 #undef ASSERT_ADD_TO_UPDATE
@@ -1240,6 +1240,19 @@ namespace dmGameSystem
         }
     }
 
+    void RayCastBatch(void* _world, const dmPhysics::RayCastRequest* requests, uint32_t request_count, dmPhysics::RayCastResponse* responses)
+    {
+        CollisionWorld* world = (CollisionWorld*)_world;
+        if (world->m_3D)
+        {
+            dmPhysics::RayCastBatch3D(world->m_World3D, requests, request_count, responses);
+        }
+        else
+        {
+            dmPhysics::RayCastBatch2D(world->m_World2D, requests, request_count, responses);
+        }
+    }
+
     // Find a JointEntry in the linked list of a collision component based on the joint id.
     static JointEntry* FindJointEntry(CollisionWorld* world, CollisionComponent* component, dmhash_t id)
     {
@@ -50,6 +50,7 @@ namespace dmGameSystem
 
     // For script_physics.cpp
     void RayCast(void* world, const dmPhysics::RayCastRequest& request, dmArray<dmPhysics::RayCastResponse>& results);
+    void RayCastBatch(void* world, const dmPhysics::RayCastRequest* requests, uint32_t request_count, dmPhysics::RayCastResponse* responses);
     uint64_t GetLSBGroupHash(void* world, uint16_t mask);
     dmhash_t CompCollisionObjectGetIdentifier(void* component);
 
@@ -567,6 +567,7 @@ namespace dmGameSystem
         gui_component->m_ComponentIndex = params.m_ComponentIndex;
         gui_component->m_Enabled = 1;
         gui_component->m_AddedToUpdate = 0;
+        gui_component->m_RenderCacheValid = 0;
 
         dmGui::NewSceneParams scene_params;
         // 1024 is a hard cap since the render key has 10 bits for node index
@@ -685,6 +686,7 @@ namespace dmGameSystem
         dmRender::HRenderContext    m_RenderContext;
         dmRender::HMaterial         m_Material;
         GuiWorld*                   m_GuiWorld;
+        GuiComponent*               m_Component;
 
         // This order value is increased during rendering for each
         // render object generated, then used to make sure the final
@@ -1561,6 +1563,110 @@ namespace dmGameSystem
         ro.m_VertexCount = gui_world->m_ClientVertexBuffer.Size() - ro.m_VertexStart;
     }
 
+    static void UploadVertexData(GuiWorld* gui_world)
+    {
+        dmGraphics::SetVertexBufferData(gui_world->m_VertexBuffer,
+                                        gui_world->m_ClientVertexBuffer.Size() * sizeof(BoxVertex),
+                                        gui_world->m_ClientVertexBuffer.Begin(),
+                                        dmGraphics::BUFFER_USAGE_STREAM_DRAW);
+        DM_COUNTER("Gui.VertexCount", gui_world->m_ClientVertexBuffer.Size());
+    }
+
+    static void PushTextBatch(GuiComponent* component, RenderGuiContext* gui_context, uint32_t entry_start, uint32_t entry_count, uint32_t sort_order_start)
+    {
+        GuiTextBatch batch;
+        batch.m_EntryStart = entry_start;
+        batch.m_EntryCount = entry_count;
+        batch.m_SortOrder = gui_context->m_NextSortOrder - sort_order_start;
+        batch.m_FirstStencil = gui_context->m_FirstStencil;
+        if (component->m_CachedTextBatches.Full())
+        {
+            component->m_CachedTextBatches.OffsetCapacity(16);
+        }
+        component->m_CachedTextBatches.Push(batch);
+    }
+
+    // Keep what was generated for the scene so that it can be replayed while the scene is unchanged
+    static void StoreRenderCache(GuiComponent* component, RenderGuiContext* gui_context, uint32_t render_version, uint32_t ro_start, uint32_t vertex_start, uint32_t sort_order_start)
+    {
+        GuiWorld* gui_world = gui_context->m_GuiWorld;
+
+        uint32_t ro_count = gui_world->m_GuiRenderObjects.Size() - ro_start;
+        dmArray<GuiRenderObject>& render_objects = component->m_CachedRenderObjects;
+        if (render_objects.Capacity() < ro_count)
+        {
+            render_objects.SetCapacity(ro_count);
+        }
+        render_objects.SetSize(ro_count);
+        for (uint32_t i = 0; i < ro_count; ++i)
+        {
+            GuiRenderObject& gro = render_objects[i];
+            gro = gui_world->m_GuiRenderObjects[ro_start + i];
+            gro.m_SortOrder -= sort_order_start;
+            gro.m_RenderObject.m_VertexStart -= vertex_start;
+        }
+
+        uint32_t vertex_count = gui_world->m_ClientVertexBuffer.Size() - vertex_start;
+        if (component->m_CachedVertices.Capacity() < vertex_count)
+        {
+            component->m_CachedVertices.SetCapacity(vertex_count);
+        }
+        component->m_CachedVertices.SetSize(vertex_count);
+        memcpy(component->m_CachedVertices.Begin(), gui_world->m_ClientVertexBuffer.Begin() + vertex_start, vertex_count * sizeof(BoxVertex));
+
+        component->m_CachedMaterial = gui_context->m_Material;
+        component->m_CachedRenderVersion = render_version;
+        component->m_CachedSortOrderCount = gui_context->m_NextSortOrder - sort_order_start;
+    }
+
+    static void ReplayRenderCache(GuiComponent* component,
+                                  dmGui::HScene scene,
+                                  const dmGui::RenderEntry* entries,
+                                  const Matrix4* node_transforms,
+                                  const float* node_opacities,
+                                  const dmGui::StencilScope** stencil_scopes,
+                                  void* context)
+    {
+        DM_PROFILE(Gui, "ReplayRenderCache");
+
+        RenderGuiContext* gui_context = (RenderGuiContext*) context;
+        GuiWorld* gui_world = gui_context->m_GuiWorld;
+
+        uint32_t sort_order_start = gui_context->m_NextSortOrder;
+        uint32_t vertex_start = gui_world->m_ClientVertexBuffer.Size();
+
+        uint32_t vertex_count = component->m_CachedVertices.Size();
+        if (gui_world->m_ClientVertexBuffer.Remaining() < vertex_count) {
+            gui_world->m_ClientVertexBuffer.OffsetCapacity(dmMath::Max(128U, vertex_count));
+        }
+        gui_world->m_ClientVertexBuffer.SetSize(vertex_start + vertex_count);
+        memcpy(gui_world->m_ClientVertexBuffer.Begin() + vertex_start, component->m_CachedVertices.Begin(), vertex_count * sizeof(BoxVertex));
+
+        uint32_t ro_count = component->m_CachedRenderObjects.Size();
+        uint32_t ro_start = gui_world->m_GuiRenderObjects.Size();
+        gui_world->m_GuiRenderObjects.SetSize(ro_start + ro_count);
+        for (uint32_t i = 0; i < ro_count; ++i)
+        {
+            GuiRenderObject& gro = gui_world->m_GuiRenderObjects[ro_start + i];
+            gro = component->m_CachedRenderObjects[i];
+            gro.m_SortOrder += sort_order_start;
+            gro.m_RenderObject.m_VertexStart += vertex_start;
+        }
+
+        // Text is batched by dmRender and has to be drawn again, in its original place in the sort order
+        uint32_t text_batch_count = component->m_CachedTextBatches.Size();
+        for (uint32_t i = 0; i < text_batch_count; ++i)
+        {
+            const GuiTextBatch& batch = component->m_CachedTextBatches[i];
+            uint32_t start = batch.m_EntryStart;
+            gui_context->m_NextSortOrder = sort_order_start + batch.m_SortOrder;
+            gui_context->m_FirstStencil = batch.m_FirstStencil;
+            RenderTextNodes(scene, entries + start, node_transforms + start, node_opacities + start, stencil_scopes + start, batch.m_EntryCount, context);
+        }
+
+        gui_context->m_NextSortOrder = sort_order_start + component->m_CachedSortOrderCount;
+    }
+
     void RenderNodes(dmGui::HScene scene,
                     const dmGui::RenderEntry* entries,
                     const Matrix4* node_transforms,
@@ -1576,10 +1682,26 @@ namespace dmGameSystem
 
         RenderGuiContext* gui_context = (RenderGuiContext*) context;
         GuiWorld* gui_world = gui_context->m_GuiWorld;
+        GuiComponent* component = gui_context->m_Component;
 
         gui_world->m_RenderedParticlesSize = 0;
         gui_context->m_FirstStencil = true;
 
+        uint32_t render_version = dmGui::GetSceneRenderVersion(scene);
+        if (component->m_RenderCacheValid && component->m_CachedRenderVersion == render_version && component->m_CachedMaterial == gui_context->m_Material)
+        {
+            ReplayRenderCache(component, scene, entries, node_transforms, node_opacities, stencil_scopes, context);
+            UploadVertexData(gui_world);
+            return;
+        }
+
+        uint32_t ro_start = gui_world->m_GuiRenderObjects.Size();
+        uint32_t vertex_start = gui_world->m_ClientVertexBuffer.Size();
+        uint32_t sort_order_start = gui_context->m_NextSortOrder;
+        // Scenes with spine or particlefx nodes are regenerated every frame and not worth caching
+        bool cacheable = true;
+        component->m_CachedTextBatches.SetSize(0);
+
         dmGui::HNode first_node = entries[0].m_Node;
         dmGui::BlendMode prev_blend_mode = dmGui::GetNodeBlendMode(scene, first_node);
         dmGui::NodeType prev_node_type = dmGui::GetNodeType(scene, first_node);
@@ -1627,6 +1749,7 @@ namespace dmGameSystem
                 switch (prev_node_type)
                 {
                     case dmGui::NODE_TYPE_TEXT:
+                        PushTextBatch(component, gui_context, start, n, sort_order_start);
                         RenderTextNodes(scene, entries + start, node_transforms + start, node_opacities + start, stencil_scopes + start, n, context);
                         break;
                     case dmGui::NODE_TYPE_BOX:
@@ -1637,9 +1760,11 @@ namespace dmGameSystem
                         break;
                     case dmGui::NODE_TYPE_SPINE:
                         RenderSpineNodes(scene, entries + start, node_transforms + start, node_opacities + start, stencil_scopes + start, n, context);
+                        cacheable = false;
                         break;
                     case dmGui::NODE_TYPE_PARTICLEFX:
                     	RenderParticlefxNodes(scene, entries + start, node_transforms + start, node_opacities + start, stencil_scopes + start, n, context);
+                        cacheable = false;
                     	break;
                     default:
                         break;
@@ -1662,6 +1787,7 @@ namespace dmGameSystem
             switch (prev_node_type)
             {
                 case dmGui::NODE_TYPE_TEXT:
+                    PushTextBatch(component, gui_context, start, n, sort_order_start);
                     RenderTextNodes(scene, entries + start, node_transforms + start, node_opacities + start, stencil_scopes + start, n, context);
                     break;
                 case dmGui::NODE_TYPE_BOX:
@@ -1672,20 +1798,24 @@ namespace dmGameSystem
                     break;
                 case dmGui::NODE_TYPE_SPINE:
                     RenderSpineNodes(scene, entries + start, node_transforms + start, node_opacities + start, stencil_scopes + start, n, context);
+                    cacheable = false;
                     break;
                 case dmGui::NODE_TYPE_PARTICLEFX:
                     RenderParticlefxNodes(scene, entries + start, node_transforms + start, node_opacities + start, stencil_scopes + start, n, context);
+                    cacheable = false;
                     break;
                 default:
                     break;
             }
         }
 
-        dmGraphics::SetVertexBufferData(gui_world->m_VertexBuffer,
-                                        gui_world->m_ClientVertexBuffer.Size() * sizeof(BoxVertex),
-                                        gui_world->m_ClientVertexBuffer.Begin(),
-                                        dmGraphics::BUFFER_USAGE_STREAM_DRAW);
-        DM_COUNTER("Gui.VertexCount", gui_world->m_ClientVertexBuffer.Size());
+        component->m_RenderCacheValid = cacheable;
+        if (cacheable)
+        {
+            StoreRenderCache(component, gui_context, render_version, ro_start, vertex_start, sort_order_start);
+        }
+
+        UploadVertexData(gui_world);
     }
 
     static dmGraphics::TextureFormat ToGraphicsFormat(dmImage::Type type) {
@@ -1858,6 +1988,7 @@ namespace dmGameSystem
         RenderGuiContext render_gui_context;
         render_gui_context.m_RenderContext = gui_context->m_RenderContext;
         render_gui_context.m_GuiWorld = gui_world;
+        render_gui_context.m_Component = 0;
         render_gui_context.m_NextSortOrder = 0;
 
         uint32_t total_node_count = 0;
@@ -1888,6 +2019,7 @@ namespace dmGameSystem
 
             // Render scene and see how many render objects it added, then we add those individually.
             render_gui_context.m_Material = GetMaterial(c, c->m_Resource);
+            render_gui_context.m_Component = c;
             dmGui::RenderScene(c->m_Scene, rp, &render_gui_context);
             const uint32_t count = gui_world->m_GuiRenderObjects.Size() - lastEnd;
 
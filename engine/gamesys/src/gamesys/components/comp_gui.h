@@ -26,17 +26,6 @@ namespace dmGameSystem
 
     struct GuiSceneResource;
 
-    struct GuiComponent
-    {
-        GuiSceneResource*       m_Resource;
-        dmGui::HScene           m_Scene;
-        dmGameObject::HInstance m_Instance;
-        dmRender::HMaterial     m_Material;
-        uint16_t                m_ComponentIndex;
-        uint8_t                 m_Enabled : 1;
-        uint8_t                 m_AddedToUpdate : 1;
-    };
-
     struct BoxVertex
     {
         inline BoxVertex() {}
@@ -79,6 +68,35 @@ namespace dmGameSystem
         uint32_t m_SortOrder;
     };
 
+    // Text batch recorded in the render cache, text is drawn through dmRender and has to be re-issued each frame
+    struct GuiTextBatch
+    {
+        uint32_t m_EntryStart;
+        uint32_t m_EntryCount;
+        uint32_t m_SortOrder;
+        uint8_t  m_FirstStencil : 1;
+    };
+
+    struct GuiComponent
+    {
+        GuiSceneResource*       m_Resource;
+        dmGui::HScene           m_Scene;
+        dmGameObject::HInstance m_Instance;
+        dmRender::HMaterial     m_Material;
+        // Render objects, vertices and text batches generated the last time the scene was rebuilt.
+        // Sort orders and vertex starts are relative to the first render object of the scene.
+        dmArray<GuiRenderObject> m_CachedRenderObjects;
+        dmArray<BoxVertex>      m_CachedVertices;
+        dmArray<GuiTextBatch>   m_CachedTextBatches;
+        dmRender::HMaterial     m_CachedMaterial;
+        uint32_t                m_CachedRenderVersion;
+        uint32_t                m_CachedSortOrderCount;
+        uint16_t                m_ComponentIndex;
+        uint8_t                 m_Enabled : 1;
+        uint8_t                 m_AddedToUpdate : 1;
+        uint8_t                 m_RenderCacheValid : 1;
+    };
+
     struct GuiWorld
     {
         dmArray<GuiRenderObject>         m_GuiRenderObjects;
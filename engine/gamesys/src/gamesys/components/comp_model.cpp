@@ -75,6 +75,7 @@ namespace dmGameSystem
         dmArray<dmRig::RigModelVertex>* m_VertexBufferData;
         // Temporary scratch array for instances, only used during the creation phase of components
         dmArray<dmGameObject::HInstance> m_ScratchInstances;
+        dmArray<dmRig::GenerateVertexDataParams> m_VertexDataParams;
         dmRig::HRigContext              m_RigContext;
         uint32_t                        m_MaxElementsVertices;
         uint32_t                        m_VertexBufferSwapChainIndex;
@@ -102,6 +103,7 @@ namespace dmGameSystem
         dmRig::NewContextParams rig_params = {0};
         rig_params.m_Context = &world->m_RigContext;
         rig_params.m_MaxRigInstanceCount = context->m_MaxModelCount;
+        rig_params.m_WorkerPool = context->m_WorkerPool;
         dmRig::Result rr = dmRig::NewContext(rig_params);
         if (rr != dmRig::RESULT_OK)
         {
@@ -517,17 +519,27 @@ namespace dmGameSystem
 
         dmGraphics::HVertexBuffer& gfx_vertex_buffer = world->m_VertexBuffers[batchIndex];
 
-        // Fill in vertex buffer
+        uint32_t instance_count = end - begin;
+        dmArray<dmRig::GenerateVertexDataParams>& vertex_params = world->m_VertexDataParams;
+        if (vertex_params.Capacity() < instance_count)
+            vertex_params.OffsetCapacity(instance_count - vertex_params.Capacity());
+        vertex_params.SetSize(instance_count);
+
+        // Fill in vertex buffer, each instance writes to its own range so they can be skinned in parallel
         dmRig::RigModelVertex *vb_begin = vertex_buffer.End();
         dmRig::RigModelVertex *vb_end = vb_begin;
         for (uint32_t *i=begin;i!=end;i++)
         {
             const ModelComponent* c = (ModelComponent*) buf[*i].m_UserData;
-            dmRig::HRigContext rig_context = world->m_RigContext;
-            Matrix4 normal_matrix = inverse(c->m_World);
-            normal_matrix = transpose(normal_matrix);
-            vb_end = (dmRig::RigModelVertex *)dmRig::GenerateVertexData(rig_context, c->m_RigInstance, c->m_World, normal_matrix, Vector4(1.0), dmRig::RIG_VERTEX_FORMAT_MODEL, (void*)vb_end);
+            dmRig::GenerateVertexDataParams& p = vertex_params[i - begin];
+            p.m_Instance = c->m_RigInstance;
+            p.m_ModelMatrix = c->m_World;
+            p.m_NormalMatrix = transpose(inverse(c->m_World));
+            p.m_Color = Vector4(1.0);
+            p.m_VertexDataOut = (void*)vb_end;
+            vb_end += dmRig::GetVertexCount(c->m_RigInstance);
         }
+        dmRig::GenerateVertexDataBatch(world->m_RigContext, vertex_params.Begin(), instance_count, dmRig::RIG_VERTEX_FORMAT_MODEL);
         vertex_buffer.SetSize(vb_end - vertex_buffer.Begin());
 
         // Ninja in-place writing of render object.
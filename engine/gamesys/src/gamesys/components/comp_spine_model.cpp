@@ -76,6 +76,7 @@ namespace dmGameSystem
         dmRig::NewContextParams rig_params = {0};
         rig_params.m_Context = &world->m_RigContext;
         rig_params.m_MaxRigInstanceCount = context->m_MaxSpineModelCount;
+        rig_params.m_WorkerPool = context->m_WorkerPool;
         dmRig::Result rr = dmRig::NewContext(rig_params);
         if (rr != dmRig::RESULT_OK)
         {
@@ -438,15 +439,27 @@ namespace dmGameSystem
         if (vertex_buffer.Remaining() < vertex_count)
             vertex_buffer.OffsetCapacity(vertex_count - vertex_buffer.Remaining());
 
-        // Fill in vertex buffer
+        uint32_t instance_count = end - begin;
+        dmArray<dmRig::GenerateVertexDataParams>& vertex_params = world->m_VertexDataParams;
+        if (vertex_params.Capacity() < instance_count)
+            vertex_params.OffsetCapacity(instance_count - vertex_params.Capacity());
+        vertex_params.SetSize(instance_count);
+
+        // Fill in vertex buffer, each instance writes to its own range so they can be skinned in parallel
         dmRig::RigSpineModelVertex *vb_begin = vertex_buffer.End();
         dmRig::RigSpineModelVertex *vb_end = vb_begin;
-        dmRig::HRigContext rig_context = world->m_RigContext;
         for (uint32_t *i=begin;i!=end;i++)
         {
             const SpineModelComponent* c = (SpineModelComponent*) buf[*i].m_UserData;
-            vb_end = (dmRig::RigSpineModelVertex*)dmRig::GenerateVertexData(rig_context, c->m_RigInstance, c->m_World, Matrix4::identity(), Vector4(1.0), dmRig::RIG_VERTEX_FORMAT_SPINE, (void*)vb_end);
-        }
+            dmRig::GenerateVertexDataParams& p = vertex_params[i - begin];
+            p.m_Instance = c->m_RigInstance;
+            p.m_ModelMatrix = c->m_World;
+            p.m_NormalMatrix = Matrix4::identity();
+            p.m_Color = Vector4(1.0);
+            p.m_VertexDataOut = (void*)vb_end;
+            vb_end += dmRig::GetVertexCount(c->m_RigInstance);
+        }
+        dmRig::GenerateVertexDataBatch(world->m_RigContext, vertex_params.Begin(), instance_count, dmRig::RIG_VERTEX_FORMAT_SPINE);
         vertex_buffer.SetSize(vb_end - vertex_buffer.Begin());
 
         // Ninja in-place writing of render object.
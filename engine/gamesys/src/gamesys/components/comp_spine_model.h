@@ -55,6 +55,7 @@ namespace dmGameSystem
         dmGraphics::HVertexDeclaration      m_VertexDeclaration;
         dmGraphics::HVertexBuffer           m_VertexBuffer;
         dmArray<dmRig::RigSpineModelVertex> m_VertexBufferData;
+        dmArray<dmRig::GenerateVertexDataParams> m_VertexDataParams;
         // Temporary scratch array for instances, only used during the creation phase of components
         dmArray<dmGameObject::HInstance>    m_ScratchInstances;
         dmRig::HRigContext                  m_RigContext;
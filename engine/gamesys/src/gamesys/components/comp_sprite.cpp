@@ -36,6 +36,14 @@
 #include "sprite_ddf.h"
 #include "gamesys_ddf.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define DM_SPRITE_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define DM_SPRITE_NEON
+#endif
+
 using namespace Vectormath::Aos;
 namespace dmGameSystem
 {
@@ -77,15 +85,6 @@ namespace dmGameSystem
         uint16_t                    m_Padding : 7;
     };
 
-    struct SpriteVertex
-    {
-        float x;
-        float y;
-        float z;
-        float u;
-        float v;
-    };
-
     struct SpriteWorld
     {
         dmObjectPool<SpriteComponent>   m_Components;
@@ -368,6 +367,45 @@ namespace dmGameSystem
         return dmGameObject::CREATE_RESULT_OK;
     }
 
+    dmGameObject::CreateResult CompSpriteCreateBatch(const dmGameObject::ComponentCreateBatchParams& params)
+    {
+        SpriteWorld* sprite_world = (SpriteWorld*)params.m_World;
+
+        if (sprite_world->m_Components.Capacity() - sprite_world->m_Components.Size() < params.m_Count)
+        {
+            dmLogError("%u sprites could not be created since the sprite buffer is full (%d).", params.m_Count, sprite_world->m_Components.Capacity());
+            return dmGameObject::CREATE_RESULT_UNKNOWN_ERROR;
+        }
+
+        // The sprites all start out the same, so set up the first one and copy it to the rest
+        dmGameObject::ComponentCreateParams create_params;
+        create_params.m_Instance = params.m_Instances[0];
+        create_params.m_Position = params.m_Position;
+        create_params.m_Rotation = params.m_Rotation;
+        create_params.m_PropertySet = params.m_PropertySet;
+        create_params.m_Resource = params.m_Resource;
+        create_params.m_World = params.m_World;
+        create_params.m_Context = params.m_Context;
+        create_params.m_UserData = params.m_UserData[0];
+        create_params.m_ComponentIndex = params.m_ComponentIndex;
+        dmGameObject::CreateResult result = CompSpriteCreate(create_params);
+        if (result != dmGameObject::CREATE_RESULT_OK)
+        {
+            return result;
+        }
+
+        uint32_t first_index = (uint32_t)*params.m_UserData[0];
+        for (uint32_t i = 1; i < params.m_Count; ++i)
+        {
+            uint32_t index = sprite_world->m_Components.Alloc();
+            SpriteComponent* component = &sprite_world->m_Components.Get(index);
+            memcpy(component, &sprite_world->m_Components.Get(first_index), sizeof(SpriteComponent));
+            component->m_Instance = params.m_Instances[i];
+            *params.m_UserData[i] = (uintptr_t)index;
+        }
+        return dmGameObject::CREATE_RESULT_OK;
+    }
+
     dmGameObject::CreateResult CompSpriteDestroy(const dmGameObject::ComponentDestroyParams& params)
     {
         SpriteWorld* sprite_world = (SpriteWorld*)params.m_World;
@@ -385,6 +423,130 @@ namespace dmGameSystem
     }
 
 
+    // Minimal four-wide float helpers for the vertex generation.
+    // A vector holds one transformed position (x, y, z, w).
+#if defined(DM_SPRITE_SSE)
+    typedef __m128 SpriteVec4;
+
+    static inline SpriteVec4 VecLoad(const Vector4& v)                              { return _mm_loadu_ps((const float*)&v); }
+    static inline SpriteVec4 VecSplat(float f)                                      { return _mm_set1_ps(f); }
+    static inline SpriteVec4 VecAdd(SpriteVec4 a, SpriteVec4 b)                     { return _mm_add_ps(a, b); }
+    static inline SpriteVec4 VecSub(SpriteVec4 a, SpriteVec4 b)                     { return _mm_sub_ps(a, b); }
+    static inline SpriteVec4 VecMul(SpriteVec4 a, SpriteVec4 b)                     { return _mm_mul_ps(a, b); }
+    static inline SpriteVec4 VecMulAdd(SpriteVec4 a, SpriteVec4 b, SpriteVec4 c)    { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    // Writes x, y, z and w, where w lands in u and is then overwritten
+    static inline void VecStoreVertex(SpriteVertex* out, SpriteVec4 p, float u, float v) { _mm_storeu_ps(&out->x, p); out->u = u; out->v = v; }
+#elif defined(DM_SPRITE_NEON)
+    typedef float32x4_t SpriteVec4;
+
+    static inline SpriteVec4 VecLoad(const Vector4& v)                              { return vld1q_f32((const float*)&v); }
+    static inline SpriteVec4 VecSplat(float f)                                      { return vdupq_n_f32(f); }
+    static inline SpriteVec4 VecAdd(SpriteVec4 a, SpriteVec4 b)                     { return vaddq_f32(a, b); }
+    static inline SpriteVec4 VecSub(SpriteVec4 a, SpriteVec4 b)                     { return vsubq_f32(a, b); }
+    static inline SpriteVec4 VecMul(SpriteVec4 a, SpriteVec4 b)                     { return vmulq_f32(a, b); }
+    static inline SpriteVec4 VecMulAdd(SpriteVec4 a, SpriteVec4 b, SpriteVec4 c)    { return vmlaq_f32(c, a, b); }
+    // Writes x, y, z and w, where w lands in u and is then overwritten
+    static inline void VecStoreVertex(SpriteVertex* out, SpriteVec4 p, float u, float v) { vst1q_f32(&out->x, p); out->u = u; out->v = v; }
+#else
+    typedef Vector4 SpriteVec4;
+
+    static inline SpriteVec4 VecLoad(const Vector4& v)                              { return v; }
+    static inline SpriteVec4 VecSplat(float f)                                      { return Vector4(f); }
+    static inline SpriteVec4 VecAdd(SpriteVec4 a, SpriteVec4 b)                     { return a + b; }
+    static inline SpriteVec4 VecSub(SpriteVec4 a, SpriteVec4 b)                     { return a - b; }
+    static inline SpriteVec4 VecMul(SpriteVec4 a, SpriteVec4 b)                     { return mulPerElem(a, b); }
+    static inline SpriteVec4 VecMulAdd(SpriteVec4 a, SpriteVec4 b, SpriteVec4 c)    { return mulPerElem(a, b) + c; }
+    static inline void VecStoreVertex(SpriteVertex* out, SpriteVec4 p, float u, float v)
+    {
+        out->x = p.getX();
+        out->y = p.getY();
+        out->z = p.getZ();
+        out->u = u;
+        out->v = v;
+    }
+#endif
+
+    void CompSpriteQuadVertices(const Matrix4& world, const float uvs[8], SpriteVertex* out)
+    {
+        // The corners are +-0.5 along the x and y axis, and z is 0, so each corner is the
+        // translation plus/minus half of the first two columns.
+        const SpriteVec4 half = VecSplat(0.5f);
+        const SpriteVec4 hx = VecMul(VecLoad(world.getCol0()), half);
+        const SpriteVec4 hy = VecMul(VecLoad(world.getCol1()), half);
+        const SpriteVec4 t = VecLoad(world.getCol3());
+
+        const SpriteVec4 left = VecSub(t, hx);
+        const SpriteVec4 right = VecAdd(t, hx);
+
+        VecStoreVertex(&out[0], VecSub(left, hy), uvs[0], uvs[1]);
+        VecStoreVertex(&out[1], VecAdd(left, hy), uvs[2], uvs[3]);
+        VecStoreVertex(&out[2], VecAdd(right, hy), uvs[4], uvs[5]);
+        VecStoreVertex(&out[3], VecSub(right, hy), uvs[6], uvs[7]);
+    }
+
+    void CompSpriteGeometryVertices(const Matrix4& world, const float* points, const float* uvs, int step, float scale_x, float scale_y, uint32_t count, SpriteVertex* out)
+    {
+        // The flip is folded into the columns, and z is 0, so each point is c0 * x + c1 * y + c3
+        const SpriteVec4 c0 = VecMul(VecLoad(world.getCol0()), VecSplat(scale_x));
+        const SpriteVec4 c1 = VecMul(VecLoad(world.getCol1()), VecSplat(scale_y));
+        const SpriteVec4 c3 = VecLoad(world.getCol3());
+
+        for (uint32_t i = 0; i < count; ++i, ++out, points += step, uvs += step)
+        {
+            SpriteVec4 p = VecMulAdd(c0, VecSplat(points[0]), VecMulAdd(c1, VecSplat(points[1]), c3));
+            VecStoreVertex(out, p, uvs[0], uvs[1]);
+        }
+    }
+
+    static void OffsetIndices(uint32_t* out, const uint32_t* indices, uint32_t count, uint32_t offset)
+    {
+        uint32_t i = 0;
+#if defined(DM_SPRITE_SSE)
+        const __m128i off = _mm_set1_epi32((int32_t)offset);
+        for (; i + 4 <= count; i += 4)
+        {
+            _mm_storeu_si128((__m128i*)(out + i), _mm_add_epi32(_mm_loadu_si128((const __m128i*)(indices + i)), off));
+        }
+#elif defined(DM_SPRITE_NEON)
+        const uint32x4_t off = vdupq_n_u32(offset);
+        for (; i + 4 <= count; i += 4)
+        {
+            vst1q_u32(out + i, vaddq_u32(vld1q_u32(indices + i), off));
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            out[i] = offset + indices[i];
+        }
+    }
+
+    static void OffsetIndices(uint16_t* out, const uint32_t* indices, uint32_t count, uint32_t offset)
+    {
+        uint32_t i = 0;
+#if defined(DM_SPRITE_SSE)
+        // There is no unsigned 32 to 16 bit pack in SSE2, so bias the values into the signed
+        // range before the saturating pack, and remove the bias afterwards.
+        const __m128i off = _mm_set1_epi32((int32_t)offset - 0x8000);
+        const __m128i bias = _mm_set1_epi16((int16_t)0x8000);
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i lo = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(indices + i)), off);
+            __m128i hi = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(indices + i + 4)), off);
+            _mm_storeu_si128((__m128i*)(out + i), _mm_add_epi16(_mm_packs_epi32(lo, hi), bias));
+        }
+#elif defined(DM_SPRITE_NEON)
+        const uint32x4_t off = vdupq_n_u32(offset);
+        for (; i + 4 <= count; i += 4)
+        {
+            vst1_u16(out + i, vmovn_u32(vaddq_u32(vld1q_u32(indices + i), off)));
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            out[i] = (uint16_t)(offset + indices[i]);
+        }
+    }
+
     static void CreateVertexData(SpriteWorld* sprite_world, SpriteVertex** vb_where, uint8_t** ib_where, TextureSetResource* texture_set, dmRender::RenderListEntry* buf, uint32_t* begin, uint32_t* end)
     {
         DM_PROFILE(Sprite, "CreateVertexData");
@@ -415,8 +577,6 @@ namespace dmGameSystem
 
                 const dmGameSystemDDF::SpriteGeometry* geometry = &geometries[frame_index];
 
-                const Matrix4& w = component->m_World;
-
                 uint32_t num_points = geometry->m_Vertices.m_Count / 2;
 
                 const float* points = geometry->m_Vertices.m_Data;
@@ -435,36 +595,18 @@ namespace dmGameSystem
                 points = reverse ? points + num_points*2 - 2 : points;
                 uvs = reverse ? uvs + num_points*2 - 2 : uvs;
 
-                for (uint32_t vert = 0; vert < num_points; ++vert, ++vertices, points += step, uvs += step)
-                {
-                    float x = points[0] * scaleX; // range -0.5,+0.5
-                    float y = points[1] * scaleY;
-                    float u = uvs[0];
-                    float v = uvs[1];
-
-                    Vector4 p0 = w * Point3(x, y, 0.0f);
-                    vertices[0].x = ((float*)&p0)[0];
-                    vertices[0].y = ((float*)&p0)[1];
-                    vertices[0].z = ((float*)&p0)[2];
-                    vertices[0].u = u;
-                    vertices[0].v = v;
-                }
+                CompSpriteGeometryVertices(component->m_World, points, uvs, step, scaleX, scaleY, num_points, vertices);
+                vertices += num_points;
 
                 uint32_t index_count = geometry->m_Indices.m_Count;
-                uint32_t* geom_indices = geometry->m_Indices.m_Data;
+                const uint32_t* geom_indices = geometry->m_Indices.m_Data;
                 if (sprite_world->m_Is16BitIndex)
                 {
-                    for (uint32_t index = 0; index < index_count; ++index)
-                    {
-                        ((uint16_t*)indices)[index] = vertex_offset + geom_indices[index];
-                    }
+                    OffsetIndices((uint16_t*)indices, geom_indices, index_count, vertex_offset);
                 }
                 else
                 {
-                    for (uint32_t index = 0; index < index_count; ++index)
-                    {
-                        ((uint32_t*)indices)[index] = vertex_offset + geom_indices[index];
-                    }
+                    OffsetIndices((uint32_t*)indices, geom_indices, index_count, vertex_offset);
                 }
                 indices += index_type_size * geometry->m_Indices.m_Count;
                 vertex_offset += num_points;
@@ -504,38 +646,14 @@ namespace dmGameSystem
 
                 const int* tex_lookup = &tex_coord_order[flip_flag * 6];
 
-                const Matrix4& w = component->m_World;
-
-                Vector4 p0 = w * Point3(-0.5f, -0.5f, 0.0f);
-                vertices[0].x = p0.getX();
-                vertices[0].y = p0.getY();
-                vertices[0].z = p0.getZ();
-                vertices[0].u = tc[tex_lookup[0] * 2];
-                vertices[0].v = tc[tex_lookup[0] * 2 + 1];
-
-                Vector4 p1 = w * Point3(-0.5f, 0.5f, 0.0f);
-                vertices[1].x = p1.getX();
-                vertices[1].y = p1.getY();
-                vertices[1].z = p1.getZ();
-                vertices[1].u = tc[tex_lookup[1] * 2];
-                vertices[1].v = tc[tex_lookup[1] * 2 + 1];
-
-                Vector4 p2 = w * Point3(0.5f, 0.5f, 0.0f);
-                vertices[2].x = p2.getX();
-                vertices[2].y = p2.getY();
-                vertices[2].z = p2.getZ();
-                vertices[2].u = tc[tex_lookup[2] * 2];
-                vertices[2].v = tc[tex_lookup[2] * 2 + 1];
-
-                Vector4 p3 = w * Point3(0.5f, -0.5f, 0.0f);
-                vertices[3].x = p3.getX();
-                vertices[3].y = p3.getY();
-                vertices[3].z = p3.getZ();
-                vertices[3].u = tc[tex_lookup[4] * 2];
-                vertices[3].v = tc[tex_lookup[4] * 2 + 1];
-
-                // for (int f = 0; f < 4; ++f)
-                //     printf("  %u: %.2f, %.2f\t%.2f, %.2f\n", f, vertices[f].x, vertices[f].y, vertices[f].u, vertices[f].v );
+                // The fifth entry of the lookup is the bottom-right corner of the quad
+                float uvs[8] = {
+                    tc[tex_lookup[0] * 2], tc[tex_lookup[0] * 2 + 1],
+                    tc[tex_lookup[1] * 2], tc[tex_lookup[1] * 2 + 1],
+                    tc[tex_lookup[2] * 2], tc[tex_lookup[2] * 2 + 1],
+                    tc[tex_lookup[4] * 2], tc[tex_lookup[4] * 2 + 1],
+                };
+                CompSpriteQuadVertices(component->m_World, uvs, vertices);
 
                 vertices += 4;
                 indices += 6 * index_type_size;
@@ -918,6 +1036,8 @@ namespace dmGameSystem
             write_ptr->m_Dispatch = sprite_dispatch;
             write_ptr->m_MinorOrder = 0;
             write_ptr->m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
+            // The world transform includes the sprite size, the quad spans [-0.5, 0.5]
+            dmRender::RenderListSetAABB(render_context, write_ptr, component.m_World, Point3(-0.5f, -0.5f, 0.0f), Point3(0.5f, 0.5f, 0.0f));
             ++write_ptr;
         }
 
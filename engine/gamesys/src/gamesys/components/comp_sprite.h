@@ -13,16 +13,28 @@
 #ifndef DM_GAMESYS_COMP_SPRITE_H
 #define DM_GAMESYS_COMP_SPRITE_H
 
+#include <stdint.h>
 #include <gameobject/gameobject.h>
 
 namespace dmGameSystem
 {
+    struct SpriteVertex
+    {
+        float x;
+        float y;
+        float z;
+        float u;
+        float v;
+    };
+
     dmGameObject::CreateResult CompSpriteNewWorld(const dmGameObject::ComponentNewWorldParams& params);
 
     dmGameObject::CreateResult CompSpriteDeleteWorld(const dmGameObject::ComponentDeleteWorldParams& params);
 
     dmGameObject::CreateResult CompSpriteCreate(const dmGameObject::ComponentCreateParams& params);
 
+    dmGameObject::CreateResult CompSpriteCreateBatch(const dmGameObject::ComponentCreateBatchParams& params);
+
     dmGameObject::CreateResult CompSpriteDestroy(const dmGameObject::ComponentDestroyParams& params);
 
     dmGameObject::CreateResult CompSpriteAddToUpdate(const dmGameObject::ComponentAddToUpdateParams& params);
@@ -38,6 +50,28 @@ namespace dmGameSystem
     dmGameObject::PropertyResult CompSpriteGetProperty(const dmGameObject::ComponentGetPropertyParams& params, dmGameObject::PropertyDesc& out_value);
 
     dmGameObject::PropertyResult CompSpriteSetProperty(const dmGameObject::ComponentSetPropertyParams& params);
+
+    /**
+     * Transform the unit quad [-0.5, 0.5] with the world transform and write its four vertices
+     * (bottom-left, top-left, top-right, bottom-right).
+     * @param world world transform of the sprite, including the size
+     * @param uvs texture coordinates, one (u, v) pair per vertex
+     * @param out destination for four vertices
+     */
+    void CompSpriteQuadVertices(const Vectormath::Aos::Matrix4& world, const float uvs[8], SpriteVertex* out);
+
+    /**
+     * Transform sprite geometry points with the world transform and write them as vertices.
+     * @param world world transform of the sprite, including the size
+     * @param points first (x, y) point, in the range [-0.5, 0.5]
+     * @param uvs first (u, v) texture coordinate
+     * @param step float stride between consecutive points and uvs, negative to write them in reverse
+     * @param scale_x scale of the x coordinate, -1 when flipped horizontally
+     * @param scale_y scale of the y coordinate, -1 when flipped vertically
+     * @param count number of points
+     * @param out destination for count vertices
+     */
+    void CompSpriteGeometryVertices(const Vectormath::Aos::Matrix4& world, const float* points, const float* uvs, int step, float scale_x, float scale_y, uint32_t count, SpriteVertex* out);
 }
 
 #endif // DM_GAMESYS_COMP_SPRITE_H
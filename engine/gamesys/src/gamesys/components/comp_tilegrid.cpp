@@ -38,6 +38,8 @@
 namespace dmGameSystem
 {
     const uint32_t TILEGRID_REGION_SIZE = 32;
+    // Number of frames a region cache may go undrawn before its vertices are freed
+    const uint32_t TILEGRID_REGION_CACHE_MAX_AGE = 120;
 
     using namespace Vectormath::Aos;
 
@@ -56,6 +58,23 @@ namespace dmGameSystem
         uint8_t :7;
     };
 
+    struct TileGridVertex
+    {
+        float x, y, z, u, v;
+    };
+
+    // The world space vertices of one layer of a region. They are kept between frames and only
+    // rebuilt when a tile in the region changes, or the transform or tile source of the grid changes
+    struct TileGridRegionCache
+    {
+        TileGridVertex* m_Vertices;
+        uint32_t        m_VertexCount;
+        uint32_t        m_VertexCapacity;
+        uint32_t        m_LastUsedFrame;
+        uint8_t         m_Valid:1;
+        uint8_t         :7;
+    };
+
     struct TileGridComponent
     {
         struct Flags
@@ -66,12 +85,14 @@ namespace dmGameSystem
         };
 
         TileGridComponent()
-        : m_Instance(0)
+        : m_World(Vectormath::Aos::Matrix4::identity())
+        , m_Instance(0)
         , m_Material(0)
         , m_TextureSet(0)
         , m_Resource(0)
         , m_Cells(0)
         , m_CellFlags(0)
+        , m_CachedTextureSet(0)
         {
         }
 
@@ -83,6 +104,8 @@ namespace dmGameSystem
         Flags*                      m_CellFlags;
         dmArray<TileGridRegion>     m_Regions;
         dmArray<TileGridLayer>      m_Layers;
+        dmArray<TileGridRegionCache> m_RegionCaches; // layer major, i.e. [layer * region_count + region]
+        const dmGameSystemDDF::TextureSet* m_CachedTextureSet; // The tile source the region caches were built with
         uint32_t                    m_MixedHash;
         CompRenderConstants         m_RenderConstants;
         dmRender::HMaterial         m_Material;
@@ -96,11 +119,6 @@ namespace dmGameSystem
         uint8_t                     : 6;
     };
 
-    struct TileGridVertex
-    {
-        float x, y, z, u, v;
-    };
-
     struct TileGridWorld
     {
         TileGridWorld()
@@ -120,6 +138,10 @@ namespace dmGameSystem
 
         uint32_t                        m_MaxTilemapCount;
         uint32_t                        m_MaxTileCount;
+
+        uint32_t                        m_Frame;
+        uint32_t                        m_RegionsSubmitted; // Region layers submitted to the render list this frame
+        uint32_t                        m_RegionsDrawn;     // Region layers that reached the dispatch this frame
     };
 
     static void TileGridWorldAllocate(TileGridWorld* world)
@@ -254,6 +276,62 @@ namespace dmGameSystem
         component->m_MixedHash = dmHashFinal32(&state);
     }
 
+    static void FreeRegionCaches(TileGridComponent* component)
+    {
+        uint32_t n = component->m_RegionCaches.Size();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            free(component->m_RegionCaches[i].m_Vertices);
+        }
+        component->m_RegionCaches.SetSize(0);
+    }
+
+    static void CreateRegionCaches(TileGridComponent* component)
+    {
+        FreeRegionCaches(component);
+        uint32_t cache_count = component->m_Regions.Size() * component->m_Layers.Size();
+        component->m_RegionCaches.SetCapacity(cache_count);
+        component->m_RegionCaches.SetSize(cache_count);
+        if (cache_count > 0)
+        {
+            memset(&component->m_RegionCaches[0], 0, cache_count * sizeof(TileGridRegionCache));
+        }
+    }
+
+    // Frees the vertices of all region caches. They are rebuilt when the regions are drawn again
+    static void ReleaseRegionCacheVertices(TileGridComponent* component)
+    {
+        uint32_t n = component->m_RegionCaches.Size();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            TileGridRegionCache* cache = &component->m_RegionCaches[i];
+            if (cache->m_Vertices)
+            {
+                free(cache->m_Vertices);
+                memset(cache, 0, sizeof(TileGridRegionCache));
+            }
+        }
+    }
+
+    static void InvalidateRegionCaches(TileGridComponent* component, uint32_t region_index)
+    {
+        uint32_t region_count = component->m_Regions.Size();
+        uint32_t n_layers = component->m_Layers.Size();
+        for (uint32_t l = 0; l < n_layers; ++l)
+        {
+            component->m_RegionCaches[l * region_count + region_index].m_Valid = 0;
+        }
+    }
+
+    static void InvalidateAllRegionCaches(TileGridComponent* component)
+    {
+        uint32_t n = component->m_RegionCaches.Size();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            component->m_RegionCaches[i].m_Valid = 0;
+        }
+    }
+
     static void CreateRegions(TileGridComponent* component, TileGridResource* resource)
     {
         // Round up to closest multiple
@@ -274,6 +352,7 @@ namespace dmGameSystem
             return region->m_Occupied;
         }
         region->m_Dirty = 0;
+        InvalidateRegionCaches(component, index);
 
         TileGridResource* resource = component->m_Resource;
         dmGameSystemDDF::TileGrid* tile_grid_ddf = resource->m_TileGrid;
@@ -372,6 +451,7 @@ namespace dmGameSystem
         }
 
         CreateRegions(component, resource);
+        CreateRegionCaches(component);
         component->m_Occupied = UpdateRegions(component);
         return n_layers;
     }
@@ -435,6 +515,7 @@ namespace dmGameSystem
                     dmResource::Release(dmGameObject::GetFactory(params.m_Instance), tile_grid->m_TextureSet);
                 }
 
+                FreeRegionCaches(tile_grid);
                 delete [] tile_grid->m_Cells;
                 delete [] tile_grid->m_CellFlags;
                 world->m_Components.EraseSwap(i);
@@ -475,18 +556,30 @@ namespace dmGameSystem
 
             component->m_Occupied = UpdateRegions(component);
             if (!component->m_Occupied) {
+                // Empty tile maps aren't rendered, so the region caches would never be evicted
+                ReleaseRegionCacheVertices(component);
                 continue;
             }
 
             Matrix4 local(component->m_Rotation, component->m_Translation);
             const Matrix4& go_world = dmGameObject::GetWorldMatrix(component->m_Instance);
+            Matrix4 world;
             if (dmGameObject::ScaleAlongZ(component->m_Instance))
             {
-                component->m_World = go_world * local;
+                world = go_world * local;
             }
             else
             {
-                component->m_World = dmTransform::MulNoScaleZ(go_world, local);
+                world = dmTransform::MulNoScaleZ(go_world, local);
+            }
+
+            // The cached vertices are in world space, and use the tex coords of the tile source
+            const dmGameSystemDDF::TextureSet* texture_set_ddf = GetTextureSet(component)->m_TextureSet;
+            if (memcmp(&world, &component->m_World, sizeof(Matrix4)) != 0 || texture_set_ddf != component->m_CachedTextureSet)
+            {
+                InvalidateAllRegionCaches(component);
+                component->m_World = world;
+                component->m_CachedTextureSet = texture_set_ddf;
             }
         }
         return dmGameObject::UPDATE_RESULT_OK;
@@ -505,99 +598,148 @@ namespace dmGameSystem
         region_y = (ptr >> 48) & 0xFFFF;
     }
 
-    TileGridVertex* CreateVertexData(TileGridWorld* world, TileGridVertex* where, TextureSetResource* texture_set, dmRender::RenderListEntry* buf, uint32_t* begin, uint32_t* end)
-    {
-        DM_PROFILE(TileGrid, "CreateVertexData");
-        static int tex_coord_order[] = {
-            0,1,2,2,3,0,
-            3,2,1,1,0,3,    //h
-            1,0,3,3,2,1,    //v
-            2,3,0,0,1,2     //hv
-        };
+    static const int TEX_COORD_ORDER[] = {
+        0,1,2,2,3,0,
+        3,2,1,1,0,3,    //h
+        1,0,3,3,2,1,    //v
+        2,3,0,0,1,2     //hv
+    };
 
-        dmGameSystemDDF::TextureSet* texture_set_ddf = texture_set->m_TextureSet;
+    static void BuildRegionCache(const TileGridComponent* component, uint32_t layer, uint32_t region_x, uint32_t region_y, TileGridRegionCache* cache)
+    {
+        const TileGridResource* resource = component->m_Resource;
+        dmGameSystemDDF::TileLayer* layer_ddf = &resource->m_TileGrid->m_Layers[layer];
+        dmGameSystemDDF::TextureSet* texture_set_ddf = GetTextureSet(component)->m_TextureSet;
         const float* tex_coords = (const float*) texture_set_ddf->m_TexCoords.m_Data;
 
         uint32_t tile_width = texture_set_ddf->m_TileWidth;
         uint32_t tile_height = texture_set_ddf->m_TileHeight;
 
-        for (uint32_t* i = begin; i != end; ++i)
-        {
-            uint32_t index, layer, region_x, region_y;
-            DecodeGridAndLayer(buf[*i].m_UserData, index, layer, region_x, region_y);
+        const Matrix4& w = component->m_World;
+        const float z = layer_ddf->m_Z;
 
-            const TileGridComponent* component = world->m_Components[index];
-            const TileGridResource* resource = component->m_Resource;
-            dmGameSystemDDF::TileGrid* tile_grid_ddf = resource->m_TileGrid;
-            dmGameSystemDDF::TileLayer* layer_ddf = &tile_grid_ddf->m_Layers[layer];
+        uint32_t column_count = resource->m_ColumnCount;
+        uint32_t row_count = resource->m_RowCount;
 
-            const Matrix4& w = component->m_World;
-            const float z = layer_ddf->m_Z;
+        int32_t min_x = resource->m_MinCellX + region_x * TILEGRID_REGION_SIZE;
+        int32_t min_y = resource->m_MinCellY + region_y * TILEGRID_REGION_SIZE;
+        int32_t max_x = dmMath::Min(min_x + (int32_t)TILEGRID_REGION_SIZE, resource->m_MinCellX + (int32_t)column_count);
+        int32_t max_y = dmMath::Min(min_y + (int32_t)TILEGRID_REGION_SIZE, resource->m_MinCellY + (int32_t)row_count);
 
-            uint32_t column_count = resource->m_ColumnCount;
-            uint32_t row_count = resource->m_RowCount;
+        uint32_t tile_count = 0;
+        for (int32_t y = min_y; y < max_y; ++y)
+        {
+            for (int32_t x = min_x; x < max_x; ++x)
+            {
+                uint32_t cell = CalculateCellIndex(layer, x - resource->m_MinCellX, y - resource->m_MinCellY, column_count, row_count);
+                tile_count += component->m_Cells[cell] != 0xffff;
+            }
+        }
 
-            int32_t min_x = resource->m_MinCellX + region_x * TILEGRID_REGION_SIZE;
-            int32_t min_y = resource->m_MinCellY + region_y * TILEGRID_REGION_SIZE;
-            int32_t max_x = dmMath::Min(min_x + (int32_t)TILEGRID_REGION_SIZE, resource->m_MinCellX + (int32_t)column_count);
-            int32_t max_y = dmMath::Min(min_y + (int32_t)TILEGRID_REGION_SIZE, resource->m_MinCellY + (int32_t)row_count);
+        if (cache->m_VertexCapacity < tile_count * 6)
+        {
+            cache->m_VertexCapacity = tile_count * 6;
+            cache->m_Vertices = (TileGridVertex*) realloc(cache->m_Vertices, sizeof(TileGridVertex) * cache->m_VertexCapacity);
+        }
+        cache->m_VertexCount = tile_count * 6;
+        cache->m_Valid = 1;
 
-            for (int32_t y = min_y; y < max_y; ++y)
+        TileGridVertex* where = cache->m_Vertices;
+        for (int32_t y = min_y; y < max_y; ++y)
+        {
+            for (int32_t x = min_x; x < max_x; ++x)
             {
-                for (int32_t x = min_x; x < max_x; ++x)
+                uint32_t cell = CalculateCellIndex(layer, x - resource->m_MinCellX, y - resource->m_MinCellY, column_count, row_count);
+                uint16_t tile = component->m_Cells[cell];
+                if (tile == 0xffff)
                 {
-                    uint32_t cell = CalculateCellIndex(layer, x - resource->m_MinCellX, y - resource->m_MinCellY, column_count, row_count);
-                    uint16_t tile = component->m_Cells[cell];
-                    if (tile == 0xffff)
-                    {
-                        continue;
-                    }
+                    continue;
+                }
 
-                    if( where >= world->m_VertexBufferDataEnd )
-                    {
-                        dmLogError("Out of tiles to render (%zu). You can change this with the game.project setting tilemap.max_tile_count", (size_t)((world->m_VertexBufferDataEnd - world->m_VertexBufferData) / 6));
-                        return world->m_VertexBufferDataEnd;
+                float p[4];
+                CalculateCellBounds(x, y, 1, 1, p);
+                const float* puv = &tex_coords[tile * 8];
+                uint32_t flip_flag = 0;
+
+                TileGridComponent::Flags flags = component->m_CellFlags[cell];
+                if (flags.m_FlipHorizontal)
+                {
+                    flip_flag = 1;
+                }
+                if (flags.m_FlipVertical)
+                {
+                    flip_flag |= 2;
+                }
+                const int* tex_lookup = &TEX_COORD_ORDER[flip_flag * 6];
+
+                #define SET_VERTEX(_I, _X, _Y, _Z, _U, _V) \
+                    { \
+                        const Vector4 v = w * Point3(_X * tile_width, _Y * tile_height, _Z); \
+                        where[_I].x = v.getX(); \
+                        where[_I].y = v.getY(); \
+                        where[_I].z = v.getZ(); \
+                        where[_I].u = _U; \
+                        where[_I].v = _V; \
                     }
 
-                    float p[4];
-                    CalculateCellBounds(x, y, 1, 1, p);
-                    const float* puv = &tex_coords[tile * 8];
-                    uint32_t flip_flag = 0;
+                SET_VERTEX(0, p[0], p[1], z, puv[tex_lookup[0] * 2], puv[tex_lookup[0] * 2 + 1]);
+                SET_VERTEX(1, p[0], p[3], z, puv[tex_lookup[1] * 2], puv[tex_lookup[1] * 2 + 1]);
+                SET_VERTEX(2, p[2], p[3], z, puv[tex_lookup[2] * 2], puv[tex_lookup[2] * 2 + 1]);
+                SET_VERTEX(3, p[2], p[3], z, puv[tex_lookup[3] * 2], puv[tex_lookup[3] * 2 + 1]);
+                SET_VERTEX(4, p[2], p[1], z, puv[tex_lookup[4] * 2], puv[tex_lookup[4] * 2 + 1]);
+                SET_VERTEX(5, p[0], p[1], z, puv[tex_lookup[5] * 2], puv[tex_lookup[5] * 2 + 1]);
 
-                    TileGridComponent::Flags flags = component->m_CellFlags[cell];
-                    if (flags.m_FlipHorizontal)
-                    {
-                        flip_flag = 1;
-                    }
-                    if (flags.m_FlipVertical)
-                    {
-                        flip_flag |= 2;
-                    }
-                    const int* tex_lookup = &tex_coord_order[flip_flag * 6];
-
-                    #define SET_VERTEX(_I, _X, _Y, _Z, _U, _V) \
-                        { \
-                            const Vector4 v = w * Point3(_X * tile_width, _Y * tile_height, _Z); \
-                            where[_I].x = v.getX(); \
-                            where[_I].y = v.getY(); \
-                            where[_I].z = v.getZ(); \
-                            where[_I].u = _U; \
-                            where[_I].v = _V; \
-                        }
+                where += 6;
+
+                #undef SET_VERTEX
+            }
+        }
+    }
+
+    // Copies the cached vertices of each region into the vertex buffer, rebuilding the caches of regions that have changed
+    TileGridVertex* CreateVertexData(TileGridWorld* world, TileGridVertex* where, dmRender::RenderListEntry* buf, uint32_t* begin, uint32_t* end)
+    {
+        DM_PROFILE(TileGrid, "CreateVertexData");
+
+        uint32_t rebuilt = 0;
+        uint32_t reused = 0;
+        for (uint32_t* i = begin; i != end; ++i)
+        {
+            uint32_t index, layer, region_x, region_y;
+            DecodeGridAndLayer(buf[*i].m_UserData, index, layer, region_x, region_y);
 
-                    SET_VERTEX(0, p[0], p[1], z, puv[tex_lookup[0] * 2], puv[tex_lookup[0] * 2 + 1]);
-                    SET_VERTEX(1, p[0], p[3], z, puv[tex_lookup[1] * 2], puv[tex_lookup[1] * 2 + 1]);
-                    SET_VERTEX(2, p[2], p[3], z, puv[tex_lookup[2] * 2], puv[tex_lookup[2] * 2 + 1]);
-                    SET_VERTEX(3, p[2], p[3], z, puv[tex_lookup[3] * 2], puv[tex_lookup[3] * 2 + 1]);
-                    SET_VERTEX(4, p[2], p[1], z, puv[tex_lookup[4] * 2], puv[tex_lookup[4] * 2 + 1]);
-                    SET_VERTEX(5, p[0], p[1], z, puv[tex_lookup[5] * 2], puv[tex_lookup[5] * 2 + 1]);
+            TileGridComponent* component = world->m_Components[index];
+            uint32_t region_index = region_y * component->m_RegionsX + region_x;
+            TileGridRegionCache* cache = &component->m_RegionCaches[layer * component->m_Regions.Size() + region_index];
+            if (!cache->m_Valid)
+            {
+                BuildRegionCache(component, layer, region_x, region_y, cache);
+                ++rebuilt;
+            }
+            else
+            {
+                ++reused;
+            }
 
-                    where += 6;
+            if (cache->m_LastUsedFrame != world->m_Frame)
+            {
+                cache->m_LastUsedFrame = world->m_Frame;
+                ++world->m_RegionsDrawn;
+            }
 
-                    #undef SET_VERTEX
-                }
+            if (cache->m_VertexCount > (uint32_t)(world->m_VertexBufferDataEnd - where))
+            {
+                dmLogError("Out of tiles to render (%zu). You can change this with the game.project setting tilemap.max_tile_count", (size_t)((world->m_VertexBufferDataEnd - world->m_VertexBufferData) / 6));
+                where = world->m_VertexBufferDataEnd;
+                break;
             }
+
+            memcpy(where, cache->m_Vertices, sizeof(TileGridVertex) * cache->m_VertexCount);
+            where += cache->m_VertexCount;
         }
+
+        DM_COUNTER("TileGridRegionsRebuilt", rebuilt);
+        DM_COUNTER("TileGridRegionsReused", reused);
         return where;
     }
 
@@ -618,7 +760,7 @@ namespace dmGameSystem
 
         // Fill in vertex buffer
         TileGridVertex* vb_begin = world->m_VertexBufferWritePtr;
-        world->m_VertexBufferWritePtr = CreateVertexData(world, vb_begin, texture_set, buf, begin, end);
+        world->m_VertexBufferWritePtr = CreateVertexData(world, vb_begin, buf, begin, end);
 
         ro.Init();
         ro.m_VertexDeclaration = world->m_VertexDeclaration;
@@ -727,6 +869,13 @@ namespace dmGameSystem
             return dmGameObject::UPDATE_RESULT_OK;
         }
 
+        // The regions culled by the render list are only known after the frame has been drawn,
+        // so they are counted for the previous frame
+        DM_COUNTER("TileGridRegionsCulled", world->m_RegionsSubmitted - dmMath::Min(world->m_RegionsDrawn, world->m_RegionsSubmitted));
+        world->m_RegionsSubmitted = 0;
+        world->m_RegionsDrawn = 0;
+        ++world->m_Frame;
+
         uint32_t num_render_entries = CalcNumVisibleRegions(&components[0], n);
         dmRender::HRenderContext render_context = context->m_RenderContext;
         dmRender::RenderListEntry* render_list = dmRender::RenderListAlloc(render_context, num_render_entries);
@@ -760,9 +909,18 @@ namespace dmGameSystem
                     continue;
 
                 dmGameSystemDDF::TileLayer* layer_ddf = &tile_grid_ddf->m_Layers[l];
+                TileGridRegionCache* caches = &component->m_RegionCaches[l * component->m_Regions.Size()];
                 for (uint32_t y = 0, region_index = 0; y < component->m_RegionsY; ++y) {
                     for (uint32_t x = 0; x < component->m_RegionsX; ++x, ++region_index) {
 
+                        // Free the vertices of regions that have been out of view for a while
+                        TileGridRegionCache* cache = &caches[region_index];
+                        if (cache->m_Vertices && world->m_Frame - cache->m_LastUsedFrame > TILEGRID_REGION_CACHE_MAX_AGE)
+                        {
+                            free(cache->m_Vertices);
+                            memset(cache, 0, sizeof(TileGridRegionCache));
+                        }
+
                         TileGridRegion* region = &component->m_Regions[region_index];
                         if (!region->m_Occupied) {
                             continue;
@@ -777,7 +935,17 @@ namespace dmGameSystem
                         write_ptr->m_Dispatch = dispatch;
                         write_ptr->m_MinorOrder = 0;
                         write_ptr->m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
+
+                        // Conservative bounds of the whole region, used for frustum culling
+                        int32_t min_x = resource->m_MinCellX + x * TILEGRID_REGION_SIZE;
+                        int32_t min_y = resource->m_MinCellY + y * TILEGRID_REGION_SIZE;
+                        int32_t max_x = dmMath::Min(min_x + (int32_t)TILEGRID_REGION_SIZE, resource->m_MinCellX + (int32_t)resource->m_ColumnCount);
+                        int32_t max_y = dmMath::Min(min_y + (int32_t)TILEGRID_REGION_SIZE, resource->m_MinCellY + (int32_t)resource->m_RowCount);
+                        dmRender::RenderListSetAABB(render_context, write_ptr, component->m_World,
+                                                    Point3(min_x * (float)tile_width, min_y * (float)tile_height, layer_ddf->m_Z),
+                                                    Point3(max_x * (float)tile_width, max_y * (float)tile_height, layer_ddf->m_Z));
                         ++write_ptr;
+                        ++world->m_RegionsSubmitted;
                     }
                 }
             }
@@ -887,11 +1055,31 @@ namespace dmGameSystem
         else if (params.m_Message->m_Id == dmGameObjectDDF::Disable::m_DDFDescriptor->m_NameHash)
         {
             component->m_Enabled = 0;
+            // Disabled tile maps aren't rendered, so the region caches would never be evicted
+            ReleaseRegionCacheVertices(component);
         }
 
         return dmGameObject::UPDATE_RESULT_OK;
     }
 
+    void* CompTileGridGetComponent(const dmGameObject::ComponentGetParams& params)
+    {
+        return (TileGridComponent*)*params.m_UserData;
+    }
+
+    void GetTileGridRegionCacheCount(const TileGridComponent* component, uint32_t* allocated, uint32_t* valid)
+    {
+        *allocated = 0;
+        *valid = 0;
+        uint32_t n = component->m_RegionCaches.Size();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            const TileGridRegionCache* cache = &component->m_RegionCaches[i];
+            *allocated += cache->m_Vertices != 0;
+            *valid += cache->m_Valid;
+        }
+    }
+
     void CompTileGridOnReload(const dmGameObject::ComponentOnReloadParams& params)
     {
         TileGridComponent* component = (TileGridComponent*)*params.m_UserData;
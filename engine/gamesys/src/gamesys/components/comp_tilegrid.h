@@ -36,6 +36,9 @@ namespace dmGameSystem
 
     void SetLayerVisible(TileGridComponent* component, uint32_t layer, bool visible);
 
+    // Counts the region caches that hold vertices, and the ones that are valid (used by tests)
+    void GetTileGridRegionCacheCount(const TileGridComponent* component, uint32_t* allocated, uint32_t* valid);
+
     // Component api functions
     dmGameObject::CreateResult CompTileGridNewWorld(const dmGameObject::ComponentNewWorldParams& params);
 
@@ -55,6 +58,8 @@ namespace dmGameSystem
 
     void CompTileGridOnReload(const dmGameObject::ComponentOnReloadParams& params);
 
+    void* CompTileGridGetComponent(const dmGameObject::ComponentGetParams& params);
+
     dmGameObject::PropertyResult CompTileGridGetProperty(const dmGameObject::ComponentGetPropertyParams& params, dmGameObject::PropertyDesc& out_value);
 
     dmGameObject::PropertyResult CompTileGridSetProperty(const dmGameObject::ComponentSetPropertyParams& params);
@@ -89,7 +89,7 @@ namespace dmGameSystem
         m_Worlds.SetCapacity(128);
     }
 
-    dmResource::Result RegisterResourceTypes(dmResource::HFactory factory, dmRender::HRenderContext render_context, GuiContext* gui_context, dmInput::HContext input_context, PhysicsContext* physics_context)
+    dmResource::Result RegisterResourceTypes(dmResource::HFactory factory, dmRender::HRenderContext render_context, GuiContext* gui_context, dmInput::HContext input_context, PhysicsContext* physics_context, TextureContext* texture_context)
     {
         dmResource::Result e;
 
@@ -110,7 +110,7 @@ namespace dmGameSystem
         REGISTER_RESOURCE_TYPE("convexshapec", physics_context, 0, ResConvexShapeCreate, 0, ResConvexShapeDestroy, ResConvexShapeRecreate);
         REGISTER_RESOURCE_TYPE("emitterc", 0, 0, ResEmitterCreate, 0,ResEmitterDestroy, ResEmitterRecreate);
         REGISTER_RESOURCE_TYPE("particlefxc", 0, ResParticleFXPreload, ResParticleFXCreate, 0, ResParticleFXDestroy, ResParticleFXRecreate);
-        REGISTER_RESOURCE_TYPE("texturec", graphics_context, ResTexturePreload, ResTextureCreate, ResTexturePostCreate, ResTextureDestroy, ResTextureRecreate);
+        REGISTER_RESOURCE_TYPE("texturec", texture_context, ResTexturePreload, ResTextureCreate, ResTexturePostCreate, ResTextureDestroy, ResTextureRecreate);
         REGISTER_RESOURCE_TYPE("vpc", graphics_context, ResVertexProgramPreload, ResVertexProgramCreate, 0, ResVertexProgramDestroy, ResVertexProgramRecreate);
         REGISTER_RESOURCE_TYPE("fpc", graphics_context, ResFragmentProgramPreload, ResFragmentProgramCreate, 0, ResFragmentProgramDestroy, ResFragmentProgramRecreate);
         REGISTER_RESOURCE_TYPE("fontc", render_context, ResFontMapPreload, ResFontMapCreate, 0, ResFontMapDestroy, ResFontMapRecreate);
@@ -144,6 +144,16 @@ namespace dmGameSystem
 
 #undef REGISTER_RESOURCE_TYPE
 
+        // Resources that only describe other resources are loaded first, so that their dependencies can
+        // be hinted as early as possible. Large leaf resources such as sounds are loaded last.
+        dmResource::SetLoadPriority(factory, "gui_scriptc", dmResource::LOAD_PRIORITY_HIGH);
+        dmResource::SetLoadPriority(factory, "render_scriptc", dmResource::LOAD_PRIORITY_HIGH);
+        dmResource::SetLoadPriority(factory, "collectionproxyc", dmResource::LOAD_PRIORITY_HIGH);
+        dmResource::SetLoadPriority(factory, "factoryc", dmResource::LOAD_PRIORITY_HIGH);
+        dmResource::SetLoadPriority(factory, "collectionfactoryc", dmResource::LOAD_PRIORITY_HIGH);
+        dmResource::SetLoadPriority(factory, "wavc", dmResource::LOAD_PRIORITY_LOW);
+        dmResource::SetLoadPriority(factory, "oggc", dmResource::LOAD_PRIORITY_LOW);
+
         return e;
     }
 
@@ -292,10 +302,12 @@ namespace dmGameSystem
                 CompSpriteCreate, CompSpriteDestroy, 0, 0, CompSpriteAddToUpdate, 0,
                 CompSpriteUpdate, CompSpriteRender, 0, CompSpriteOnMessage, 0, CompSpriteOnReload, CompSpriteGetProperty, CompSpriteSetProperty,
                 1);
+        // Sprites are often spawned in numbers, see factory.create_many
+        dmGameObject::FindComponentType(regist, type, 0x0)->m_CreateBatchFunction = CompSpriteCreateBatch;
 
         REGISTER_COMPONENT_TYPE(TILE_MAP_EXT, 1200, tilemap_context,
                 CompTileGridNewWorld, CompTileGridDeleteWorld,
-                CompTileGridCreate, CompTileGridDestroy, 0, 0, CompTileGridAddToUpdate, 0,
+                CompTileGridCreate, CompTileGridDestroy, 0, 0, CompTileGridAddToUpdate, CompTileGridGetComponent,
                 CompTileGridUpdate, CompTileGridRender, 0, CompTileGridOnMessage, 0, CompTileGridOnReload, CompTileGridGetProperty, CompTileGridSetProperty,
                 1);
 
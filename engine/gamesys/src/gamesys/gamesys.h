@@ -14,6 +14,7 @@
 #define DM_GAMESYS_H
 
 #include <dlib/configfile.h>
+#include <dlib/worker_pool.h>
 
 #include <script/script.h>
 
@@ -52,6 +53,17 @@ namespace dmGameSystem
         uint32_t                    m_MaxTileCount;
     };
 
+    struct TextureContext
+    {
+        TextureContext()
+        {
+            memset(this, 0, sizeof(*this));
+        }
+        dmGraphics::HContext        m_GraphicsContext;
+        /// Used to decode compressed mips in parallel. May be null
+        dmWorkerPool::HWorkerPool   m_WorkerPool;
+    };
+
     struct LabelContext
     {
         LabelContext()
@@ -130,6 +142,8 @@ namespace dmGameSystem
         }
         dmRender::HRenderContext    m_RenderContext;
         dmResource::HFactory        m_Factory;
+        /// Used to animate and skin the rigs in parallel. May be null
+        dmWorkerPool::HWorkerPool   m_WorkerPool;
         uint32_t                    m_MaxSpineModelCount;
     };
 
@@ -141,6 +155,8 @@ namespace dmGameSystem
         }
         dmRender::HRenderContext    m_RenderContext;
         dmResource::HFactory        m_Factory;
+        /// Used to animate and skin the rigs in parallel. May be null
+        dmWorkerPool::HWorkerPool   m_WorkerPool;
         uint32_t                    m_MaxModelCount;
     };
 
@@ -211,7 +227,8 @@ namespace dmGameSystem
         dmRender::HRenderContext render_context,
         GuiContext* gui_context,
         dmInput::HContext input_context,
-        PhysicsContext* physics_context);
+        PhysicsContext* physics_context,
+        TextureContext* texture_context);
 
     dmGameObject::Result RegisterComponentTypes(dmResource::HFactory factory,
                                                   dmGameObject::HRegister regist,
@@ -28,7 +28,12 @@ namespace dmGameSystem
             type = dmSound::SOUND_DATA_TYPE_OGG_VORBIS;
         }
 
-        dmSound::Result r = dmSound::NewSoundData(params.m_Buffer, params.m_BufferSize, type, &sound_data, params.m_Resource->m_NameHash);
+        // Data in a memory mapped archive outlives the resource, so there is no need to copy it
+        dmSound::Result r;
+        if (params.m_IsBufferMapped)
+            r = dmSound::NewSoundDataNoCopy(params.m_Buffer, params.m_BufferSize, type, &sound_data, params.m_Resource->m_NameHash);
+        else
+            r = dmSound::NewSoundData(params.m_Buffer, params.m_BufferSize, type, &sound_data, params.m_Resource->m_NameHash);
         if (r != dmSound::RESULT_OK)
         {
             return dmResource::RESULT_OUT_OF_RESOURCES;
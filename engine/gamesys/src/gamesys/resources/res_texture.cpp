@@ -13,10 +13,15 @@
 #include "res_texture.h"
 
 #include <dlib/log.h>
+#include <dlib/math.h>
 #include <dlib/webp.h>
 #include <dlib/time.h>
+#include <dlib/profile.h>
+#include <dlib/worker_pool.h>
 #include <graphics/graphics.h>
 
+#include "../gamesys.h"
+
 namespace dmGameSystem
 {
     static const uint32_t m_MaxMipCount = 32;
@@ -308,7 +313,36 @@ namespace dmGameSystem
         return result;
     }
 
-    ImageDesc* CreateImage(dmGraphics::HContext context, dmGraphics::TextureImage* texture_image)
+    struct DecodeMipsContext
+    {
+        dmGraphics::TextureImage::Image* m_Image;
+        ImageDesc*                       m_ImageDesc;
+        bool                             m_Failed[m_MaxMipCount];
+    };
+
+    static void DecodeMips(void* _ctx, uint32_t begin, uint32_t end)
+    {
+        DM_PROFILE(Resource, "DecodeMips");
+        DecodeMipsContext* ctx = (DecodeMipsContext*) _ctx;
+        dmGraphics::TextureImage::Image* image = ctx->m_Image;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            uint32_t w = dmMath::Max(image->m_Width >> i, 1u);
+            uint32_t h = dmMath::Max(image->m_Height >> i, 1u);
+            uint8_t* decompressed_data;
+            uint32_t decompressed_data_size;
+            if(WebPDecodeTexture(i, w, h, image, decompressed_data, decompressed_data_size))
+            {
+                ctx->m_ImageDesc->m_DecompressedData[i] = decompressed_data;
+            }
+            else
+            {
+                ctx->m_Failed[i] = true;
+            }
+        }
+    }
+
+    ImageDesc* CreateImage(TextureContext* context, dmGraphics::TextureImage* texture_image)
     {
         ImageDesc* image_desc = new ImageDesc;
         memset(image_desc, 0x0, sizeof(ImageDesc));
@@ -316,7 +350,7 @@ namespace dmGameSystem
         for(uint32_t i = 0; i < texture_image->m_Alternatives.m_Count; ++i)
         {
             dmGraphics::TextureImage::Image* image = &texture_image->m_Alternatives[i];
-            if (!dmGraphics::IsTextureFormatSupported(context, TextureImageToTextureFormat(image)))
+            if (!dmGraphics::IsTextureFormatSupported(context->m_GraphicsContext, TextureImageToTextureFormat(image)))
             {
                 continue;
             }
@@ -325,25 +359,19 @@ namespace dmGameSystem
                 case dmGraphics::TextureImage::COMPRESSION_TYPE_WEBP:
                 case dmGraphics::TextureImage::COMPRESSION_TYPE_WEBP_LOSSY:
                 {
-                    uint32_t w = image->m_Width;
-                    uint32_t h = image->m_Height;
-                    for (int i = 0; i < (int) image->m_MipMapOffset.m_Count; ++i)
+                    // The mips are independent, decode them in parallel
+                    uint32_t mip_count = dmMath::Min(image->m_MipMapOffset.m_Count, m_MaxMipCount);
+                    DecodeMipsContext ctx;
+                    memset(&ctx, 0, sizeof(ctx));
+                    ctx.m_Image = image;
+                    ctx.m_ImageDesc = image_desc;
+                    dmWorkerPool::ParallelFor(context->m_WorkerPool, DecodeMips, &ctx, mip_count, 1);
+                    for (uint32_t i = 0; i < mip_count; ++i)
                     {
-                        uint8_t* decompressed_data;
-                        uint32_t decompressed_data_size;
-                        if(WebPDecodeTexture(i, w, h, image, decompressed_data, decompressed_data_size))
-                        {
-                            image_desc->m_DecompressedData[i] = decompressed_data;
-                        }
-                        else
+                        if (ctx.m_Failed[i])
                         {
                             image_desc->m_UseBlankTexture = true;
-                            break;
                         }
-                        w >>= 1;
-                        h >>= 1;
-                        if (w == 0) w = 1;
-                        if (h == 0) h = 1;
                     }
                 }
                 break;
@@ -375,7 +403,7 @@ namespace dmGameSystem
             return dmResource::RESULT_FORMAT_ERROR;
         }
 
-        ImageDesc* image_desc = CreateImage((dmGraphics::HContext) params.m_Context, texture_image);
+        ImageDesc* image_desc = CreateImage((TextureContext*) params.m_Context, texture_image);
         *params.m_PreloadData = image_desc;
         return dmResource::RESULT_OK;
     }
@@ -398,7 +426,7 @@ namespace dmGameSystem
 
     dmResource::Result ResTextureCreate(const dmResource::ResourceCreateParams& params)
     {
-        dmGraphics::HContext graphics_context = (dmGraphics::HContext) params.m_Context;
+        dmGraphics::HContext graphics_context = ((TextureContext*) params.m_Context)->m_GraphicsContext;
         dmGraphics::HTexture texture;
         dmResource::Result r = AcquireResources(params.m_Resource, graphics_context, (ImageDesc*) params.m_PreloadData, 0, &texture);
         if (r == dmResource::RESULT_OK)
@@ -425,12 +453,12 @@ namespace dmGameSystem
                 return dmResource::RESULT_FORMAT_ERROR;
             }
         }
-        dmGraphics::HContext graphics_context = (dmGraphics::HContext) params.m_Context;
+        dmGraphics::HContext graphics_context = ((TextureContext*) params.m_Context)->m_GraphicsContext;
         dmGraphics::HTexture texture = (dmGraphics::HTexture) params.m_Resource->m_Resource;
 
         // Create the image from the DDF data.
         // Note that the image desc for performance reasons keeps references to the DDF image, meaning they're invalid after the DDF message has been free'd!
-        ImageDesc* image_desc = CreateImage((dmGraphics::HContext) params.m_Context, texture_image);
+        ImageDesc* image_desc = CreateImage((TextureContext*) params.m_Context, texture_image);
 
         // Set up the new texture (version), wait for it to finish before issuing new requests
         SynchronizeTexture(texture, true);
@@ -113,6 +113,9 @@ namespace dmGameSystem
     {
         dmMessage::HSocket m_Socket;
         uint32_t m_ComponentIndex;
+        // Scratch buffers for physics.raycast_batch
+        dmArray<dmPhysics::RayCastRequest> m_RayCastRequests;
+        dmArray<dmPhysics::RayCastResponse> m_RayCastResponses;
     };
 
     /*# [type:number] collision object mass
@@ -465,6 +468,112 @@ namespace dmGameSystem
         return 1;
     }
 
+    /*# performs a batch of ray casts
+     *
+     * Performs many ray casts synchronously in a single call, which is much faster than
+     * calling [ref:physics.raycast] for each ray. The rays are processed in parallel on the engine
+     * worker threads when `engine.worker_thread_count` is set. Only the closest hit of each ray
+     * is returned.
+     *
+     * @name physics.raycast_batch
+     * @param from [type:table] a list of world positions ([type:vector3]) of the starts of the rays
+     * @param to [type:table] a list of world positions ([type:vector3]) of the ends of the rays, with the same length as `from`
+     * @param groups [type:table] a lua table containing the hashed groups for which to test collisions against
+     * @return result [type:table] a table with the result of each ray at the index of the ray, or nil at the index of rays that didn't hit anything. See `ray_cast_response` for details on the values.
+     * @examples
+     *
+     * How to check the line of sight from an enemy to a set of targets:
+     *
+     * ```lua
+     * function update(self, dt)
+     *     local from = {}
+     *     local to = {}
+     *     for i,target in ipairs(self.targets) do
+     *         from[i] = go.get_position()
+     *         to[i] = go.get_position(target)
+     *     end
+     *     local results = physics.raycast_batch(from, to, self.groups)
+     *     for i=1,#to do
+     *         local result = results[i]
+     *         if result == nil or result.id == self.targets[i] then
+     *             -- target i is visible
+     *         end
+     *     end
+     * end
+     * ```
+     */
+    int Physics_RayCastBatch(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 1);
+
+        dmMessage::URL sender;
+        if (!dmScript::GetURL(L, &sender)) {
+            return luaL_error(L, "could not find a requesting instance for physics.raycast_batch");
+        }
+
+        dmScript::GetGlobal(L, PHYSICS_CONTEXT_HASH);
+        PhysicsScriptContext* context = (PhysicsScriptContext*)lua_touserdata(L, -1);
+        lua_pop(L, 1);
+
+        dmGameObject::HInstance sender_instance = CheckGoInstance(L);
+        dmGameObject::HCollection collection = dmGameObject::GetCollection(sender_instance);
+        void* world = dmGameObject::GetWorld(collection, context->m_ComponentIndex);
+
+        luaL_checktype(L, 1, LUA_TTABLE);
+        luaL_checktype(L, 2, LUA_TTABLE);
+        uint32_t count = (uint32_t)lua_objlen(L, 1);
+        if (count != (uint32_t)lua_objlen(L, 2))
+        {
+            return DM_LUA_ERROR("the 'from' and 'to' lists must have the same length (%d and %d)", count, (uint32_t)lua_objlen(L, 2));
+        }
+
+        uint32_t mask = 0;
+        luaL_checktype(L, 3, LUA_TTABLE);
+        lua_pushnil(L);
+        while (lua_next(L, 3) != 0)
+        {
+            mask |= CompCollisionGetGroupBitIndex(world, dmScript::CheckHash(L, -1));
+            lua_pop(L, 1);
+        }
+
+        dmArray<dmPhysics::RayCastRequest>& requests = context->m_RayCastRequests;
+        dmArray<dmPhysics::RayCastResponse>& responses = context->m_RayCastResponses;
+        if (requests.Capacity() < count)
+        {
+            requests.SetCapacity(count);
+            responses.SetCapacity(count);
+        }
+        requests.SetSize(count);
+        responses.SetSize(count);
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            dmPhysics::RayCastRequest& request = requests[i];
+            request = dmPhysics::RayCastRequest();
+            lua_rawgeti(L, 1, i+1);
+            request.m_From = Vectormath::Aos::Point3(*dmScript::CheckVector3(L, -1));
+            lua_rawgeti(L, 2, i+1);
+            request.m_To = Vectormath::Aos::Point3(*dmScript::CheckVector3(L, -1));
+            lua_pop(L, 2);
+            request.m_Mask = mask;
+        }
+
+        dmGameSystem::RayCastBatch(world, requests.Begin(), count, responses.Begin());
+
+        lua_createtable(L, count, 0);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (responses[i].m_Hit)
+            {
+                lua_newtable(L);
+                PushRayCastResponse(L, world, responses[i]);
+                lua_rawseti(L, -2, i+1);
+            }
+        }
+
+        return 1;
+    }
+
     // Matches JointResult in physics.h
     static const char* PhysicsResultString[] = {
         "result ok",
@@ -1062,6 +1171,7 @@ namespace dmGameSystem
         {"ray_cast",        Physics_RayCastAsync}, // Deprecated
         {"raycast_async",   Physics_RayCastAsync},
         {"raycast",         Physics_RayCast},
+        {"raycast_batch",   Physics_RayCastBatch},
 
         {"create_joint",    Physics_CreateJoint},
         {"destroy_joint",   Physics_DestroyJoint},
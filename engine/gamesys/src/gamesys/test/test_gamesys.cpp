@@ -29,6 +29,8 @@
 #include "../proto/gamesys_ddf.h"
 #include "../proto/sprite_ddf.h"
 #include "../components/comp_label.h"
+#include "../components/comp_sprite.h"
+#include "../components/comp_tilegrid.h"
 
 namespace dmGameSystem
 {
@@ -558,6 +560,89 @@ TEST_F(SpriteAnimTest, GoDeletion)
     ASSERT_TRUE(dmGameObject::Final(m_Collection));
 }
 
+static void AssertSpriteVertex(const Matrix4& world, float x, float y, float u, float v, const dmGameSystem::SpriteVertex& vertex)
+{
+    const Vector4 p = world * Point3(x, y, 0.0f);
+    ASSERT_NEAR(p.getX(), vertex.x, 0.001f);
+    ASSERT_NEAR(p.getY(), vertex.y, 0.001f);
+    ASSERT_NEAR(p.getZ(), vertex.z, 0.001f);
+    ASSERT_EQ(u, vertex.u);
+    ASSERT_EQ(v, vertex.v);
+}
+
+TEST(SpriteVertexTest, BenchVertexGeneration)
+{
+    const uint32_t sprite_count = 50000;
+    const uint32_t iterations = 10;
+
+    dmArray<Matrix4> worlds;
+    worlds.SetCapacity(sprite_count);
+    for (uint32_t i = 0; i < sprite_count; ++i)
+    {
+        float f = (float)i;
+        worlds.Push(Matrix4::translation(Vector3(f, -f, 0.5f)) * Matrix4::rotationZ(f * 0.01f) * Matrix4::scale(Vector3(32.0f + (i & 31), 32.0f, 1.0f)));
+    }
+
+    // Quads
+    const float quad_uvs[8] = { 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f, 0.0f };
+    dmArray<dmGameSystem::SpriteVertex> vertices;
+    vertices.SetCapacity(sprite_count * 4);
+    vertices.SetSize(sprite_count * 4);
+
+    uint64_t start = dmTime::GetTime();
+    for (uint32_t n = 0; n < iterations; ++n)
+    {
+        for (uint32_t i = 0; i < sprite_count; ++i)
+        {
+            dmGameSystem::CompSpriteQuadVertices(worlds[i], quad_uvs, &vertices[i * 4]);
+        }
+    }
+    uint64_t quad_time = dmTime::GetTime() - start;
+
+    for (uint32_t i = 0; i < sprite_count; i += 997)
+    {
+        AssertSpriteVertex(worlds[i], -0.5f, -0.5f, 0.0f, 0.0f, vertices[i * 4 + 0]);
+        AssertSpriteVertex(worlds[i], -0.5f,  0.5f, 0.0f, 1.0f, vertices[i * 4 + 1]);
+        AssertSpriteVertex(worlds[i],  0.5f,  0.5f, 1.0f, 1.0f, vertices[i * 4 + 2]);
+        AssertSpriteVertex(worlds[i],  0.5f, -0.5f, 1.0f, 0.0f, vertices[i * 4 + 3]);
+    }
+
+    // Geometries (octagon shaped), written in reverse as for a horizontally flipped sprite
+    const uint32_t point_count = 8;
+    const float points[point_count * 2] = {
+        -0.25f, -0.5f,  0.25f, -0.5f,  0.5f, -0.25f,  0.5f, 0.25f,
+         0.25f,  0.5f, -0.25f,  0.5f, -0.5f,  0.25f, -0.5f, -0.25f,
+    };
+    vertices.SetCapacity(sprite_count * point_count);
+    vertices.SetSize(sprite_count * point_count);
+
+    const float* last_point = points + point_count * 2 - 2;
+    start = dmTime::GetTime();
+    for (uint32_t n = 0; n < iterations; ++n)
+    {
+        for (uint32_t i = 0; i < sprite_count; ++i)
+        {
+            dmGameSystem::CompSpriteGeometryVertices(worlds[i], last_point, last_point, -2, -1.0f, 1.0f, point_count, &vertices[i * point_count]);
+        }
+    }
+    uint64_t geometry_time = dmTime::GetTime() - start;
+
+    for (uint32_t i = 0; i < sprite_count; i += 997)
+    {
+        for (uint32_t j = 0; j < point_count; ++j)
+        {
+            const float* p = last_point - j * 2;
+            AssertSpriteVertex(worlds[i], -p[0], p[1], p[0], p[1], vertices[i * point_count + j]);
+        }
+    }
+
+    float quad_ms = quad_time / 1000.0f;
+    float geometry_ms = geometry_time / 1000.0f;
+    printf("Sprite vertices, %u sprites x %u iterations\n", sprite_count, iterations);
+    printf("    quads:      %8.3f ms  %10.0f verts/ms\n", quad_ms, (sprite_count * 4 * iterations) / dmMath::Max(quad_ms, 0.001f));
+    printf("    geometries: %8.3f ms  %10.0f verts/ms\n", geometry_ms, (sprite_count * point_count * iterations) / dmMath::Max(geometry_ms, 0.001f));
+}
+
 static float GetFloatProperty(dmGameObject::HInstance go, dmhash_t component_id, dmhash_t property_id)
 {
     dmGameObject::PropertyDesc property_desc;
@@ -908,6 +993,33 @@ TEST_P(FactoryTest, Test)
     dmGameSystem::FinalizeScriptLibs(scriptlibcontext);
 }
 
+TEST_F(FactoryTest, CreateMany)
+{
+    const char* prototype_path = "/factory/factory_resource.goc";
+    dmHashEnableReverseHash(true);
+
+    dmGameSystem::ScriptLibContext scriptlibcontext;
+    scriptlibcontext.m_Factory = m_Factory;
+    scriptlibcontext.m_Register = m_Register;
+    scriptlibcontext.m_LuaState = dmScript::GetLuaState(m_ScriptContext);
+    dmGameSystem::InitializeScriptLibs(scriptlibcontext);
+
+    // The script creates ten instances in init, see factory_create_many_test.script
+    ASSERT_TRUE(dmGameObject::Init(m_Collection));
+    dmGameObject::HInstance go = Spawn(m_Factory, m_Collection, "/factory/factory_create_many_test.goc", dmHashString64("/go"), 0, 0, Point3(0, 0, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    ASSERT_NE((void*)0, go);
+    ASSERT_EQ(11, dmResource::GetRefCount(m_Factory, dmHashString64(prototype_path)));
+
+    // The instances are deleted in final
+    dmGameObject::Delete(m_Collection, go, true);
+    ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+    ASSERT_TRUE(dmGameObject::PostUpdate(m_Collection));
+    dmGameObject::PostUpdate(m_Register);
+    ASSERT_EQ(0, dmResource::GetRefCount(m_Factory, dmHashString64(prototype_path)));
+
+    dmGameSystem::FinalizeScriptLibs(scriptlibcontext);
+}
+
 /* Collection factory dynamic and static loading */
 
 TEST_P(CollectionFactoryTest, Test)
@@ -1176,6 +1288,138 @@ TEST_P(BoxRenderTest, BoxRender)
     ASSERT_TRUE(dmGameObject::Final(m_Collection));
 }
 
+/* Tile grid region caches */
+
+static dmMessage::URL GetTileGridURL(dmGameObject::HCollection collection, dmhash_t go_id)
+{
+    dmMessage::URL url;
+    dmMessage::ResetURL(url);
+    url.m_Socket = dmGameObject::GetMessageSocket(collection);
+    url.m_Path = go_id;
+    url.m_Fragment = dmHashString64("tilegrid");
+    return url;
+}
+
+// The region caches are built when the render list is drawn, and evicted when they haven't been drawn for a while
+static void UpdateAndRenderTileGrid(dmGameObject::HCollection collection, const dmGameObject::UpdateContext* update_context, dmRender::HRenderContext render_context, bool draw)
+{
+    ASSERT_TRUE(dmGameObject::Update(collection, update_context));
+    dmRender::RenderListBegin(render_context);
+    dmGameObject::Render(collection);
+    dmRender::RenderListEnd(render_context);
+    if (draw)
+    {
+        dmRender::DrawRenderList(render_context, 0x0, 0x0);
+    }
+    ASSERT_TRUE(dmGameObject::PostUpdate(collection));
+    dmRender::ClearRenderObjects(render_context);
+}
+
+TEST_F(TileGridTest, RegionCacheInvalidation)
+{
+    ASSERT_TRUE(dmGameObject::Init(m_Collection));
+
+    dmhash_t go_id = dmHashString64("/tilegrid");
+    dmGameObject::HInstance go = Spawn(m_Factory, m_Collection, "/tile/valid_tilegrid.goc", go_id, 0, 0, Point3(0, 0, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    ASSERT_NE((void*)0, go);
+    dmGameSystem::TileGridComponent* component = (dmGameSystem::TileGridComponent*)dmGameObject::GetComponentFromURL(GetTileGridURL(m_Collection, go_id));
+    ASSERT_NE((void*)0, component);
+
+    // One layer with one region
+    uint32_t allocated, valid;
+    UpdateAndRenderTileGrid(m_Collection, &m_UpdateContext, m_RenderContext, true);
+    dmGameSystem::GetTileGridRegionCacheCount(component, &allocated, &valid);
+    ASSERT_EQ(1u, allocated);
+    ASSERT_EQ(1u, valid);
+
+    // set_tile
+    dmGameSystem::SetTileGridTile(component, 0, 0, 0, 3, false, false);
+    ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+    dmGameSystem::GetTileGridRegionCacheCount(component, &allocated, &valid);
+    ASSERT_EQ(0u, valid);
+    ASSERT_TRUE(dmGameObject::PostUpdate(m_Collection));
+
+    UpdateAndRenderTileGrid(m_Collection, &m_UpdateContext, m_RenderContext, true);
+    dmGameSystem::GetTileGridRegionCacheCount(component, &allocated, &valid);
+    ASSERT_EQ(1u, valid);
+
+    // Transform
+    dmGameObject::SetPosition(go, Point3(10.0f, 0.0f, 0.0f));
+    ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+    dmGameSystem::GetTileGridRegionCacheCount(component, &allocated, &valid);
+    ASSERT_EQ(0u, valid);
+    ASSERT_TRUE(dmGameObject::PostUpdate(m_Collection));
+
+    UpdateAndRenderTileGrid(m_Collection, &m_UpdateContext, m_RenderContext, true);
+    dmGameSystem::GetTileGridRegionCacheCount(component, &allocated, &valid);
+    ASSERT_EQ(1u, valid);
+
+    // Tile source
+    void* texture_set = 0;
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::Get(m_Factory, "/tile/valid2.texturesetc", &texture_set));
+    dmGameObject::PropertyVar tile_source(dmHashString64("/tile/valid2.texturesetc"));
+    ASSERT_EQ(dmGameObject::PROPERTY_RESULT_OK, dmGameObject::SetProperty(go, dmHashString64("tilegrid"), dmHashString64("tile_source"), tile_source));
+    ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+    dmGameSystem::GetTileGridRegionCacheCount(component, &allocated, &valid);
+    ASSERT_EQ(0u, valid);
+    ASSERT_TRUE(dmGameObject::PostUpdate(m_Collection));
+
+    UpdateAndRenderTileGrid(m_Collection, &m_UpdateContext, m_RenderContext, true);
+    dmGameSystem::GetTileGridRegionCacheCount(component, &allocated, &valid);
+    ASSERT_EQ(1u, valid);
+
+    // Unchanged regions are reused
+    UpdateAndRenderTileGrid(m_Collection, &m_UpdateContext, m_RenderContext, true);
+    dmGameSystem::GetTileGridRegionCacheCount(component, &allocated, &valid);
+    ASSERT_EQ(1u, allocated);
+    ASSERT_EQ(1u, valid);
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+    dmResource::Release(m_Factory, texture_set);
+}
+
+TEST_F(TileGridTest, RegionCacheRelease)
+{
+    ASSERT_TRUE(dmGameObject::Init(m_Collection));
+
+    dmhash_t go_id = dmHashString64("/tilegrid");
+    dmGameObject::HInstance go = Spawn(m_Factory, m_Collection, "/tile/valid_tilegrid.goc", go_id, 0, 0, Point3(0, 0, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    ASSERT_NE((void*)0, go);
+    dmMessage::URL url = GetTileGridURL(m_Collection, go_id);
+    dmGameSystem::TileGridComponent* component = (dmGameSystem::TileGridComponent*)dmGameObject::GetComponentFromURL(url);
+    ASSERT_NE((void*)0, component);
+
+    uint32_t allocated, valid;
+    UpdateAndRenderTileGrid(m_Collection, &m_UpdateContext, m_RenderContext, true);
+    dmGameSystem::GetTileGridRegionCacheCount(component, &allocated, &valid);
+    ASSERT_EQ(1u, allocated);
+
+    // Regions that haven't been drawn for 120 frames are freed
+    for (uint32_t i = 0; i < 120; ++i)
+    {
+        UpdateAndRenderTileGrid(m_Collection, &m_UpdateContext, m_RenderContext, false);
+    }
+    dmGameSystem::GetTileGridRegionCacheCount(component, &allocated, &valid);
+    ASSERT_EQ(1u, allocated);
+    UpdateAndRenderTileGrid(m_Collection, &m_UpdateContext, m_RenderContext, false);
+    dmGameSystem::GetTileGridRegionCacheCount(component, &allocated, &valid);
+    ASSERT_EQ(0u, allocated);
+    ASSERT_EQ(0u, valid);
+
+    UpdateAndRenderTileGrid(m_Collection, &m_UpdateContext, m_RenderContext, true);
+    dmGameSystem::GetTileGridRegionCacheCount(component, &allocated, &valid);
+    ASSERT_EQ(1u, allocated);
+
+    // Disabled tile maps are not rendered, so their caches are freed right away
+    dmGameObjectDDF::Disable disable;
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(&url, &url, dmGameObjectDDF::Disable::m_DDFDescriptor->m_NameHash, (uintptr_t)go, (uintptr_t)dmGameObjectDDF::Disable::m_DDFDescriptor, &disable, sizeof(disable), 0));
+    UpdateAndRenderTileGrid(m_Collection, &m_UpdateContext, m_RenderContext, true);
+    dmGameSystem::GetTileGridRegionCacheCount(component, &allocated, &valid);
+    ASSERT_EQ(0u, allocated);
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+}
+
 /* Gamepad connected */
 
 TEST_F(GamepadConnectedTest, TestGamepadConnectedInputEvent)
@@ -50,6 +50,7 @@ protected:
     dmRender::HRenderContext m_RenderContext;
     dmGameSystem::PhysicsContext m_PhysicsContext;
     dmGameSystem::ParticleFXContext m_ParticleFXContext;
+    dmGameSystem::TextureContext m_TextureContext;
     dmGameSystem::GuiContext m_GuiContext;
     dmHID::HContext m_HidContext;
     dmInput::HContext m_InputContext;
@@ -184,6 +185,12 @@ public:
     virtual ~BoxRenderTest() {}
 };
 
+class TileGridTest : public GamesysTest<const char*>
+{
+public:
+    virtual ~TileGridTest() {}
+};
+
 class GamepadConnectedTest : public GamesysTest<const char*>
 {
 public:
@@ -329,7 +336,10 @@ void GamesysTest<T>::SetUp()
 
     m_SoundContext.m_MaxComponentCount = 32;
 
-    dmResource::Result r = dmGameSystem::RegisterResourceTypes(m_Factory, m_RenderContext, &m_GuiContext, m_InputContext, &m_PhysicsContext);
+    m_TextureContext.m_GraphicsContext = m_GraphicsContext;
+    m_TextureContext.m_WorkerPool = dmWorkerPool::New(2, "test_worker");
+
+    dmResource::Result r = dmGameSystem::RegisterResourceTypes(m_Factory, m_RenderContext, &m_GuiContext, m_InputContext, &m_PhysicsContext, &m_TextureContext);
     assert(dmResource::RESULT_OK == r);
 
     dmResource::Get(m_Factory, "/input/valid.gamepadsc", (void**)&m_GamepadMapsDDF);
@@ -355,6 +365,7 @@ void GamesysTest<T>::TearDown()
     dmScript::Finalize(m_ScriptContext);
     dmScript::DeleteContext(m_ScriptContext);
     dmResource::DeleteFactory(m_Factory);
+    dmWorkerPool::Delete(m_TextureContext.m_WorkerPool);
     dmGameObject::DeleteRegister(m_Register);
     dmSound::Finalize();
     dmInput::DeleteContext(m_InputContext);
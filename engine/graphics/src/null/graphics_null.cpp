@@ -606,6 +606,8 @@ namespace dmGraphics
             VertexStream& vs = context->m_VertexStreams[i];
             if (vs.m_Size > 0)
             {
+                // The vertex declaration may stay enabled over several draw calls
+                delete [] (char*)vs.m_Buffer;
                 vs.m_Buffer = new char[vs.m_Size * count];
             }
         }
@@ -975,6 +977,7 @@ namespace dmGraphics
         tex->m_Height = params.m_Height;
         tex->m_MipMapCount = 0;
         tex->m_Data = 0;
+        tex->m_DataSize = 0;
 
         if (params.m_OriginalWidth == 0) {
             tex->m_OriginalWidth = params.m_Width;
@@ -1019,11 +1022,38 @@ namespace dmGraphics
         assert(!params.m_SubUpdate || (params.m_X + params.m_Width <= texture->m_Width));
         assert(!params.m_SubUpdate || (params.m_Y + params.m_Height <= texture->m_Height));
 
+        uint32_t bytes_per_pixel = GetTextureFormatBPP(params.m_Format) >> 3;
+        if (params.m_SubUpdate && params.m_MipMap == 0 && params.m_DataSize == params.m_Width * params.m_Height * bytes_per_pixel)
+        {
+            // Write the sub image into the texture data, so that the data holds the result of all updates
+            uint32_t size = texture->m_Width * texture->m_Height * bytes_per_pixel;
+            if (texture->m_Data == 0x0 || texture->m_DataSize != size || texture->m_Format != params.m_Format)
+            {
+                delete [] (char*)texture->m_Data;
+                texture->m_Data = new char[size];
+                texture->m_DataSize = size;
+                memset(texture->m_Data, 0, size);
+            }
+            texture->m_Format = params.m_Format;
+            if (params.m_Data != 0x0)
+            {
+                uint32_t row_size = params.m_Width * bytes_per_pixel;
+                for (uint32_t y = 0; y < params.m_Height; ++y)
+                {
+                    char* dst = (char*)texture->m_Data + ((params.m_Y + y) * texture->m_Width + params.m_X) * bytes_per_pixel;
+                    memcpy(dst, (const char*)params.m_Data + y * row_size, row_size);
+                }
+            }
+            texture->m_MipMapCount = dmMath::Max(texture->m_MipMapCount, (uint16_t)1);
+            return;
+        }
+
         if (texture->m_Data != 0x0)
             delete [] (char*)texture->m_Data;
         texture->m_Format = params.m_Format;
         // Allocate even for 0x0 size so that the rendertarget dummies will work.
         texture->m_Data = new char[params.m_DataSize];
+        texture->m_DataSize = params.m_DataSize;
         if (params.m_Data != 0x0)
             memcpy(texture->m_Data, params.m_Data, params.m_DataSize);
         texture->m_MipMapCount = dmMath::Max(texture->m_MipMapCount, (uint16_t)(params.m_MipMap+1));
@@ -18,6 +18,7 @@ namespace dmGraphics
     struct Texture
     {
         void* m_Data;
+        uint32_t m_DataSize;
         TextureFormat m_Format;
         uint32_t m_Width;
         uint32_t m_Height;
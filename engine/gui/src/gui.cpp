@@ -281,6 +281,16 @@ namespace dmGui
         }
     }
 
+    static void SetScenesRenderDirty(HContext context)
+    {
+        dmArray<HScene>& scenes = context->m_Scenes;
+        uint32_t scene_count = scenes.Size();
+        for (uint32_t i = 0; i < scene_count; ++i)
+        {
+            scenes[i]->m_RenderDirty = 1;
+        }
+    }
+
     void GetDefaultResolution(HContext context, uint32_t& width, uint32_t& height)
     {
         width = context->m_DefaultProjectWidth;
@@ -291,6 +301,7 @@ namespace dmGui
     {
         context->m_DefaultProjectWidth = width;
         context->m_DefaultProjectHeight = height;
+        SetScenesRenderDirty(context);
     }
 
     void* GetDisplayProfiles(HScene scene)
@@ -317,10 +328,12 @@ namespace dmGui
     void SetDefaultFont(HContext context, void* font)
     {
         context->m_DefaultFont = font;
+        SetScenesRenderDirty(context);
     }
 
     void SetSceneAdjustReference(HScene scene, AdjustReference adjust_reference)
     {
+        scene->m_RenderDirty = 1;
         scene->m_AdjustReference = adjust_reference;
     }
 
@@ -399,6 +412,7 @@ namespace dmGui
         scene->m_RenderTail = INVALID_INDEX;
         scene->m_NextVersionNumber = 0;
         scene->m_RenderOrder = 0;
+        scene->m_RenderDirty = 1;
         scene->m_Width = context->m_DefaultProjectWidth;
         scene->m_Height = context->m_DefaultProjectHeight;
         scene->m_FetchTextureSetAnimCallback = params->m_FetchTextureSetAnimCallback;
@@ -482,6 +496,7 @@ namespace dmGui
 
     Result AddTexture(HScene scene, const char* texture_name, void* texture, NodeTextureType texture_type, uint32_t original_width, uint32_t original_height)
     {
+        scene->m_RenderDirty = 1;
         if (scene->m_Textures.Full())
             return RESULT_OUT_OF_RESOURCES;
 
@@ -502,6 +517,7 @@ namespace dmGui
 
     void RemoveTexture(HScene scene, const char* texture_name)
     {
+        scene->m_RenderDirty = 1;
         uint64_t texture_name_hash = dmHashString64(texture_name);
         scene->m_Textures.Erase(texture_name_hash);
         uint32_t n = scene->m_Nodes.Size();
@@ -524,6 +540,7 @@ namespace dmGui
 
     void ClearTextures(HScene scene)
     {
+        scene->m_RenderDirty = 1;
         scene->m_Textures.Clear();
         uint32_t n = scene->m_Nodes.Size();
         InternalNode* nodes = scene->m_Nodes.Begin();
@@ -566,6 +583,7 @@ namespace dmGui
 
     Result NewDynamicTexture(HScene scene, const dmhash_t texture_hash, uint32_t width, uint32_t height, dmImage::Type type, bool flip, const void* buffer, uint32_t buffer_size)
     {
+        scene->m_RenderDirty = 1;
         uint32_t expected_buffer_size = width * height * dmImage::BytesPerPixel(type);
         if (buffer_size != expected_buffer_size) {
             dmLogError("Invalid image buffer size. Expected %d, got %d", expected_buffer_size, buffer_size);
@@ -607,6 +625,7 @@ namespace dmGui
 
 Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
     {
+        scene->m_RenderDirty = 1;
         DynamicTexture* t = scene->m_DynamicTextures.Get(texture_hash);
 
         if (!t) {
@@ -624,6 +643,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     Result SetDynamicTextureData(HScene scene, const dmhash_t texture_hash, uint32_t width, uint32_t height, dmImage::Type type, bool flip, const void* buffer, uint32_t buffer_size)
     {
+        scene->m_RenderDirty = 1;
         DynamicTexture*t = scene->m_DynamicTextures.Get(texture_hash);
 
         if (!t) {
@@ -685,6 +705,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     Result AddFont(HScene scene, const char* font_name, void* font)
     {
+        scene->m_RenderDirty = 1;
         if (scene->m_Fonts.Full())
             return RESULT_OUT_OF_RESOURCES;
 
@@ -705,6 +726,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void RemoveFont(HScene scene, const char* font_name)
     {
+        scene->m_RenderDirty = 1;
         uint64_t font_hash = dmHashString64(font_name);
         scene->m_Fonts.Erase(font_hash);
         uint32_t n = scene->m_Nodes.Size();
@@ -782,6 +804,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void ClearFonts(HScene scene)
     {
+        scene->m_RenderDirty = 1;
         scene->m_Fonts.Clear();
         uint32_t n = scene->m_Nodes.Size();
         InternalNode* nodes = scene->m_Nodes.Begin();
@@ -793,6 +816,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     Result AddLayer(HScene scene, const char* layer_name)
     {
+        scene->m_RenderDirty = 1;
         if (scene->m_Layers.Full())
         {
             dmLogError("Max number of layers exhausted (max %d total)", scene->m_Layers.Capacity());
@@ -823,6 +847,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void ClearLayouts(HScene scene)
     {
+        scene->m_RenderDirty = 1;
         scene->m_LayoutId = DEFAULT_LAYOUT;
         scene->m_Layouts.SetSize(0);
         scene->m_Layouts.Push(DEFAULT_LAYOUT);
@@ -896,6 +921,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     Result SetLayout(const HScene scene, dmhash_t layout_id, SetNodeCallback set_node_callback)
     {
+        scene->m_RenderDirty = 1;
         scene->m_LayoutId = layout_id;
         uint16_t index = GetLayoutIndex(scene, layout_id);
         uint32_t n = scene->m_Nodes.Size();
@@ -1389,30 +1415,28 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
         CollectRenderEntries(scene, scene->m_RenderHead, 0, 0x0, clippers, render_entries);
     }
 
-    void RenderScene(HScene scene, const RenderSceneParams& params, void* context)
+    static void RebuildRenderEntries(HScene scene)
     {
         Context* c = scene->m_Context;
 
-        UpdateDynamicTextures(scene, params, context);
-        DeferredDeleteDynamicTextures(scene, params, context);
-
-        c->m_RenderNodes.SetSize(0);
-        c->m_RenderTransforms.SetSize(0);
-        c->m_RenderOpacities.SetSize(0);
-        c->m_StencilClippingNodes.SetSize(0);
-        c->m_StencilScopes.SetSize(0);
-        c->m_StencilScopeIndices.SetSize(0);
+        scene->m_RenderNodes.SetSize(0);
+        scene->m_RenderTransforms.SetSize(0);
+        scene->m_RenderOpacities.SetSize(0);
+        scene->m_StencilClippingNodes.SetSize(0);
+        scene->m_StencilScopes.SetSize(0);
         uint32_t capacity = scene->m_NodePool.Size() * 2;
-        if (capacity > c->m_RenderNodes.Capacity())
+        if (capacity > scene->m_RenderNodes.Capacity())
+        {
+            scene->m_RenderNodes.SetCapacity(capacity);
+            scene->m_RenderTransforms.SetCapacity(capacity);
+            scene->m_RenderOpacities.SetCapacity(capacity);
+            scene->m_StencilClippingNodes.SetCapacity(capacity);
+            scene->m_StencilScopes.SetCapacity(capacity);
+        }
+        if (capacity > c->m_SceneTraversalCache.m_Data.Capacity())
         {
-            c->m_RenderNodes.SetCapacity(capacity);
-            c->m_RenderTransforms.SetCapacity(capacity);
-            c->m_RenderOpacities.SetCapacity(capacity);
             c->m_SceneTraversalCache.m_Data.SetCapacity(capacity);
             c->m_SceneTraversalCache.m_Data.SetSize(capacity);
-            c->m_StencilClippingNodes.SetCapacity(capacity);
-            c->m_StencilScopes.SetCapacity(capacity);
-            c->m_StencilScopeIndices.SetCapacity(capacity);
         }
 
         c->m_SceneTraversalCache.m_NodeIndex = 0;
@@ -1421,56 +1445,84 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
             c->m_SceneTraversalCache.m_Version = 0;
         }
 
-        Matrix4 node_transform;
-        CollectNodes(scene, c->m_StencilClippingNodes, c->m_RenderNodes);
-        uint32_t node_count = c->m_RenderNodes.Size();
-        std::sort(c->m_RenderNodes.Begin(), c->m_RenderNodes.End(), RenderEntrySortPred(scene));
+        CollectNodes(scene, scene->m_StencilClippingNodes, scene->m_RenderNodes);
+        uint32_t node_count = scene->m_RenderNodes.Size();
+        std::sort(scene->m_RenderNodes.Begin(), scene->m_RenderNodes.End(), RenderEntrySortPred(scene));
         Matrix4 transform;
 
-        if (c->m_RenderNodes.Capacity() > c->m_RenderTransforms.Capacity())
+        if (scene->m_RenderNodes.Capacity() > scene->m_RenderTransforms.Capacity())
         {
-            uint32_t new_capacity = c->m_RenderNodes.Capacity();
-            c->m_RenderTransforms.SetCapacity(new_capacity);
-            c->m_RenderOpacities.SetCapacity(new_capacity);
+            uint32_t new_capacity = scene->m_RenderNodes.Capacity();
+            scene->m_RenderTransforms.SetCapacity(new_capacity);
+            scene->m_RenderOpacities.SetCapacity(new_capacity);
+            scene->m_StencilClippingNodes.SetCapacity(new_capacity);
+            scene->m_StencilScopes.SetCapacity(new_capacity);
+        }
+        if (scene->m_RenderNodes.Capacity() > c->m_SceneTraversalCache.m_Data.Capacity())
+        {
+            uint32_t new_capacity = scene->m_RenderNodes.Capacity();
             c->m_SceneTraversalCache.m_Data.SetCapacity(new_capacity);
             c->m_SceneTraversalCache.m_Data.SetSize(new_capacity);
-            c->m_StencilClippingNodes.SetCapacity(new_capacity);
-            c->m_StencilScopes.SetCapacity(new_capacity);
-            c->m_StencilScopeIndices.SetCapacity(new_capacity);
         }
 
+        // Spine and particlefx nodes change every frame without going through the scene api,
+        // so a scene containing them is never considered clean
+        scene->m_RenderDirty = 0;
+
         for (uint32_t i = 0; i < node_count; ++i)
         {
-            const RenderEntry& entry = c->m_RenderNodes[i];
+            const RenderEntry& entry = scene->m_RenderNodes[i];
             uint16_t index = entry.m_Node & 0xffff;
             InternalNode* n = &scene->m_Nodes[index];
             float opacity = 1.0f;
             CalculateNodeSize(n);
             CalculateNodeTransformAndAlphaCached(scene, n, CalculateNodeTransformFlags(CALCULATE_NODE_INCLUDE_SIZE | CALCULATE_NODE_RESET_PIVOT), transform, opacity);
-            c->m_RenderTransforms.Push(transform);
-            c->m_RenderOpacities.Push(opacity);
+            scene->m_RenderTransforms.Push(transform);
+            scene->m_RenderOpacities.Push(opacity);
             if (n->m_ClipperIndex != INVALID_INDEX) {
-                InternalClippingNode* clipper = &c->m_StencilClippingNodes[n->m_ClipperIndex];
+                InternalClippingNode* clipper = &scene->m_StencilClippingNodes[n->m_ClipperIndex];
                 if (clipper->m_NodeIndex == index) {
                     if (clipper->m_VisibleRenderKey == entry.m_RenderKey) {
                         StencilScope* scope = 0x0;
                         if (clipper->m_ParentIndex != INVALID_INDEX) {
-                            scope = &c->m_StencilClippingNodes[clipper->m_ParentIndex].m_ChildScope;
+                            scope = &scene->m_StencilClippingNodes[clipper->m_ParentIndex].m_ChildScope;
                         }
-                        c->m_StencilScopes.Push(scope);
+                        scene->m_StencilScopes.Push(scope);
                     } else {
-                        c->m_StencilScopes.Push(&clipper->m_Scope);
+                        scene->m_StencilScopes.Push(&clipper->m_Scope);
                     }
                 } else {
-                    c->m_StencilScopes.Push(&clipper->m_ChildScope);
+                    scene->m_StencilScopes.Push(&clipper->m_ChildScope);
                 }
             } else {
-                c->m_StencilScopes.Push(0x0);
+                scene->m_StencilScopes.Push(0x0);
+            }
+
+            if (n->m_Node.m_NodeType == NODE_TYPE_SPINE || n->m_Node.m_NodeType == NODE_TYPE_PARTICLEFX) {
+                scene->m_RenderDirty = 1;
             }
         }
 
+        ++scene->m_RenderVersion;
+    }
+
+    void RenderScene(HScene scene, const RenderSceneParams& params, void* context)
+    {
+        UpdateDynamicTextures(scene, params, context);
+        DeferredDeleteDynamicTextures(scene, params, context);
+
+        if (scene->m_RenderDirty || scene->m_ResChanged)
+        {
+            RebuildRenderEntries(scene);
+            DM_COUNTER("Gui.ScenesRebuilt", 1);
+        }
+        else
+        {
+            DM_COUNTER("Gui.ScenesReused", 1);
+        }
+
         scene->m_ResChanged = 0;
-        params.m_RenderNodes(scene, c->m_RenderNodes.Begin(), c->m_RenderTransforms.Begin(), c->m_RenderOpacities.Begin(), (const StencilScope**)c->m_StencilScopes.Begin(), c->m_RenderNodes.Size(), context);
+        params.m_RenderNodes(scene, scene->m_RenderNodes.Begin(), scene->m_RenderTransforms.Begin(), scene->m_RenderOpacities.Begin(), (const StencilScope**)scene->m_StencilScopes.Begin(), scene->m_RenderNodes.Size(), context);
     }
 
     void RenderScene(HScene scene, RenderNodes render_nodes, void* context)
@@ -1542,6 +1594,12 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
     {
         dmArray<Animation>* animations = &scene->m_Animations;
 
+        // Animated values are written straight into the nodes
+        if (animations->Size() > 0)
+        {
+            scene->m_RenderDirty = 1;
+        }
+
         uint32_t active_animations = 0;
 
         for (uint32_t i = 0; i < animations->Size(); ++i)
@@ -2202,6 +2260,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     HNode NewNode(HScene scene, const Point3& position, const Vector3& size, NodeType node_type)
     {
+        scene->m_RenderDirty = 1;
         uint16_t index = AllocateNode(scene);
         if (index == scene->m_NodePool.Capacity())
         {
@@ -2411,6 +2470,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void DeleteNode(HScene scene, HNode node, bool delete_headless_pfx)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
 
         // Delete rig instance if node was a spine
@@ -2502,6 +2562,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void ClearNodes(HScene scene)
     {
+        scene->m_RenderDirty = 1;
         scene->m_Nodes.SetSize(0);
         scene->m_RenderHead = INVALID_INDEX;
         scene->m_RenderTail = INVALID_INDEX;
@@ -2612,6 +2673,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void ResetNodes(HScene scene)
     {
+        scene->m_RenderDirty = 1;
         uint32_t n_nodes = scene->m_Nodes.Size();
         InternalNode* nodes = scene->m_Nodes.Begin();
         for (uint32_t i = 0; i < n_nodes; ++i) {
@@ -2626,6 +2688,11 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
         scene->m_Animations.SetSize(0);
     }
 
+    uint32_t GetSceneRenderVersion(HScene scene)
+    {
+        return scene->m_RenderVersion;
+    }
+
     uint16_t GetRenderOrder(HScene scene)
     {
         return scene->m_RenderOrder;
@@ -2657,6 +2724,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void SetNodePosition(HScene scene, HNode node, const Point3& position)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_Properties[PROPERTY_POSITION] = Vector4(position);
         n->m_Node.m_DirtyLocal = 1;
@@ -2694,6 +2762,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void SetNodeProperty(HScene scene, HNode node, Property property, const Vector4& value)
     {
+        scene->m_RenderDirty = 1;
         assert(property < PROPERTY_COUNT);
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_Properties[property] = value;
@@ -2716,6 +2785,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void SetNodeText(HScene scene, HNode node, const char* text)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         if (n->m_Node.m_Text)
             free((void*) n->m_Node.m_Text);
@@ -2728,6 +2798,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void SetNodeLineBreak(HScene scene, HNode node, bool line_break)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_LineBreak = line_break;
     }
@@ -2740,6 +2811,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void SetNodeTextLeading(HScene scene, HNode node, float leading)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_Properties[PROPERTY_TEXT_PARAMS].setX(leading);
     }
@@ -2751,6 +2823,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void SetNodeTextTracking(HScene scene, HNode node, float tracking)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_Properties[PROPERTY_TEXT_PARAMS].setY(tracking);
     }
@@ -2781,6 +2854,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     Result SetNodeTexture(HScene scene, HNode node, dmhash_t texture_id)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         if (n->m_Node.m_TextureType == NODE_TEXTURE_TYPE_TEXTURE_SET)
             CancelNodeFlipbookAnim(scene, node);
@@ -2855,6 +2929,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     Result SetNodeSpineScene(HScene scene, HNode node, dmhash_t spine_scene_id, dmhash_t skin_id, dmhash_t default_animation_id, bool generate_bones)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         if (n->m_Node.m_NodeType != NODE_TYPE_SPINE) {
             return RESULT_INVAL_ERROR;
@@ -3064,6 +3139,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     Result SetNodeParticlefx(HScene scene, HNode node, dmhash_t particlefx_id)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         if (n->m_Node.m_NodeType != NODE_TYPE_PARTICLEFX) {
             return RESULT_WRONG_TYPE;
@@ -3148,6 +3224,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     Result SetNodeFont(HScene scene, HNode node, dmhash_t font_id)
     {
+        scene->m_RenderDirty = 1;
         void** font = scene->m_Fonts.Get(font_id);
         if (font)
         {
@@ -3175,6 +3252,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     Result SetNodeLayer(HScene scene, HNode node, dmhash_t layer_id)
     {
+        scene->m_RenderDirty = 1;
         uint16_t* layer_index = scene->m_Layers.Get(layer_id);
         if (layer_index)
         {
@@ -3202,6 +3280,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void SetNodeInheritAlpha(HScene scene, HNode node, bool inherit_alpha)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_InheritAlpha = inherit_alpha;
     }
@@ -3216,6 +3295,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void SetNodeFlipbookCursor(HScene scene, HNode node, float cursor)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
 
         cursor = dmMath::Clamp(cursor, 0.0f, 1.0f);
@@ -3408,6 +3488,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     Result PlayNodeParticlefx(HScene scene, HNode node, dmParticle::EmitterStateChangedData* callbackdata)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         if (n->m_Node.m_NodeType != NODE_TYPE_PARTICLEFX) {
             return RESULT_WRONG_TYPE;
@@ -3482,6 +3563,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void SetNodeClippingMode(HScene scene, HNode node, ClippingMode mode)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_ClippingMode = mode;
     }
@@ -3494,6 +3576,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void SetNodeClippingVisible(HScene scene, HNode node, bool visible)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_ClippingVisible = (uint32_t) visible;
     }
@@ -3506,6 +3589,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void SetNodeClippingInverted(HScene scene, HNode node, bool inverted)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_ClippingInverted = (uint32_t) inverted;
     }
@@ -3541,6 +3625,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void SetNodeBlendMode(HScene scene, HNode node, BlendMode blend_mode)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_BlendMode = (uint32_t) blend_mode;
     }
@@ -3553,6 +3638,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void SetNodeXAnchor(HScene scene, HNode node, XAnchor x_anchor)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_XAnchor = (uint32_t) x_anchor;
     }
@@ -3565,6 +3651,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void SetNodeYAnchor(HScene scene, HNode node, YAnchor y_anchor)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_YAnchor = (uint32_t) y_anchor;
     }
@@ -3572,24 +3659,28 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void SetNodeOuterBounds(HScene scene, HNode node, PieBounds bounds)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_OuterBounds = bounds;
     }
 
     void SetNodePerimeterVertices(HScene scene, HNode node, uint32_t vertices)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_PerimeterVertices = vertices;
     }
 
     void SetNodeInnerRadius(HScene scene, HNode node, float radius)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_Properties[PROPERTY_PIE_PARAMS].setX(radius);
     }
 
     void SetNodePieFillAngle(HScene scene, HNode node, float fill_angle)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_Properties[PROPERTY_PIE_PARAMS].setY(fill_angle);
     }
@@ -3626,6 +3717,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void SetNodePivot(HScene scene, HNode node, Pivot pivot)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_Pivot = (uint32_t) pivot;
     }
@@ -3638,18 +3730,21 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void SetNodeIsBone(HScene scene, HNode node, bool is_bone)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_IsBone = is_bone;
     }
 
     void SetNodeAdjustMode(HScene scene, HNode node, AdjustMode adjust_mode)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_AdjustMode = (uint32_t) adjust_mode;
     }
 
     void SetNodeSizeMode(HScene scene, HNode node, SizeMode size_mode)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_SizeMode = (uint32_t) size_mode;
         if((n->m_Node.m_SizeMode != SIZE_MODE_MANUAL) && (n->m_Node.m_NodeType != NODE_TYPE_SPINE) && (n->m_Node.m_NodeType != NODE_TYPE_PARTICLEFX))
@@ -3978,6 +4073,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     Result PlayNodeFlipbookAnim(HScene scene, HNode node, dmhash_t anim, float offset, float playback_rate, AnimationComplete anim_complete_callback, void* callback_userdata1, void* callback_userdata2)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_FlipbookAnimPosition = 0.0f;
         n->m_Node.m_FlipbookAnimHash = 0x0;
@@ -4026,6 +4122,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void CancelNodeFlipbookAnim(HScene scene, HNode node)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         CancelAnimationComponent(scene, node, &n->m_Node.m_FlipbookAnimPosition);
         n->m_Node.m_FlipbookAnimHash = 0;
@@ -4093,6 +4190,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void SetNodeEnabled(HScene scene, HNode node, bool enabled)
     {
+        scene->m_RenderDirty = 1;
         InternalNode* n = GetNode(scene, node);
         n->m_Node.m_Enabled = enabled;
         if(enabled)
@@ -4103,6 +4201,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void MoveNodeBelow(HScene scene, HNode node, HNode reference)
     {
+        scene->m_RenderDirty = 1;
         if (node != INVALID_HANDLE && node != reference)
         {
             InternalNode* n = GetNode(scene, node);
@@ -4129,6 +4228,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     void MoveNodeAbove(HScene scene, HNode node, HNode reference)
     {
+        scene->m_RenderDirty = 1;
         if (node != INVALID_HANDLE && node != reference)
         {
             InternalNode* n = GetNode(scene, node);
@@ -4159,6 +4259,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     Result SetNodeParent(HScene scene, HNode node, HNode parent, bool keep_scene_transform)
     {
+        scene->m_RenderDirty = 1;
         if (node == parent)
             return RESULT_INF_RECURSION;
         InternalNode* n = GetNode(scene, node);
@@ -4257,6 +4358,7 @@ Result DeleteDynamicTexture(HScene scene, const dmhash_t texture_hash)
 
     Result CloneNode(HScene scene, HNode node, HNode* out_node)
     {
+        scene->m_RenderDirty = 1;
         uint16_t index = AllocateNode(scene);
         if (index == scene->m_NodePool.Capacity())
         {
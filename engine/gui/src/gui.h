@@ -891,6 +891,16 @@ namespace dmGui
      */
     void ResetNodes(HScene scene);
 
+    /**
+     * Get the version of the render entries passed to RenderNodes by RenderScene.
+     * The version is bumped every time the entries are rebuilt. An unchanged version
+     * means that the entries, transforms, opacities and stencil scopes of the previous
+     * frame are passed again, and anything generated from them may be reused.
+     * @param scene
+     * @return render version
+     */
+    uint32_t GetSceneRenderVersion(HScene scene);
+
     /**
      * Get scene render-order. The value is typically used for a render-key when sorting
      * @param scene
@@ -88,12 +88,6 @@ namespace dmGui
         uint32_t                        m_DefaultProjectHeight;
         uint32_t                        m_Dpi;
         dmArray<HScene>                 m_Scenes;
-        dmArray<RenderEntry>            m_RenderNodes;
-        dmArray<Matrix4>                m_RenderTransforms;
-        dmArray<float>                	m_RenderOpacities;
-        dmArray<InternalClippingNode>   m_StencilClippingNodes;
-        dmArray<StencilScope*>          m_StencilScopes;
-        dmArray<uint16_t>               m_StencilScopeIndices;
         dmArray<HNode>                  m_ScratchBoneNodes;
         dmHID::HContext                 m_HidContext;
         void*                           m_DefaultFont;
@@ -302,6 +296,15 @@ namespace dmGui
         uint16_t                m_RenderOrder; // For the render-key
         uint16_t                m_NextLayerIndex;
         uint16_t                m_ResChanged : 1;
+        // Set when anything affecting the rendered output has changed since the last RenderScene
+        uint16_t                m_RenderDirty : 1;
+        // Render entries from the last rebuild, reused by RenderScene while the scene is not dirty
+        dmArray<RenderEntry>            m_RenderNodes;
+        dmArray<Matrix4>                m_RenderTransforms;
+        dmArray<float>                  m_RenderOpacities;
+        dmArray<InternalClippingNode>   m_StencilClippingNodes;
+        dmArray<StencilScope*>          m_StencilScopes;
+        uint32_t                m_RenderVersion;
         uint32_t                m_Width;
         uint32_t                m_Height;
         dmScript::ScriptWorld*  m_ScriptWorld;
@@ -1303,6 +1303,7 @@ namespace dmGui
         if (n->m_Node.m_Text)
             free((void*) n->m_Node.m_Text);
         n->m_Node.m_Text = strdup(text);
+        GetScene(L)->m_RenderDirty = 1;
         return 0;
     }
 
@@ -1335,6 +1336,7 @@ namespace dmGui
         InternalNode* n = LuaCheckNode(L, 1, &hnode);
         bool line_break = (bool) lua_toboolean(L, 2);
         n->m_Node.m_LineBreak = line_break;
+        GetScene(L)->m_RenderDirty = 1;
         return 0;
     }
 
@@ -1377,6 +1379,7 @@ namespace dmGui
         InternalNode* n = LuaCheckNode(L, 1, &hnode);
         int blend_mode = (int) luaL_checknumber(L, 2);
         n->m_Node.m_BlendMode = (BlendMode) blend_mode;
+        GetScene(L)->m_RenderDirty = 1;
         return 0;
     }
 
@@ -2030,6 +2033,7 @@ namespace dmGui
         InternalNode* n = LuaCheckNode(L, 1, &hnode);
         int clipping_mode = (int) luaL_checknumber(L, 2);
         n->m_Node.m_ClippingMode = (ClippingMode) clipping_mode;
+        GetScene(L)->m_RenderDirty = 1;
         return 0;
     }
 
@@ -2061,6 +2065,7 @@ namespace dmGui
         InternalNode* n = LuaCheckNode(L, 1, &hnode);
         int visible = lua_toboolean(L, 2);
         n->m_Node.m_ClippingVisible = visible;
+        GetScene(L)->m_RenderDirty = 1;
         return 0;
     }
 
@@ -2092,6 +2097,7 @@ namespace dmGui
         InternalNode* n = LuaCheckNode(L, 1, &hnode);
         int inverted = lua_toboolean(L, 2);
         n->m_Node.m_ClippingInverted = inverted;
+        GetScene(L)->m_RenderDirty = 1;
         return 0;
     }
 
@@ -2911,6 +2917,7 @@ namespace dmGui
         InternalNode* n = LuaCheckNode(L, 1, &hnode);
         int adjust_mode = (int) luaL_checknumber(L, 2);
         n->m_Node.m_AdjustMode = (AdjustMode) adjust_mode;
+        GetScene(L)->m_RenderDirty = 1;
         return 0;
     }
 
@@ -3476,6 +3483,7 @@ namespace dmGui
                 v = *dmScript::CheckVector4(L, 2);\
             n->m_Node.m_Properties[property] = v;\
             n->m_Node.m_DirtyLocal = 1;\
+            GetScene(L)->m_RenderDirty = 1;\
             return 0;\
         }\
 
@@ -3541,6 +3549,7 @@ namespace dmGui
         }
         n->m_Node.m_Properties[PROPERTY_ROTATION] = v;
         n->m_Node.m_DirtyLocal = 1;
+        GetScene(L)->m_RenderDirty = 1;
         return 0;
     }
 
@@ -3587,6 +3596,7 @@ namespace dmGui
             v = *dmScript::CheckVector4(L, 2);
         n->m_Node.m_Properties[PROPERTY_SIZE] = v;
         n->m_Node.m_DirtyLocal = 1;
+        GetScene(L)->m_RenderDirty = 1;
         return 0;
     }
 
@@ -4505,6 +4515,7 @@ namespace dmGui
         InternalNode* n = LuaCheckNode(L, 1, &hnode);
         int inherit_alpha = lua_toboolean(L, 2);
         n->m_Node.m_InheritAlpha = inherit_alpha;
+        GetScene(L)->m_RenderDirty = 1;
 
         assert(top == lua_gettop(L));
         return 0;
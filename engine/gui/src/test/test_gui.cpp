@@ -2956,6 +2956,55 @@ TEST_F(dmGuiTest, ScriptAnchoring)
     ASSERT_NEAR(physical_height - 10.0f * ref_scale.getY(), pos2.getY() + ref_factor * 0.5f * (TEXT_MAX_DESCENT + TEXT_MAX_ASCENT), EPSILON);
 }
 
+TEST_F(dmGuiTest, RenderCache)
+{
+    const char* n1_name = "n1";
+    dmGui::HNode n1 = dmGui::NewNode(m_Scene, Point3(10, 10, 0), Vector3(10, 10, 0), dmGui::NODE_TYPE_BOX);
+    dmGui::SetNodeText(m_Scene, n1, n1_name);
+
+    dmGui::RenderScene(m_Scene, &RenderNodes, this);
+    uint32_t version = dmGui::GetSceneRenderVersion(m_Scene);
+    float x = m_NodeTextToRenderedPosition[n1_name].getX();
+
+    // Nothing changed, the render entries are reused
+    dmGui::RenderScene(m_Scene, &RenderNodes, this);
+    ASSERT_EQ(version, dmGui::GetSceneRenderVersion(m_Scene));
+    ASSERT_EQ(dmGui::RESULT_OK, dmGui::UpdateScene(m_Scene, 1.0f / 60.0f));
+    dmGui::RenderScene(m_Scene, &RenderNodes, this);
+    ASSERT_EQ(version, dmGui::GetSceneRenderVersion(m_Scene));
+    ASSERT_EQ(x, m_NodeTextToRenderedPosition[n1_name].getX());
+
+    // Property change
+    dmGui::SetNodePosition(m_Scene, n1, Point3(20, 10, 0));
+    dmGui::RenderScene(m_Scene, &RenderNodes, this);
+    ASSERT_NE(version, dmGui::GetSceneRenderVersion(m_Scene));
+    ASSERT_LT(x, m_NodeTextToRenderedPosition[n1_name].getX());
+    version = dmGui::GetSceneRenderVersion(m_Scene);
+    x = m_NodeTextToRenderedPosition[n1_name].getX();
+
+    // Animation, rebuilt every frame until it has completed
+    dmhash_t property = dmHashString64("position.x");
+    dmGui::AnimateNodeHash(m_Scene, n1, property, Vector4(40, 0, 0, 0), dmEasing::Curve(dmEasing::TYPE_LINEAR), dmGui::PLAYBACK_ONCE_FORWARD, 2.0f / 60.0f, 0.0f, 0, 0, 0);
+    uint32_t rebuilt = 0;
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        ASSERT_EQ(dmGui::RESULT_OK, dmGui::UpdateScene(m_Scene, 1.0f / 60.0f));
+        dmGui::RenderScene(m_Scene, &RenderNodes, this);
+        if (version == dmGui::GetSceneRenderVersion(m_Scene))
+            break;
+        version = dmGui::GetSceneRenderVersion(m_Scene);
+        ++rebuilt;
+    }
+    ASSERT_LE(2U, rebuilt);
+    ASSERT_GT(10U, rebuilt);
+    ASSERT_LT(x, m_NodeTextToRenderedPosition[n1_name].getX());
+
+    // Resolution change
+    dmGui::SetPhysicalResolution(m_Context, 320, 240);
+    dmGui::RenderScene(m_Scene, &RenderNodes, this);
+    ASSERT_NE(version, dmGui::GetSceneRenderVersion(m_Scene));
+}
+
 TEST_F(dmGuiTest, ScriptPivot)
 {
     const char* s = "function init(self)\n"
@@ -14,9 +14,11 @@
 #include <stdint.h>
 #include <float.h>
 #include <algorithm>
+#include <dlib/align.h>
 #include <dlib/hash.h>
 #include <dlib/log.h>
 #include <dlib/math.h>
+#include <dlib/memory.h>
 #include <dlib/vmath.h>
 #include <dlib/profile.h>
 #include <dlib/time.h>
@@ -24,6 +26,14 @@
 #include "particle.h"
 #include "particle_private.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define DM_PARTICLE_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define DM_PARTICLE_NEON
+#endif
+
 namespace dmParticle
 {
     using namespace dmParticleDDF;
@@ -48,6 +58,90 @@ namespace dmParticle
     /// Simulate motion blur at 60 fps with a 180 deg shutter
     const static float STRETCH_SCALING = (1.0f/60.0f) * 0.5f;
 
+    // Four particles are processed at a time over the streams of the particle buffer.
+    // The operations are the same as the scalar vectormath ones, in the same order, so the results match.
+#if defined(DM_PARTICLE_SSE)
+    typedef __m128 Float4;
+
+    static inline Float4 Load4(const float* p)                      { return _mm_load_ps(p); }
+    static inline void   Store4(float* p, Float4 v)                 { _mm_store_ps(p, v); }
+    static inline Float4 Splat4(float f)                            { return _mm_set1_ps(f); }
+    static inline Float4 Set4(float a, float b, float c, float d)   { return _mm_setr_ps(a, b, c, d); }
+    static inline Float4 Add4(Float4 a, Float4 b)                   { return _mm_add_ps(a, b); }
+    static inline Float4 Sub4(Float4 a, Float4 b)                   { return _mm_sub_ps(a, b); }
+    static inline Float4 Mul4(Float4 a, Float4 b)                   { return _mm_mul_ps(a, b); }
+    static inline Float4 Min4(Float4 a, Float4 b)                   { return _mm_min_ps(a, b); }
+    // Like dmMath::Max, b is returned when either value is NaN
+    static inline Float4 Max4(Float4 a, Float4 b)                   { return _mm_max_ps(a, b); }
+    static inline Float4 Sqrt4(Float4 a)                            { return _mm_sqrt_ps(a); }
+    // a > 0 ? b : c
+    static inline Float4 SelectPositive4(Float4 a, Float4 b, Float4 c)
+    {
+        __m128 mask = _mm_cmpgt_ps(a, _mm_setzero_ps());
+        return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, c));
+    }
+#elif defined(DM_PARTICLE_NEON)
+    typedef float32x4_t Float4;
+
+    static inline Float4 Load4(const float* p)                      { return vld1q_f32(p); }
+    static inline void   Store4(float* p, Float4 v)                 { vst1q_f32(p, v); }
+    static inline Float4 Splat4(float f)                            { return vdupq_n_f32(f); }
+    static inline Float4 Set4(float a, float b, float c, float d)   { float v[4] = {a, b, c, d}; return vld1q_f32(v); }
+    static inline Float4 Add4(Float4 a, Float4 b)                   { return vaddq_f32(a, b); }
+    static inline Float4 Sub4(Float4 a, Float4 b)                   { return vsubq_f32(a, b); }
+    static inline Float4 Mul4(Float4 a, Float4 b)                   { return vmulq_f32(a, b); }
+    static inline Float4 Min4(Float4 a, Float4 b)                   { return vminq_f32(a, b); }
+    static inline Float4 Max4(Float4 a, Float4 b)                   { return vbslq_f32(vcgtq_f32(a, b), a, b); }
+#if defined(__aarch64__)
+    static inline Float4 Sqrt4(Float4 a)                            { return vsqrtq_f32(a); }
+#else
+    static inline Float4 Sqrt4(Float4 a)
+    {
+        float v[4];
+        vst1q_f32(v, a);
+        return Set4(sqrtf(v[0]), sqrtf(v[1]), sqrtf(v[2]), sqrtf(v[3]));
+    }
+#endif
+    static inline Float4 SelectPositive4(Float4 a, Float4 b, Float4 c) { return vbslq_f32(vcgtq_f32(a, vdupq_n_f32(0.0f)), b, c); }
+#else
+    typedef Vector4 Float4;
+
+    static inline Float4 Load4(const float* p)                      { return Vector4(p[0], p[1], p[2], p[3]); }
+    static inline void   Store4(float* p, Float4 v)                 { p[0] = v.getX(); p[1] = v.getY(); p[2] = v.getZ(); p[3] = v.getW(); }
+    static inline Float4 Splat4(float f)                            { return Vector4(f); }
+    static inline Float4 Set4(float a, float b, float c, float d)   { return Vector4(a, b, c, d); }
+    static inline Float4 Add4(Float4 a, Float4 b)                   { return a + b; }
+    static inline Float4 Sub4(Float4 a, Float4 b)                   { return a - b; }
+    static inline Float4 Mul4(Float4 a, Float4 b)                   { return mulPerElem(a, b); }
+    static inline Float4 Min4(Float4 a, Float4 b)                   { return minPerElem(a, b); }
+    static inline Float4 Max4(Float4 a, Float4 b)
+    {
+        return Vector4(dmMath::Max(a.getX(), b.getX()), dmMath::Max(a.getY(), b.getY()),
+                       dmMath::Max(a.getZ(), b.getZ()), dmMath::Max(a.getW(), b.getW()));
+    }
+    static inline Float4 Sqrt4(Float4 a)                            { return sqrtPerElem(a); }
+    static inline Float4 SelectPositive4(Float4 a, Float4 b, Float4 c)
+    {
+        return Vector4(a.getX() > 0.0f ? b.getX() : c.getX(), a.getY() > 0.0f ? b.getY() : c.getY(),
+                       a.getZ() > 0.0f ? b.getZ() : c.getZ(), a.getW() > 0.0f ? b.getW() : c.getW());
+    }
+#endif
+
+    static inline Float4 MulAdd4(Float4 a, Float4 b, Float4 c)      { return Add4(Mul4(a, b), c); }
+    static inline Float4 Clamp4(Float4 v, Float4 min, Float4 max)   { return Min4(Max4(v, min), max); }
+
+    // Same as vectormath rotate(), over four vectors
+    static inline void Rotate4(Float4 qx, Float4 qy, Float4 qz, Float4 qw, Float4 vx, Float4 vy, Float4 vz, Float4* out_x, Float4* out_y, Float4* out_z)
+    {
+        Float4 tmp_x = Sub4(Add4(Mul4(qw, vx), Mul4(qy, vz)), Mul4(qz, vy));
+        Float4 tmp_y = Sub4(Add4(Mul4(qw, vy), Mul4(qz, vx)), Mul4(qx, vz));
+        Float4 tmp_z = Sub4(Add4(Mul4(qw, vz), Mul4(qx, vy)), Mul4(qy, vx));
+        Float4 tmp_w = Add4(Add4(Mul4(qx, vx), Mul4(qy, vy)), Mul4(qz, vz));
+        *out_x = Add4(Sub4(Add4(Mul4(tmp_w, qx), Mul4(tmp_x, qw)), Mul4(tmp_y, qz)), Mul4(tmp_z, qy));
+        *out_y = Add4(Sub4(Add4(Mul4(tmp_w, qy), Mul4(tmp_y, qw)), Mul4(tmp_z, qx)), Mul4(tmp_x, qz));
+        *out_z = Add4(Sub4(Add4(Mul4(tmp_w, qz), Mul4(tmp_z, qw)), Mul4(tmp_x, qy)), Mul4(tmp_y, qx));
+    }
+
     AnimationData::AnimationData()
     {
         memset(this, 0, sizeof(*this));
@@ -173,11 +267,139 @@ namespace dmParticle
         }
     }
 
+    // Number of particles per stream, including the padding up to a multiple of four
+    static inline uint32_t GetParticleStreamStride(uint32_t capacity)
+    {
+        return (capacity + 3) & ~3u;
+    }
+
+    void SetParticleCapacity(ParticleBuffer* particles, uint32_t capacity)
+    {
+        ParticleBuffer old = *particles;
+        memset(particles, 0, sizeof(ParticleBuffer));
+        if (capacity > 0)
+        {
+#define DM_PARTICLE_COUNT_STREAM(name) + 1
+            const uint32_t float_stream_count = 0 DM_PARTICLE_FLOAT_STREAMS(DM_PARTICLE_COUNT_STREAM);
+#undef DM_PARTICLE_COUNT_STREAM
+            uint32_t stride = GetParticleStreamStride(capacity);
+            // The sort scratch holds the sort order followed by a temporary copy of one stream
+            uint32_t particle_size = 2 * sizeof(Quat) + float_stream_count * sizeof(float) + sizeof(SortKey) + sizeof(uint64_t) + sizeof(Quat);
+            uint32_t size = stride * particle_size;
+            if (dmMemory::AlignedMalloc(&particles->m_Memory, 16, size) != dmMemory::RESULT_OK)
+            {
+                dmLogError("Could not allocate memory for %d particles.", capacity);
+                particles->m_Memory = 0x0;
+            }
+            else
+            {
+                memset(particles->m_Memory, 0, size);
+                uint8_t* cursor = (uint8_t*)particles->m_Memory;
+                particles->m_SourceRotation = (Quat*)cursor; cursor += stride * sizeof(Quat);
+                particles->m_Rotation = (Quat*)cursor; cursor += stride * sizeof(Quat);
+#define DM_PARTICLE_ASSIGN_STREAM(name) particles->m_##name = (float*)cursor; cursor += stride * sizeof(float);
+                DM_PARTICLE_FLOAT_STREAMS(DM_PARTICLE_ASSIGN_STREAM)
+#undef DM_PARTICLE_ASSIGN_STREAM
+                particles->m_SortKey = (SortKey*)cursor; cursor += stride * sizeof(SortKey);
+                particles->m_Scratch = cursor;
+                particles->m_Capacity = capacity;
+                particles->m_Size = dmMath::Min(old.m_Size, capacity);
+
+                // Keep the particles that fit, e.g. when reloading
+                uint32_t count = particles->m_Size;
+                if (count > 0)
+                {
+                    memcpy(particles->m_SourceRotation, old.m_SourceRotation, count * sizeof(Quat));
+                    memcpy(particles->m_Rotation, old.m_Rotation, count * sizeof(Quat));
+#define DM_PARTICLE_COPY_STREAM(name) memcpy(particles->m_##name, old.m_##name, count * sizeof(float));
+                    DM_PARTICLE_FLOAT_STREAMS(DM_PARTICLE_COPY_STREAM)
+#undef DM_PARTICLE_COPY_STREAM
+                    memcpy(particles->m_SortKey, old.m_SortKey, count * sizeof(SortKey));
+                }
+            }
+        }
+        if (old.m_Memory != 0x0)
+        {
+            dmMemory::AlignedFree(old.m_Memory);
+        }
+    }
+
+    void PushParticle(ParticleBuffer* particles, const Particle& particle)
+    {
+        assert(particles->m_Size < particles->m_Capacity);
+        uint32_t i = particles->m_Size++;
+        particles->m_PositionX[i] = particle.m_Position.getX();
+        particles->m_PositionY[i] = particle.m_Position.getY();
+        particles->m_PositionZ[i] = particle.m_Position.getZ();
+        particles->m_SourceRotation[i] = particle.m_SourceRotation;
+        particles->m_Rotation[i] = particle.m_Rotation;
+        particles->m_VelocityX[i] = particle.m_Velocity.getX();
+        particles->m_VelocityY[i] = particle.m_Velocity.getY();
+        particles->m_VelocityZ[i] = particle.m_Velocity.getZ();
+        particles->m_TimeLeft[i] = particle.m_TimeLeft;
+        particles->m_MaxLifeTime[i] = particle.m_MaxLifeTime;
+        particles->m_ooMaxLifeTime[i] = particle.m_ooMaxLifeTime;
+        particles->m_SpreadFactor[i] = particle.m_SpreadFactor;
+        particles->m_SourceSize[i] = particle.m_SourceSize;
+        particles->m_SourceStretchFactorX[i] = particle.m_SourceStretchFactorX;
+        particles->m_SourceStretchFactorY[i] = particle.m_SourceStretchFactorY;
+        particles->m_SourceColorR[i] = particle.m_SourceColor.getX();
+        particles->m_SourceColorG[i] = particle.m_SourceColor.getY();
+        particles->m_SourceColorB[i] = particle.m_SourceColor.getZ();
+        particles->m_SourceColorA[i] = particle.m_SourceColor.getW();
+        particles->m_ColorR[i] = particle.m_Color.getX();
+        particles->m_ColorG[i] = particle.m_Color.getY();
+        particles->m_ColorB[i] = particle.m_Color.getZ();
+        particles->m_ColorA[i] = particle.m_Color.getW();
+        particles->m_ScaleX[i] = particle.m_Scale.getX();
+        particles->m_ScaleY[i] = particle.m_Scale.getY();
+        particles->m_ScaleZ[i] = particle.m_Scale.getZ();
+        particles->m_SortKey[i] = particle.m_SortKey;
+        particles->m_StretchFactorX[i] = particle.m_StretchFactorX;
+        particles->m_StretchFactorY[i] = particle.m_StretchFactorY;
+        particles->m_SourceAngularVelocity[i] = particle.m_SourceAngularVelocity;
+    }
+
+    void EraseSwapParticle(ParticleBuffer* particles, uint32_t index)
+    {
+        assert(index < particles->m_Size);
+        uint32_t last = --particles->m_Size;
+        particles->m_SourceRotation[index] = particles->m_SourceRotation[last];
+        particles->m_Rotation[index] = particles->m_Rotation[last];
+#define DM_PARTICLE_MOVE_STREAM(name) particles->m_##name[index] = particles->m_##name[last];
+        DM_PARTICLE_FLOAT_STREAMS(DM_PARTICLE_MOVE_STREAM)
+#undef DM_PARTICLE_MOVE_STREAM
+        particles->m_SortKey[index] = particles->m_SortKey[last];
+    }
+
+    void GetParticle(const ParticleBuffer& particles, uint32_t i, Particle* out)
+    {
+        memset(out, 0, sizeof(Particle));
+        out->m_Position = Point3(particles.m_PositionX[i], particles.m_PositionY[i], particles.m_PositionZ[i]);
+        out->m_SourceRotation = particles.m_SourceRotation[i];
+        out->m_Rotation = particles.m_Rotation[i];
+        out->m_Velocity = Vector3(particles.m_VelocityX[i], particles.m_VelocityY[i], particles.m_VelocityZ[i]);
+        out->m_TimeLeft = particles.m_TimeLeft[i];
+        out->m_MaxLifeTime = particles.m_MaxLifeTime[i];
+        out->m_ooMaxLifeTime = particles.m_ooMaxLifeTime[i];
+        out->m_SpreadFactor = particles.m_SpreadFactor[i];
+        out->m_SourceSize = particles.m_SourceSize[i];
+        out->m_SourceStretchFactorX = particles.m_SourceStretchFactorX[i];
+        out->m_SourceStretchFactorY = particles.m_SourceStretchFactorY[i];
+        out->m_SourceColor = Vector4(particles.m_SourceColorR[i], particles.m_SourceColorG[i], particles.m_SourceColorB[i], particles.m_SourceColorA[i]);
+        out->m_Color = Vector4(particles.m_ColorR[i], particles.m_ColorG[i], particles.m_ColorB[i], particles.m_ColorA[i]);
+        out->m_Scale = Vector3(particles.m_ScaleX[i], particles.m_ScaleY[i], particles.m_ScaleZ[i]);
+        out->m_SortKey = particles.m_SortKey[i];
+        out->m_StretchFactorX = particles.m_StretchFactorX[i];
+        out->m_StretchFactorY = particles.m_StretchFactorY[i];
+        out->m_SourceAngularVelocity = particles.m_SourceAngularVelocity[i];
+    }
+
     static void InitEmitter(Emitter* emitter, dmParticleDDF::Emitter* emitter_ddf, uint32_t original_seed)
     {
         emitter->m_Id = dmHashString64(emitter_ddf->m_Id);
         uint32_t particle_count = emitter_ddf->m_MaxParticleCount;
-        emitter->m_Particles.SetCapacity(particle_count);
+        SetParticleCapacity(&emitter->m_Particles, particle_count);
         emitter->m_OriginalSeed = original_seed;
 
         uint32_t seed = original_seed;
@@ -253,7 +475,7 @@ namespace dmParticle
         for (uint32_t emitter_i = 0; emitter_i < emitter_count; ++emitter_i)
         {
             Emitter* emitter = &i->m_Emitters[emitter_i];
-            emitter->m_Particles.SetCapacity(0);
+            SetParticleCapacity(&emitter->m_Particles, 0);
             emitter->m_RenderConstants.SetCapacity(0);
         }
         delete i;
@@ -359,7 +581,7 @@ namespace dmParticle
             {
                 for (uint32_t emitter_i = prototype_emitter_count; emitter_i < emitter_count; ++emitter_i)
                 {
-                    emitters[emitter_i].m_Particles.SetCapacity(0);
+                    SetParticleCapacity(&emitters[emitter_i].m_Particles, 0);
                 }
             }
             emitters.SetCapacity(prototype_emitter_count);
@@ -467,9 +689,8 @@ namespace dmParticle
 
     static void ResetEmitter(Emitter* emitter)
     {
-        // Save particles array and id
-        dmArray<Particle> tmp;
-        tmp.Swap(emitter->m_Particles);
+        // Save particles buffer and id
+        ParticleBuffer particles = emitter->m_Particles;
         dmhash_t id = emitter->m_Id;
         uint32_t original_seed = emitter->m_OriginalSeed;
         float duration = emitter->m_Duration;
@@ -480,11 +701,11 @@ namespace dmParticle
         memset(emitter, 0, sizeof(Emitter));
 
         // Restore particles and id
-        tmp.Swap(emitter->m_Particles);
+        emitter->m_Particles = particles;
         emitter->m_Id = id;
 
         // Remove living particles
-        emitter->m_Particles.SetSize(0);
+        emitter->m_Particles.m_Size = 0;
 
         // Restore values
         emitter->m_OriginalSeed = original_seed;
@@ -731,17 +952,25 @@ namespace dmParticle
     {
         DM_PROFILE(Particle, "UpdateParticles");
 
-        // Step particle life, prune dead particles
-        uint32_t particle_count = emitter->m_Particles.Size();
+        ParticleBuffer& particles = emitter->m_Particles;
+        uint32_t particle_count = particles.Size();
+
+        // Step particle life
+        float* time_left = particles.m_TimeLeft;
+        const Float4 dt4 = Splat4(dt);
+        for (uint32_t j = 0; j < particle_count; j += 4)
+        {
+            Store4(time_left + j, Sub4(Load4(time_left + j), dt4));
+        }
+
+        // Prune dead particles
         uint32_t j = 0;
         while (j < particle_count)
         {
-            Particle* p = &emitter->m_Particles[j];
-            p->SetTimeLeft(p->GetTimeLeft() - dt);
-            if (p->GetTimeLeft() < 0.0f)
+            if (time_left[j] < 0.0f)
             {
                 // TODO Handle death-action
-                emitter->m_Particles.EraseSwap(j);
+                EraseSwapParticle(&particles, j);
                 --particle_count;
             } else {
                 ++j;
@@ -749,7 +978,7 @@ namespace dmParticle
         }
     }
 
-    static void SpawnParticle(dmArray<Particle>& particles, uint32_t* seed, dmParticleDDF::Emitter* ddf, const dmTransform::TransformS1& emitter_transform, Vector3 emitter_velocity, float emitter_properties[EMITTER_KEY_COUNT], float dt);
+    static void SpawnParticle(ParticleBuffer& particles, uint32_t* seed, dmParticleDDF::Emitter* ddf, const dmTransform::TransformS1& emitter_transform, Vector3 emitter_velocity, float emitter_properties[EMITTER_KEY_COUNT], float dt);
 
     static void UpdateEmitterState(Instance* instance, Emitter* emitter, EmitterPrototype* emitter_prototype, dmParticleDDF::Emitter* emitter_ddf, float dt)
     {
@@ -828,14 +1057,13 @@ namespace dmParticle
         return particle_count * vertices_per_particle;
     }
 
-    static void SpawnParticle(dmArray<Particle>& particles, uint32_t* seed, dmParticleDDF::Emitter* ddf, const dmTransform::TransformS1& emitter_transform, Vector3 emitter_velocity, float emitter_properties[EMITTER_KEY_COUNT], float dt)
+    static void SpawnParticle(ParticleBuffer& particles, uint32_t* seed, dmParticleDDF::Emitter* ddf, const dmTransform::TransformS1& emitter_transform, Vector3 emitter_velocity, float emitter_properties[EMITTER_KEY_COUNT], float dt)
     {
         DM_PROFILE(Particle, "Spawn");
 
-        uint32_t particle_count = particles.Size();
-        particles.SetSize(particle_count + 1);
-        Particle *particle = &particles[particle_count];
-        memset(particle, 0, sizeof(Particle));
+        Particle p;
+        memset(&p, 0, sizeof(Particle));
+        Particle* particle = &p;
 
         // TODO Handle birth-action
 
@@ -998,6 +1226,8 @@ namespace dmParticle
         particle->m_SourceStretchFactorY = emitter_properties[EMITTER_KEY_PARTICLE_STRETCH_FACTOR_Y];
         particle->m_StretchFactorY = particle->m_SourceStretchFactorY;
         particle->m_SourceAngularVelocity = emitter_properties[EMITTER_KEY_PARTICLE_ANGULAR_VELOCITY];
+
+        PushParticle(&particles, p);
     }
 
     static float unit_tex_coords[] =
@@ -1064,7 +1294,9 @@ namespace dmParticle
         }
 
         uint32_t max_vertex_count = vertex_buffer_size / vertex_size;
-        uint32_t particle_count = emitter->m_Particles.Size();
+        const ParticleBuffer& particles = emitter->m_Particles;
+        uint32_t particle_count = particles.Size();
+        uint32_t render_count = dmMath::Min(particle_count, vertex_index < max_vertex_count ? (max_vertex_count - vertex_index) / 6 : 0);
         uint32_t j;
 
         float width_factor = 1.0f;
@@ -1084,140 +1316,201 @@ namespace dmParticle
             height_factor *= 0.5f;
         }
 
-        for (j = 0; j < particle_count && vertex_index + 6 <= max_vertex_count; j++)
+        uint32_t flip_flag = 0;
+        if (hFlip)
         {
-            Particle* particle = &emitter->m_Particles[j];
-            // Evaluate anim frame
-            uint32_t tile = 0;
-            Vector3 size;
-            if (anim_playing)
+            flip_flag = 1;
+        }
+        if (vFlip)
+        {
+            flip_flag |= 2;
+        }
+        const int* tex_lookup = &tex_coord_order[flip_flag * 6];
+
+        const Quat emission_rotation = emission_transform.GetRotation();
+        const Float4 erx = Splat4(emission_rotation.getX());
+        const Float4 ery = Splat4(emission_rotation.getY());
+        const Float4 erz = Splat4(emission_rotation.getZ());
+        const Float4 erw = Splat4(emission_rotation.getW());
+        const Float4 es = Splat4(emission_transform.GetScale());
+        const Vector3 emission_translation = emission_transform.GetTranslation();
+        const Float4 etx = Splat4(emission_translation.getX());
+        const Float4 ety = Splat4(emission_translation.getY());
+        const Float4 etz = Splat4(emission_translation.getZ());
+        const Float4 zero = Splat4(0.0f);
+
+        // Per particle data of the current block of four particles
+        DM_ALIGNED(16) float extent_x[4];
+        DM_ALIGNED(16) float extent_y[4];
+        DM_ALIGNED(16) float corners[4][3][4];
+        DM_ALIGNED(16) float colors[4][4];
+        float* block_tex_coords[4];
+
+        for (j = 0; j < render_count; j += 4)
+        {
+            uint32_t block_count = dmMath::Min(render_count - j, 4u);
+
+            // Evaluate anim frames and quad extents
+            for (uint32_t l = 0; l < block_count; ++l)
             {
-                float anim_cursor = particle->GetMaxLifeTime() - particle->GetTimeLeft() - half_dt;
-                float anim_t = 0.0f;
-                if (anim_once) // stretch over particle life
-                {
-                    anim_t = anim_cursor * particle->GetooMaxLifeTime();
-                }
-                else // use anim FPS
+                uint32_t i = j + l;
+                uint32_t tile = 0;
+                float size_x;
+                float size_y;
+                if (anim_playing)
                 {
-                    anim_t = anim_cursor * inv_anim_length;
-                }
-                tile = (uint32_t)(tile_count * anim_t);
-                tile = tile % tile_count;
-                if (tile >= interval) {
-                    tile = (interval-1) * 2 - tile;
-                }
-                if (anim_bwd)
-                    tile = tile_count - tile - 1;
+                    float anim_cursor = particles.m_MaxLifeTime[i] - particles.m_TimeLeft[i] - half_dt;
+                    float anim_t = 0.0f;
+                    if (anim_once) // stretch over particle life
+                    {
+                        anim_t = anim_cursor * particles.m_ooMaxLifeTime[i];
+                    }
+                    else // use anim FPS
+                    {
+                        anim_t = anim_cursor * inv_anim_length;
+                    }
+                    tile = (uint32_t)(tile_count * anim_t);
+                    tile = tile % tile_count;
+                    if (tile >= interval) {
+                        tile = (interval-1) * 2 - tile;
+                    }
+                    if (anim_bwd)
+                        tile = tile_count - tile - 1;
 
-                size = particle->GetScale();
-                if(anim_auto_size)
-                {
-                    const float* td = &tex_dims[(start_tile + tile) << 1];
-                    width_factor = td[0] * 0.5;
-                    height_factor = td[1] * 0.5;
+                    size_x = particles.m_ScaleX[i];
+                    size_y = particles.m_ScaleY[i];
+                    if(anim_auto_size)
+                    {
+                        const float* td = &tex_dims[(start_tile + tile) << 1];
+                        width_factor = td[0] * 0.5;
+                        height_factor = td[1] * 0.5;
+                    }
+                    else
+                    {
+                        size_x *= particles.m_SourceSize[i];
+                        size_y *= particles.m_SourceSize[i];
+                    }
                 }
                 else
                 {
-                    size *= particle->GetSourceSize();
+                    size_x = particles.m_ScaleX[i] * particles.m_SourceSize[i];
+                    size_y = particles.m_ScaleY[i] * particles.m_SourceSize[i];
                 }
-            }
-            else
-            {
-                size = particle->GetScale() * particle->GetSourceSize();
-            }
-            tile += start_tile;
-            float* tex_coord = &tex_coords[tile << 3];
-
-            particle_transform.SetTranslation(Vector3(particle->GetPosition()));
-            particle_transform.SetRotation(particle->GetRotation());
-            particle_transform.SetScale(size);
-            particle_transform.SetRotation(emission_transform.GetRotation() * particle_transform.GetRotation());
-            particle_transform.SetTranslation(Vector3(Apply(emission_transform, Point3(particle_transform.GetTranslation()))));
-            particle_transform.SetScale(emission_transform.GetScale() * particle_transform.GetScale());
-
-            Vector3 x = dmTransform::Apply(particle_transform, Vector3(width_factor, 0.0f, 0.0f));
-            Vector3 y = dmTransform::Apply(particle_transform, Vector3(0.0f, height_factor, 0.0f));
-
-            Vector3 p0 = -x - y + particle_transform.GetTranslation();
-            Vector3 p1 = -x + y + particle_transform.GetTranslation();
-            Vector3 p2 = x - y + particle_transform.GetTranslation();
-            Vector3 p3 = x + y + particle_transform.GetTranslation();
-
-            uint32_t flip_flag = 0;
-            if (hFlip)
-            {
-                flip_flag = 1;
-            }
-            if (vFlip)
-            {
-                flip_flag |= 2;
-            }
-            const int* tex_lookup = &tex_coord_order[flip_flag * 6];
+                tile += start_tile;
+                block_tex_coords[l] = &tex_coords[tile << 3];
 
-            Vector4 c = particle->GetColor();
-            c = Vector4(mulPerElem(c.getXYZ(), color.getXYZ()), c.getW() * color.getW());
+                extent_x[l] = width_factor * (emission_transform.GetScale() * size_x);
+                extent_y[l] = height_factor * (emission_transform.GetScale() * size_y);
+            }
 
-            if (format == PARTICLE_GO)
+            // Particle rotation in emission space
+            const Quat* r = &particles.m_Rotation[j];
+            Float4 rx = Set4(r[0].getX(), r[1].getX(), r[2].getX(), r[3].getX());
+            Float4 ry = Set4(r[0].getY(), r[1].getY(), r[2].getY(), r[3].getY());
+            Float4 rz = Set4(r[0].getZ(), r[1].getZ(), r[2].getZ(), r[3].getZ());
+            Float4 rw = Set4(r[0].getW(), r[1].getW(), r[2].getW(), r[3].getW());
+            Float4 qx = Sub4(Add4(Add4(Mul4(erw, rx), Mul4(erx, rw)), Mul4(ery, rz)), Mul4(erz, ry));
+            Float4 qy = Sub4(Add4(Add4(Mul4(erw, ry), Mul4(ery, rw)), Mul4(erz, rx)), Mul4(erx, rz));
+            Float4 qz = Sub4(Add4(Add4(Mul4(erw, rz), Mul4(erz, rw)), Mul4(erx, ry)), Mul4(ery, rx));
+            Float4 qw = Sub4(Sub4(Sub4(Mul4(erw, rw), Mul4(erx, rx)), Mul4(ery, ry)), Mul4(erz, rz));
+
+            // Quad axes
+            Float4 xx, xy, xz, yx, yy, yz;
+            Rotate4(qx, qy, qz, qw, Load4(extent_x), zero, zero, &xx, &xy, &xz);
+            Rotate4(qx, qy, qz, qw, zero, Load4(extent_y), zero, &yx, &yy, &yz);
+
+            // Particle position in emission space
+            Float4 tx, ty, tz;
+            Rotate4(erx, ery, erz, erw, Mul4(Load4(&particles.m_PositionX[j]), es), Mul4(Load4(&particles.m_PositionY[j]), es), Mul4(Load4(&particles.m_PositionZ[j]), es), &tx, &ty, &tz);
+            tx = Add4(tx, etx);
+            ty = Add4(ty, ety);
+            tz = Add4(tz, etz);
+
+            // Corners p0 = -x - y, p1 = -x + y, p2 = x - y, p3 = x + y
+            Store4(corners[0][0], Add4(Sub4(Sub4(zero, xx), yx), tx));
+            Store4(corners[0][1], Add4(Sub4(Sub4(zero, xy), yy), ty));
+            Store4(corners[0][2], Add4(Sub4(Sub4(zero, xz), yz), tz));
+            Store4(corners[1][0], Add4(Add4(Sub4(zero, xx), yx), tx));
+            Store4(corners[1][1], Add4(Add4(Sub4(zero, xy), yy), ty));
+            Store4(corners[1][2], Add4(Add4(Sub4(zero, xz), yz), tz));
+            Store4(corners[2][0], Add4(Sub4(xx, yx), tx));
+            Store4(corners[2][1], Add4(Sub4(xy, yy), ty));
+            Store4(corners[2][2], Add4(Sub4(xz, yz), tz));
+            Store4(corners[3][0], Add4(Add4(xx, yx), tx));
+            Store4(corners[3][1], Add4(Add4(xy, yy), ty));
+            Store4(corners[3][2], Add4(Add4(xz, yz), tz));
+
+            Store4(colors[0], Mul4(Load4(&particles.m_ColorR[j]), Splat4(color.getX())));
+            Store4(colors[1], Mul4(Load4(&particles.m_ColorG[j]), Splat4(color.getY())));
+            Store4(colors[2], Mul4(Load4(&particles.m_ColorB[j]), Splat4(color.getZ())));
+            Store4(colors[3], Mul4(Load4(&particles.m_ColorA[j]), Splat4(color.getW())));
+
+            for (uint32_t l = 0; l < block_count; ++l)
             {
-                Vertex* vertex = &((Vertex*)vertex_buffer)[vertex_index];
-
-#define SET_VERTEX_GO(vertex, p, c, u, v)\
-    vertex->m_X = p.getX();\
-    vertex->m_Y = p.getY();\
-    vertex->m_Z = p.getZ();\
-    vertex->m_Red = c.getX();\
-    vertex->m_Green = c.getY();\
-    vertex->m_Blue = c.getZ();\
-    vertex->m_Alpha = c.getW();\
+                const float* tex_coord = block_tex_coords[l];
+
+                if (format == PARTICLE_GO)
+                {
+                    Vertex* vertex = &((Vertex*)vertex_buffer)[vertex_index];
+
+#define SET_VERTEX_GO(vertex, p, u, v)\
+    vertex->m_X = corners[p][0][l];\
+    vertex->m_Y = corners[p][1][l];\
+    vertex->m_Z = corners[p][2][l];\
+    vertex->m_Red = colors[0][l];\
+    vertex->m_Green = colors[1][l];\
+    vertex->m_Blue = colors[2][l];\
+    vertex->m_Alpha = colors[3][l];\
     vertex->m_U = u;\
     vertex->m_V = v;
 
-                SET_VERTEX_GO(vertex, p0, c, tex_coord[tex_lookup[0] * 2], tex_coord[tex_lookup[0] * 2 + 1])
-                ++vertex;
-                SET_VERTEX_GO(vertex, p1, c, tex_coord[tex_lookup[1] * 2], tex_coord[tex_lookup[1] * 2 + 1])
-                ++vertex;
-                SET_VERTEX_GO(vertex, p3, c, tex_coord[tex_lookup[2] * 2], tex_coord[tex_lookup[2] * 2 + 1])
-                ++vertex;
-                SET_VERTEX_GO(vertex, p3, c, tex_coord[tex_lookup[3] * 2], tex_coord[tex_lookup[3] * 2 + 1])
-                ++vertex;
-                SET_VERTEX_GO(vertex, p2, c, tex_coord[tex_lookup[4] * 2], tex_coord[tex_lookup[4] * 2 + 1])
-                ++vertex;
-                SET_VERTEX_GO(vertex, p0, c, tex_coord[tex_lookup[5] * 2], tex_coord[tex_lookup[5] * 2 + 1])
+                    SET_VERTEX_GO(vertex, 0, tex_coord[tex_lookup[0] * 2], tex_coord[tex_lookup[0] * 2 + 1])
+                    ++vertex;
+                    SET_VERTEX_GO(vertex, 1, tex_coord[tex_lookup[1] * 2], tex_coord[tex_lookup[1] * 2 + 1])
+                    ++vertex;
+                    SET_VERTEX_GO(vertex, 3, tex_coord[tex_lookup[2] * 2], tex_coord[tex_lookup[2] * 2 + 1])
+                    ++vertex;
+                    SET_VERTEX_GO(vertex, 3, tex_coord[tex_lookup[3] * 2], tex_coord[tex_lookup[3] * 2 + 1])
+                    ++vertex;
+                    SET_VERTEX_GO(vertex, 2, tex_coord[tex_lookup[4] * 2], tex_coord[tex_lookup[4] * 2 + 1])
+                    ++vertex;
+                    SET_VERTEX_GO(vertex, 0, tex_coord[tex_lookup[5] * 2], tex_coord[tex_lookup[5] * 2 + 1])
 
 #undef SET_VERTEX_GO
-            }
-            else if (format == PARTICLE_GUI)
-            {
-                ParticleGuiVertex* vertex = &((ParticleGuiVertex*)vertex_buffer)[vertex_index];
-
-#define SET_VERTEX_GUI(vertex, p, c, u, v)\
-    vertex->m_Position[0] = p.getX();\
-    vertex->m_Position[1] = p.getY();\
-    vertex->m_Position[2] = p.getZ();\
-    vertex->m_Color[0] = c.getX(); \
-    vertex->m_Color[1] = c.getY(); \
-    vertex->m_Color[2] = c.getZ(); \
-    vertex->m_Color[3] = c.getW(); \
+                }
+                else if (format == PARTICLE_GUI)
+                {
+                    ParticleGuiVertex* vertex = &((ParticleGuiVertex*)vertex_buffer)[vertex_index];
+
+#define SET_VERTEX_GUI(vertex, p, u, v)\
+    vertex->m_Position[0] = corners[p][0][l];\
+    vertex->m_Position[1] = corners[p][1][l];\
+    vertex->m_Position[2] = corners[p][2][l];\
+    vertex->m_Color[0] = colors[0][l]; \
+    vertex->m_Color[1] = colors[1][l]; \
+    vertex->m_Color[2] = colors[2][l]; \
+    vertex->m_Color[3] = colors[3][l]; \
     vertex->m_UV[0] = u;\
     vertex->m_UV[1] = v;
 
-                SET_VERTEX_GUI(vertex, p0, c, tex_coord[tex_lookup[0] * 2], tex_coord[tex_lookup[0] * 2 + 1])
-                ++vertex;
-                SET_VERTEX_GUI(vertex, p1, c, tex_coord[tex_lookup[1] * 2], tex_coord[tex_lookup[1] * 2 + 1])
-                ++vertex;
-                SET_VERTEX_GUI(vertex, p3, c, tex_coord[tex_lookup[2] * 2], tex_coord[tex_lookup[2] * 2 + 1])
-                ++vertex;
-                SET_VERTEX_GUI(vertex, p3, c, tex_coord[tex_lookup[3] * 2], tex_coord[tex_lookup[3] * 2 + 1])
-                ++vertex;
-                SET_VERTEX_GUI(vertex, p2, c, tex_coord[tex_lookup[4] * 2], tex_coord[tex_lookup[4] * 2 + 1])
-                ++vertex;
-                SET_VERTEX_GUI(vertex, p0, c, tex_coord[tex_lookup[5] * 2], tex_coord[tex_lookup[5] * 2 + 1])
+                    SET_VERTEX_GUI(vertex, 0, tex_coord[tex_lookup[0] * 2], tex_coord[tex_lookup[0] * 2 + 1])
+                    ++vertex;
+                    SET_VERTEX_GUI(vertex, 1, tex_coord[tex_lookup[1] * 2], tex_coord[tex_lookup[1] * 2 + 1])
+                    ++vertex;
+                    SET_VERTEX_GUI(vertex, 3, tex_coord[tex_lookup[2] * 2], tex_coord[tex_lookup[2] * 2 + 1])
+                    ++vertex;
+                    SET_VERTEX_GUI(vertex, 3, tex_coord[tex_lookup[3] * 2], tex_coord[tex_lookup[3] * 2 + 1])
+                    ++vertex;
+                    SET_VERTEX_GUI(vertex, 2, tex_coord[tex_lookup[4] * 2], tex_coord[tex_lookup[4] * 2 + 1])
+                    ++vertex;
+                    SET_VERTEX_GUI(vertex, 0, tex_coord[tex_lookup[5] * 2], tex_coord[tex_lookup[5] * 2 + 1])
 #undef SET_VERTEX_GUI
-            }
+                }
 
-            vertex_index += 6;
+                vertex_index += 6;
+            }
         }
+        j = render_count;
         if (j < particle_count)
         {
             if (emitter->m_RenderWarning == 0)
@@ -1235,43 +1528,62 @@ namespace dmParticle
         return emitter->m_VertexCount;
     }
 
-    struct SortPred
-    {
-        inline bool operator () (const Particle& p1, const Particle& p2)
-        {
-            return p1.GetSortKey().m_Key < p2.GetSortKey().m_Key;
-        }
-
-    };
-
     void GenerateKeys(Emitter* emitter, float max_particle_life_time)
     {
-        dmArray<Particle>& particles = emitter->m_Particles;
+        ParticleBuffer& particles = emitter->m_Particles;
         uint32_t n = particles.Size();
 
         float range = 1.0f / max_particle_life_time;
 
-        Particle* first = particles.Begin();
         for (uint32_t i = 0; i < n; ++i)
         {
-            Particle* p = &particles[i];
-            uint32_t index = p - first;
-
-            float life_time = (1.0f - p->GetTimeLeft() * range) * 65535;
+            float life_time = (1.0f - particles.m_TimeLeft[i] * range) * 65535;
             life_time = dmMath::Clamp(life_time, 0.0f, 65535.0f);
             uint16_t lt = (uint16_t) life_time;
             SortKey key;
             key.m_LifeTime = lt;
-            key.m_Index = index;
-            p->SetSortKey(key);
+            key.m_Index = i;
+            particles.m_SortKey[i] = key;
         }
     }
 
+    template <typename T>
+    static void PermuteStream(T* stream, const uint64_t* order, uint32_t count, void* scratch)
+    {
+        T* tmp = (T*)scratch;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            tmp[i] = stream[(uint32_t)order[i]];
+        }
+        memcpy(stream, tmp, count * sizeof(T));
+    }
+
     void SortParticles(Emitter* emitter)
     {
         DM_PROFILE(Particle, "Sort");
 
-        std::sort(emitter->m_Particles.Begin(), emitter->m_Particles.End(), SortPred());
+        // Sort (key, index) pairs rather than moving whole particles around, then reorder each stream once
+        ParticleBuffer& particles = emitter->m_Particles;
+        uint32_t count = particles.Size();
+        uint64_t* order = (uint64_t*)particles.m_Scratch;
+        bool sorted = true;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            order[i] = ((uint64_t)particles.m_SortKey[i].m_Key << 32) | i;
+            sorted = sorted && (i == 0 || order[i - 1] <= order[i]);
+        }
+        if (sorted)
+            return;
+
+        std::sort(order, order + count);
+
+        void* scratch = order + GetParticleStreamStride(particles.Capacity());
+        PermuteStream(particles.m_SourceRotation, order, count, scratch);
+        PermuteStream(particles.m_Rotation, order, count, scratch);
+#define DM_PARTICLE_PERMUTE_STREAM(name) PermuteStream(particles.m_##name, order, count, scratch);
+        DM_PARTICLE_FLOAT_STREAMS(DM_PARTICLE_PERMUTE_STREAM)
+#undef DM_PARTICLE_PERMUTE_STREAM
+        PermuteStream(particles.m_SortKey, order, count, scratch);
     }
 
 #define SAMPLE_PROP(segment, x, target)\
@@ -1290,78 +1602,102 @@ namespace dmParticle
         }
     }
 
+    static inline float GetParticleLifeSample(const ParticleBuffer& particles, uint32_t i, uint32_t* segment_index)
+    {
+        float x = dmMath::Select(-particles.m_MaxLifeTime[i], 0.0f, 1.0f - particles.m_TimeLeft[i] * particles.m_ooMaxLifeTime[i]);
+        *segment_index = dmMath::Min((uint32_t)(x * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
+        return x;
+    }
+
+    static inline Float4 SampleProperty4(const Property& property, const uint32_t segment_index[4], Float4 x)
+    {
+        const LinearSegment* s0 = &property.m_Segments[segment_index[0]];
+        const LinearSegment* s1 = &property.m_Segments[segment_index[1]];
+        const LinearSegment* s2 = &property.m_Segments[segment_index[2]];
+        const LinearSegment* s3 = &property.m_Segments[segment_index[3]];
+        Float4 sx = Set4(s0->m_X, s1->m_X, s2->m_X, s3->m_X);
+        Float4 sk = Set4(s0->m_K, s1->m_K, s2->m_K, s3->m_K);
+        Float4 sy = Set4(s0->m_Y, s1->m_Y, s2->m_Y, s3->m_Y);
+        return MulAdd4(Sub4(x, sx), sk, sy);
+    }
+
     void EvaluateParticleProperties(Emitter* emitter, Property* particle_properties, dmParticleDDF::Emitter* emitter_ddf, float dt)
     {
         float properties[PARTICLE_KEY_COUNT];
-        // TODO Optimize this
-        dmArray<Particle>& particles = emitter->m_Particles;
+        ParticleBuffer& particles = emitter->m_Particles;
         uint32_t count = particles.Size();
-        for (uint32_t i = 0; i < count; ++i)
-        {
-            Particle* particle = &particles[i];
-            float x = dmMath::Select(-particle->GetMaxLifeTime(), 0.0f, 1.0f - particle->GetTimeLeft() * particle->GetooMaxLifeTime());
-            uint32_t segment_index = dmMath::Min((uint32_t)(x * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
-
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_SCALE].m_Segments[segment_index], x, properties[PARTICLE_KEY_SCALE])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_RED].m_Segments[segment_index], x, properties[PARTICLE_KEY_RED])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_GREEN].m_Segments[segment_index], x, properties[PARTICLE_KEY_GREEN])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_BLUE].m_Segments[segment_index], x, properties[PARTICLE_KEY_BLUE])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_ALPHA].m_Segments[segment_index], x, properties[PARTICLE_KEY_ALPHA])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_STRETCH_FACTOR_X].m_Segments[segment_index], x, properties[PARTICLE_KEY_STRETCH_FACTOR_X])
-            SAMPLE_PROP(particle_properties[PARTICLE_KEY_STRETCH_FACTOR_Y].m_Segments[segment_index], x, properties[PARTICLE_KEY_STRETCH_FACTOR_Y])
-            Vector4 c = particle->GetSourceColor();
-            particle->SetScale(Vector3(properties[PARTICLE_KEY_SCALE]));
-            particle->SetColor(Vector4(dmMath::Clamp(c.getX() * properties[PARTICLE_KEY_RED], 0.0f, 1.0f),
-                    dmMath::Clamp(c.getY() * properties[PARTICLE_KEY_GREEN], 0.0f, 1.0f),
-                    dmMath::Clamp(c.getZ() * properties[PARTICLE_KEY_BLUE], 0.0f, 1.0f),
-                    dmMath::Clamp(c.getW() * properties[PARTICLE_KEY_ALPHA], 0.0f, 1.0f)));
-            particle->m_StretchFactorX = particle->m_SourceStretchFactorX + (properties[PARTICLE_KEY_STRETCH_FACTOR_X]);
-            particle->m_StretchFactorY = particle->m_SourceStretchFactorY + (properties[PARTICLE_KEY_STRETCH_FACTOR_Y]);
+
+        const Float4 zero = Splat4(0.0f);
+        const Float4 one = Splat4(1.0f);
+        const Float4 sample_count = Splat4((float)PROPERTY_SAMPLE_COUNT);
+        const Float4 max_segment = Splat4((float)(PROPERTY_SAMPLE_COUNT - 1));
+        DM_ALIGNED(16) float segment[4];
+        uint32_t segment_index[4];
+        for (uint32_t i = 0; i < count; i += 4)
+        {
+            Float4 x = Sub4(one, Mul4(Load4(&particles.m_TimeLeft[i]), Load4(&particles.m_ooMaxLifeTime[i])));
+            x = SelectPositive4(Load4(&particles.m_MaxLifeTime[i]), x, zero);
+            // Clamp before the conversion, which also keeps the indices of the unused slots in range
+            Store4(segment, Clamp4(Mul4(x, sample_count), zero, max_segment));
+            for (uint32_t l = 0; l < 4; ++l)
+            {
+                segment_index[l] = (uint32_t)segment[l];
+            }
+
+            Float4 scale = SampleProperty4(particle_properties[PARTICLE_KEY_SCALE], segment_index, x);
+            Store4(&particles.m_ScaleX[i], scale);
+            Store4(&particles.m_ScaleY[i], scale);
+            Store4(&particles.m_ScaleZ[i], scale);
+
+            Store4(&particles.m_ColorR[i], Clamp4(Mul4(Load4(&particles.m_SourceColorR[i]), SampleProperty4(particle_properties[PARTICLE_KEY_RED], segment_index, x)), zero, one));
+            Store4(&particles.m_ColorG[i], Clamp4(Mul4(Load4(&particles.m_SourceColorG[i]), SampleProperty4(particle_properties[PARTICLE_KEY_GREEN], segment_index, x)), zero, one));
+            Store4(&particles.m_ColorB[i], Clamp4(Mul4(Load4(&particles.m_SourceColorB[i]), SampleProperty4(particle_properties[PARTICLE_KEY_BLUE], segment_index, x)), zero, one));
+            Store4(&particles.m_ColorA[i], Clamp4(Mul4(Load4(&particles.m_SourceColorA[i]), SampleProperty4(particle_properties[PARTICLE_KEY_ALPHA], segment_index, x)), zero, one));
+
+            Store4(&particles.m_StretchFactorX[i], Add4(Load4(&particles.m_SourceStretchFactorX[i]), SampleProperty4(particle_properties[PARTICLE_KEY_STRETCH_FACTOR_X], segment_index, x)));
+            Store4(&particles.m_StretchFactorY[i], Add4(Load4(&particles.m_SourceStretchFactorY[i]), SampleProperty4(particle_properties[PARTICLE_KEY_STRETCH_FACTOR_Y], segment_index, x)));
         }
 
         if (emitter_ddf->m_ParticleOrientation == PARTICLE_ORIENTATION_MOVEMENT_DIRECTION) {
             for (uint32_t i = 0; i < count; ++i)
             {
-                Particle* particle = &particles[i];
-                float x = dmMath::Select(-particle->GetMaxLifeTime(), 0.0f, 1.0f - particle->GetTimeLeft() * particle->GetooMaxLifeTime());
-                uint32_t segment_index = dmMath::Min((uint32_t)(x * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
+                uint32_t segment_index;
+                float x = GetParticleLifeSample(particles, i, &segment_index);
                 SAMPLE_PROP(particle_properties[PARTICLE_KEY_ROTATION].m_Segments[segment_index], x, properties[PARTICLE_KEY_ROTATION])
-                particle->SetRotation(particle->GetSourceRotation() * dmVMath::QuatFromAngle(2, DEG_RAD * properties[PARTICLE_KEY_ROTATION]));
-                if (lengthSqr(particle->m_Velocity) > EPSILON)
+                particles.m_Rotation[i] = particles.m_SourceRotation[i] * dmVMath::QuatFromAngle(2, DEG_RAD * properties[PARTICLE_KEY_ROTATION]);
+                Vector3 velocity(particles.m_VelocityX[i], particles.m_VelocityY[i], particles.m_VelocityZ[i]);
+                if (lengthSqr(velocity) > EPSILON)
                 {
-                    Vector3 vel_norm = normalize(particle->m_Velocity);
+                    Vector3 vel_norm = normalize(velocity);
                     float y_dot = dot(Vector3::yAxis(), vel_norm);
                     // Corner case, https://gamedev.stackexchange.com/questions/61672/align-a-rotation-to-a-direction
                     Quat q_vel = (dmMath::Abs(y_dot + 1.0f) > EPSILON) ? Quat::rotation(Vector3::yAxis(), vel_norm) : Quat(0.0, 0.0, 1.0, 0.0);
-                    Quat q = particle->GetRotation() * q_vel;
-                    particle->SetRotation(q);
+                    particles.m_Rotation[i] = particles.m_Rotation[i] * q_vel;
                 }
             }
 
         } else if (emitter_ddf->m_ParticleOrientation == PARTICLE_ORIENTATION_ANGULAR_VELOCITY) {
             for (uint32_t i = 0; i < count; ++i)
             {
-                Particle* particle = &particles[i];
-                float x = dmMath::Select(-particle->GetMaxLifeTime(), 0.0f, 1.0f - particle->GetTimeLeft() * particle->GetooMaxLifeTime());
-                uint32_t segment_index = dmMath::Min((uint32_t)(x * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
+                uint32_t segment_index;
+                float x = GetParticleLifeSample(particles, i, &segment_index);
                 SAMPLE_PROP(particle_properties[PARTICLE_KEY_ANGULAR_VELOCITY].m_Segments[segment_index], x, properties[PARTICLE_KEY_ANGULAR_VELOCITY])
-                particle->SetRotation(particle->GetRotation() * Quat::rotationZ(DEG_RAD * (particle->m_SourceAngularVelocity * (properties[PARTICLE_KEY_ANGULAR_VELOCITY])) * dt));
+                particles.m_Rotation[i] = particles.m_Rotation[i] * Quat::rotationZ(DEG_RAD * (particles.m_SourceAngularVelocity[i] * (properties[PARTICLE_KEY_ANGULAR_VELOCITY])) * dt);
             }
 
         } else {
             for (uint32_t i = 0; i < count; ++i)
             {
-                Particle* particle = &particles[i];
-                float x = dmMath::Select(-particle->GetMaxLifeTime(), 0.0f, 1.0f - particle->GetTimeLeft() * particle->GetooMaxLifeTime());
-                uint32_t segment_index = dmMath::Min((uint32_t)(x * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
+                uint32_t segment_index;
+                float x = GetParticleLifeSample(particles, i, &segment_index);
                 SAMPLE_PROP(particle_properties[PARTICLE_KEY_ROTATION].m_Segments[segment_index], x, properties[PARTICLE_KEY_ROTATION])
-                particle->SetRotation(particle->GetSourceRotation() * dmVMath::QuatFromAngle(2, DEG_RAD * properties[PARTICLE_KEY_ROTATION]));
+                particles.m_Rotation[i] = particles.m_SourceRotation[i] * dmVMath::QuatFromAngle(2, DEG_RAD * properties[PARTICLE_KEY_ROTATION]);
             }
         }
 
     }
 
-    void ApplyAcceleration(dmArray<Particle>& particles, Property* modifier_properties, const Quat& rotation, float scale, float emitter_t, float dt)
+    void ApplyAcceleration(ParticleBuffer& particles, Property* modifier_properties, const Quat& rotation, float scale, float emitter_t, float dt)
     {
         uint32_t particle_count = particles.Size();
         Vector3 acc_step = rotate(rotation, ACCELERATION_LOCAL_DIR) * dt * scale;
@@ -1369,15 +1705,21 @@ namespace dmParticle
         uint32_t segment_index = dmMath::Min((uint32_t)(emitter_t * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
         float magnitude;
         SAMPLE_PROP(magnitude_property.m_Segments[segment_index], emitter_t, magnitude)
-        float mag_spread = magnitude_property.m_Spread;
-        for (uint32_t i = 0; i < particle_count; ++i)
+        const Float4 mag = Splat4(magnitude);
+        const Float4 mag_spread = Splat4(magnitude_property.m_Spread);
+        const Float4 acc_x = Splat4(acc_step.getX());
+        const Float4 acc_y = Splat4(acc_step.getY());
+        const Float4 acc_z = Splat4(acc_step.getZ());
+        for (uint32_t i = 0; i < particle_count; i += 4)
         {
-            Particle* particle = &particles[i];
-            particle->SetVelocity(particle->GetVelocity() + acc_step * (magnitude + mag_spread * particle->GetSpreadFactor()));
+            Float4 f = MulAdd4(mag_spread, Load4(&particles.m_SpreadFactor[i]), mag);
+            Store4(&particles.m_VelocityX[i], MulAdd4(acc_x, f, Load4(&particles.m_VelocityX[i])));
+            Store4(&particles.m_VelocityY[i], MulAdd4(acc_y, f, Load4(&particles.m_VelocityY[i])));
+            Store4(&particles.m_VelocityZ[i], MulAdd4(acc_z, f, Load4(&particles.m_VelocityZ[i])));
         }
     }
 
-    void ApplyDrag(dmArray<Particle>& particles, Property* modifier_properties, dmParticleDDF::Modifier* modifier_ddf, const Quat& rotation, float emitter_t, float dt)
+    void ApplyDrag(ParticleBuffer& particles, Property* modifier_properties, dmParticleDDF::Modifier* modifier_ddf, const Quat& rotation, float emitter_t, float dt)
     {
         uint32_t particle_count = particles.Size();
         Vector3 direction = rotate(rotation, DRAG_LOCAL_DIR);
@@ -1385,22 +1727,52 @@ namespace dmParticle
         uint32_t segment_index = dmMath::Min((uint32_t)(emitter_t * PROPERTY_SAMPLE_COUNT), PROPERTY_SAMPLE_COUNT - 1);
         float magnitude;
         SAMPLE_PROP(magnitude_property.m_Segments[segment_index], emitter_t, magnitude)
-        float mag_spread = magnitude_property.m_Spread;
-        for (uint32_t i = 0; i < particle_count; ++i)
-        {
-            Particle* particle = &particles[i];
-            Vector3 v = particle->GetVelocity();
-            if (modifier_ddf->m_UseDirection)
-                v = projection(Point3(particle->GetVelocity()), direction) * direction;
+        const Float4 mag = Splat4(magnitude);
+        const Float4 mag_spread = Splat4(magnitude_property.m_Spread);
+        const Float4 dt4 = Splat4(dt);
+        const Float4 one = Splat4(1.0f);
+        const Float4 dir_x = Splat4(direction.getX());
+        const Float4 dir_y = Splat4(direction.getY());
+        const Float4 dir_z = Splat4(direction.getZ());
+        const bool use_direction = modifier_ddf->m_UseDirection != 0;
+        for (uint32_t i = 0; i < particle_count; i += 4)
+        {
+            Float4 vel_x = Load4(&particles.m_VelocityX[i]);
+            Float4 vel_y = Load4(&particles.m_VelocityY[i]);
+            Float4 vel_z = Load4(&particles.m_VelocityZ[i]);
+            Float4 v_x = vel_x;
+            Float4 v_y = vel_y;
+            Float4 v_z = vel_z;
+            if (use_direction)
+            {
+                Float4 p = Add4(Add4(Mul4(vel_x, dir_x), Mul4(vel_y, dir_y)), Mul4(vel_z, dir_z));
+                v_x = Mul4(dir_x, p);
+                v_y = Mul4(dir_y, p);
+                v_z = Mul4(dir_z, p);
+            }
             // Applied drag > 1 means the particle would travel in the reverse direction
-            float applied_drag = dmMath::Min((magnitude + mag_spread * particle->GetSpreadFactor()) * dt, 1.0f);
-            particle->SetVelocity(particle->GetVelocity() - v * applied_drag);
+            Float4 applied_drag = Min4(Mul4(MulAdd4(mag_spread, Load4(&particles.m_SpreadFactor[i]), mag), dt4), one);
+            Store4(&particles.m_VelocityX[i], Sub4(vel_x, Mul4(v_x, applied_drag)));
+            Store4(&particles.m_VelocityY[i], Sub4(vel_y, Mul4(v_y, applied_drag)));
+            Store4(&particles.m_VelocityZ[i], Sub4(vel_z, Mul4(v_z, applied_drag)));
         }
     }
 
-    static Vector3 GetParticleDir(Particle* particle)
+    static Vector3 GetParticleDir(const ParticleBuffer& particles, uint32_t i)
     {
-        return rotate(particle->GetRotation(), PARTICLE_LOCAL_BASE_DIR);
+        return rotate(particles.m_Rotation[i], PARTICLE_LOCAL_BASE_DIR);
+    }
+
+    static inline Point3 GetParticlePosition(const ParticleBuffer& particles, uint32_t i)
+    {
+        return Point3(particles.m_PositionX[i], particles.m_PositionY[i], particles.m_PositionZ[i]);
+    }
+
+    static inline void AddParticleVelocity(ParticleBuffer& particles, uint32_t i, const Vector3& v)
+    {
+        particles.m_VelocityX[i] += v.getX();
+        particles.m_VelocityY[i] += v.getY();
+        particles.m_VelocityZ[i] += v.getZ();
     }
 
     static Vector3 NonZeroVector3(Vector3 v, float sq_length, Vector3 fallback)
@@ -1413,7 +1785,7 @@ namespace dmParticle
         return result;
     }
 
-    void ApplyRadial(dmArray<Particle>& particles, Property* modifier_properties, const Point3& position, float scale, float emitter_t, float dt)
+    void ApplyRadial(ParticleBuffer& particles, Property* modifier_properties, const Point3& position, float scale, float emitter_t, float dt)
     {
         uint32_t particle_count = particles.Size();
         const Property& magnitude_property = modifier_properties[MODIFIER_KEY_MAGNITUDE];
@@ -1428,18 +1800,17 @@ namespace dmParticle
         float applied_factor = dt * scale;
         for (uint32_t i = 0; i < particle_count; ++i)
         {
-            Particle* particle = &particles[i];
-            Vector3 delta = particle->GetPosition() - position;
+            Vector3 delta = GetParticlePosition(particles, i) - position;
             float delta_sq_len = lengthSqr(delta);
-            float applied_magnitude = magnitude + mag_spread * particle->GetSpreadFactor();
+            float applied_magnitude = magnitude + mag_spread * particles.m_SpreadFactor[i];
             // 0 acc delta lies outside max dist
             float a = dmMath::Select(max_sq_distance - delta_sq_len, applied_magnitude, 0.0f);
-            Vector3 dir = normalize(NonZeroVector3(delta, delta_sq_len, GetParticleDir(particle)));
-            particle->SetVelocity(particle->GetVelocity() + dir * a * applied_factor);
+            Vector3 dir = normalize(NonZeroVector3(delta, delta_sq_len, GetParticleDir(particles, i)));
+            AddParticleVelocity(particles, i, dir * a * applied_factor);
         }
     }
 
-    void ApplyVortex(dmArray<Particle>& particles, Property* modifier_properties, const Point3& position, const Quat& rotation, float scale, float emitter_t, float dt)
+    void ApplyVortex(ParticleBuffer& particles, Property* modifier_properties, const Point3& position, const Quat& rotation, float scale, float emitter_t, float dt)
     {
         uint32_t particle_count = particles.Size();
         const Property& magnitude_property = modifier_properties[MODIFIER_KEY_MAGNITUDE];
@@ -1456,9 +1827,8 @@ namespace dmParticle
         float applied_factor = dt * scale;
         for (uint32_t i = 0; i < particle_count; ++i)
         {
-            Particle* particle = &particles[i];
             // delta from vortex position
-            Vector3 delta = particle->GetPosition() - position;
+            Vector3 delta = GetParticlePosition(particles, i) - position;
             // normal from vortex axis (non-unit)
             Vector3 normal = delta - projection(Point3(delta), axis) * axis;
             // tangent is the direction of the vortex acceleration
@@ -1469,8 +1839,8 @@ namespace dmParticle
             tangent = normalize(tangent);
             // use normal for max distance test
             float normal_sq_len = lengthSqr(normal);
-            float acceleration = dmMath::Select(max_sq_distance - normal_sq_len, magnitude + mag_spread * particle->GetSpreadFactor(), 0.0f);
-            particle->SetVelocity(particle->GetVelocity() + tangent * acceleration * applied_factor);
+            float acceleration = dmMath::Select(max_sq_distance - normal_sq_len, magnitude + mag_spread * particles.m_SpreadFactor[i], 0.0f);
+            AddParticleVelocity(particles, i, tangent * acceleration * applied_factor);
         }
     }
 
@@ -1499,7 +1869,7 @@ namespace dmParticle
     {
         DM_PROFILE(Particle, "Simulate");
 
-        dmArray<Particle>& particles = emitter->m_Particles;
+        ParticleBuffer& particles = emitter->m_Particles;
         EvaluateParticleProperties(emitter, prototype->m_ParticleProperties, ddf, dt);
         float emitter_t = dmMath::Select(-ddf->m_Duration, 0.0f, emitter->m_Timer / ddf->m_Duration);
         float scale = 1.0f;
@@ -1541,18 +1911,29 @@ namespace dmParticle
             }
         }
         uint32_t particle_count = particles.Size();
-        for (uint32_t i = 0; i < particle_count; ++i)
+        const Float4 dt4 = Splat4(dt);
+        const Float4 stretch_scaling = Splat4(STRETCH_SCALING);
+        for (uint32_t i = 0; i < particle_count; i += 4)
         {
-            Particle* p = &particles[i];
+            Float4 vel_x = Load4(&particles.m_VelocityX[i]);
+            Float4 vel_y = Load4(&particles.m_VelocityY[i]);
+            Float4 vel_z = Load4(&particles.m_VelocityZ[i]);
             // NOTE This velocity integration has a larger error than normal since we don't use the velocity at the
             // beginning of the frame, but it's ok since particle movement does not need to be very exact
-            p->SetPosition(p->GetPosition() + p->m_Velocity * dt);
-
-            p->m_Scale[0] += p->m_Scale[0] * p->m_StretchFactorX;
-            if (!ddf->m_StretchWithVelocity)
-                p->m_Scale[1] += p->m_Scale[1] * p->m_StretchFactorY;
-            else
-                p->m_Scale[1] += p->m_Scale[1] * p->m_StretchFactorY * length(p->m_Velocity) * STRETCH_SCALING;
+            Store4(&particles.m_PositionX[i], MulAdd4(vel_x, dt4, Load4(&particles.m_PositionX[i])));
+            Store4(&particles.m_PositionY[i], MulAdd4(vel_y, dt4, Load4(&particles.m_PositionY[i])));
+            Store4(&particles.m_PositionZ[i], MulAdd4(vel_z, dt4, Load4(&particles.m_PositionZ[i])));
+
+            Float4 scale_x = Load4(&particles.m_ScaleX[i]);
+            Store4(&particles.m_ScaleX[i], MulAdd4(scale_x, Load4(&particles.m_StretchFactorX[i]), scale_x));
+            Float4 scale_y = Load4(&particles.m_ScaleY[i]);
+            Float4 stretch_y = Mul4(scale_y, Load4(&particles.m_StretchFactorY[i]));
+            if (ddf->m_StretchWithVelocity)
+            {
+                Float4 speed = Sqrt4(Add4(Add4(Mul4(vel_x, vel_x), Mul4(vel_y, vel_y)), Mul4(vel_z, vel_z)));
+                stretch_y = Mul4(Mul4(stretch_y, speed), stretch_scaling);
+            }
+            Store4(&particles.m_ScaleY[i], Add4(scale_y, stretch_y));
         }
     }
 
@@ -42,7 +42,8 @@ namespace dmParticle
     };
 
     /**
-     * Representation of a particle.
+     * Representation of a single particle, unpacked from a ParticleBuffer.
+     * Used when spawning particles and when inspecting them in tests.
      *
      * TODO Separate source state from current (chaining modifiers)
      */
@@ -101,6 +102,49 @@ namespace dmParticle
         float       m_SourceAngularVelocity;
     };
 
+    /// The float streams of a ParticleBuffer
+#define DM_PARTICLE_FLOAT_STREAMS(STREAM)\
+        STREAM(PositionX) STREAM(PositionY) STREAM(PositionZ)\
+        STREAM(VelocityX) STREAM(VelocityY) STREAM(VelocityZ)\
+        STREAM(TimeLeft) STREAM(MaxLifeTime) STREAM(ooMaxLifeTime)\
+        STREAM(SpreadFactor) STREAM(SourceSize)\
+        STREAM(SourceStretchFactorX) STREAM(SourceStretchFactorY)\
+        STREAM(SourceColorR) STREAM(SourceColorG) STREAM(SourceColorB) STREAM(SourceColorA)\
+        STREAM(ColorR) STREAM(ColorG) STREAM(ColorB) STREAM(ColorA)\
+        STREAM(ScaleX) STREAM(ScaleY) STREAM(ScaleZ)\
+        STREAM(StretchFactorX) STREAM(StretchFactorY)\
+        STREAM(SourceAngularVelocity)
+
+    /**
+     * Particle storage with one stream per particle attribute (structure of arrays).
+     *
+     * All streams live in a single 16 byte aligned allocation and every stream is padded
+     * to a multiple of four particles, which lets the simulation process four particles
+     * at a time without a scalar tail. A zeroed buffer is a valid empty buffer.
+     */
+    struct ParticleBuffer
+    {
+        uint32_t Size() const       { return m_Size; }
+        uint32_t Capacity() const   { return m_Capacity; }
+        uint32_t Remaining() const  { return m_Capacity - m_Size; }
+        bool     Empty() const      { return m_Size == 0; }
+        bool     Full() const       { return m_Size == m_Capacity; }
+
+        /// Rotation streams, see Particle
+        Quat*       m_SourceRotation;
+        Quat*       m_Rotation;
+#define DM_PARTICLE_DECLARE_STREAM(name) float* m_##name;
+        DM_PARTICLE_FLOAT_STREAMS(DM_PARTICLE_DECLARE_STREAM)
+#undef DM_PARTICLE_DECLARE_STREAM
+        SortKey*    m_SortKey;
+        /// Scratch memory used when sorting the particles
+        void*       m_Scratch;
+        /// The allocation backing all streams
+        void*       m_Memory;
+        uint32_t    m_Size;
+        uint32_t    m_Capacity;
+    };
+
     /**
      * Representation of an emitter.
      */
@@ -113,7 +157,7 @@ namespace dmParticle
 
         AnimationData           m_AnimationData;
         /// Particle buffer.
-        dmArray<Particle>       m_Particles;
+        ParticleBuffer          m_Particles;
         dmArray<RenderConstant> m_RenderConstants;
         Vector3                 m_Velocity;
         Point3                  m_LastPosition;
@@ -286,6 +330,37 @@ namespace dmParticle
     };
 
     void UpdateRenderData(HParticleContext context, HInstance instance, uint32_t emitter_index);
+
+    /**
+     * Set the capacity of a particle buffer, keeping as many of the existing particles as fit.
+     * A capacity of 0 frees the buffer.
+     * @param particles Particle buffer
+     * @param capacity New capacity
+     */
+    void SetParticleCapacity(ParticleBuffer* particles, uint32_t capacity);
+
+    /**
+     * Append a particle to a particle buffer, which must not be full.
+     * @param particles Particle buffer
+     * @param particle Particle to append
+     */
+    void PushParticle(ParticleBuffer* particles, const Particle& particle);
+
+    /**
+     * Remove a particle by moving the last particle into its slot.
+     * @param particles Particle buffer
+     * @param index Index of the particle to remove
+     */
+    void EraseSwapParticle(ParticleBuffer* particles, uint32_t index);
+
+    /**
+     * Unpack a particle from a particle buffer. The particle is cleared first, so two
+     * unpacked particles can be compared with memcmp.
+     * @param particles Particle buffer
+     * @param index Index of the particle
+     * @param out Unpacked particle
+     */
+    void GetParticle(const ParticleBuffer& particles, uint32_t index, Particle* out);
 }
 
 #endif // DM_PARTICLE_PRIVATE_H
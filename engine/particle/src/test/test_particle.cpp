@@ -13,12 +13,14 @@
 #define JC_TEST_IMPLEMENTATION
 #include <jc_test/jc_test.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <algorithm>
 #include <map>
 
 #include <dlib/dstrings.h>
 #include <dlib/log.h>
 #include <dlib/math.h>
+#include <dlib/time.h>
 #include <dlib/vmath.h>
 
 #include <ddf/ddf.h>
@@ -168,6 +170,14 @@ uint32_t ParticleCount(dmParticle::Emitter* emitter)
     return emitter->m_Particles.Size();
 }
 
+// Snapshot of a particle, which needs to be fetched again after updating
+dmParticle::Particle GetEmitterParticle(dmParticle::Emitter* emitter, uint32_t index)
+{
+    dmParticle::Particle particle;
+    dmParticle::GetParticle(emitter->m_Particles, index, &particle);
+    return particle;
+}
+
 bool LoadPrototype(const char* filename, dmParticle::HPrototype* prototype)
 {
     char path[128];
@@ -703,8 +713,8 @@ TEST_F(ParticleTest, EmissionSpace)
     dmParticle::Update(m_Context, dt, 0x0);
 
     dmParticle::Emitter* e = GetEmitter(m_Context, instance, 0);
-    dmParticle::Particle* p = &e->m_Particles[0];
-    ASSERT_EQ(10.0f, p->GetPosition().getX());
+    dmParticle::Particle p = GetEmitterParticle(e, 0);
+    ASSERT_EQ(10.0f, p.GetPosition().getX());
 
     dmParticle::DestroyInstance(m_Context, instance);
     dmParticle::Particle_DeletePrototype(m_Prototype);
@@ -720,8 +730,8 @@ TEST_F(ParticleTest, EmissionSpace)
     dmParticle::Update(m_Context, dt, 0x0);
 
     e = GetEmitter(m_Context, instance, 0);
-    p = &e->m_Particles[0];
-    ASSERT_EQ(0.0f, p->GetPosition().getX());
+    p = GetEmitterParticle(e, 0);
+    ASSERT_EQ(0.0f, p.GetPosition().getX());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -750,7 +760,7 @@ TEST_F(ParticleTest, ParticleLife)
 
     dmParticle::Update(m_Context, dt, 0x0);
 
-    ASSERT_EQ(0.0f, e->m_Particles[0].GetTimeLeft());
+    ASSERT_EQ(0.0f, GetEmitterParticle(e, 0).GetTimeLeft());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -797,10 +807,10 @@ TEST_F(ParticleTest, ParticleVelocityStretch)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_NEAR(3.5f, e->m_Particles[0].m_Scale[1], EPSILON);
+    ASSERT_NEAR(3.5f, GetEmitterParticle(e, 0).m_Scale[1], EPSILON);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_NEAR(1.0f, e->m_Particles[0].m_Scale[1], EPSILON);
+    ASSERT_NEAR(1.0f, GetEmitterParticle(e, 0).m_Scale[1], EPSILON);
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -819,12 +829,12 @@ TEST_F(ParticleTest, ParticleStretch)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_NEAR(2.f, e->m_Particles[0].m_Scale[0], EPSILON);
-    ASSERT_NEAR(4.f, e->m_Particles[0].m_Scale[1], EPSILON);
+    ASSERT_NEAR(2.f, GetEmitterParticle(e, 0).m_Scale[0], EPSILON);
+    ASSERT_NEAR(4.f, GetEmitterParticle(e, 0).m_Scale[1], EPSILON);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_NEAR(2.f, e->m_Particles[0].m_Scale[0], EPSILON);
-    ASSERT_NEAR(2.f, e->m_Particles[0].m_Scale[1], EPSILON);
+    ASSERT_NEAR(2.f, GetEmitterParticle(e, 0).m_Scale[0], EPSILON);
+    ASSERT_NEAR(2.f, GetEmitterParticle(e, 0).m_Scale[1], EPSILON);
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -844,7 +854,7 @@ TEST_F(ParticleTest, ParticleOrientationMovementDirection)
 
     dmParticle::Update(m_Context, dt, 0x0);
 
-    Quat q = e->m_Particles[0].GetRotation();
+    Quat q = GetEmitterParticle(e, 0).GetRotation();
 
     // Represents an euler rotation of 90 deg around Z
     ASSERT_EQ(0.0f, q.getX());
@@ -871,7 +881,7 @@ TEST_F(ParticleTest, ParticleApplyLifeRotationToMovementDirection)
 
     dmParticle::Update(m_Context, dt, 0x0);
 
-    Quat q = e->m_Particles[0].GetRotation();
+    Quat q = GetEmitterParticle(e, 0).GetRotation();
 
     // Represents an euler rotation of 90deg particle life rotation combined with 90deg rotation along direction
     ASSERT_EQ(0.0f, q.getX());
@@ -904,7 +914,7 @@ TEST_F(ParticleTest, ParticleMovementDirection)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    Quat q = e->m_Particles[0].GetRotation();
+    Quat q = GetEmitterParticle(e, 0).GetRotation();
 
     ASSERT_EQ(0.0f, q.getX());
     ASSERT_EQ(0.0f, q.getY());
@@ -912,7 +922,7 @@ TEST_F(ParticleTest, ParticleMovementDirection)
     ASSERT_NEAR(0.70710677, q.getW(), EPSILON);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    q = e->m_Particles[0].GetRotation();
+    q = GetEmitterParticle(e, 0).GetRotation();
 
     ASSERT_EQ(0.0f, q.getX());
     ASSERT_EQ(0.0f, q.getY());
@@ -937,7 +947,7 @@ TEST_F(ParticleTest, ParticleAngularVelocity)
 
     dmParticle::Update(m_Context, dt, 0x0);
 
-    Quat q = e->m_Particles[0].GetRotation();
+    Quat q = GetEmitterParticle(e, 0).GetRotation();
 
     Vector3 r = dmVMath::QuatToEuler(q.getX(), q.getY(), q.getZ(), q.getW());
     ASSERT_EQ(0.0f, r.getX());
@@ -945,7 +955,7 @@ TEST_F(ParticleTest, ParticleAngularVelocity)
     ASSERT_EQ(90.0f, r.getZ());
 
     dmParticle::Update(m_Context, dt, 0x0);
-    q = e->m_Particles[0].GetRotation();
+    q = GetEmitterParticle(e, 0).GetRotation();
 
     r = dmVMath::QuatToEuler(q.getX(), q.getY(), q.getZ(), q.getW());
     ASSERT_EQ(0.0f, r.getX());
@@ -970,7 +980,7 @@ TEST_F(ParticleTest, ParticleAngularVelocityInitialRotation)
 
     dmParticle::Update(m_Context, dt, 0x0);
 
-    Quat q = e->m_Particles[0].GetRotation();
+    Quat q = GetEmitterParticle(e, 0).GetRotation();
 
     Vector3 r = dmVMath::QuatToEuler(q.getX(), q.getY(), q.getZ(), q.getW());
     ASSERT_EQ(0.0f, r.getX());
@@ -978,7 +988,7 @@ TEST_F(ParticleTest, ParticleAngularVelocityInitialRotation)
     ASSERT_EQ(0.0f, r.getZ());
 
     dmParticle::Update(m_Context, dt, 0x0);
-    q = e->m_Particles[0].GetRotation();
+    q = GetEmitterParticle(e, 0).GetRotation();
 
     r = dmVMath::QuatToEuler(q.getX(), q.getY(), q.getZ(), q.getW());
     ASSERT_EQ(0.0f, r.getX());
@@ -1154,36 +1164,43 @@ TEST_F(ParticleTest, EvaluateEmitterProperty)
 
     // t = 0.125, size < 0
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &e->m_Particles[0];
-    ASSERT_GT(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    dmParticle::Particle particle = GetEmitterParticle(e, 0);
+    ASSERT_GT(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.25, size = 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_EQ(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = GetEmitterParticle(e, 0);
+    ASSERT_EQ(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.375, size > 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_LT(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = GetEmitterParticle(e, 0);
+    ASSERT_LT(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.5, size = 1
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_EQ(1.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = GetEmitterParticle(e, 0);
+    ASSERT_EQ(1.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.625, size > 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_LT(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = GetEmitterParticle(e, 0);
+    ASSERT_LT(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.75, size = 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_EQ(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = GetEmitterParticle(e, 0);
+    ASSERT_EQ(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.875, size < 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_GT(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = GetEmitterParticle(e, 0);
+    ASSERT_GT(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 1, size = 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_NEAR(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize(), EPSILON);
+    particle = GetEmitterParticle(e, 0);
+    ASSERT_NEAR(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize(), EPSILON);
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1205,10 +1222,10 @@ TEST_F(ParticleTest, EvaluateEmitterPropertySpread)
         dmParticle::StartInstance(m_Context, instance);
 
         dmParticle::Update(m_Context, dt, 0x0);
-        dmParticle::Particle* particle = &emitter->m_Particles[0];
+        dmParticle::Particle particle = GetEmitterParticle(emitter, 0);
         // NOTE size could potentially be 0, but not likely
-        ASSERT_NE(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
-        ASSERT_GE(1.0f, dmMath::Abs(minElem(particle->GetScale()) * particle->GetSourceSize()));
+        ASSERT_NE(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
+        ASSERT_GE(1.0f, dmMath::Abs(minElem(particle.GetScale()) * particle.GetSourceSize()));
 
         dmParticle::DestroyInstance(m_Context, instance);
     }
@@ -1237,37 +1254,44 @@ TEST_F(ParticleTest, EvaluateParticleProperty)
 
     // t = 0.125, size < 0
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &e->m_Particles[0];
-    ASSERT_GT(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    dmParticle::Particle particle = GetEmitterParticle(e, 0);
+    ASSERT_GT(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.25, size = 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_EQ(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = GetEmitterParticle(e, 0);
+    ASSERT_EQ(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.375, size > 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_LT(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = GetEmitterParticle(e, 0);
+    ASSERT_LT(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.5, size = 1
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_EQ(1.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = GetEmitterParticle(e, 0);
+    ASSERT_EQ(1.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.625, size > 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_LT(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = GetEmitterParticle(e, 0);
+    ASSERT_LT(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.75, size = 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_EQ(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = GetEmitterParticle(e, 0);
+    ASSERT_EQ(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 0.875, size < 0
     // Updating with a full dt here will make the emitter reach its duration
     dmParticle::Update(m_Context, dt - EPSILON, 0x0);
-    ASSERT_GT(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize());
+    particle = GetEmitterParticle(e, 0);
+    ASSERT_GT(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize());
 
     // t = 1, size = 0
     dmParticle::Update(m_Context, dt, 0x0);
-    ASSERT_NEAR(0.0f, minElem(particle->GetScale()) * particle->GetSourceSize(), EPSILON);
+    particle = GetEmitterParticle(e, 0);
+    ASSERT_NEAR(0.0f, minElem(particle.GetScale()) * particle.GetSourceSize(), EPSILON);
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1288,8 +1312,8 @@ TEST_F(ParticleTest, ParticleInstanceScale)
     dmParticle::Update(m_Context, dt, 0x0);
 
     dmParticle::Emitter* e = GetEmitter(m_Context, instance, 0);
-    dmParticle::Particle* p = &e->m_Particles[0];
-    ASSERT_EQ(2.0f, minElem(p->GetScale()) * p->GetSourceSize());
+    dmParticle::Particle p = GetEmitterParticle(e, 0);
+    ASSERT_EQ(2.0f, minElem(p.GetScale()) * p.GetSourceSize());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1475,25 +1499,21 @@ TEST_F(ParticleTest, StableSort)
     ASSERT_EQ(particle_count, i->m_Emitters[0].m_Particles.Size());
 
     float x[particle_count];
-    dmParticle::Particle* p = &i->m_Emitters[0].m_Particles[0];
+    dmParticle::ParticleBuffer& particles = i->m_Emitters[0].m_Particles;
     // Store x-positions
     for (uint32_t pi = 0; pi < particle_count; ++pi)
     {
         float f = (float)pi + 1;
         x[pi] = f;
-        Point3 pos = p[pi].GetPosition();
-        pos.setX(f);
-        p[pi].SetPosition(pos);
+        particles.m_PositionX[pi] = f;
     }
     // Disturb order by altering a few particles
     const uint32_t disturb_count = particle_count / 2;
     for (uint32_t d = 0; d < disturb_count; ++d)
     {
-        p[d].SetTimeLeft(p[d].GetTimeLeft() - dt);
+        particles.m_TimeLeft[d] -= dt;
         x[d] += particle_count;
-        Point3 pos = p[d].GetPosition();
-        pos.setX(x[d]);
-        p[d].SetPosition(pos);
+        particles.m_PositionX[d] = x[d];
     }
     // Sort
     dmParticle::Update(m_Context, dt, 0x0);
@@ -1502,7 +1522,7 @@ TEST_F(ParticleTest, StableSort)
     // Verify order of undisturbed
     for (uint32_t pi = 0; pi < particle_count; ++pi)
     {
-        ASSERT_EQ(x[pi], p[pi].GetPosition().getX());
+        ASSERT_EQ(x[pi], particles.m_PositionX[pi]);
     }
 
     dmParticle::DestroyInstance(m_Context, instance);
@@ -1535,7 +1555,7 @@ TEST_F(ParticleTest, ReloadInstance)
     ASSERT_EQ(1u, e->m_Particles.Size());
 
     dmParticle::Particle original_particle;
-    memcpy(&original_particle, &e->m_Particles[0], sizeof(dmParticle::Particle));
+    dmParticle::GetParticle(e->m_Particles, 0, &original_particle);
 
     uint32_t seed = e->m_Seed;
     float timer = e->m_Timer;
@@ -1546,8 +1566,9 @@ TEST_F(ParticleTest, ReloadInstance)
     ASSERT_EQ(timer, e->m_Timer);
     ASSERT_EQ(seed, e->m_Seed);
     ASSERT_EQ(1u, e->m_Particles.Size());
-    dmParticle::Particle* particle = &e->m_Particles[0];
-    ASSERT_EQ(0, memcmp(&original_particle, particle, sizeof(dmParticle::Particle)));
+    dmParticle::Particle particle;
+    dmParticle::GetParticle(e->m_Particles, 0, &particle);
+    ASSERT_EQ(0, memcmp(&original_particle, &particle, sizeof(dmParticle::Particle)));
 
     dmParticle::Emitter* e1 = GetEmitter(m_Context, instance, 1);
     ASSERT_EQ(1u, e1->m_Particles.Size());
@@ -1557,8 +1578,8 @@ TEST_F(ParticleTest, ReloadInstance)
     e = GetEmitter(m_Context, instance, 0);
 
     ASSERT_EQ(1u, e->m_Particles.Size());
-    particle = &e->m_Particles[0];
-    ASSERT_EQ(0, memcmp(&original_particle, particle, sizeof(dmParticle::Particle)));
+    dmParticle::GetParticle(e->m_Particles, 0, &particle);
+    ASSERT_EQ(0, memcmp(&original_particle, &particle, sizeof(dmParticle::Particle)));
 
     // Test reload with max_particle_count changed
     ASSERT_TRUE(ReloadPrototype("reload3.particlefxc", m_Prototype));
@@ -1566,8 +1587,8 @@ TEST_F(ParticleTest, ReloadInstance)
     e = GetEmitter(m_Context, instance, 0);
 
     ASSERT_EQ(2u, e->m_Particles.Size());
-    particle = &e->m_Particles[0];
-    ASSERT_EQ(0, memcmp(&original_particle, particle, sizeof(dmParticle::Particle)));
+    dmParticle::GetParticle(e->m_Particles, 0, &particle);
+    ASSERT_EQ(0, memcmp(&original_particle, &particle, sizeof(dmParticle::Particle)));
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1595,7 +1616,7 @@ TEST_F(ParticleTest, ReloadInstanceLoop)
     float emitter_timer = e->m_Timer;
 
     dmParticle::Particle original_particle;
-    memcpy(&original_particle, &e->m_Particles[0], sizeof(dmParticle::Particle));
+    dmParticle::GetParticle(e->m_Particles, 0, &original_particle);
 
     ASSERT_TRUE(ReloadPrototype("reload_loop.particlefxc", m_Prototype));
     dmParticle::ReloadInstance(m_Context, instance, true);
@@ -1604,8 +1625,9 @@ TEST_F(ParticleTest, ReloadInstanceLoop)
     ASSERT_EQ(1u, e->m_Particles.Size());
     ASSERT_EQ(emitter_timer, e->m_Timer);
     ASSERT_EQ(1u, e->m_Particles.Size());
-    dmParticle::Particle* particle = &e->m_Particles[0];
-    ASSERT_EQ(0, memcmp(&original_particle, particle, sizeof(dmParticle::Particle)));
+    dmParticle::Particle particle;
+    dmParticle::GetParticle(e->m_Particles, 0, &particle);
+    ASSERT_EQ(0, memcmp(&original_particle, &particle, sizeof(dmParticle::Particle)));
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1662,19 +1684,19 @@ TEST_F(ParticleTest, AccelerationWorld)
 
     dmParticle::StartInstance(m_Context, instance);
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, particle->GetVelocity().getX());
-    ASSERT_EQ(1.0f, particle->GetVelocity().getY());
-    ASSERT_EQ(0.0f, particle->GetVelocity().getZ());
+    dmParticle::Particle particle = GetEmitterParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getX());
+    ASSERT_EQ(1.0f, particle.GetVelocity().getY());
+    ASSERT_EQ(0.0f, particle.GetVelocity().getZ());
 
     dmParticle::SetRotation(m_Context, instance, Quat::rotationZ(M_PI * 0.5f));
     dmParticle::ResetInstance(m_Context, instance);
     dmParticle::StartInstance(m_Context, instance);
     dmParticle::Update(m_Context, dt, 0x0);
-    particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, particle->GetVelocity().getX());
-    ASSERT_EQ(1.0f, particle->GetVelocity().getY());
-    ASSERT_EQ(0.0f, particle->GetVelocity().getZ());
+    particle = GetEmitterParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getX());
+    ASSERT_EQ(1.0f, particle.GetVelocity().getY());
+    ASSERT_EQ(0.0f, particle.GetVelocity().getZ());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1698,8 +1720,8 @@ TEST_F(ParticleTest, AccelerationScaledEmitter)
 
         dmParticle::StartInstance(m_Context, instance);
         dmParticle::Update(m_Context, dt, 0x0);
-        dmParticle::Particle* particle = &inst->m_Emitters[0].m_Particles[0];
-        delta[i] = Vector3(particle->GetPosition());
+        dmParticle::Particle particle = GetEmitterParticle(&inst->m_Emitters[0], 0);
+        delta[i] = Vector3(particle.GetPosition());
 
         dmParticle::DestroyInstance(m_Context, instance);
     }
@@ -1729,8 +1751,8 @@ TEST_F(ParticleTest, AccelerationScaledWorld)
 
         dmParticle::StartInstance(m_Context, instance);
         dmParticle::Update(m_Context, dt, 0x0);
-        dmParticle::Particle* particle = &inst->m_Emitters[0].m_Particles[0];
-        delta[i] = Vector3(particle->GetPosition());
+        dmParticle::Particle particle = GetEmitterParticle(&inst->m_Emitters[0], 0);
+        delta[i] = Vector3(particle.GetPosition());
 
         dmParticle::DestroyInstance(m_Context, instance);
     }
@@ -1752,19 +1774,19 @@ TEST_F(ParticleTest, AccelerationEmitter)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, particle->GetVelocity().getX());
-    ASSERT_NEAR(1.0f, particle->GetVelocity().getY(), EPSILON);
-    ASSERT_EQ(0.0f, particle->GetVelocity().getZ());
+    dmParticle::Particle particle = GetEmitterParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getX());
+    ASSERT_NEAR(1.0f, particle.GetVelocity().getY(), EPSILON);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getZ());
 
     dmParticle::SetRotation(m_Context, instance, Quat::rotationZ(M_PI));
     dmParticle::ResetInstance(m_Context, instance);
     dmParticle::StartInstance(m_Context, instance);
     dmParticle::Update(m_Context, dt, 0x0);
-    particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, particle->GetVelocity().getX());
-    ASSERT_NEAR(1.0f, particle->GetVelocity().getY(), EPSILON);
-    ASSERT_EQ(0.0f, particle->GetVelocity().getZ());
+    particle = GetEmitterParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getX());
+    ASSERT_NEAR(1.0f, particle.GetVelocity().getY(), EPSILON);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getZ());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1780,22 +1802,22 @@ TEST_F(ParticleTest, AccelerationAnimated)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &emitter->m_Particles[0];
-    ASSERT_EQ(0.0f, particle->GetVelocity().getX());
-    ASSERT_LT(0.0f, particle->GetVelocity().getY());
-    ASSERT_EQ(0.0f, particle->GetVelocity().getZ());
+    dmParticle::Particle particle = GetEmitterParticle(emitter, 0);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getX());
+    ASSERT_LT(0.0f, particle.GetVelocity().getY());
+    ASSERT_EQ(0.0f, particle.GetVelocity().getZ());
 
     dmParticle::Update(m_Context, dt, 0x0);
     // New particle at 0 because of sorting
-    particle = &emitter->m_Particles[0];
-    ASSERT_EQ(0.0f, lengthSqr(particle->GetVelocity()));
+    particle = GetEmitterParticle(emitter, 0);
+    ASSERT_EQ(0.0f, lengthSqr(particle.GetVelocity()));
 
     dmParticle::Update(m_Context, dt, 0x0);
     // New particle at 0 because of sorting
-    particle = &emitter->m_Particles[0];
-    ASSERT_EQ(0.0f, particle->GetVelocity().getX());
-    ASSERT_GT(0.0f, particle->GetVelocity().getY());
-    ASSERT_EQ(0.0f, particle->GetVelocity().getZ());
+    particle = GetEmitterParticle(emitter, 0);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getX());
+    ASSERT_GT(0.0f, particle.GetVelocity().getY());
+    ASSERT_EQ(0.0f, particle.GetVelocity().getZ());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1812,8 +1834,8 @@ TEST_F(ParticleTest, DragNoDir)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, lengthSqr(particle->GetVelocity()));
+    dmParticle::Particle particle = GetEmitterParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(0.0f, lengthSqr(particle.GetVelocity()));
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1830,8 +1852,8 @@ TEST_F(ParticleTest, DragDir)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    Vector3 velocity = particle->GetVelocity();
+    dmParticle::Particle particle = GetEmitterParticle(&i->m_Emitters[0], 0);
+    Vector3 velocity = particle.GetVelocity();
     ASSERT_NEAR(0.0f, velocity.getX(), EPSILON);
     ASSERT_LT(0.0f, velocity.getY());
     ASSERT_EQ(0.0f, velocity.getZ());
@@ -1851,8 +1873,8 @@ TEST_F(ParticleTest, DragBigMagnitude)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0u, lengthSqr(particle->GetVelocity()));
+    dmParticle::Particle particle = GetEmitterParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(0u, lengthSqr(particle.GetVelocity()));
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1869,9 +1891,9 @@ TEST_F(ParticleTest, Radial)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(1.0f, lengthSqr(particle->GetVelocity()));
-    ASSERT_EQ(-1.0f, particle->GetVelocity().getX());
+    dmParticle::Particle particle = GetEmitterParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(1.0f, lengthSqr(particle.GetVelocity()));
+    ASSERT_EQ(-1.0f, particle.GetVelocity().getX());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1888,16 +1910,16 @@ TEST_F(ParticleTest, RadialMaxDistance)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, lengthSqr(particle->GetVelocity()));
+    dmParticle::Particle particle = GetEmitterParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(0.0f, lengthSqr(particle.GetVelocity()));
 
     // Test with instance scale
     dmParticle::ResetInstance(m_Context, instance);
     dmParticle::SetScale(m_Context, instance, 2.0f);
     dmParticle::StartInstance(m_Context, instance);
     dmParticle::Update(m_Context, dt, 0x0);
-    particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, lengthSqr(particle->GetVelocity()));
+    particle = GetEmitterParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(0.0f, lengthSqr(particle.GetVelocity()));
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1915,8 +1937,8 @@ TEST_F(ParticleTest, RadialEdgeCase)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(1.0f, lengthSqr(particle->GetVelocity()));
+    dmParticle::Particle particle = GetEmitterParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(1.0f, lengthSqr(particle.GetVelocity()));
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1933,10 +1955,10 @@ TEST_F(ParticleTest, Vortex)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, particle->GetVelocity().getX());
-    ASSERT_EQ(-1.0f, particle->GetVelocity().getY());
-    ASSERT_EQ(0.0f, particle->GetVelocity().getZ());
+    dmParticle::Particle particle = GetEmitterParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(0.0f, particle.GetVelocity().getX());
+    ASSERT_EQ(-1.0f, particle.GetVelocity().getY());
+    ASSERT_EQ(0.0f, particle.GetVelocity().getZ());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1953,16 +1975,16 @@ TEST_F(ParticleTest, VortexMaxDistance)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, lengthSqr(particle->GetVelocity()));
+    dmParticle::Particle particle = GetEmitterParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(0.0f, lengthSqr(particle.GetVelocity()));
 
     // Test with instance scale
     dmParticle::ResetInstance(m_Context, instance);
     dmParticle::SetScale(m_Context, instance, 2.0f);
     dmParticle::StartInstance(m_Context, instance);
     dmParticle::Update(m_Context, dt, 0x0);
-    particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(0.0f, lengthSqr(particle->GetVelocity()));
+    particle = GetEmitterParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(0.0f, lengthSqr(particle.GetVelocity()));
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -1979,10 +2001,10 @@ TEST_F(ParticleTest, VortexEdgeCase)
     dmParticle::StartInstance(m_Context, instance);
 
     dmParticle::Update(m_Context, dt, 0x0);
-    dmParticle::Particle* particle = &i->m_Emitters[0].m_Particles[0];
-    ASSERT_EQ(-1.0f, particle->GetVelocity().getX());
-    ASSERT_EQ(0.0f, particle->GetVelocity().getY());
-    ASSERT_EQ(0.0f, particle->GetVelocity().getZ());
+    dmParticle::Particle particle = GetEmitterParticle(&i->m_Emitters[0], 0);
+    ASSERT_EQ(-1.0f, particle.GetVelocity().getX());
+    ASSERT_EQ(0.0f, particle.GetVelocity().getY());
+    ASSERT_EQ(0.0f, particle.GetVelocity().getZ());
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -2058,8 +2080,8 @@ TEST_F(ParticleTest, InheritVelocity)
     dmParticle::SetPosition(m_Context, instance, Point3(10, 0, 0));
     dmParticle::Update(m_Context, dt, 0x0);
 
-    ASSERT_EQ(0.0f, lengthSqr(e1->m_Particles[0].GetVelocity()));
-    ASSERT_NE(0.0f, lengthSqr(e2->m_Particles[0].GetVelocity()));
+    ASSERT_EQ(0.0f, lengthSqr(GetEmitterParticle(e1, 0).GetVelocity()));
+    ASSERT_NE(0.0f, lengthSqr(GetEmitterParticle(e2, 0).GetVelocity()));
 
     dmParticle::DestroyInstance(m_Context, instance);
 }
@@ -2092,6 +2114,55 @@ TEST_F(ParticleTest, Stats)
     dmParticle::DestroyInstance(m_Context, instance);
 }
 
+TEST_F(ParticleTest, BenchSimulation)
+{
+    const float dt = 1.0f / 60.0f;
+    const uint32_t frame_count = 120;
+
+    ASSERT_TRUE(LoadPrototype("bench.particlefxc", &m_Prototype));
+    dmParticle::HInstance instance = dmParticle::CreateInstance(m_Context, m_Prototype, 0x0);
+    dmParticle::Emitter* e = GetEmitter(m_Context, instance, 0);
+    dmParticle::StartInstance(m_Context, instance);
+
+    uint32_t max_particle_count = e->m_Particles.Capacity();
+    uint32_t vertex_buffer_size = dmParticle::GetVertexBufferSize(max_particle_count, dmParticle::PARTICLE_GO);
+    void* vertex_buffer = malloc(vertex_buffer_size);
+
+    // Fill the emitter up
+    for (uint32_t i = 0; i < 60; ++i)
+    {
+        dmParticle::Update(m_Context, dt, 0x0);
+    }
+    ASSERT_LT(max_particle_count / 2, ParticleCount(e));
+
+    uint64_t update_time = 0;
+    uint64_t vertex_time = 0;
+    uint64_t particles = 0;
+    for (uint32_t i = 0; i < frame_count; ++i)
+    {
+        uint64_t start = dmTime::GetTime();
+        dmParticle::Update(m_Context, dt, 0x0);
+        uint64_t mid = dmTime::GetTime();
+        uint32_t out_vertex_buffer_size = 0;
+        dmParticle::GenerateVertexData(m_Context, dt, instance, 0, Vector4(1,1,1,1), vertex_buffer, vertex_buffer_size, &out_vertex_buffer_size, dmParticle::PARTICLE_GO);
+        uint64_t end = dmTime::GetTime();
+
+        ASSERT_EQ(ParticleCount(e) * 6 * sizeof(dmParticle::Vertex), out_vertex_buffer_size);
+        update_time += mid - start;
+        vertex_time += end - mid;
+        particles += ParticleCount(e);
+    }
+
+    float update_ms = dmMath::Max(update_time / 1000.0f, 0.001f);
+    float vertex_ms = dmMath::Max(vertex_time / 1000.0f, 0.001f);
+    printf("Particles, %u frames, %.0f particles per frame\n", frame_count, particles / (float)frame_count);
+    printf("    update:   %8.3f ms  %10.0f particles/ms\n", update_ms, particles / update_ms);
+    printf("    vertices: %8.3f ms  %10.0f particles/ms\n", vertex_ms, particles / vertex_ms);
+
+    free(vertex_buffer);
+    dmParticle::DestroyInstance(m_Context, instance);
+}
+
 int main(int argc, char **argv)
 {
     jc_test_init(&argc, argv);
@@ -169,6 +169,48 @@ b2Island::b2Island(
 
 	m_velocities = (b2Velocity*)m_allocator->Allocate(m_bodyCapacity * sizeof(b2Velocity));
 	m_positions = (b2Position*)m_allocator->Allocate(m_bodyCapacity * sizeof(b2Position));
+
+	m_staticBodies = NULL;
+	m_impulses = NULL;
+	m_staticCount = 0;
+	m_bodyOffset = 0;
+	m_ownsLists = true;
+	m_positionSolved = false;
+}
+
+// Defold modification
+b2Island::b2Island(
+	b2Body** bodies, int32 bodyCount,
+	b2Body** staticBodies, int32 staticCount, int32 staticSlotCount,
+	b2Contact** contacts, int32 contactCount,
+	b2Joint** joints, int32 jointCount,
+	b2StackAllocator* allocator,
+	b2ContactImpulse* impulses)
+{
+	m_bodyCapacity = bodyCount;
+	m_contactCapacity = contactCount;
+	m_jointCapacity = jointCount;
+	m_bodyCount = bodyCount;
+	m_contactCount = contactCount;
+	m_jointCount = jointCount;
+
+	m_allocator = allocator;
+	m_listener = NULL;
+
+	m_bodies = bodies;
+	m_contacts = contacts;
+	m_joints = joints;
+
+	m_staticBodies = staticBodies;
+	m_impulses = impulses;
+	m_staticCount = staticCount;
+	m_bodyOffset = staticSlotCount;
+	m_ownsLists = false;
+	m_positionSolved = false;
+
+	// The state buffers are indexed by m_islandIndex, which is global for the static bodies
+	m_velocities = (b2Velocity*)m_allocator->Allocate((staticSlotCount + bodyCount) * sizeof(b2Velocity));
+	m_positions = (b2Position*)m_allocator->Allocate((staticSlotCount + bodyCount) * sizeof(b2Position));
 }
 
 b2Island::~b2Island()
@@ -176,9 +218,12 @@ b2Island::~b2Island()
 	// Warning: the order should reverse the constructor order.
 	m_allocator->Free(m_positions);
 	m_allocator->Free(m_velocities);
-	m_allocator->Free(m_joints);
-	m_allocator->Free(m_contacts);
-	m_allocator->Free(m_bodies);
+	if (m_ownsLists)
+	{
+		m_allocator->Free(m_joints);
+		m_allocator->Free(m_contacts);
+		m_allocator->Free(m_bodies);
+	}
 }
 
 void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep)
@@ -187,10 +232,22 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 
 	float32 h = step.dt;
 
+	// Defold modification: static bodies shared with other islands are read only
+	for (int32 i = 0; i < m_staticCount; ++i)
+	{
+		b2Body* b = m_staticBodies[i];
+		int32 index = b->m_islandIndex;
+		m_positions[index].c = b->m_sweep.c;
+		m_positions[index].a = b->m_sweep.a;
+		m_velocities[index].v = b->m_linearVelocity;
+		m_velocities[index].w = b->m_angularVelocity;
+	}
+
 	// Integrate velocities and apply damping. Initialize the body state.
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
 		b2Body* b = m_bodies[i];
+		int32 index = m_bodyOffset + i;
 
 		b2Vec2 c = b->m_sweep.c;
 		float32 a = b->m_sweep.a;
@@ -228,10 +285,10 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 			w *= b2Clamp(b2FastPow(1.0f - b->m_angularDamping, h), 0.0f, 1.0f);
 		}
 
-		m_positions[i].c = c;
-		m_positions[i].a = a;
-		m_velocities[i].v = v;
-		m_velocities[i].w = w;
+		m_positions[index].c = c;
+		m_positions[index].a = a;
+		m_velocities[index].v = v;
+		m_velocities[index].w = w;
 	}
 
 	timer.Reset();
@@ -283,7 +340,7 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	profile->solveVelocity = timer.GetMilliseconds();
 
 	// Integrate positions
-	for (int32 i = 0; i < m_bodyCount; ++i)
+	for (int32 i = m_bodyOffset; i < m_bodyOffset + m_bodyCount; ++i)
 	{
 		b2Vec2 c = m_positions[i].c;
 		float32 a = m_positions[i].a;
@@ -341,55 +398,73 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
 		b2Body* body = m_bodies[i];
-		body->m_sweep.c = m_positions[i].c;
-		body->m_sweep.a = m_positions[i].a;
-		body->m_linearVelocity = m_velocities[i].v;
-		body->m_angularVelocity = m_velocities[i].w;
+		int32 index = m_bodyOffset + i;
+		body->m_sweep.c = m_positions[index].c;
+		body->m_sweep.a = m_positions[index].a;
+		body->m_linearVelocity = m_velocities[index].v;
+		body->m_angularVelocity = m_velocities[index].w;
 		body->SynchronizeTransform();
 	}
 
 	profile->solvePosition = timer.GetMilliseconds();
 
+	m_positionSolved = positionSolved;
+
+	// Defold modification: when solving in parallel, the impulses are reported and
+	// the bodies put to sleep afterwards, on the calling thread
+	if (m_impulses != NULL)
+	{
+		Store(contactSolver.m_velocityConstraints);
+		return;
+	}
+
 	Report(contactSolver.m_velocityConstraints);
 
 	if (allowSleep)
 	{
-		float32 minSleepTime = b2_maxFloat;
+		UpdateSleep(m_bodies, m_bodyCount, h, positionSolved);
+	}
+}
+
+bool b2Island::UpdateSleep(b2Body** bodies, int32 bodyCount, float32 h, bool positionSolved)
+{
+	float32 minSleepTime = b2_maxFloat;
+
+	const float32 linTolSqr = b2_linearSleepTolerance * b2_linearSleepTolerance;
+	const float32 angTolSqr = b2_angularSleepTolerance * b2_angularSleepTolerance;
 
-		const float32 linTolSqr = b2_linearSleepTolerance * b2_linearSleepTolerance;
-		const float32 angTolSqr = b2_angularSleepTolerance * b2_angularSleepTolerance;
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		b2Body* b = bodies[i];
+		if (b->GetType() == b2_staticBody)
+		{
+			continue;
+		}
 
-		for (int32 i = 0; i < m_bodyCount; ++i)
+		if ((b->m_flags & b2Body::e_autoSleepFlag) == 0 ||
+			b->m_angularVelocity * b->m_angularVelocity > angTolSqr ||
+			b2Dot(b->m_linearVelocity, b->m_linearVelocity) > linTolSqr)
+		{
+			b->m_sleepTime = 0.0f;
+			minSleepTime = 0.0f;
+		}
+		else
 		{
-			b2Body* b = m_bodies[i];
-			if (b->GetType() == b2_staticBody)
-			{
-				continue;
-			}
-
-			if ((b->m_flags & b2Body::e_autoSleepFlag) == 0 ||
-				b->m_angularVelocity * b->m_angularVelocity > angTolSqr ||
-				b2Dot(b->m_linearVelocity, b->m_linearVelocity) > linTolSqr)
-			{
-				b->m_sleepTime = 0.0f;
-				minSleepTime = 0.0f;
-			}
-			else
-			{
-				b->m_sleepTime += h;
-				minSleepTime = b2Min(minSleepTime, b->m_sleepTime);
-			}
+			b->m_sleepTime += h;
+			minSleepTime = b2Min(minSleepTime, b->m_sleepTime);
 		}
+	}
 
-		if (minSleepTime >= b2_timeToSleep && positionSolved)
+	if (minSleepTime >= b2_timeToSleep && positionSolved)
+	{
+		for (int32 i = 0; i < bodyCount; ++i)
 		{
-			for (int32 i = 0; i < m_bodyCount; ++i)
-			{
-				b2Body* b = m_bodies[i];
-				b->SetAwake(false);
-			}
+			b2Body* b = bodies[i];
+			b->SetAwake(false);
 		}
+		return true;
 	}
+	return false;
 }
 
 void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiIndexB)
@@ -548,3 +623,20 @@ void b2Island::Report(const b2ContactVelocityConstraint* constraints)
 		m_listener->PostSolve(c, &impulse);
 	}
 }
+
+// Defold modification
+void b2Island::Store(const b2ContactVelocityConstraint* constraints)
+{
+	for (int32 i = 0; i < m_contactCount; ++i)
+	{
+		const b2ContactVelocityConstraint* vc = constraints + i;
+
+		b2ContactImpulse* impulse = m_impulses + i;
+		impulse->count = vc->pointCount;
+		for (int32 j = 0; j < vc->pointCount; ++j)
+		{
+			impulse->normalImpulses[j] = vc->points[j].normalImpulse;
+			impulse->tangentImpulses[j] = vc->points[j].tangentImpulse;
+		}
+	}
+}
@@ -28,6 +28,7 @@ class b2Joint;
 class b2StackAllocator;
 class b2ContactListener;
 struct b2ContactVelocityConstraint;
+struct b2ContactImpulse;
 struct b2Profile;
 
 /// This is an internal class.
@@ -36,6 +37,17 @@ class b2Island
 public:
 	b2Island(int32 bodyCapacity, int32 contactCapacity, int32 jointCapacity,
 			b2StackAllocator* allocator, b2ContactListener* listener);
+
+	/// Defold modification
+	/// Creates an island over lists owned by the caller, used by the parallel solver.
+	/// The non-static bodies are expected to have m_islandIndex staticSlotCount + i,
+	/// and the static bodies a unique index below staticSlotCount. Static bodies are
+	/// never written to, and contact impulses are stored in impulses instead of being
+	/// reported, since the listener isn't thread safe.
+	b2Island(b2Body** bodies, int32 bodyCount, b2Body** staticBodies, int32 staticCount, int32 staticSlotCount,
+			b2Contact** contacts, int32 contactCount, b2Joint** joints, int32 jointCount,
+			b2StackAllocator* allocator, b2ContactImpulse* impulses);
+
 	~b2Island();
 
 	void Clear()
@@ -71,6 +83,13 @@ public:
 
 	void Report(const b2ContactVelocityConstraint* constraints);
 
+	// Defold modification
+	void Store(const b2ContactVelocityConstraint* constraints);
+
+	/// Update the sleep timers and put the bodies to sleep if all of them have been resting long enough.
+	/// @return true if the bodies were put to sleep
+	static bool UpdateSleep(b2Body** bodies, int32 bodyCount, float32 h, bool positionSolved);
+
 	b2StackAllocator* m_allocator;
 	b2ContactListener* m_listener;
 
@@ -88,6 +107,14 @@ public:
 	int32 m_bodyCapacity;
 	int32 m_contactCapacity;
 	int32 m_jointCapacity;
+
+	// Defold modification
+	b2Body** m_staticBodies;
+	b2ContactImpulse* m_impulses;
+	int32 m_staticCount;
+	int32 m_bodyOffset;
+	bool m_ownsLists;
+	bool m_positionSolved;
 };
 
 #endif
@@ -62,10 +62,16 @@ b2World::b2World(const b2Vec2& gravity)
 	m_contactManager.m_allocator = &m_blockAllocator;
 
 	memset(&m_profile, 0, sizeof(b2Profile));
+
+	m_taskScheduler = NULL;
+	m_batchAllocators = NULL;
+	m_batchCount = 0;
 }
 
 b2World::~b2World()
 {
+	SetTaskScheduler(NULL, 0);
+
 	// Some shapes allocate using b2Alloc.
 	b2Body* b = m_bodyList;
 	while (b)
@@ -85,6 +91,35 @@ b2World::~b2World()
 	}
 }
 
+// Defold modification
+void b2World::SetTaskScheduler(b2TaskScheduler* scheduler, int32 batchCount)
+{
+	b2Assert(IsLocked() == false);
+
+	for (int32 i = 0; i < m_batchCount; ++i)
+	{
+		m_batchAllocators[i]->~b2StackAllocator();
+		b2Free(m_batchAllocators[i]);
+	}
+	b2Free(m_batchAllocators);
+	m_batchAllocators = NULL;
+	m_batchCount = 0;
+
+	m_taskScheduler = scheduler;
+	if (scheduler == NULL || batchCount <= 0)
+	{
+		return;
+	}
+
+	m_batchCount = batchCount;
+	m_batchAllocators = (b2StackAllocator**)b2Alloc(batchCount * sizeof(b2StackAllocator*));
+	for (int32 i = 0; i < batchCount; ++i)
+	{
+		void* mem = b2Alloc(sizeof(b2StackAllocator));
+		m_batchAllocators[i] = new (mem) b2StackAllocator;
+	}
+}
+
 void b2World::SetDestructionListener(b2DestructionListener* listener)
 {
 	m_destructionListener = listener;
@@ -390,6 +425,45 @@ void b2World::Solve(const b2TimeStep& step)
 	m_profile.solveVelocity = 0.0f;
 	m_profile.solvePosition = 0.0f;
 
+	// Defold modification
+	if (CanSolveIslandsParallel())
+	{
+		SolveIslandsParallel(step);
+	}
+	else
+	{
+		SolveIslands(step);
+	}
+
+	{
+		b2Timer timer;
+		// Synchronize fixtures, check for out of range bodies.
+		for (b2Body* b = m_bodyList; b; b = b->GetNext())
+		{
+			// If a body was not in an island then it did not move.
+			if ((b->m_flags & b2Body::e_islandFlag) == 0)
+			{
+				continue;
+			}
+
+			if (b->GetType() == b2_staticBody)
+			{
+				continue;
+			}
+
+			// Update fixtures (for broad-phase).
+			b->SynchronizeFixtures();
+		}
+
+		// Look for new contacts.
+		m_contactManager.FindNewContacts();
+		m_profile.broadphase = timer.GetMilliseconds();
+	}
+}
+
+// Build and solve the islands one at a time.
+void b2World::SolveIslands(const b2TimeStep& step)
+{
 	// Size the island for the worst case.
 	b2Island island(m_bodyCount,
 					m_contactManager.m_contactCount,
@@ -547,31 +621,345 @@ void b2World::Solve(const b2TimeStep& step)
 	}
 
 	m_stackAllocator.Free(stack);
+}
+
+// Defold modification
+// The parallel island solver builds all islands up front into flat lists, solves
+// contiguous batches of them through the task scheduler and then reports contact
+// impulses and updates sleeping in island order, which gives the same result as
+// the serial solver. Static bodies may be shared between islands, so each one is
+// given a unique slot in the state buffers and is only read while solving.
 
+struct b2IslandRange
+{
+	int32 bodyStart;
+	int32 bodyCount;
+	int32 staticStart;
+	int32 staticCount;
+	int32 contactStart;
+	int32 contactCount;
+	int32 jointStart;
+	int32 jointCount;
+	bool positionSolved;
+	b2Profile profile;
+};
+
+struct b2SolveIslandsContext
+{
+	b2TimeStep step;
+	b2Vec2 gravity;
+	bool allowSleep;
+	b2IslandRange* islands;
+	int32* batchStart;
+	b2Body** bodies;
+	b2Body** staticBodies;
+	b2Contact** contacts;
+	b2Joint** joints;
+	b2ContactImpulse* impulses;
+	b2StackAllocator** allocators;
+	int32 staticSlotCount;
+};
+
+static void b2SolveIslandBatch(void* ctx, int32 index)
+{
+	b2SolveIslandsContext* context = (b2SolveIslandsContext*)ctx;
+	for (int32 i = context->batchStart[index]; i < context->batchStart[index + 1]; ++i)
 	{
-		b2Timer timer;
-		// Synchronize fixtures, check for out of range bodies.
-		for (b2Body* b = m_bodyList; b; b = b->GetNext())
+		b2IslandRange* range = context->islands + i;
+		b2Island island(context->bodies + range->bodyStart, range->bodyCount,
+						context->staticBodies + range->staticStart, range->staticCount, context->staticSlotCount,
+						context->contacts + range->contactStart, range->contactCount,
+						context->joints + range->jointStart, range->jointCount,
+						context->allocators[index],
+						context->impulses + range->contactStart);
+		island.Solve(&range->profile, context->step, context->gravity, context->allowSleep);
+		range->positionSolved = island.m_positionSolved;
+	}
+}
+
+bool b2World::CanSolveIslandsParallel() const
+{
+	if (m_taskScheduler == NULL || m_batchCount < 2)
+	{
+		return false;
+	}
+
+	// Gear joints use bodies outside of their own island, which the state buffers don't hold.
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		if (j->GetType() == e_gearJoint)
 		{
-			// If a body was not in an island then it did not move.
-			if ((b->m_flags & b2Body::e_islandFlag) == 0)
+			return false;
+		}
+	}
+	return true;
+}
+
+void b2World::SolveIslandsParallel(const b2TimeStep& step)
+{
+	// Clear all the island flags. Static bodies get their slot when first added to an island.
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		b->m_flags &= ~b2Body::e_islandFlag;
+		if (b->GetType() == b2_staticBody)
+		{
+			b->m_islandIndex = -1;
+		}
+	}
+	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	{
+		c->m_flags &= ~b2Contact::e_islandFlag;
+	}
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		j->m_islandFlag = false;
+	}
+
+	// A static body is listed once per island it is part of, which requires a contact or joint each time.
+	int32 staticCapacity = m_contactManager.m_contactCount + m_jointCount;
+
+	int32 stackSize = m_bodyCount;
+	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
+	b2Body** bodies = (b2Body**)m_stackAllocator.Allocate(m_bodyCount * sizeof(b2Body*));
+	b2Body** staticBodies = (b2Body**)m_stackAllocator.Allocate(staticCapacity * sizeof(b2Body*));
+	b2Contact** contacts = (b2Contact**)m_stackAllocator.Allocate(m_contactManager.m_contactCount * sizeof(b2Contact*));
+	b2Joint** joints = (b2Joint**)m_stackAllocator.Allocate(m_jointCount * sizeof(b2Joint*));
+	b2IslandRange* islands = (b2IslandRange*)m_stackAllocator.Allocate(m_bodyCount * sizeof(b2IslandRange));
+
+	int32 bodyCount = 0;
+	int32 staticCount = 0;
+	int32 contactCount = 0;
+	int32 jointCount = 0;
+	int32 islandCount = 0;
+	int32 staticSlotCount = 0;
+
+	// Build all awake islands, in the same order as the serial solver.
+	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
+	{
+		if (seed->m_flags & b2Body::e_islandFlag)
+		{
+			continue;
+		}
+
+		if (seed->IsAwake() == false || seed->IsActive() == false)
+		{
+			continue;
+		}
+
+		// The seed can be dynamic or kinematic.
+		if (seed->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		b2IslandRange* range = islands + islandCount++;
+		range->bodyStart = bodyCount;
+		range->staticStart = staticCount;
+		range->contactStart = contactCount;
+		range->jointStart = jointCount;
+
+		int32 stackCount = 0;
+		stack[stackCount++] = seed;
+		seed->m_flags |= b2Body::e_islandFlag;
+
+		// Perform a depth first search (DFS) on the constraint graph.
+		while (stackCount > 0)
+		{
+			b2Body* b = stack[--stackCount];
+			b2Assert(b->IsActive() == true);
+
+			// Make sure the body is awake.
+			b->SetAwake(true);
+
+			// To keep islands as small as possible, we don't
+			// propagate islands across static bodies.
+			if (b->GetType() == b2_staticBody)
 			{
+				if (b->m_islandIndex < 0)
+				{
+					b->m_islandIndex = staticSlotCount++;
+				}
+
+				// Store positions for continuous collision.
+				b->m_sweep.c0 = b->m_sweep.c;
+				b->m_sweep.a0 = b->m_sweep.a;
+
+				b2Assert(staticCount < staticCapacity);
+				staticBodies[staticCount++] = b;
 				continue;
 			}
 
-			if (b->GetType() == b2_staticBody)
+			bodies[bodyCount++] = b;
+
+			// Search all contacts connected to this body.
+			for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
 			{
-				continue;
+				b2Contact* contact = ce->contact;
+
+				if (contact->m_flags & b2Contact::e_islandFlag)
+				{
+					continue;
+				}
+
+				if (contact->IsEnabled() == false ||
+					contact->IsTouching() == false)
+				{
+					continue;
+				}
+
+				bool sensorA = contact->m_fixtureA->m_isSensor;
+				bool sensorB = contact->m_fixtureB->m_isSensor;
+				if (sensorA || sensorB)
+				{
+					continue;
+				}
+
+				contacts[contactCount++] = contact;
+				contact->m_flags |= b2Contact::e_islandFlag;
+
+				b2Body* other = ce->other;
+				if (other->m_flags & b2Body::e_islandFlag)
+				{
+					continue;
+				}
+
+				b2Assert(stackCount < stackSize);
+				stack[stackCount++] = other;
+				other->m_flags |= b2Body::e_islandFlag;
 			}
 
-			// Update fixtures (for broad-phase).
-			b->SynchronizeFixtures();
+			// Search all joints connect to this body.
+			for (b2JointEdge* je = b->m_jointList; je; je = je->next)
+			{
+				if (je->joint->m_islandFlag == true)
+				{
+					continue;
+				}
+
+				b2Body* other = je->other;
+
+				// Don't simulate joints connected to inactive bodies.
+				if (other->IsActive() == false)
+				{
+					continue;
+				}
+
+				joints[jointCount++] = je->joint;
+				je->joint->m_islandFlag = true;
+
+				if (other->m_flags & b2Body::e_islandFlag)
+				{
+					continue;
+				}
+
+				b2Assert(stackCount < stackSize);
+				stack[stackCount++] = other;
+				other->m_flags |= b2Body::e_islandFlag;
+			}
 		}
 
-		// Look for new contacts.
-		m_contactManager.FindNewContacts();
-		m_profile.broadphase = timer.GetMilliseconds();
+		range->bodyCount = bodyCount - range->bodyStart;
+		range->staticCount = staticCount - range->staticStart;
+		range->contactCount = contactCount - range->contactStart;
+		range->jointCount = jointCount - range->jointStart;
+
+		// Allow static bodies to participate in other islands.
+		for (int32 i = 0; i < range->staticCount; ++i)
+		{
+			staticBodies[range->staticStart + i]->m_flags &= ~b2Body::e_islandFlag;
+		}
+	}
+
+	// The non-static bodies are placed after the static slots in the state buffers.
+	for (int32 i = 0; i < islandCount; ++i)
+	{
+		const b2IslandRange* range = islands + i;
+		for (int32 j = 0; j < range->bodyCount; ++j)
+		{
+			bodies[range->bodyStart + j]->m_islandIndex = staticSlotCount + j;
+		}
+	}
+
+	b2ContactImpulse* impulses = (b2ContactImpulse*)m_stackAllocator.Allocate(b2Max(contactCount, 1) * sizeof(b2ContactImpulse));
+
+	// Split the islands into contiguous batches of roughly the same cost.
+	int32 batchCount = b2Min(m_batchCount, islandCount);
+	int32* batchStart = (int32*)m_stackAllocator.Allocate((batchCount + 1) * sizeof(int32));
+	{
+		int32 totalCost = bodyCount + contactCount + jointCount;
+		int32 cost = 0;
+		int32 batch = 0;
+		batchStart[0] = 0;
+		for (int32 i = 0; i < islandCount && batch < batchCount - 1; ++i)
+		{
+			cost += islands[i].bodyCount + islands[i].contactCount + islands[i].jointCount;
+			if (cost * batchCount >= totalCost * (batch + 1))
+			{
+				batchStart[++batch] = i + 1;
+			}
+		}
+		while (batch < batchCount)
+		{
+			batchStart[++batch] = islandCount;
+		}
+	}
+
+	if (batchCount > 0)
+	{
+		b2SolveIslandsContext context;
+		context.step = step;
+		context.gravity = m_gravity;
+		context.allowSleep = m_allowSleep;
+		context.islands = islands;
+		context.batchStart = batchStart;
+		context.bodies = bodies;
+		context.staticBodies = staticBodies;
+		context.contacts = contacts;
+		context.joints = joints;
+		context.impulses = impulses;
+		context.allocators = m_batchAllocators;
+		context.staticSlotCount = staticSlotCount;
+		m_taskScheduler->ParallelFor(b2SolveIslandBatch, &context, batchCount);
+	}
+
+	// Report the impulses and update sleeping on this thread, island by island.
+	b2ContactListener* listener = m_contactManager.m_contactListener;
+	for (int32 i = 0; i < islandCount; ++i)
+	{
+		const b2IslandRange* range = islands + i;
+		m_profile.solveInit += range->profile.solveInit;
+		m_profile.solveVelocity += range->profile.solveVelocity;
+		m_profile.solvePosition += range->profile.solvePosition;
+
+		if (listener)
+		{
+			for (int32 j = range->contactStart; j < range->contactStart + range->contactCount; ++j)
+			{
+				listener->PostSolve(contacts[j], impulses + j);
+			}
+		}
+
+		if (m_allowSleep)
+		{
+			bool sleeping = b2Island::UpdateSleep(bodies + range->bodyStart, range->bodyCount, step.dt, range->positionSolved);
+
+			// The serial solver puts the static bodies to sleep along with the island,
+			// and wakes them up again when they are added to a later island.
+			for (int32 j = 0; j < range->staticCount; ++j)
+			{
+				staticBodies[range->staticStart + j]->SetAwake(!sleeping);
+			}
+		}
 	}
+
+	m_stackAllocator.Free(batchStart);
+	m_stackAllocator.Free(impulses);
+	m_stackAllocator.Free(islands);
+	m_stackAllocator.Free(joints);
+	m_stackAllocator.Free(contacts);
+	m_stackAllocator.Free(staticBodies);
+	m_stackAllocator.Free(bodies);
+	m_stackAllocator.Free(stack);
 }
 
 // Find TOI contacts and solve them.
@@ -61,6 +61,15 @@ public:
 	/// remain in scope.
 	void SetContactListener(b2ContactListener* listener);
 
+	/// Defold modification
+	/// Register a task scheduler used to solve independent islands in parallel.
+	/// The islands are split into at most batchCount batches, each with its own
+	/// stack allocator. The result is identical to the serial solver. Contact
+	/// PostSolve callbacks and sleeping are still done on the calling thread.
+	/// Pass NULL to use the serial solver. The scheduler is owned by you and must
+	/// remain in scope.
+	void SetTaskScheduler(b2TaskScheduler* scheduler, int32 batchCount);
+
 	/// Register a routine for debug drawing. The debug draw functions are called
 	/// inside with b2World::DrawDebugData method. The debug draw object is owned
 	/// by you and must remain in scope.
@@ -220,6 +229,10 @@ private:
 	friend class b2Controller;
 
 	void Solve(const b2TimeStep& step);
+	// Defold modification
+	void SolveIslands(const b2TimeStep& step);
+	void SolveIslandsParallel(const b2TimeStep& step);
+	bool CanSolveIslandsParallel() const;
 	void SolveTOI(const b2TimeStep& step);
 
 	void DrawJoint(b2Joint* joint);
@@ -257,6 +270,11 @@ private:
 	bool m_stepComplete;
 
 	b2Profile m_profile;
+
+	// Defold modification
+	b2TaskScheduler* m_taskScheduler;
+	b2StackAllocator** m_batchAllocators;
+	int32 m_batchCount;
 };
 
 inline b2Body* b2World::GetBodyList()
@@ -152,4 +152,17 @@ public:
 									const b2Vec2& normal, float32 fraction) = 0;
 };
 
+/// Defold modification
+/// Interface used by b2World to solve independent islands in parallel.
+/// See b2World::SetTaskScheduler
+class b2TaskScheduler
+{
+public:
+	virtual ~b2TaskScheduler() {}
+
+	/// Run task(context, index) for every index in [0, count) and return when all are done.
+	/// The tasks may run concurrently, in any order, on any thread.
+	virtual void ParallelFor(void (*task)(void* context, int32 index), void* context, int32 count) = 0;
+};
+
 #endif
@@ -19,6 +19,7 @@
 #include <dlib/hash.h>
 #include <dlib/message.h>
 #include <dlib/transform.h>
+#include <dlib/worker_pool.h>
 
 template <typename T> class dmArray;
 
@@ -239,9 +240,13 @@ namespace dmPhysics
         uint32_t m_RayCastLimit3D;
         /// Maximum number of overlapping triggers
         uint32_t m_TriggerOverlapCapacity;
+        /// Worker pool used for parallel work, such as batched ray casts. 0 to do all work on the calling thread
+        dmWorkerPool::HWorkerPool m_WorkerPool;
         /// If true, the collision objects will retrieve the position of its game object
         uint8_t m_AllowDynamicTransforms:1;
-        uint8_t :7;
+        /// If true, independent islands are solved in parallel on the worker pool when using 2D physics
+        uint8_t m_ParallelIslands2D:1;
+        uint8_t :6;
     };
 
     /**
@@ -1114,6 +1119,28 @@ namespace dmPhysics
      */
     void RayCast2D(HWorld2D world, const RayCastRequest& request, dmArray<RayCastResponse>& results);
 
+    /**
+     * Perform a batch of synchronous ray casts, returning the closest hit of each ray.
+     * The rays are distributed over the worker pool of the context, if there is one.
+     *
+     * @param world Physics world in which to perform the ray casts
+     * @param requests Array of requests, m_ReturnAllResults is ignored
+     * @param request_count Number of requests
+     * @param responses Array receiving one response per request. m_Hit is 0 for rays that didn't hit anything.
+     */
+    void RayCastBatch3D(HWorld3D world, const RayCastRequest* requests, uint32_t request_count, RayCastResponse* responses);
+
+    /**
+     * Perform a batch of synchronous ray casts, returning the closest hit of each ray.
+     * The rays are distributed over the worker pool of the context, if there is one.
+     *
+     * @param world Physics world in which to perform the ray casts
+     * @param requests Array of requests, m_ReturnAllResults is ignored
+     * @param request_count Number of requests
+     * @param responses Array receiving one response per request. m_Hit is 0 for rays that didn't hit anything.
+     */
+    void RayCastBatch2D(HWorld2D world, const RayCastRequest* requests, uint32_t request_count, RayCastResponse* responses);
+
     /**
      * Set the gravity for a 2D physics world.
      *
@@ -30,6 +30,8 @@ namespace dmPhysics
     Context2D::Context2D()
     : m_Worlds()
     , m_DebugCallbacks()
+    , m_TaskScheduler()
+    , m_WorkerPool(0)
     , m_Gravity(0.0f, -10.0f)
     , m_Socket(0)
     , m_Scale(1.0f)
@@ -39,15 +41,48 @@ namespace dmPhysics
     , m_RayCastLimit(0)
     , m_TriggerOverlapCapacity(0)
     , m_AllowDynamicTransforms(0)
+    , m_ParallelIslands(0)
     {
 
     }
 
+    TaskScheduler2D::TaskScheduler2D()
+    : m_WorkerPool(0)
+    {
+
+    }
+
+    struct IslandTaskContext
+    {
+        void (*m_Task)(void* context, int32 index);
+        void* m_Context;
+    };
+
+    static void RunIslandTasks(void* _context, uint32_t begin, uint32_t end)
+    {
+        IslandTaskContext* context = (IslandTaskContext*)_context;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            context->m_Task(context->m_Context, (int32)i);
+        }
+    }
+
+    void TaskScheduler2D::ParallelFor(void (*task)(void* context, int32 index), void* context, int32 count)
+    {
+        DM_PROFILE(Physics, "SolveIslands");
+        IslandTaskContext task_context;
+        task_context.m_Task = task;
+        task_context.m_Context = context;
+        // Each task is already a batch of islands
+        dmWorkerPool::ParallelFor(m_WorkerPool, RunIslandTasks, &task_context, (uint32_t)count, 1);
+    }
+
     World2D::World2D(HContext2D context, const NewWorldParams& params)
     : m_TriggerOverlaps(context->m_TriggerOverlapCapacity)
     , m_Context(context)
     , m_World(context->m_Gravity)
     , m_RayCastRequests()
+    , m_RayCastResponses()
     , m_DebugDraw(&context->m_DebugCallbacks)
     , m_ContactListener(this)
     , m_GetWorldTransformCallback(params.m_GetWorldTransformCallback)
@@ -55,6 +90,7 @@ namespace dmPhysics
     , m_AllowDynamicTransforms(context->m_AllowDynamicTransforms)
     {
     	m_RayCastRequests.SetCapacity(context->m_RayCastLimit);
+        m_RayCastResponses.SetCapacity(context->m_RayCastLimit);
         OverlapCacheInit(&m_TriggerOverlaps);
     }
 
@@ -216,6 +252,9 @@ namespace dmPhysics
         context->m_RayCastLimit = params.m_RayCastLimit2D;
         context->m_TriggerOverlapCapacity = params.m_TriggerOverlapCapacity;
         context->m_AllowDynamicTransforms = params.m_AllowDynamicTransforms;
+        context->m_ParallelIslands = params.m_ParallelIslands2D;
+        context->m_WorkerPool = params.m_WorkerPool;
+        context->m_TaskScheduler.m_WorkerPool = params.m_WorkerPool;
         dmMessage::Result result = dmMessage::NewSocket(PHYSICS_SOCKET_NAME, &context->m_Socket);
         if (result != dmMessage::RESULT_OK)
         {
@@ -255,6 +294,13 @@ namespace dmPhysics
         world->m_World.SetDebugDraw(&world->m_DebugDraw);
         world->m_World.SetContactListener(&world->m_ContactListener);
         world->m_World.SetContinuousPhysics(false);
+        if (context->m_ParallelIslands && context->m_WorkerPool)
+        {
+            // Two batches per thread (the workers and the calling thread) to even out uneven islands.
+            // Each batch has its own Box2D stack allocator.
+            uint32_t thread_count = dmWorkerPool::GetWorkerCount(context->m_WorkerPool) + 1;
+            world->m_World.SetTaskScheduler(&context->m_TaskScheduler, (int32)(thread_count * 2));
+        }
         context->m_Worlds.Push(world);
         return world;
     }
@@ -462,20 +508,11 @@ namespace dmPhysics
         if (size > 0)
         {
             DM_PROFILE(Physics, "RayCasts");
-            ProcessRayCastResultCallback2D callback;
-            callback.m_Context = world->m_Context;
+            world->m_RayCastResponses.SetSize(size);
+            RayCastBatch2D(world, world->m_RayCastRequests.Begin(), size, world->m_RayCastResponses.Begin());
             for (uint32_t i = 0; i < size; ++i)
             {
-                RayCastRequest& request = world->m_RayCastRequests[i];
-                b2Vec2 from;
-                ToB2(request.m_From, from, scale);
-                b2Vec2 to;
-                ToB2(request.m_To, to, scale);
-                callback.m_IgnoredUserData = request.m_IgnoredUserData;
-                callback.m_CollisionMask = request.m_Mask;
-                callback.m_Response.m_Hit = 0;
-                world->m_World.RayCast(&callback, from, to);
-                (*step_context.m_RayCastCallback)(callback.m_Response, request, step_context.m_RayCastUserData);
+                (*step_context.m_RayCastCallback)(world->m_RayCastResponses[i], world->m_RayCastRequests[i], step_context.m_RayCastUserData);
             }
             world->m_RayCastRequests.SetSize(0);
         }
@@ -1194,6 +1231,53 @@ namespace dmPhysics
         }
     }
 
+    struct RayCastBatchContext2D
+    {
+        HWorld2D                m_World;
+        const RayCastRequest*   m_Requests;
+        RayCastResponse*        m_Responses;
+    };
+
+    // Called from the worker threads, the world is only read
+    static void RayCastRange2D(void* _context, uint32_t begin, uint32_t end)
+    {
+        RayCastBatchContext2D* context = (RayCastBatchContext2D*)_context;
+        HWorld2D world = context->m_World;
+        float scale = world->m_Context->m_Scale;
+
+        ProcessRayCastResultCallback2D callback;
+        callback.m_Context = world->m_Context;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            const RayCastRequest& request = context->m_Requests[i];
+            RayCastResponse& response = context->m_Responses[i];
+            b2Vec2 from;
+            ToB2(request.m_From, from, scale);
+            b2Vec2 to;
+            ToB2(request.m_To, to, scale);
+            if ((to - from).LengthSquared() <= 0.0f)
+            {
+                response = RayCastResponse();
+                continue;
+            }
+            callback.m_IgnoredUserData = request.m_IgnoredUserData;
+            callback.m_CollisionMask = request.m_Mask;
+            callback.m_Response.m_Hit = 0;
+            world->m_World.RayCast(&callback, from, to);
+            response = callback.m_Response;
+        }
+    }
+
+    void RayCastBatch2D(HWorld2D world, const RayCastRequest* requests, uint32_t request_count, RayCastResponse* responses)
+    {
+        DM_PROFILE(Physics, "RayCastBatch");
+        RayCastBatchContext2D context;
+        context.m_World = world;
+        context.m_Requests = requests;
+        context.m_Responses = responses;
+        dmWorkerPool::ParallelFor(world->m_Context->m_WorkerPool, RayCastRange2D, &context, request_count, RAY_CAST_BATCH_SIZE);
+    }
+
     void SetGravity2D(HWorld2D world, const Vectormath::Aos::Vector3& gravity)
     {
         b2Vec2 gravity_b;
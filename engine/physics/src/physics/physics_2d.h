@@ -37,6 +37,17 @@ namespace dmPhysics
         const StepWorldContext* m_TempStepWorldContext;
     };
 
+    /// Runs the island solver tasks of the 2D worlds on a worker pool
+    class TaskScheduler2D : public b2TaskScheduler
+    {
+    public:
+        TaskScheduler2D();
+
+        virtual void ParallelFor(void (*task)(void* context, int32 index), void* context, int32 count);
+
+        dmWorkerPool::HWorkerPool m_WorkerPool;
+    };
+
     struct World2D
     {
         World2D(HContext2D context, const NewWorldParams& params);
@@ -45,6 +56,7 @@ namespace dmPhysics
         HContext2D                  m_Context;
         b2World                     m_World;
         dmArray<RayCastRequest>     m_RayCastRequests;
+        dmArray<RayCastResponse>    m_RayCastResponses;
         DebugDraw2D                 m_DebugDraw;
         ContactListener             m_ContactListener;
         GetWorldTransformCallback   m_GetWorldTransformCallback;
@@ -59,6 +71,8 @@ namespace dmPhysics
 
         dmArray<World2D*>           m_Worlds;
         DebugCallbacks              m_DebugCallbacks;
+        TaskScheduler2D             m_TaskScheduler;
+        dmWorkerPool::HWorkerPool   m_WorkerPool;
         b2Vec2                      m_Gravity;
         dmMessage::HSocket          m_Socket;
         float                       m_Scale;
@@ -68,7 +82,8 @@ namespace dmPhysics
         int                         m_RayCastLimit;
         int                         m_TriggerOverlapCapacity;
         uint8_t                     m_AllowDynamicTransforms:1;
-        uint8_t                     :7;
+        uint8_t                     m_ParallelIslands:1;
+        uint8_t                     :6;
     };
 
     inline void ToB2(const Vectormath::Aos::Point3& p0, b2Vec2& p1, float scale)
@@ -226,6 +226,12 @@ namespace dmPhysics
     {
     }
 
+    void RayCastBatch2D(HWorld2D world, const RayCastRequest* requests, uint32_t request_count, RayCastResponse* responses)
+    {
+        for (uint32_t i = 0; i < request_count; ++i)
+            responses[i].m_Hit = 0;
+    }
+
     void SetGravity2D(HWorld2D world, const Vectormath::Aos::Vector3& gravity)
     {
     }
@@ -112,6 +112,7 @@ namespace dmPhysics
     Context3D::Context3D()
     : m_Worlds()
     , m_DebugCallbacks()
+    , m_WorkerPool(0)
     , m_Gravity(0.0f, -10.0f, 0.0f)
     , m_Socket(0)
     , m_Scale(1.0f)
@@ -153,6 +154,7 @@ namespace dmPhysics
         m_SetWorldTransform = params.m_SetWorldTransformCallback;
 
         m_RayCastRequests.SetCapacity(context->m_RayCastLimit);
+        m_RayCastResponses.SetCapacity(context->m_RayCastLimit);
         OverlapCacheInit(&m_TriggerOverlaps);
     }
 
@@ -284,6 +286,7 @@ namespace dmPhysics
         context->m_RayCastLimit = params.m_RayCastLimit3D;
         context->m_TriggerOverlapCapacity = params.m_TriggerOverlapCapacity;
         context->m_AllowDynamicTransforms = params.m_AllowDynamicTransforms;
+        context->m_WorkerPool = params.m_WorkerPool;
         dmMessage::Result result = dmMessage::NewSocket(PHYSICS_SOCKET_NAME, &context->m_Socket);
         if (result != dmMessage::RESULT_OK)
         {
@@ -430,33 +433,18 @@ namespace dmPhysics
         if (size > 0)
         {
             DM_PROFILE(Physics, "RayCasts");
-            for (uint32_t i = 0; i < size; ++i)
+            if (step_context.m_RayCastCallback == 0x0)
             {
-                const RayCastRequest& request = world->m_RayCastRequests[i];
-                if (step_context.m_RayCastCallback == 0x0)
-                {
-                    dmLogWarning("Ray cast requested without any response callback, skipped.");
-                    continue;
-                }
-                float scale = world->m_Context->m_Scale;
-                btVector3 from;
-                ToBt(request.m_From, from, scale);
-                btVector3 to;
-                ToBt(request.m_To, to, scale);
-                RayCastResultClosestCallback3D result_callback(from, to, request.m_Mask, request.m_IgnoredUserData);
-                world->m_DynamicsWorld->rayTest(from, to, result_callback);
-                RayCastResponse response;
-                response.m_Hit = result_callback.hasHit() ? 1 : 0;
-                response.m_Fraction = result_callback.m_closestHitFraction;
-                float inv_scale = world->m_Context->m_InvScale;
-                FromBt(result_callback.m_hitPointWorld, response.m_Position, inv_scale);
-                FromBt(result_callback.m_hitNormalWorld, response.m_Normal, 1.0f); // don't scale normal
-                if (result_callback.m_collisionObject != 0x0)
+                dmLogWarning("%d ray casts requested without any response callback, skipped.", size);
+            }
+            else
+            {
+                world->m_RayCastResponses.SetSize(size);
+                RayCastBatch3D(world, world->m_RayCastRequests.Begin(), size, world->m_RayCastResponses.Begin());
+                for (uint32_t i = 0; i < size; ++i)
                 {
-                    response.m_CollisionObjectUserData = result_callback.m_collisionObject->getUserPointer();
-                    response.m_CollisionObjectGroup = result_callback.m_collisionObject->getBroadphaseHandle()->m_collisionFilterGroup;
+                    step_context.m_RayCastCallback(world->m_RayCastResponses[i], world->m_RayCastRequests[i], step_context.m_RayCastUserData);
                 }
-                step_context.m_RayCastCallback(response, request, step_context.m_RayCastUserData);
             }
             world->m_RayCastRequests.SetSize(0);
         }
@@ -1156,6 +1144,54 @@ namespace dmPhysics
         }
     }
 
+    struct RayCastBatchContext3D
+    {
+        HWorld3D                m_World;
+        const RayCastRequest*   m_Requests;
+        RayCastResponse*        m_Responses;
+    };
+
+    // Called from the worker threads, the world is only read
+    static void RayCastRange3D(void* _context, uint32_t begin, uint32_t end)
+    {
+        RayCastBatchContext3D* context = (RayCastBatchContext3D*)_context;
+        HWorld3D world = context->m_World;
+        float scale = world->m_Context->m_Scale;
+        float inv_scale = world->m_Context->m_InvScale;
+
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            const RayCastRequest& request = context->m_Requests[i];
+            RayCastResponse& response = context->m_Responses[i];
+            response = RayCastResponse();
+            if (Vectormath::Aos::lengthSqr(request.m_To - request.m_From) <= 0.0f)
+            {
+                continue;
+            }
+
+            btVector3 from;
+            ToBt(request.m_From, from, scale);
+            btVector3 to;
+            ToBt(request.m_To, to, scale);
+            RayCastResultClosestCallback3D result_callback(from, to, request.m_Mask, request.m_IgnoredUserData);
+            world->m_DynamicsWorld->rayTest(from, to, result_callback);
+            if (result_callback.hasHit())
+            {
+                ResponseFromRayCastResult(response, inv_scale, result_callback.m_closestHitFraction, result_callback.m_hitPointWorld, result_callback.m_hitNormalWorld, result_callback.m_collisionObject);
+            }
+        }
+    }
+
+    void RayCastBatch3D(HWorld3D world, const RayCastRequest* requests, uint32_t request_count, RayCastResponse* responses)
+    {
+        DM_PROFILE(Physics, "RayCastBatch");
+        RayCastBatchContext3D context;
+        context.m_World = world;
+        context.m_Requests = requests;
+        context.m_Responses = responses;
+        dmWorkerPool::ParallelFor(world->m_Context->m_WorkerPool, RayCastRange3D, &context, request_count, RAY_CAST_BATCH_SIZE);
+    }
+
     void SetGravity3D(HWorld3D world, const Vectormath::Aos::Vector3& gravity)
     {
         HContext3D context = world->m_Context;
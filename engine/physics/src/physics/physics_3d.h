@@ -28,6 +28,7 @@ namespace dmPhysics
 
         OverlapCache                            m_TriggerOverlaps;
         dmArray<RayCastRequest>                 m_RayCastRequests;
+        dmArray<RayCastResponse>                m_RayCastResponses;
         DebugDraw3D                             m_DebugDraw;
         HContext3D                              m_Context;
         btDefaultCollisionConfiguration*        m_CollisionConfiguration;
@@ -47,6 +48,7 @@ namespace dmPhysics
 
         dmArray<World3D*>           m_Worlds;
         DebugCallbacks              m_DebugCallbacks;
+        dmWorkerPool::HWorkerPool   m_WorkerPool;
         btVector3                   m_Gravity;
         dmMessage::HSocket          m_Socket;
         float                       m_Scale;
@@ -30,7 +30,9 @@ namespace dmPhysics
     , m_RayCastLimit2D(0)
     , m_RayCastLimit3D(0)
     , m_TriggerOverlapCapacity(0)
+    , m_WorkerPool(0)
     , m_AllowDynamicTransforms(0)
+    , m_ParallelIslands2D(0)
     {
 
     }
@@ -38,6 +38,11 @@ namespace dmPhysics
      */
     const uint32_t CACHE_EXPANSION = 16;
 
+    /**
+     * Number of rays processed at a time by each worker in batched ray casts.
+     */
+    const uint32_t RAY_CAST_BATCH_SIZE = 32;
+
     /**
      * Used to track all overlaps given an object.
      */
@@ -125,6 +125,7 @@ Test3D::Test3D()
 , m_GetMassFunc(dmPhysics::GetMass3D)
 , m_RequestRayCastFunc(dmPhysics::RequestRayCast3D)
 , m_RayCastFunc(dmPhysics::RayCast3D)
+, m_RayCastBatchFunc(dmPhysics::RayCastBatch3D)
 , m_SetDebugCallbacksFunc(dmPhysics::SetDebugCallbacks3D)
 , m_ReplaceShapeFunc(dmPhysics::ReplaceShape3D)
 , m_SetGravityFunc(dmPhysics::SetGravity3D)
@@ -182,6 +183,7 @@ Test2D::Test2D()
 , m_GetMassFunc(dmPhysics::GetMass2D)
 , m_RequestRayCastFunc(dmPhysics::RequestRayCast2D)
 , m_RayCastFunc(dmPhysics::RayCast2D)
+, m_RayCastBatchFunc(dmPhysics::RayCastBatch2D)
 , m_SetDebugCallbacksFunc(dmPhysics::SetDebugCallbacks2D)
 , m_ReplaceShapeFunc(dmPhysics::ReplaceShape2D)
 , m_SetGravityFunc(dmPhysics::SetGravity2D)
@@ -1042,6 +1044,57 @@ TYPED_TEST(PhysicsTest, RayCasting)
     (*TestFixture::m_Test.m_DeleteCollisionShapeFunc)(shape);
 }
 
+TYPED_TEST(PhysicsTest, RayCastBatch)
+{
+    float box_half_ext = 0.5f;
+    VisualObject vo;
+    dmPhysics::CollisionObjectData data;
+    typename TypeParam::CollisionShapeType shape = (*TestFixture::m_Test.m_NewBoxShapeFunc)(TestFixture::m_Context, Vector3(box_half_ext, box_half_ext, box_half_ext));
+    data.m_Mass = 0.0f;
+    data.m_Type = dmPhysics::COLLISION_OBJECT_TYPE_KINEMATIC;
+    data.m_UserData = &vo;
+    typename TypeParam::CollisionObjectType box_co = (*TestFixture::m_Test.m_NewCollisionObjectFunc)(TestFixture::m_World, data, &shape, 1u);
+
+    // The rays are spread over the worker pool of the fixture context.
+    // Every other ray hits the box from above, the others pass beside it.
+    const uint32_t count = 1000;
+    dmPhysics::RayCastRequest* requests = new dmPhysics::RayCastRequest[count];
+    dmPhysics::RayCastResponse* responses = new dmPhysics::RayCastResponse[count];
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        float x = (i & 1) ? 2.0f : 0.4f * ((float)i / count - 0.5f);
+        requests[i].m_From = Vectormath::Aos::Point3(x, 1.0f, 0.0f);
+        requests[i].m_To = Vectormath::Aos::Point3(x, 0.0f, 0.0f);
+    }
+    // A zero length ray never hits
+    requests[0].m_To = requests[0].m_From;
+
+    (*TestFixture::m_Test.m_RayCastBatchFunc)(TestFixture::m_World, requests, count, responses);
+
+    ASSERT_FALSE(responses[0].m_Hit);
+    dmArray<dmPhysics::RayCastResponse> results;
+    for (uint32_t i = 1; i < count; ++i)
+    {
+        results.SetSize(0);
+        (*TestFixture::m_Test.m_RayCastFunc)(TestFixture::m_World, requests[i], results);
+        ASSERT_EQ(results.Size(), responses[i].m_Hit ? 1u : 0u);
+        ASSERT_EQ((i & 1) == 0, (bool)responses[i].m_Hit);
+        if (responses[i].m_Hit)
+        {
+            ASSERT_EQ(results[0].m_Fraction, responses[i].m_Fraction);
+            ASSERT_EQ(results[0].m_Position.getY(), responses[i].m_Position.getY());
+            ASSERT_EQ(results[0].m_Normal.getY(), responses[i].m_Normal.getY());
+            ASSERT_EQ((void*)&vo, (void*)responses[i].m_CollisionObjectUserData);
+        }
+    }
+
+    delete [] requests;
+    delete [] responses;
+
+    (*TestFixture::m_Test.m_DeleteCollisionObjectFunc)(TestFixture::m_World, box_co);
+    (*TestFixture::m_Test.m_DeleteCollisionShapeFunc)(shape);
+}
+
 TYPED_TEST(PhysicsTest, InsideRayCasting)
 {
     float box_half_ext = 0.5f;
@@ -51,6 +51,8 @@ protected:
         context_params.m_RayCastLimit2D = 64;
         context_params.m_RayCastLimit3D = 128;
         context_params.m_TriggerOverlapCapacity = 16;
+        m_WorkerPool = dmWorkerPool::New(2, "physics_test");
+        context_params.m_WorkerPool = m_WorkerPool;
         m_Context = (*m_Test.m_NewContextFunc)(context_params);
         dmPhysics::NewWorldParams world_params;
         world_params.m_GetWorldTransformCallback = GetWorldTransform;
@@ -69,10 +71,12 @@ protected:
     {
         (*m_Test.m_DeleteWorldFunc)(m_Context, m_World);
         (*m_Test.m_DeleteContextFunc)(m_Context);
+        dmWorkerPool::Delete(m_WorkerPool);
     }
 
     typename T::ContextType m_Context;
     typename T::WorldType m_World;
+    dmWorkerPool::HWorkerPool m_WorkerPool;
     T m_Test;
     dmPhysics::StepWorldContext m_StepWorldContext;
     int m_CollisionCount;
@@ -120,6 +124,7 @@ struct Funcs
     typedef float (*GetMassFunc)(typename T::CollisionObjectType collision_object);
     typedef void (*RequestRayCastFunc)(typename T::WorldType world, const dmPhysics::RayCastRequest& request);
     typedef void (*RayCastFunc)(typename T::WorldType world, const dmPhysics::RayCastRequest& request, dmArray<dmPhysics::RayCastResponse>& results);
+    typedef void (*RayCastBatchFunc)(typename T::WorldType world, const dmPhysics::RayCastRequest* requests, uint32_t request_count, dmPhysics::RayCastResponse* responses);
     typedef void (*SetDebugCallbacks)(typename T::ContextType context, const dmPhysics::DebugCallbacks& callbacks);
     typedef void (*ReplaceShapeFunc)(typename T::ContextType context, typename T::CollisionShapeType old_shape, typename T::CollisionShapeType new_shape);
     typedef void (*SetGravityFunc)(typename T::WorldType world, const Vectormath::Aos::Vector3& gravity);
@@ -174,6 +179,7 @@ struct Test3D
     Funcs<Test3D>::GetMassFunc                      m_GetMassFunc;
     Funcs<Test3D>::RequestRayCastFunc               m_RequestRayCastFunc;
     Funcs<Test3D>::RayCastFunc                      m_RayCastFunc;
+    Funcs<Test3D>::RayCastBatchFunc                 m_RayCastBatchFunc;
     Funcs<Test3D>::SetDebugCallbacks                m_SetDebugCallbacksFunc;
     Funcs<Test3D>::ReplaceShapeFunc                 m_ReplaceShapeFunc;
     Funcs<Test3D>::SetGravityFunc                   m_SetGravityFunc;
@@ -231,6 +237,7 @@ struct Test2D
     Funcs<Test2D>::GetMassFunc                      m_GetMassFunc;
     Funcs<Test2D>::RequestRayCastFunc               m_RequestRayCastFunc;
     Funcs<Test2D>::RayCastFunc                      m_RayCastFunc;
+    Funcs<Test2D>::RayCastBatchFunc                 m_RayCastBatchFunc;
     Funcs<Test2D>::SetDebugCallbacks                m_SetDebugCallbacksFunc;
     Funcs<Test2D>::ReplaceShapeFunc                 m_ReplaceShapeFunc;
     Funcs<Test2D>::SetGravityFunc                   m_SetGravityFunc;
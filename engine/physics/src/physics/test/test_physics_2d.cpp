@@ -22,7 +22,9 @@
 
 #include <vector>
 #include <dlib/math.h>
+#include <dlib/time.h>
 #include <dlib/vmath.h>
+#include <dlib/worker_pool.h>
 
 using namespace Vectormath::Aos;
 
@@ -1607,6 +1609,98 @@ TYPED_TEST(PhysicsTest, SetGridShapeEnable)
     dmPhysics::DeleteHullSet2D(hull_set);
 }
 
+// Steps a world of independent box piles and returns the final box positions
+static uint64_t StepBoxPiles(dmWorkerPool::HWorkerPool pool, uint32_t pile_count, uint32_t pile_height, uint32_t step_count, std::vector<Point3>& positions, int* contact_point_count)
+{
+    dmPhysics::NewContextParams context_params;
+    context_params.m_Scale = PHYSICS_SCALE;
+    context_params.m_WorkerPool = pool;
+    context_params.m_ParallelIslands2D = 1;
+    dmPhysics::HContext2D context = dmPhysics::NewContext2D(context_params);
+    dmPhysics::NewWorldParams world_params;
+    world_params.m_GetWorldTransformCallback = GetWorldTransform;
+    world_params.m_SetWorldTransformCallback = SetWorldTransform;
+    dmPhysics::HWorld2D world = dmPhysics::NewWorld2D(context, world_params);
+
+    const float pile_spacing = 4.0f;
+    VisualObject ground;
+    ground.m_Position.setX(pile_count * pile_spacing * 0.5f);
+    dmPhysics::HCollisionShape2D ground_shape = dmPhysics::NewBoxShape2D(context, Vector3(pile_count * pile_spacing, 0.5f, 0.0f));
+    dmPhysics::CollisionObjectData data;
+    data.m_Type = dmPhysics::COLLISION_OBJECT_TYPE_STATIC;
+    data.m_Mass = 0.0f;
+    data.m_UserData = &ground;
+    dmPhysics::HCollisionObject2D ground_co = dmPhysics::NewCollisionObject2D(world, data, &ground_shape, 1u);
+
+    uint32_t box_count = pile_count * pile_height;
+    std::vector<VisualObject> boxes(box_count);
+    std::vector<dmPhysics::HCollisionObject2D> box_cos(box_count);
+    dmPhysics::HCollisionShape2D box_shape = dmPhysics::NewBoxShape2D(context, Vector3(0.5f, 0.5f, 0.0f));
+    data.m_Type = dmPhysics::COLLISION_OBJECT_TYPE_DYNAMIC;
+    data.m_Mass = 1.0f;
+    for (uint32_t i = 0; i < box_count; ++i)
+    {
+        VisualObject& box = boxes[i];
+        box.m_Position.setX((i / pile_height) * pile_spacing + 0.01f * (i % 3));
+        box.m_Position.setY(1.0f + (i % pile_height) * 1.05f);
+        data.m_UserData = &box;
+        box_cos[i] = dmPhysics::NewCollisionObject2D(world, data, &box_shape, 1u);
+    }
+
+    dmPhysics::StepWorldContext step_context;
+    step_context.m_DT = 1.0f / 60.0f;
+    step_context.m_ContactPointCallback = ContactPointCallback;
+    step_context.m_ContactPointUserData = contact_point_count;
+
+    uint64_t start = dmTime::GetTime();
+    for (uint32_t i = 0; i < step_count; ++i)
+    {
+        dmPhysics::StepWorld2D(world, step_context);
+    }
+    uint64_t elapsed = dmTime::GetTime() - start;
+
+    positions.resize(box_count);
+    for (uint32_t i = 0; i < box_count; ++i)
+    {
+        positions[i] = boxes[i].m_Position;
+        dmPhysics::DeleteCollisionObject2D(world, box_cos[i]);
+    }
+    dmPhysics::DeleteCollisionObject2D(world, ground_co);
+    dmPhysics::DeleteCollisionShape2D(box_shape);
+    dmPhysics::DeleteCollisionShape2D(ground_shape);
+    dmPhysics::DeleteWorld2D(context, world);
+    dmPhysics::DeleteContext2D(context);
+    return elapsed;
+}
+
+TEST(PhysicsParallel2D, IslandStress)
+{
+    const uint32_t pile_count = 256;
+    const uint32_t pile_height = 12;
+    const uint32_t step_count = 120;
+
+    std::vector<Point3> serial_positions;
+    int serial_contact_points = 0;
+    uint64_t serial_time = StepBoxPiles(0, pile_count, pile_height, step_count, serial_positions, &serial_contact_points);
+
+    dmWorkerPool::HWorkerPool pool = dmWorkerPool::New(3, "physics_test");
+    std::vector<Point3> parallel_positions;
+    int parallel_contact_points = 0;
+    uint64_t parallel_time = StepBoxPiles(pool, pile_count, pile_height, step_count, parallel_positions, &parallel_contact_points);
+    dmWorkerPool::Delete(pool);
+
+    printf("%u bodies, %u steps: serial %.2f ms, parallel %.2f ms\n", pile_count * pile_height, step_count, serial_time / 1000.0f, parallel_time / 1000.0f);
+
+    // The parallel solver must give the exact same result
+    ASSERT_EQ(serial_contact_points, parallel_contact_points);
+    ASSERT_EQ(serial_positions.size(), parallel_positions.size());
+    for (uint32_t i = 0; i < serial_positions.size(); ++i)
+    {
+        ASSERT_EQ(serial_positions[i].getX(), parallel_positions[i].getX());
+        ASSERT_EQ(serial_positions[i].getY(), parallel_positions[i].getY());
+    }
+}
+
 int main(int argc, char **argv)
 {
     jc_test_init(&argc, argv);
@@ -68,6 +68,17 @@ namespace dmRender
 
     }
 
+    // Max number of cached text layouts per font map, the cache is cleared when full
+    static const uint32_t MAX_LAYOUT_CACHE_ENTRIES = 512;
+
+    // The line breaks of a text, see Layout()
+    struct LayoutCacheEntry
+    {
+        TextLine*   m_Lines;
+        uint32_t    m_LineCount;
+        float       m_LayoutWidth;
+    };
+
     struct FontMap
     {
         FontMap()
@@ -86,6 +97,10 @@ namespace dmRender
         , m_CacheColumns(0)
         , m_CacheRows(0)
         , m_CellTempData(0)
+        , m_CacheData(0)
+        , m_CacheChannels(0)
+        , m_CacheDirtyMinY(0)
+        , m_CacheDirtyMaxY(0)
         , m_CacheCellWidth(0)
         , m_CacheCellHeight(0)
         , m_CacheCellMaxAscent(0)
@@ -106,9 +121,24 @@ namespace dmRender
             if (m_CellTempData) {
                 free(m_CellTempData);
             }
+            if (m_CacheData) {
+                free(m_CacheData);
+            }
+            ClearLayoutCache();
             dmGraphics::DeleteTexture(m_Texture);
         }
 
+        static void FreeLayoutCacheEntry(void*, const uint64_t*, LayoutCacheEntry* entry)
+        {
+            free(entry->m_Lines);
+        }
+
+        void ClearLayoutCache()
+        {
+            m_LayoutCache.Iterate(FreeLayoutCacheEntry, (void*)0);
+            m_LayoutCache.Clear();
+        }
+
         dmGraphics::HTexture    m_Texture;
         HMaterial               m_Material;
         dmHashTable32<Glyph>    m_Glyphs;
@@ -139,6 +169,16 @@ namespace dmRender
 
         uint8_t*                m_CellTempData; // a temporary unpack buffer for the compressed glyphs
 
+        // A copy of the cache texture. New glyphs are written here, and the rows
+        // [m_CacheDirtyMinY, m_CacheDirtyMaxY) are uploaded at the end of the dispatch
+        uint8_t*                m_CacheData;
+        uint32_t                m_CacheChannels;
+        uint32_t                m_CacheDirtyMinY;
+        uint32_t                m_CacheDirtyMaxY;
+
+        // Hash of (text, width, tracking) -> line breaks
+        dmHashTable64<LayoutCacheEntry> m_LayoutCache;
+
         uint32_t                m_CacheCellWidth;
         uint32_t                m_CacheCellHeight;
         uint32_t                m_CacheCellMaxAscent;
@@ -148,19 +188,22 @@ namespace dmRender
 
     static float GetLineTextMetrics(HFontMap font_map, float tracking, const char* text, int n);
 
-    static void InitFontmap(FontMapParams& params, dmGraphics::TextureParams& tex_params, uint8_t init_val)
+    // The data is kept as the cache copy of the texture, see FontMap::m_CacheData
+    static void InitFontmap(FontMap* font_map, FontMapParams& params, dmGraphics::TextureParams& tex_params, uint8_t init_val)
     {
         uint8_t bpp = params.m_GlyphChannels;
         uint32_t data_size = tex_params.m_Width * tex_params.m_Height * bpp;
         tex_params.m_Data = malloc(data_size);
         tex_params.m_DataSize = data_size;
         memset((void*)tex_params.m_Data, init_val, tex_params.m_DataSize);
-    }
 
-    static void CleanupFontmap(dmGraphics::TextureParams& tex_params)
-    {
-        free((void*)tex_params.m_Data);
-        tex_params.m_DataSize = 0;
+        if (font_map->m_CacheData) {
+            free(font_map->m_CacheData);
+        }
+        font_map->m_CacheData = (uint8_t*)tex_params.m_Data;
+        font_map->m_CacheChannels = bpp;
+        font_map->m_CacheDirtyMinY = 0;
+        font_map->m_CacheDirtyMaxY = 0;
     }
 
     // Font maps have no mips, so we need to make sure we use a supported min filter
@@ -267,9 +310,8 @@ namespace dmRender
         tex_params.m_MagFilter = dmGraphics::TEXTURE_FILTER_LINEAR;
         font_map->m_Texture = dmGraphics::NewTexture(graphics_context, tex_create_params);
 
-        InitFontmap(params, tex_params, 0);
+        InitFontmap(font_map, params, tex_params, 0);
         dmGraphics::SetTexture(font_map->m_Texture, tex_params);
-        CleanupFontmap(tex_params);
 
         return font_map;
     }
@@ -296,6 +338,9 @@ namespace dmRender
             free(font_map->m_CellTempData);
         }
 
+        // the metrics may have changed
+        font_map->ClearLayoutCache();
+
         font_map->m_ShadowX = params.m_ShadowX;
         font_map->m_ShadowY = params.m_ShadowY;
         font_map->m_MaxAscent = params.m_MaxAscent;
@@ -351,9 +396,8 @@ namespace dmRender
         tex_params.m_Width = params.m_CacheWidth;
         tex_params.m_Height = params.m_CacheHeight;
 
-        InitFontmap(params, tex_params, 0);
+        InitFontmap(font_map, params, tex_params, 0);
         dmGraphics::SetTexture(font_map->m_Texture, tex_params);
-        CleanupFontmap(tex_params);
     }
 
     dmGraphics::HTexture GetFontMapTexture(HFontMap font_map)
@@ -386,6 +430,7 @@ namespace dmRender
         text_context.m_VerticesFlushed = 0;
         text_context.m_Frame = 0;
         text_context.m_TextEntriesFlushed = 0;
+        text_context.m_DirtyFontMaps.SetCapacity(8);
 
         dmMemory::Result r = dmMemory::AlignedMalloc((void**)&text_context.m_ClientBuffer, 16, buffer_size);
         if (r != dmMemory::RESULT_OK) {
@@ -556,14 +601,9 @@ namespace dmRender
         return g;
     }
 
+    // Writes the glyph into the cache copy of the texture. The texture itself is updated for all new glyphs at once, see UploadGlyphCaches()
     void AddGlyphToCache(HFontMap font_map, TextContext& text_context, Glyph* g, int16_t g_offset_y) {
         uint32_t prev_cache_cursor = font_map->m_CacheCursor;
-        dmGraphics::TextureParams tex_params;
-        tex_params.m_SubUpdate = true;
-        tex_params.m_MipMap = 0;
-        tex_params.m_Format = font_map->m_CacheFormat;
-        tex_params.m_MinFilter = font_map->m_MinFilter;
-        tex_params.m_MagFilter = font_map->m_MagFilter;
 
         // Locate a cache cell candidate
         do {
@@ -585,49 +625,78 @@ namespace dmRender
                 g->m_Frame = text_context.m_Frame;
                 g->m_InCache = true;
 
-                // Upload glyph data to GPU
-                tex_params.m_Width = g->m_Width + font_map->m_CacheCellPadding*2;
-                tex_params.m_Height = g->m_Ascent + g->m_Descent + font_map->m_CacheCellPadding*2;
+                uint32_t glyph_width = g->m_Width + font_map->m_CacheCellPadding*2;
+                uint32_t glyph_height = g->m_Ascent + g->m_Descent + font_map->m_CacheCellPadding*2;
+
+                uint32_t bytes_per_pixel;
+                dmWebP::TextureEncodeFormat encode_format;
+                switch (font_map->m_CacheFormat) {
+                    case dmGraphics::TEXTURE_FORMAT_RGB:        bytes_per_pixel = 3;
+                                                                encode_format = dmWebP::TEXTURE_ENCODE_FORMAT_RGB888;
+                                                                break;
+                    case dmGraphics::TEXTURE_FORMAT_RGBA:       bytes_per_pixel = 4;
+                                                                encode_format = dmWebP::TEXTURE_ENCODE_FORMAT_RGBA8888;
+                                                                break;
+                    case dmGraphics::TEXTURE_FORMAT_LUMINANCE:
+                    default:                                    bytes_per_pixel = 1;
+                                                                encode_format = dmWebP::TEXTURE_ENCODE_FORMAT_L8;
+                };
 
                 uint8_t* glyph_data = (uint8_t*)(uint8_t*)font_map->m_GlyphData + g->m_GlyphDataOffset;
                 uint32_t glyph_data_size = g->m_GlyphDataSize-1; // The first byte is a header
                 uint8_t is_compressed = *glyph_data++;
 
+                const uint8_t* src = glyph_data;
                 if (is_compressed) {
-
-                    uint32_t bytes_per_pixel;
-                    dmWebP::TextureEncodeFormat encode_format;
-                    switch (font_map->m_CacheFormat) {
-                        case dmGraphics::TEXTURE_FORMAT_RGB:        bytes_per_pixel = 3;
-                                                                    encode_format = dmWebP::TEXTURE_ENCODE_FORMAT_RGB888;
-                                                                    break;
-                        case dmGraphics::TEXTURE_FORMAT_RGBA:       bytes_per_pixel = 4;
-                                                                    encode_format = dmWebP::TEXTURE_ENCODE_FORMAT_RGBA8888;
-                                                                    break;
-                        case dmGraphics::TEXTURE_FORMAT_LUMINANCE:
-                        default:                                    bytes_per_pixel = 1;
-                                                                    encode_format = dmWebP::TEXTURE_ENCODE_FORMAT_L8;
-                    };
-
                     dmWebP::Result result = dmWebP::DecodeCompressedTexture(glyph_data,
                                                 glyph_data_size,
                                                 font_map->m_CellTempData,
                                                 font_map->m_CacheCellWidth*font_map->m_CacheCellHeight*4, // the max size
-                                                tex_params.m_Width*bytes_per_pixel,
+                                                glyph_width*bytes_per_pixel,
                                                 encode_format);
 
                     if (result != dmWebP::RESULT_OK) {
                         dmLogWarning("Failed to decompress glyph: %d", result);
                     }
-                    tex_params.m_Data = font_map->m_CellTempData;
-                } else {
-                    tex_params.m_Data = glyph_data;
+                    src = font_map->m_CellTempData;
                 }
 
-                tex_params.m_X = g->m_X;
-                tex_params.m_Y = g->m_Y + g_offset_y;
+                // Copy the glyph rows into the cache copy, clipped to the texture
+                int32_t dst_x = g->m_X;
+                int32_t dst_y = g->m_Y + g_offset_y;
+                int32_t y_begin = dmMath::Max(0, -dst_y);
+                int32_t y_end = dmMath::Min((int32_t)glyph_height, (int32_t)font_map->m_CacheHeight - dst_y);
+                int32_t x_end = dmMath::Min((int32_t)glyph_width, (int32_t)font_map->m_CacheWidth - dst_x);
+                if (x_end <= 0)
+                {
+                    // The cell starts outside the texture, nothing to copy
+                    x_end = 0;
+                    y_end = y_begin;
+                }
+                uint32_t row_size = (uint32_t)x_end * bytes_per_pixel;
+                uint32_t dst_stride = font_map->m_CacheWidth * bytes_per_pixel;
+                for (int32_t y = y_begin; y < y_end; ++y)
+                {
+                    memcpy(font_map->m_CacheData + (dst_y + y) * dst_stride + dst_x * bytes_per_pixel, src + y * glyph_width * bytes_per_pixel, row_size);
+                }
 
-                dmGraphics::SetTexture(font_map->m_Texture, tex_params);
+                if (y_begin < y_end)
+                {
+                    if (font_map->m_CacheDirtyMinY >= font_map->m_CacheDirtyMaxY)
+                    {
+                        font_map->m_CacheDirtyMinY = dst_y + y_begin;
+                        font_map->m_CacheDirtyMaxY = dst_y + y_end;
+                        if (text_context.m_DirtyFontMaps.Full())
+                            text_context.m_DirtyFontMaps.OffsetCapacity(8);
+                        text_context.m_DirtyFontMaps.Push(font_map);
+                    }
+                    else
+                    {
+                        font_map->m_CacheDirtyMinY = dmMath::Min(font_map->m_CacheDirtyMinY, (uint32_t)(dst_y + y_begin));
+                        font_map->m_CacheDirtyMaxY = dmMath::Max(font_map->m_CacheDirtyMaxY, (uint32_t)(dst_y + y_end));
+                    }
+                }
+                DM_COUNTER("FontGlyphCacheMisses", 1);
                 break;
             }
 
@@ -638,6 +707,86 @@ namespace dmRender
         }
     }
 
+    // Uploads the rows of the cache textures that new glyphs were written to, with one sub update per font map
+    static void UploadGlyphCaches(TextContext& text_context)
+    {
+        DM_PROFILE(Render, "UploadGlyphCaches");
+        uint32_t n = text_context.m_DirtyFontMaps.Size();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            HFontMap font_map = text_context.m_DirtyFontMaps[i];
+            uint32_t stride = font_map->m_CacheWidth * font_map->m_CacheChannels;
+
+            dmGraphics::TextureParams tex_params;
+            tex_params.m_SubUpdate = true;
+            tex_params.m_MipMap = 0;
+            tex_params.m_Format = font_map->m_CacheFormat;
+            tex_params.m_MinFilter = font_map->m_MinFilter;
+            tex_params.m_MagFilter = font_map->m_MagFilter;
+            tex_params.m_X = 0;
+            tex_params.m_Y = font_map->m_CacheDirtyMinY;
+            tex_params.m_Width = font_map->m_CacheWidth;
+            tex_params.m_Height = font_map->m_CacheDirtyMaxY - font_map->m_CacheDirtyMinY;
+            tex_params.m_Data = font_map->m_CacheData + font_map->m_CacheDirtyMinY * stride;
+            tex_params.m_DataSize = tex_params.m_Height * stride;
+            dmGraphics::SetTexture(font_map->m_Texture, tex_params);
+
+            DM_COUNTER("FontGlyphCacheUploadSize", tex_params.m_DataSize);
+            font_map->m_CacheDirtyMinY = 0;
+            font_map->m_CacheDirtyMaxY = 0;
+        }
+        text_context.m_DirtyFontMaps.SetSize(0);
+    }
+
+    // Breaks the text into lines, or returns the lines from the font map layout cache if the same text has been laid out before.
+    // The leading only offsets the lines, and is not part of the key. The returned lines are valid until the next call.
+    static uint32_t LayoutCached(HFontMap font_map, const char* text, float width, float tracking, const TextLine** out_lines, float* out_layout_width)
+    {
+        HashState64 key_state;
+        dmHashInit64(&key_state, false);
+        dmHashUpdateBuffer64(&key_state, text, strlen(text));
+        dmHashUpdateBuffer64(&key_state, &width, sizeof(width));
+        dmHashUpdateBuffer64(&key_state, &tracking, sizeof(tracking));
+        uint64_t key = dmHashFinal64(&key_state);
+
+        LayoutCacheEntry* entry = font_map->m_LayoutCache.Get(key);
+        if (entry)
+        {
+            DM_COUNTER("FontLayoutCacheHits", 1);
+            *out_lines = entry->m_Lines;
+            *out_layout_width = entry->m_LayoutWidth;
+            return entry->m_LineCount;
+        }
+        DM_COUNTER("FontLayoutCacheMisses", 1);
+
+        const uint32_t max_lines = 128;
+        TextLine lines[max_lines];
+
+        LayoutMetrics lm(font_map, tracking);
+        LayoutCacheEntry new_entry;
+        new_entry.m_LineCount = Layout(text, width, lines, max_lines, &new_entry.m_LayoutWidth, lm);
+        new_entry.m_Lines = (TextLine*)malloc(sizeof(TextLine) * dmMath::Max(new_entry.m_LineCount, 1u));
+        memcpy(new_entry.m_Lines, lines, sizeof(TextLine) * new_entry.m_LineCount);
+
+        if (font_map->m_LayoutCache.Full())
+        {
+            if (font_map->m_LayoutCache.Capacity() < MAX_LAYOUT_CACHE_ENTRIES)
+            {
+                uint32_t capacity = dmMath::Min(font_map->m_LayoutCache.Capacity() + 64, MAX_LAYOUT_CACHE_ENTRIES);
+                font_map->m_LayoutCache.SetCapacity((2 * capacity) / 3, capacity);
+            }
+            else
+            {
+                font_map->ClearLayoutCache();
+            }
+        }
+        font_map->m_LayoutCache.Put(key, new_entry);
+
+        *out_lines = font_map->m_LayoutCache.Get(key)->m_Lines;
+        *out_layout_width = new_entry.m_LayoutWidth;
+        return new_entry.m_LineCount;
+    }
+
     static int CreateFontVertexDataInternal(TextContext& text_context, HFontMap font_map, const char* text, const TextEntry& te, float recip_w, float recip_h, GlyphVertex* vertices, uint32_t num_vertices)
     {
         float width = te.m_Width;
@@ -648,12 +797,9 @@ namespace dmRender
         float leading = line_height * te.m_Leading;
         float tracking = line_height * te.m_Tracking;
 
-        const uint32_t max_lines = 128;
-        TextLine lines[max_lines];
-
-        LayoutMetrics lm(font_map, tracking);
+        const TextLine* lines;
         float layout_width;
-        int line_count = Layout(text, width, lines, max_lines, &layout_width, lm);
+        int line_count = LayoutCached(font_map, text, width, tracking, &lines, &layout_width);
         float x_offset = OffsetX(te.m_Align, te.m_Width);
         float y_offset = OffsetY(te.m_VAlign, te.m_Height, font_map->m_MaxAscent, font_map->m_MaxDescent, te.m_Leading, line_count);
 
@@ -700,7 +846,7 @@ namespace dmRender
             // Calculate number of valid glyphs
             for (int line = 0; line < line_count; ++line)
             {
-                TextLine& l = lines[line];
+                const TextLine& l = lines[line];
                 const char* cursor = &text[l.m_Index];
                 bool inner_break = false;
 
@@ -750,7 +896,7 @@ namespace dmRender
         }
 
         for (int line = 0; line < line_count; ++line) {
-            TextLine& l = lines[line];
+            const TextLine& l = lines[line];
             int16_t x = (int16_t)(x_offset - OffsetX(te.m_Align, l.m_Width) + 0.5f);
             int16_t y = (int16_t) (y_offset - line * leading + 0.5f);
             const char* cursor = &text[l.m_Index];
@@ -1021,6 +1167,8 @@ namespace dmRender
                 break;
             case dmRender::RENDER_LIST_OPERATION_END:
                 {
+                    UploadGlyphCaches(text_context);
+
                     if (text_context.m_VertexIndex != text_context.m_VerticesFlushed)
                     {
                         uint32_t buffer_size = sizeof(GlyphVertex) * text_context.m_VertexIndex;
@@ -1110,14 +1258,11 @@ namespace dmRender
             width = FLT_MAX;
         }
 
-        const uint32_t max_lines = 128;
-        dmRender::TextLine lines[max_lines];
-
         float line_height = font_map->m_MaxAscent + font_map->m_MaxDescent;
 
-        LayoutMetrics lm(font_map, tracking * line_height);
+        const TextLine* lines;
         float layout_width;
-        uint32_t num_lines = Layout(text, width, lines, max_lines, &layout_width, lm);
+        uint32_t num_lines = LayoutCached(font_map, text, width, tracking * line_height, &lines, &layout_width);
         metrics->m_Width = layout_width;
         metrics->m_Height = num_lines * (line_height * leading) - line_height * (leading - 1.0f);
     }
@@ -1127,6 +1272,7 @@ namespace dmRender
         uint32_t size = sizeof(FontMap);
         size += font_map->m_Glyphs.Capacity()*(sizeof(Glyph)+sizeof(uint32_t));
         size += dmGraphics::GetTextureResourceSize(font_map->m_Texture);
+        size += font_map->m_CacheWidth * font_map->m_CacheHeight * font_map->m_CacheChannels;
         return size;
     }
 
@@ -154,112 +154,143 @@ namespace dmRender
         delete material;
     }
 
-    void ApplyMaterialConstants(dmRender::HRenderContext render_context, HMaterial material, const RenderObject* ro)
+    static void ApplyMaterialConstant(dmRender::HRenderContext render_context, dmGraphics::HContext graphics_context, const Constant& constant, const RenderObject* ro)
     {
-        const dmArray<MaterialConstant>& constants = material->m_Constants;
-        dmGraphics::HContext graphics_context = dmRender::GetGraphicsContext(render_context);
-        uint32_t n = constants.Size();
-        for (uint32_t i = 0; i < n; ++i)
+        int32_t location = constant.m_Location;
+        switch (constant.m_Type)
         {
-            const MaterialConstant& material_constant = constants[i];
-            const Constant& constant = material_constant.m_Constant;
-            int32_t location = constant.m_Location;
-            switch (constant.m_Type)
+            case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_USER:
             {
-                case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_USER:
-                {
-                    dmGraphics::SetConstantV4(graphics_context, &constant.m_Value, location);
-                    break;
-                }
-                case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_VIEWPROJ:
+                dmGraphics::SetConstantV4(graphics_context, &constant.m_Value, location);
+                break;
+            }
+            case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_VIEWPROJ:
+            {
+                if (dmGraphics::GetShaderProgramLanguage(graphics_context) == dmGraphics::ShaderDesc::LANGUAGE_SPIRV)
                 {
-                    if (dmGraphics::GetShaderProgramLanguage(graphics_context) == dmGraphics::ShaderDesc::LANGUAGE_SPIRV)
-                    {
-                        Matrix4 ndc_matrix = Matrix4::identity();
-                        ndc_matrix.setElem(2, 2, 0.5f );
-                        ndc_matrix.setElem(3, 2, 0.5f );
-                        const Matrix4 view_projection = ndc_matrix * render_context->m_ViewProj;
-                        dmGraphics::SetConstantM4(graphics_context, (Vector4*)&view_projection, location);
-                    }
-                    else
-                    {
-                        dmGraphics::SetConstantM4(graphics_context, (Vector4*)&render_context->m_ViewProj, location);
-                    }
-                    break;
+                    Matrix4 ndc_matrix = Matrix4::identity();
+                    ndc_matrix.setElem(2, 2, 0.5f );
+                    ndc_matrix.setElem(3, 2, 0.5f );
+                    const Matrix4 view_projection = ndc_matrix * render_context->m_ViewProj;
+                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&view_projection, location);
                 }
-                case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_WORLD:
+                else
                 {
-                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&ro->m_WorldTransform, location);
-                    break;
+                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&render_context->m_ViewProj, location);
                 }
-                case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_TEXTURE:
+                break;
+            }
+            case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_WORLD:
+            {
+                dmGraphics::SetConstantM4(graphics_context, (Vector4*)&ro->m_WorldTransform, location);
+                break;
+            }
+            case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_TEXTURE:
+            {
+                dmGraphics::SetConstantM4(graphics_context, (Vector4*)&ro->m_TextureTransform, location);
+                break;
+            }
+            case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_VIEW:
+            {
+                dmGraphics::SetConstantM4(graphics_context, (Vector4*)&render_context->m_View, location);
+                break;
+            }
+            case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_PROJECTION:
+            {
+                // Vulkan NDC is [0..1] for z, so we must transform
+                // the projection before setting the constant.
+                if (dmGraphics::GetShaderProgramLanguage(graphics_context) == dmGraphics::ShaderDesc::LANGUAGE_SPIRV)
                 {
-                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&ro->m_TextureTransform, location);
-                    break;
+                    Matrix4 ndc_matrix = Matrix4::identity();
+                    ndc_matrix.setElem(2, 2, 0.5f );
+                    ndc_matrix.setElem(3, 2, 0.5f );
+                    const Matrix4 proj = ndc_matrix * render_context->m_Projection;
+                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&proj, location);
                 }
-                case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_VIEW:
+                else
                 {
-                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&render_context->m_View, location);
-                    break;
+                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&render_context->m_Projection, location);
                 }
-                case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_PROJECTION:
+                break;
+            }
+            case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_NORMAL:
+            {
                 {
-                    // Vulkan NDC is [0..1] for z, so we must transform
-                    // the projection before setting the constant.
-                    if (dmGraphics::GetShaderProgramLanguage(graphics_context) == dmGraphics::ShaderDesc::LANGUAGE_SPIRV)
-                    {
-                        Matrix4 ndc_matrix = Matrix4::identity();
-                        ndc_matrix.setElem(2, 2, 0.5f );
-                        ndc_matrix.setElem(3, 2, 0.5f );
-                        const Matrix4 proj = ndc_matrix * render_context->m_Projection;
-                        dmGraphics::SetConstantM4(graphics_context, (Vector4*)&proj, location);
-                    }
-                    else
-                    {
-                        dmGraphics::SetConstantM4(graphics_context, (Vector4*)&render_context->m_Projection, location);
-                    }
-                    break;
+                    // normalT = transp(inv(view * world))
+                    Matrix4 normalT = render_context->m_View * ro->m_WorldTransform;
+                    // The world transform might include non-uniform scaling, which breaks the orthogonality of the combined model-view transform
+                    // It is always affine however
+                    normalT = affineInverse(normalT);
+                    normalT = transpose(normalT);
+                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&normalT, location);
                 }
-                case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_NORMAL:
+                break;
+            }
+            case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_WORLDVIEW:
+            {
                 {
-                    {
-                        // normalT = transp(inv(view * world))
-                        Matrix4 normalT = render_context->m_View * ro->m_WorldTransform;
-                        // The world transform might include non-uniform scaling, which breaks the orthogonality of the combined model-view transform
-                        // It is always affine however
-                        normalT = affineInverse(normalT);
-                        normalT = transpose(normalT);
-                        dmGraphics::SetConstantM4(graphics_context, (Vector4*)&normalT, location);
-                    }
-                    break;
+                    Matrix4 world_view = render_context->m_View * ro->m_WorldTransform;
+                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&world_view, location);
                 }
-                case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_WORLDVIEW:
+                break;
+            }
+            case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_WORLDVIEWPROJ:
+            {
+                if (dmGraphics::GetShaderProgramLanguage(graphics_context) == dmGraphics::ShaderDesc::LANGUAGE_SPIRV)
                 {
-                    {
-                        Matrix4 world_view = render_context->m_View * ro->m_WorldTransform;
-                        dmGraphics::SetConstantM4(graphics_context, (Vector4*)&world_view, location);
-                    }
-                    break;
+                    Matrix4 ndc_matrix = Matrix4::identity();
+                    ndc_matrix.setElem(2, 2, 0.5f );
+                    ndc_matrix.setElem(3, 2, 0.5f );
+                    const Matrix4 world_view_projection = ndc_matrix * render_context->m_ViewProj * ro->m_WorldTransform;
+                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&world_view_projection, location);
                 }
-                case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_WORLDVIEWPROJ:
+                else
                 {
-                    if (dmGraphics::GetShaderProgramLanguage(graphics_context) == dmGraphics::ShaderDesc::LANGUAGE_SPIRV)
-                    {
-                        Matrix4 ndc_matrix = Matrix4::identity();
-                        ndc_matrix.setElem(2, 2, 0.5f );
-                        ndc_matrix.setElem(3, 2, 0.5f );
-                        const Matrix4 world_view_projection = ndc_matrix * render_context->m_ViewProj * ro->m_WorldTransform;
-                        dmGraphics::SetConstantM4(graphics_context, (Vector4*)&world_view_projection, location);
-                    }
-                    else
-                    {
-                        const Matrix4 world_view_projection = render_context->m_ViewProj * ro->m_WorldTransform;
-                        dmGraphics::SetConstantM4(graphics_context, (Vector4*)&world_view_projection, location);
-                    }
-                    break;
+                    const Matrix4 world_view_projection = render_context->m_ViewProj * ro->m_WorldTransform;
+                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&world_view_projection, location);
                 }
+                break;
+            }
+        }
+    }
+
+    // Constants that depend on the render object (and not only on the material or render context)
+    static inline bool IsObjectConstant(dmRenderDDF::MaterialDesc::ConstantType type)
+    {
+        return type == dmRenderDDF::MaterialDesc::CONSTANT_TYPE_WORLD ||
+               type == dmRenderDDF::MaterialDesc::CONSTANT_TYPE_TEXTURE ||
+               type == dmRenderDDF::MaterialDesc::CONSTANT_TYPE_NORMAL ||
+               type == dmRenderDDF::MaterialDesc::CONSTANT_TYPE_WORLDVIEW ||
+               type == dmRenderDDF::MaterialDesc::CONSTANT_TYPE_WORLDVIEWPROJ;
+    }
+
+    void ApplyMaterialConstants(dmRender::HRenderContext render_context, HMaterial material, const RenderObject* ro)
+    {
+        const dmArray<MaterialConstant>& constants = material->m_Constants;
+        dmGraphics::HContext graphics_context = dmRender::GetGraphicsContext(render_context);
+        uint32_t n = constants.Size();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            ApplyMaterialConstant(render_context, graphics_context, constants[i].m_Constant, ro);
+        }
+    }
+
+    uint32_t ApplyMaterialObjectConstants(dmRender::HRenderContext render_context, HMaterial material, const RenderObject* ro)
+    {
+        const dmArray<MaterialConstant>& constants = material->m_Constants;
+        dmGraphics::HContext graphics_context = dmRender::GetGraphicsContext(render_context);
+        uint32_t n = constants.Size();
+        uint32_t applied = 0;
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            const Constant& constant = constants[i].m_Constant;
+            if (IsObjectConstant(constant.m_Type))
+            {
+                ApplyMaterialConstant(render_context, graphics_context, constant, ro);
+                ++applied;
             }
         }
+        return applied;
     }
 
     void ApplyMaterialSampler(dmRender::HRenderContext render_context, HMaterial material, uint32_t unit, dmGraphics::HTexture texture)
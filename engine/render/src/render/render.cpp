@@ -128,6 +128,8 @@ namespace dmRender
         }
 
         memset(context->m_Textures, 0, sizeof(dmGraphics::HTexture) * RenderObject::MAX_TEXTURE_COUNT);
+        memset(&context->m_RenderStateCache, 0, sizeof(context->m_RenderStateCache));
+        context->m_RenderListCulled = 0;
 
         InitializeTextContext(context, params.m_MaxCharacters);
 
@@ -164,6 +166,7 @@ namespace dmRender
     void RenderListBegin(HRenderContext render_context)
     {
         render_context->m_RenderList.SetSize(0);
+        render_context->m_RenderListAABBs.SetSize(0);
         render_context->m_RenderListSortIndices.SetSize(0);
         render_context->m_RenderListDispatch.SetSize(0);
         render_context->m_RenderListRanges.SetSize(0);
@@ -199,13 +202,37 @@ namespace dmRender
             const uint32_t needed = entries - render_list.Remaining();
             render_list.OffsetCapacity(dmMath::Max<uint32_t>(256, needed));
             render_context->m_RenderListSortIndices.SetCapacity(render_list.Capacity());
+            render_context->m_RenderListAABBs.SetCapacity(render_list.Capacity());
         }
 
         uint32_t size = render_list.Size();
         render_list.SetSize(size + entries);
+
+        // No bounding box until RenderListSetAABB is called
+        dmArray<RenderListAABB>& aabbs = render_context->m_RenderListAABBs;
+        aabbs.SetSize(size + entries);
+        for (uint32_t i = size; i < size + entries; ++i)
+        {
+            aabbs[i].m_Extents.setX(-1.0f);
+        }
         return (render_list.Begin() + size);
     }
 
+    void RenderListSetAABB(HRenderContext render_context, RenderListEntry* entry, const Matrix4& transform, const Point3& aabb_min, const Point3& aabb_max)
+    {
+        uint32_t index = entry - render_context->m_RenderList.Begin();
+        assert(index < render_context->m_RenderListAABBs.Size());
+
+        const Point3 center = lerp(0.5f, aabb_min, aabb_max);
+        const Vector3 extents = (aabb_max - aabb_min) * 0.5f;
+
+        RenderListAABB& aabb = render_context->m_RenderListAABBs[index];
+        aabb.m_Center = (transform * center).getXYZ();
+        aabb.m_Extents = absPerElem(transform.getCol0().getXYZ()) * extents.getX() +
+                         absPerElem(transform.getCol1().getXYZ()) * extents.getY() +
+                         absPerElem(transform.getCol2().getXYZ()) * extents.getZ();
+    }
+
     // Submit a range of entries (pointers must be from a range allocated by RenderListAlloc, and not between two alloc calls).
     void RenderListSubmit(HRenderContext render_context, RenderListEntry *begin, RenderListEntry *end)
     {
@@ -229,17 +256,6 @@ namespace dmRender
         render_context->m_RenderListRanges.SetSize(0);
     }
 
-    struct RenderListSorter
-    {
-        bool operator()(uint32_t a, uint32_t b) const
-        {
-            const RenderListSortValue& u = values[a];
-            const RenderListSortValue& v = values[b];
-            return u.m_SortKey < v.m_SortKey;
-        }
-        RenderListSortValue* values;
-    };
-
     void RenderListEnd(HRenderContext render_context)
     {
         // Unflushed leftovers are assumed to be the debug rendering
@@ -378,8 +394,106 @@ namespace dmRender
         return false;
     }
 
-    // Compute new sort values for everything that matches tag_mask
-    static void MakeSortBuffer(HRenderContext context, uint32_t tag_mask)
+    bool RadixSortRenderList(RenderListSortValue* values, uint32_t* indices, RenderListSortValue* scratch_values, uint32_t* scratch_indices, uint32_t count)
+    {
+        const uint32_t num_passes = sizeof(uint64_t);
+        uint32_t histograms[num_passes][256];
+        memset(histograms, 0, sizeof(histograms));
+
+        // Count all digits up front, in one go over the keys
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint64_t key = values[i].m_SortKey;
+            for (uint32_t pass = 0; pass < num_passes; ++pass)
+            {
+                histograms[pass][key & 0xff]++;
+                key >>= 8;
+            }
+        }
+
+        bool swapped = false;
+        for (uint32_t pass = 0; pass < num_passes; ++pass)
+        {
+            const uint32_t shift = pass * 8;
+            uint32_t* histogram = histograms[pass];
+
+            // All keys have the same digit (e.g. a single dispatch or major order), so the pass wouldn't move anything
+            if (count == 0 || histogram[(values[0].m_SortKey >> shift) & 0xff] == count)
+                continue;
+
+            uint32_t offset = 0;
+            for (uint32_t i = 0; i < 256; ++i)
+            {
+                uint32_t c = histogram[i];
+                histogram[i] = offset;
+                offset += c;
+            }
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                uint32_t dst = histogram[(values[i].m_SortKey >> shift) & 0xff]++;
+                scratch_values[dst] = values[i];
+                scratch_indices[dst] = indices[i];
+            }
+
+            RenderListSortValue* tmp_values = values;
+            values = scratch_values;
+            scratch_values = tmp_values;
+            uint32_t* tmp_indices = indices;
+            indices = scratch_indices;
+            scratch_indices = tmp_indices;
+            swapped = !swapped;
+        }
+        return swapped;
+    }
+
+    // Sorts m_RenderListSortBuffer on the keys in m_RenderListSortValues
+    static void SortBuffer(HRenderContext context)
+    {
+        uint32_t count = context->m_RenderListSortBuffer.Size();
+        context->m_RenderListSortScratchValues.SetCapacity(context->m_RenderListSortValues.Capacity());
+        context->m_RenderListSortScratchValues.SetSize(count);
+        context->m_RenderListSortScratchBuffer.SetCapacity(context->m_RenderListSortBuffer.Capacity());
+        context->m_RenderListSortScratchBuffer.SetSize(count);
+
+        if (RadixSortRenderList(context->m_RenderListSortValues.Begin(), context->m_RenderListSortBuffer.Begin(),
+                                context->m_RenderListSortScratchValues.Begin(), context->m_RenderListSortScratchBuffer.Begin(), count))
+        {
+            context->m_RenderListSortValues.Swap(context->m_RenderListSortScratchValues);
+            context->m_RenderListSortBuffer.Swap(context->m_RenderListSortScratchBuffer);
+        }
+    }
+
+    // Frustum planes (not normalized) of a view projection matrix, pointing inwards
+    static void MakeFrustumPlanes(const Matrix4& view_proj, Vector4 planes[6])
+    {
+        const Vector4 r0 = view_proj.getRow(0);
+        const Vector4 r1 = view_proj.getRow(1);
+        const Vector4 r2 = view_proj.getRow(2);
+        const Vector4 r3 = view_proj.getRow(3);
+        planes[0] = r3 + r0; // left
+        planes[1] = r3 - r0; // right
+        planes[2] = r3 + r1; // bottom
+        planes[3] = r3 - r1; // top
+        planes[4] = r3 + r2; // near
+        planes[5] = r3 - r2; // far
+    }
+
+    static inline bool IsOutsideFrustum(const Vector4 planes[6], const RenderListAABB& aabb)
+    {
+        for (uint32_t i = 0; i < 6; ++i)
+        {
+            const Vector3 normal = planes[i].getXYZ();
+            const float distance = dot(normal, aabb.m_Center) + planes[i].getW();
+            const float radius = dot(absPerElem(normal), aabb.m_Extents);
+            if (distance + radius < 0.0f)
+                return true;
+        }
+        return false;
+    }
+
+    // Compute new sort values for everything that matches tag_mask, and isn't culled
+    static void MakeSortBuffer(HRenderContext context, uint32_t tag_mask, bool frustum_culling)
     {
         DM_PROFILE(Render, "MakeSortBuffer");
 
@@ -388,9 +502,8 @@ namespace dmRender
         context->m_RenderListSortBuffer.SetCapacity(required_capacity);
         context->m_RenderListSortBuffer.SetSize(0);
         context->m_RenderListSortValues.SetCapacity(required_capacity);
-        context->m_RenderListSortValues.SetSize(context->m_RenderListSortIndices.Size());
+        context->m_RenderListSortValues.SetSize(0);
 
-        RenderListSortValue* sort_values = context->m_RenderListSortValues.Begin();
         RenderListEntry* entries = context->m_RenderList.Begin();
 
         const Matrix4& transform = context->m_ViewProj;
@@ -398,6 +511,13 @@ namespace dmRender
         float minZW = FLT_MAX;
         float maxZW = -FLT_MAX;
 
+        Vector4 frustum_planes[6];
+        if (frustum_culling)
+            MakeFrustumPlanes(transform, frustum_planes);
+        const RenderListAABB* aabbs = context->m_RenderListAABBs.Begin();
+        uint32_t culled = 0;
+
+        // Gather the matching entries, and write z values...
         RenderListRange* ranges = context->m_RenderListRanges.Begin();
         uint32_t num_ranges = context->m_RenderListRanges.Size();
         for( uint32_t i = 0; i < num_ranges; ++i)
@@ -406,54 +526,64 @@ namespace dmRender
             if ( (range.m_TagMask & tag_mask) != tag_mask )
                 continue;
 
-            // Write z values...
             for (uint32_t i = range.m_Start; i < range.m_Start+range.m_Count; ++i)
             {
                 uint32_t idx = context->m_RenderListSortIndices[i];
+                if (frustum_culling && aabbs[idx].m_Extents.getX() >= 0.0f && IsOutsideFrustum(frustum_planes, aabbs[idx]))
+                {
+                    ++culled;
+                    continue;
+                }
+                context->m_RenderListSortBuffer.Push(idx);
+
+                RenderListSortValue value;
+                value.m_SortKey = 0;
+
                 RenderListEntry* entry = &entries[idx];
-                if (entry->m_MajorOrder != RENDER_ORDER_WORLD)
-                    continue; // Could perhaps break here, if we also sorted on the major order (cost more when I tested it /MAWE)
-
-                const Vector4 res = transform * entry->m_WorldPosition;
-                const float zw = res.getZ() / res.getW();
-                sort_values[idx].m_ZW = zw;
-                if (zw < minZW) minZW = zw;
-                if (zw > maxZW) maxZW = zw;
+                if (entry->m_MajorOrder == RENDER_ORDER_WORLD)
+                {
+                    const Vector4 res = transform * entry->m_WorldPosition;
+                    const float zw = res.getZ() / res.getW();
+                    value.m_ZW = zw;
+                    if (zw < minZW) minZW = zw;
+                    if (zw > maxZW) maxZW = zw;
+                }
+                context->m_RenderListSortValues.Push(value);
             }
         }
 
+        context->m_RenderListCulled = culled;
+        DM_COUNTER("Render.Culled", culled);
+
         // ... and compute range
         float rc = 0;
         if (maxZW > minZW)
             rc = 1.0f / (maxZW - minZW);
 
-        for( uint32_t i = 0; i < num_ranges; ++i)
+        RenderListSortValue* sort_values = context->m_RenderListSortValues.Begin();
+        uint32_t* sort_buffer = context->m_RenderListSortBuffer.Begin();
+        uint32_t count = context->m_RenderListSortBuffer.Size();
+        for (uint32_t i = 0; i < count; ++i)
         {
-            RenderListRange& range = ranges[i];
-            if ( (range.m_TagMask & tag_mask) != tag_mask )
-                continue;
+            RenderListEntry* entry = &entries[sort_buffer[i]];
+            RenderListSortValue& value = sort_values[i];
 
-            for (uint32_t i = range.m_Start; i < range.m_Start+range.m_Count; ++i)
+            uint32_t order;
+            if (entry->m_MajorOrder == RENDER_ORDER_WORLD)
             {
-                uint32_t idx = context->m_RenderListSortIndices[i];
-                RenderListEntry* entry = &entries[idx];
-
-                sort_values[idx].m_MajorOrder = entry->m_MajorOrder;
-                if (entry->m_MajorOrder == RENDER_ORDER_WORLD)
-                {
-                    const float z = sort_values[idx].m_ZW;
-                    sort_values[idx].m_Order = (uint32_t) (0xfffff8 - 0xfffff0 * rc * (z - minZW));
-                }
-                else
-                {
-                    // use the integer value provided.
-                    sort_values[idx].m_Order = entry->m_Order;
-                }
-                sort_values[idx].m_MinorOrder = entry->m_MinorOrder;
-                sort_values[idx].m_BatchKey = entry->m_BatchKey & 0x00ffffff;
-                sort_values[idx].m_Dispatch = entry->m_Dispatch;
-                context->m_RenderListSortBuffer.Push(idx);
+                const float z = value.m_ZW;
+                order = (uint32_t) (0xfffff8 - 0xfffff0 * rc * (z - minZW));
+            }
+            else
+            {
+                // use the integer value provided.
+                order = entry->m_Order;
             }
+            value.m_Order = order;
+            value.m_MajorOrder = entry->m_MajorOrder;
+            value.m_MinorOrder = entry->m_MinorOrder;
+            value.m_BatchKey = entry->m_BatchKey & 0x00ffffff;
+            value.m_Dispatch = entry->m_Dispatch;
         }
     }
 
@@ -501,9 +631,26 @@ namespace dmRender
 
         // First sort on the tag masks
         {
-            RenderListEntrySorter sort;
-            sort.m_Base = context->m_RenderList.Begin();
-            std::stable_sort(context->m_RenderListSortIndices.Begin(), context->m_RenderListSortIndices.End(), sort);
+            RenderListEntry* entries = context->m_RenderList.Begin();
+            uint32_t count = context->m_RenderListSortIndices.Size();
+            context->m_RenderListSortValues.SetCapacity(context->m_RenderListSortIndices.Capacity());
+            context->m_RenderListSortValues.SetSize(count);
+            RenderListSortValue* sort_values = context->m_RenderListSortValues.Begin();
+            uint32_t* indices = context->m_RenderListSortIndices.Begin();
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                sort_values[i].m_SortKey = entries[indices[i]].m_TagMask;
+            }
+
+            context->m_RenderListSortScratchValues.SetCapacity(context->m_RenderListSortValues.Capacity());
+            context->m_RenderListSortScratchValues.SetSize(count);
+            context->m_RenderListSortScratchBuffer.SetCapacity(context->m_RenderListSortIndices.Capacity());
+            context->m_RenderListSortScratchBuffer.SetSize(count);
+            if (RadixSortRenderList(sort_values, indices, context->m_RenderListSortScratchValues.Begin(), context->m_RenderListSortScratchBuffer.Begin(), count))
+            {
+                // The scratch buffer was given the same capacity, so new submits still fit
+                context->m_RenderListSortIndices.Swap(context->m_RenderListSortScratchBuffer);
+            }
         }
         // Now find the ranges of tag masks
         {
@@ -515,6 +662,11 @@ namespace dmRender
     }
 
     Result DrawRenderList(HRenderContext context, Predicate* predicate, HNamedConstantBuffer constant_buffer)
+    {
+        return DrawRenderList(context, predicate, constant_buffer, true);
+    }
+
+    Result DrawRenderList(HRenderContext context, Predicate* predicate, HNamedConstantBuffer constant_buffer, bool frustum_culling)
     {
         DM_PROFILE(Render, "DrawRenderList");
 
@@ -533,16 +685,14 @@ namespace dmRender
             SortRenderList(context);
         }
 
-        MakeSortBuffer(context, tag_mask);
+        MakeSortBuffer(context, tag_mask, frustum_culling);
 
         if (context->m_RenderListSortBuffer.Empty())
             return RESULT_OK;
 
         {
             DM_PROFILE(Render, "DrawRenderList_SORT");
-            RenderListSorter sort;
-            sort.values = context->m_RenderListSortValues.Begin();
-            std::stable_sort(context->m_RenderListSortBuffer.Begin(), context->m_RenderListSortBuffer.End(), sort);
+            SortBuffer(context);
         }
 
         // Construct render objects
@@ -607,6 +757,22 @@ namespace dmRender
         return Draw(context, predicate, constant_buffer);
     }
 
+    static inline bool HasRenderObjectConstants(const RenderObject* ro)
+    {
+        for (uint32_t i = 0; i < RenderObject::MAX_CONSTANT_COUNT; ++i)
+        {
+            if (ro->m_Constants[i].m_Location != -1)
+                return true;
+        }
+        return false;
+    }
+
+    static inline bool HasSameTransforms(const RenderObject* a, const RenderObject* b)
+    {
+        return memcmp(&a->m_WorldTransform, &b->m_WorldTransform, sizeof(Matrix4)) == 0 &&
+               memcmp(&a->m_TextureTransform, &b->m_TextureTransform, sizeof(Matrix4)) == 0;
+    }
+
     Result Draw(HRenderContext render_context, Predicate* predicate, HNamedConstantBuffer constant_buffer)
     {
         if (render_context == 0x0)
@@ -618,6 +784,10 @@ namespace dmRender
 
         dmGraphics::HContext context = dmRender::GetGraphicsContext(render_context);
 
+        // The state is only tracked within one call, since the render script may change it in between
+        RenderStateCache& cache = render_context->m_RenderStateCache;
+        memset(&cache, 0, sizeof(cache));
+
         HMaterial material = render_context->m_Material;
         HMaterial context_material = render_context->m_Material;
         if(context_material)
@@ -640,14 +810,55 @@ namespace dmRender
                     }
                 }
 
-                ApplyMaterialConstants(render_context, material, ro);
-                ApplyRenderObjectConstants(render_context, context_material, ro);
+                const bool material_changed = material != cache.m_Material;
+                const dmGraphics::HProgram program = GetMaterialProgram(material);
 
-                if (constant_buffer)
-                    ApplyNamedConstantBuffer(render_context, material, constant_buffer);
+                // All material constants are set when the material changes, or when the previous
+                // render object overrode some of them. Otherwise only the ones depending on the render object.
+                bool constants_set = false;
+                if (material_changed || cache.m_ObjectConstantsSet)
+                {
+                    ApplyMaterialConstants(render_context, material, ro);
+                    constants_set = true;
+                }
+                else if (!HasSameTransforms(cache.m_RenderObject, ro))
+                {
+                    constants_set = ApplyMaterialObjectConstants(render_context, material, ro) != 0;
+                }
+
+                cache.m_ObjectConstantsSet = HasRenderObjectConstants(ro);
+                if (cache.m_ObjectConstantsSet)
+                {
+                    ApplyRenderObjectConstants(render_context, context_material, ro);
+                    constants_set = true;
+                }
+
+                if (constants_set)
+                {
+                    if (constant_buffer)
+                        ApplyNamedConstantBuffer(render_context, material, constant_buffer);
+                    ++cache.m_StateChanges;
+                }
+                else
+                {
+                    ++cache.m_StateChangesSkipped;
+                }
 
                 if (ro->m_SetBlendFactors)
-                    dmGraphics::SetBlendFunc(context, ro->m_SourceBlendFactor, ro->m_DestinationBlendFactor);
+                {
+                    if (!cache.m_BlendFactorsSet || cache.m_SourceBlendFactor != ro->m_SourceBlendFactor || cache.m_DestinationBlendFactor != ro->m_DestinationBlendFactor)
+                    {
+                        dmGraphics::SetBlendFunc(context, ro->m_SourceBlendFactor, ro->m_DestinationBlendFactor);
+                        cache.m_SourceBlendFactor = ro->m_SourceBlendFactor;
+                        cache.m_DestinationBlendFactor = ro->m_DestinationBlendFactor;
+                        cache.m_BlendFactorsSet = 1;
+                        ++cache.m_StateChanges;
+                    }
+                    else
+                    {
+                        ++cache.m_StateChangesSkipped;
+                    }
+                }
 
                 if (ro->m_SetStencilTest)
                     ApplyStencilTest(render_context, ro);
@@ -657,34 +868,65 @@ namespace dmRender
                     dmGraphics::HTexture texture = ro->m_Textures[i];
                     if (render_context->m_Textures[i])
                         texture = render_context->m_Textures[i];
-                    if (texture)
+
+                    // The samplers are material specific. Setting the texture params also relies on the texture unit being active.
+                    if (texture != cache.m_Textures[i] || (texture && material_changed))
                     {
-                        dmGraphics::EnableTexture(context, i, texture);
-                        ApplyMaterialSampler(render_context, material, i, texture);
+                        if (texture)
+                        {
+                            dmGraphics::EnableTexture(context, i, texture);
+                            ApplyMaterialSampler(render_context, material, i, texture);
+                        }
+                        else
+                        {
+                            dmGraphics::DisableTexture(context, i, cache.m_Textures[i]);
+                        }
+                        cache.m_Textures[i] = texture;
+                        ++cache.m_StateChanges;
+                    }
+                    else if (texture)
+                    {
+                        ++cache.m_StateChangesSkipped;
                     }
-
                 }
 
-                dmGraphics::EnableVertexDeclaration(context, ro->m_VertexDeclaration, ro->m_VertexBuffer, GetMaterialProgram(material));
+                if (ro->m_VertexDeclaration != cache.m_VertexDeclaration || ro->m_VertexBuffer != cache.m_VertexBuffer || program != cache.m_Program)
+                {
+                    if (cache.m_VertexDeclaration)
+                        dmGraphics::DisableVertexDeclaration(context, cache.m_VertexDeclaration);
+                    dmGraphics::EnableVertexDeclaration(context, ro->m_VertexDeclaration, ro->m_VertexBuffer, program);
+                    cache.m_VertexDeclaration = ro->m_VertexDeclaration;
+                    cache.m_VertexBuffer = ro->m_VertexBuffer;
+                    cache.m_Program = program;
+                    ++cache.m_StateChanges;
+                }
+                else
+                {
+                    ++cache.m_StateChangesSkipped;
+                }
 
                 if (ro->m_IndexBuffer)
                     dmGraphics::DrawElements(context, ro->m_PrimitiveType, ro->m_VertexStart, ro->m_VertexCount, ro->m_IndexType, ro->m_IndexBuffer);
                 else
                     dmGraphics::Draw(context, ro->m_PrimitiveType, ro->m_VertexStart, ro->m_VertexCount);
 
-                dmGraphics::DisableVertexDeclaration(context, ro->m_VertexDeclaration);
+                cache.m_Material = material;
+                cache.m_RenderObject = ro;
+            }
+        }
 
-                for (uint32_t i = 0; i < RenderObject::MAX_TEXTURE_COUNT; ++i)
-                {
-                    dmGraphics::HTexture texture = ro->m_Textures[i];
-                    if (render_context->m_Textures[i])
-                        texture = render_context->m_Textures[i];
-                    if (texture)
-                        dmGraphics::DisableTexture(context, i, texture);
-                }
+        if (cache.m_VertexDeclaration)
+            dmGraphics::DisableVertexDeclaration(context, cache.m_VertexDeclaration);
 
-            }
+        for (uint32_t i = 0; i < RenderObject::MAX_TEXTURE_COUNT; ++i)
+        {
+            if (cache.m_Textures[i])
+                dmGraphics::DisableTexture(context, i, cache.m_Textures[i]);
         }
+
+        DM_COUNTER("Render.StateChanges", cache.m_StateChanges);
+        DM_COUNTER("Render.StateChangesSkipped", cache.m_StateChangesSkipped);
+
         return RESULT_OK;
     }
 
@@ -223,6 +223,18 @@ namespace dmRender
     void RenderListSubmit(HRenderContext render_context, RenderListEntry *begin, RenderListEntry *end);
     void RenderListEnd(HRenderContext render_context);
 
+    /**
+     * Set the bounding box of an entry allocated with RenderListAlloc. The box is given in local space,
+     * together with the (affine) transform to world space. Entries with a bounding box are culled
+     * against the view frustum in DrawRenderList, entries without one are always drawn.
+     * @param render_context Render context handle
+     * @param entry Entry allocated with RenderListAlloc
+     * @param transform Local to world transform
+     * @param aabb_min Local space min corner
+     * @param aabb_max Local space max corner
+     */
+    void RenderListSetAABB(HRenderContext render_context, RenderListEntry* entry, const Matrix4& transform, const Point3& aabb_min, const Point3& aabb_max);
+
     void SetSystemFontMap(HRenderContext render_context, HFontMap font_map);
 
     dmGraphics::HContext GetGraphicsContext(HRenderContext render_context);
@@ -237,6 +249,8 @@ namespace dmRender
     // Takes the contents of the render list, sorts by view and inserts all the objects in the
     // render list, unless they already are in place from a previous call.
     Result DrawRenderList(HRenderContext context, Predicate* predicate, HNamedConstantBuffer constant_buffer);
+    // As above, but frustum culling of entries with a bounding box (see RenderListSetAABB) can be disabled
+    Result DrawRenderList(HRenderContext context, Predicate* predicate, HNamedConstantBuffer constant_buffer, bool frustum_culling);
 
     Result Draw(HRenderContext context, Predicate* predicate, HNamedConstantBuffer constant_buffer);
     Result DrawDebug3d(HRenderContext context);
@@ -159,6 +159,8 @@ namespace dmRender
         dmArray<TextEntry>                  m_TextEntries;
         uint32_t                            m_TextEntriesFlushed;
         uint32_t                            m_Frame;
+        // Font maps with new glyphs to upload at the end of the dispatch
+        dmArray<HFontMap>                   m_DirtyFontMaps;
     };
 
     struct RenderScriptContext
@@ -194,6 +196,31 @@ namespace dmRender
         };
     };
 
+    // Graphics state set by the previous render object in Draw(), used to skip redundant dmGraphics calls
+    struct RenderStateCache
+    {
+        const RenderObject*             m_RenderObject;
+        HMaterial                       m_Material;
+        dmGraphics::HTexture            m_Textures[RenderObject::MAX_TEXTURE_COUNT];
+        dmGraphics::HVertexDeclaration  m_VertexDeclaration;
+        dmGraphics::HVertexBuffer       m_VertexBuffer;
+        dmGraphics::HProgram            m_Program;
+        dmGraphics::BlendFactor         m_SourceBlendFactor;
+        dmGraphics::BlendFactor         m_DestinationBlendFactor;
+        // Stats for the last Draw()
+        uint32_t                        m_StateChanges;
+        uint32_t                        m_StateChangesSkipped;
+        uint32_t                        m_BlendFactorsSet : 1;
+        uint32_t                        m_ObjectConstantsSet : 1;   // The previous render object overrode material constants
+    };
+
+    // World space bounding box of a render list entry, negative extents means it has none
+    struct RenderListAABB
+    {
+        Vector3 m_Center;
+        Vector3 m_Extents;
+    };
+
     struct RenderListRange
     {
         uint32_t m_TagMask;
@@ -213,11 +240,17 @@ namespace dmRender
 
         dmArray<RenderListEntry>    m_RenderList;
         dmArray<RenderListDispatch> m_RenderListDispatch;
-        dmArray<RenderListSortValue>m_RenderListSortValues;
+        dmArray<RenderListAABB>     m_RenderListAABBs;          // Parallel to m_RenderList
+        dmArray<RenderListSortValue>m_RenderListSortValues;       // Sort keys, parallel to m_RenderListSortBuffer
         dmArray<uint32_t>           m_RenderListSortBuffer;
+        dmArray<RenderListSortValue>m_RenderListSortScratchValues;// Radix sort ping-pong buffers
+        dmArray<uint32_t>           m_RenderListSortScratchBuffer;
         dmArray<uint32_t>           m_RenderListSortIndices;
         dmArray<RenderListRange>    m_RenderListRanges;         // Maps tagmask to a range in the (sorted) render list
 
+        RenderStateCache            m_RenderStateCache;
+        uint32_t                    m_RenderListCulled;         // Number of entries culled by the last DrawRenderList
+
         HFontMap                    m_SystemFontMap;
 
         Matrix4                     m_View;
@@ -244,6 +277,9 @@ namespace dmRender
 
     void ApplyRenderObjectConstants(HRenderContext render_context, HMaterial material, const struct RenderObject* ro);
 
+    // Applies the material constants that depend on the render object (e.g. world transform). Returns the number of constants set.
+    uint32_t ApplyMaterialObjectConstants(HRenderContext render_context, HMaterial material, const struct RenderObject* ro);
+
 
     // Exposed here for unit testing
     struct RenderListEntrySorter
@@ -273,6 +309,11 @@ namespace dmRender
     void FindRenderListRanges(uint32_t* first, size_t offset, size_t size, RenderListEntry* entries, FindRangeComparator& comp, void* ctx, RangeCallback callback );
 
     bool FindTagMaskRange(RenderListRange* ranges, uint32_t num_ranges, uint32_t tag_mask, RenderListRange& range);
+
+    // Stable LSD radix sort of the indices on their 64 bit sort keys, 8 bits per pass.
+    // Passes where all keys share the same digit are skipped.
+    // Returns true if the sorted result ended up in the scratch buffers.
+    bool RadixSortRenderList(RenderListSortValue* values, uint32_t* indices, RenderListSortValue* scratch_values, uint32_t* scratch_indices, uint32_t count);
 }
 
 #endif
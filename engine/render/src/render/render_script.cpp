@@ -1279,9 +1279,19 @@ namespace dmRender
      * system constants buffer is used containing constants as defined in materials and set through
      * [ref:go.set] (or [ref:particlefx.set_constant]) on visual components.
      *
+     * Sprites and tile maps outside the frustum of the current view and projection are not drawn.
+     * This can be turned off with the `frustum_culling` option.
+     *
      * @name render.draw
      * @param predicate [type:predicate] predicate to draw for
-     * @param [constants] [type:constant_buffer] optional constants to use while rendering
+     * @param [options] [type:constant_buffer|table] optional constants to use while rendering, or a table with options:
+     *
+     * `constants`
+     * : [type:constant_buffer] optional constants to use while rendering
+     *
+     * `frustum_culling`
+     * : [type:boolean] cull objects outside the view frustum (default `true`)
+     *
      * @examples
      *
      * ```lua
@@ -1303,7 +1313,12 @@ namespace dmRender
      * constants.tint = vmath.vector4(1, 1, 1, 1)
      * render.draw(self.my_pred, constants)
      * ```
-
+     *
+     * Draw predicate without frustum culling:
+     *
+     * ```lua
+     * render.draw(self.my_pred, { frustum_culling = false })
+     * ```
      */
     int RenderScript_Draw(lua_State* L)
     {
@@ -1319,13 +1334,33 @@ namespace dmRender
         }
 
         HNamedConstantBuffer constant_buffer = 0;
-        if (lua_isuserdata(L, 2))
+        uint32_t frustum_culling = 1;
+        if (lua_istable(L, 2))
+        {
+            int top = lua_gettop(L);
+            lua_getfield(L, 2, "constants");
+            if (!lua_isnil(L, -1))
+            {
+                HNamedConstantBuffer* tmp = RenderScriptConstantBuffer_Check(L, lua_gettop(L));
+                constant_buffer = *tmp;
+            }
+            lua_pop(L, 1);
+
+            lua_getfield(L, 2, "frustum_culling");
+            if (!lua_isnil(L, -1))
+            {
+                frustum_culling = lua_toboolean(L, -1) ? 1 : 0;
+            }
+            lua_pop(L, 1);
+            assert(top == lua_gettop(L));
+        }
+        else if (lua_isuserdata(L, 2))
         {
             HNamedConstantBuffer* tmp = RenderScriptConstantBuffer_Check(L, 2);
             constant_buffer = *tmp;
         }
 
-        if (InsertCommand(i, Command(COMMAND_TYPE_DRAW, (uintptr_t)predicate, (uintptr_t) constant_buffer)))
+        if (InsertCommand(i, Command(COMMAND_TYPE_DRAW, (uintptr_t)predicate, (uintptr_t) constant_buffer, (uintptr_t) frustum_culling)))
             return 0;
         else
             return luaL_error(L, "Command buffer is full (%d).", i->m_CommandBuffer.Capacity());
@@ -11,12 +11,15 @@
 // specific language governing permissions and limitations under the License.
 
 #include <stdint.h>
+#include <float.h>
 #define JC_TEST_IMPLEMENTATION
 #include <jc_test/jc_test.h>
 #include <dmsdk/vectormath/cpp/vectormath_aos.h>
 
+#include <dlib/dstrings.h>
 #include <dlib/hash.h>
 #include <dlib/math.h>
+#include <dlib/time.h>
 
 #include <script/script.h>
 #include <algorithm> // std::stable_sort
@@ -29,6 +32,10 @@ const static uint32_t WIDTH = 600;
 const static uint32_t HEIGHT = 400;
 
 using namespace Vectormath::Aos;
+namespace dmGraphics
+{
+    extern const Vector4& GetConstantV4Ptr(dmGraphics::HContext context, int base_register);
+}
 
 class dmRenderTest : public jc_test_base_class
 {
@@ -318,6 +325,87 @@ TEST_F(dmRenderTest, TestRenderListDraw)
     ASSERT_EQ(ctx.m_Z, orders[1]);
 }
 
+static void TestCullDispatch(dmRender::RenderListDispatchParams const & params)
+{
+    if (params.m_Operation != dmRender::RENDER_LIST_OPERATION_BATCH)
+        return;
+    uint32_t* rendered = (uint32_t*) params.m_UserData;
+    for (uint32_t* i = params.m_Begin; i != params.m_End; ++i)
+    {
+        rendered[params.m_Buf[*i].m_Order]++;
+    }
+}
+
+TEST_F(dmRenderTest, TestRenderListFrustumCulling)
+{
+    Vectormath::Aos::Matrix4 view = Vectormath::Aos::Matrix4::identity();
+    Vectormath::Aos::Matrix4 proj = Vectormath::Aos::Matrix4::orthographic(0.0f, WIDTH, HEIGHT, 0.0f, 0.1f, 1.0f);
+    dmRender::SetViewMatrix(m_Context, view);
+    dmRender::SetProjectionMatrix(m_Context, proj);
+
+    const uint32_t n = 6;
+    // Local boxes, centered at the translation of each entry
+    const Point3 positions[n] = {
+        Point3(WIDTH * 0.5f, HEIGHT * 0.5f, -0.5f),   // inside
+        Point3(-5.0f, HEIGHT * 0.5f, -0.5f),          // straddling the left edge
+        Point3(-100.0f, HEIGHT * 0.5f, -0.5f),        // left of the view
+        Point3(WIDTH * 0.5f, HEIGHT + 100.0f, -0.5f), // beyond the bottom edge
+        Point3(WIDTH * 0.5f, HEIGHT * 0.5f, -5.0f),   // behind the far plane
+        Point3(-1000.0f, -1000.0f, -0.5f),            // off screen, but without bounds
+    };
+
+    for (uint32_t pass = 0; pass < 2; ++pass)
+    {
+        bool frustum_culling = pass == 0;
+        uint32_t rendered[n];
+        memset(rendered, 0, sizeof(rendered));
+
+        dmRender::RenderListBegin(m_Context);
+        uint8_t dispatch = dmRender::RenderListMakeDispatch(m_Context, TestCullDispatch, rendered);
+        dmRender::RenderListEntry* out = dmRender::RenderListAlloc(m_Context, n);
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            dmRender::RenderListEntry& entry = out[i];
+            entry.m_WorldPosition = positions[i];
+            entry.m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
+            entry.m_MinorOrder = 0;
+            entry.m_TagMask = 0;
+            entry.m_Order = i;
+            entry.m_BatchKey = 0;
+            entry.m_Dispatch = dispatch;
+            entry.m_UserData = 0;
+            if (i != n - 1)
+            {
+                Matrix4 transform = Matrix4::translation(Vector3(positions[i]));
+                dmRender::RenderListSetAABB(m_Context, &entry, transform, Point3(-10.0f, -10.0f, -0.1f), Point3(10.0f, 10.0f, 0.1f));
+            }
+        }
+        dmRender::RenderListSubmit(m_Context, out, out + n);
+        dmRender::RenderListEnd(m_Context);
+
+        dmRender::DrawRenderList(m_Context, 0, 0, frustum_culling);
+
+        if (frustum_culling)
+        {
+            ASSERT_EQ(3u, m_Context->m_RenderListCulled);
+            ASSERT_EQ(1u, rendered[0]);
+            ASSERT_EQ(1u, rendered[1]);
+            ASSERT_EQ(0u, rendered[2]);
+            ASSERT_EQ(0u, rendered[3]);
+            ASSERT_EQ(0u, rendered[4]);
+            ASSERT_EQ(1u, rendered[5]);
+        }
+        else
+        {
+            ASSERT_EQ(0u, m_Context->m_RenderListCulled);
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                ASSERT_EQ(1u, rendered[i]);
+            }
+        }
+    }
+}
+
 struct TestRenderListOrderDispatchCtx
 {
     int m_BeginCalls;
@@ -461,6 +549,198 @@ TEST_F(dmRenderTest, TestRenderListDebug)
     dmRender::DrawDebug3d(m_Context);
 }
 
+static inline dmGraphics::ShaderDesc::Shader MakeDDFShader(const char* data, uint32_t count)
+{
+    dmGraphics::ShaderDesc::Shader ddf;
+    memset(&ddf,0,sizeof(ddf));
+    ddf.m_Source.m_Data  = (uint8_t*)data;
+    ddf.m_Source.m_Count = count;
+    return ddf;
+}
+
+TEST_F(dmRenderTest, TestDrawRedundantState)
+{
+    const char* vp_source = "uniform vec4 tint;\nuniform mat4 world;\n";
+    dmGraphics::ShaderDesc::Shader vp_shader = MakeDDFShader(vp_source, strlen(vp_source));
+    dmGraphics::HVertexProgram vp = dmGraphics::NewVertexProgram(m_GraphicsContext, &vp_shader);
+    dmGraphics::ShaderDesc::Shader fp_shader = MakeDDFShader("foo", 3);
+    dmGraphics::HFragmentProgram fp = dmGraphics::NewFragmentProgram(m_GraphicsContext, &fp_shader);
+    dmRender::HMaterial material = dmRender::NewMaterial(m_Context, vp, fp);
+    dmhash_t tint_hash = dmHashString64("tint");
+    dmRender::SetMaterialProgramConstant(material, tint_hash, Vector4(1.0f, 2.0f, 3.0f, 4.0f));
+    dmRender::SetMaterialProgramConstantType(material, dmHashString64("world"), dmRenderDDF::MaterialDesc::CONSTANT_TYPE_WORLD);
+    int32_t tint_loc = dmGraphics::GetUniformLocation(dmRender::GetMaterialProgram(material), "tint");
+    int32_t world_loc = dmGraphics::GetUniformLocation(dmRender::GetMaterialProgram(material), "world");
+
+    float v[] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f };
+    dmGraphics::HVertexBuffer vertex_buffer = dmGraphics::NewVertexBuffer(m_GraphicsContext, sizeof(v), (void*)v, dmGraphics::BUFFER_USAGE_STATIC_DRAW);
+    dmGraphics::VertexElement ve[] =
+    {
+        {"position", 0, 3, dmGraphics::TYPE_FLOAT, false },
+    };
+    dmGraphics::HVertexDeclaration vertex_declaration = dmGraphics::NewVertexDeclaration(m_GraphicsContext, ve, 1);
+
+    dmGraphics::TextureCreationParams creation_params;
+    creation_params.m_Width = 2;
+    creation_params.m_Height = 2;
+    creation_params.m_OriginalWidth = 2;
+    creation_params.m_OriginalHeight = 2;
+    uint8_t texture_data[4] = {};
+    dmGraphics::TextureParams texture_params;
+    texture_params.m_Data = texture_data;
+    texture_params.m_DataSize = sizeof(texture_data);
+    texture_params.m_Width = 2;
+    texture_params.m_Height = 2;
+    texture_params.m_Format = dmGraphics::TEXTURE_FORMAT_LUMINANCE;
+    dmGraphics::HTexture texture = dmGraphics::NewTexture(m_GraphicsContext, creation_params);
+    dmGraphics::SetTexture(texture, texture_params);
+
+    dmRender::RenderObject ros[2];
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        dmRender::RenderObject& ro = ros[i];
+        ro.m_Material = material;
+        ro.m_VertexBuffer = vertex_buffer;
+        ro.m_VertexDeclaration = vertex_declaration;
+        ro.m_PrimitiveType = dmGraphics::PRIMITIVE_TRIANGLES;
+        ro.m_VertexStart = 0;
+        ro.m_VertexCount = 3;
+        ro.m_Textures[0] = texture;
+    }
+
+    // Identical render objects: the second one only issues the draw call
+    ASSERT_EQ(dmRender::RESULT_OK, dmRender::AddToRender(m_Context, &ros[0]));
+    ASSERT_EQ(dmRender::RESULT_OK, dmRender::AddToRender(m_Context, &ros[1]));
+    ASSERT_EQ(dmRender::RESULT_OK, dmRender::Draw(m_Context, 0, 0));
+    // constants, texture and vertex declaration
+    ASSERT_EQ(3u, m_Context->m_RenderStateCache.m_StateChanges);
+    ASSERT_EQ(3u, m_Context->m_RenderStateCache.m_StateChangesSkipped);
+
+    // Per object constants must not leak into the next render object
+    dmRender::EnableRenderObjectConstant(&ros[0], tint_hash, Vector4(5.0f, 6.0f, 7.0f, 8.0f));
+    ASSERT_EQ(dmRender::RESULT_OK, dmRender::Draw(m_Context, 0, 0));
+    ASSERT_EQ(4u, m_Context->m_RenderStateCache.m_StateChanges);
+    ASSERT_EQ(2u, m_Context->m_RenderStateCache.m_StateChangesSkipped);
+    const Vector4& tint = dmGraphics::GetConstantV4Ptr(m_GraphicsContext, tint_loc);
+    ASSERT_EQ(1.0f, tint.getX());
+    ASSERT_EQ(4.0f, tint.getW());
+    dmRender::DisableRenderObjectConstant(&ros[0], tint_hash);
+
+    // The world transform is still set per render object
+    ros[1].m_WorldTransform = Matrix4::translation(Vector3(10.0f, 0.0f, 0.0f));
+    ASSERT_EQ(dmRender::RESULT_OK, dmRender::Draw(m_Context, 0, 0));
+    ASSERT_EQ(4u, m_Context->m_RenderStateCache.m_StateChanges);
+    ASSERT_EQ(2u, m_Context->m_RenderStateCache.m_StateChangesSkipped);
+    const Vector4& translation = dmGraphics::GetConstantV4Ptr(m_GraphicsContext, world_loc + 3);
+    ASSERT_EQ(10.0f, translation.getX());
+
+    dmRender::ClearRenderObjects(m_Context);
+
+    dmGraphics::DeleteTexture(texture);
+    dmGraphics::DeleteVertexDeclaration(vertex_declaration);
+    dmGraphics::DeleteVertexBuffer(vertex_buffer);
+    dmRender::DeleteMaterial(m_Context, material);
+    dmGraphics::DeleteVertexProgram(vp);
+    dmGraphics::DeleteFragmentProgram(fp);
+}
+
+struct BenchRenderListDispatchCtx
+{
+    uint32_t m_EntriesRendered;
+    uint32_t m_TagMask;
+    float    m_Z;
+    bool     m_Sorted;
+    bool     m_Filtered;
+};
+
+static void BenchRenderListDispatch(dmRender::RenderListDispatchParams const & params)
+{
+    BenchRenderListDispatchCtx *ctx = (BenchRenderListDispatchCtx*) params.m_UserData;
+    if (params.m_Operation != dmRender::RENDER_LIST_OPERATION_BATCH)
+        return;
+
+    for (uint32_t* i = params.m_Begin; i != params.m_End; ++i)
+    {
+        const dmRender::RenderListEntry& entry = params.m_Buf[*i];
+        float z = entry.m_WorldPosition.getZ();
+        ctx->m_Sorted = ctx->m_Sorted && z >= ctx->m_Z;
+        ctx->m_Filtered = ctx->m_Filtered && (entry.m_TagMask & ctx->m_TagMask) == ctx->m_TagMask;
+        ctx->m_Z = z;
+        ctx->m_EntriesRendered++;
+    }
+}
+
+TEST_F(dmRenderTest, BenchRenderListSort)
+{
+    Vectormath::Aos::Matrix4 view = Vectormath::Aos::Matrix4::identity();
+    Vectormath::Aos::Matrix4 proj = Vectormath::Aos::Matrix4::orthographic(0.0f, WIDTH, HEIGHT, 0.0f, 0.1f, 1.0f);
+    dmRender::SetViewMatrix(m_Context, view);
+    dmRender::SetProjectionMatrix(m_Context, proj);
+
+    const uint32_t predicate_count = 5;
+    const char* tags[predicate_count] = { "tile", "sprite", "particle", "gui", "text" };
+    dmRender::Predicate predicates[predicate_count];
+    uint32_t tag_masks[predicate_count];
+    for (uint32_t i = 0; i < predicate_count; ++i)
+    {
+        predicates[i].m_Tags[0] = dmHashString64(tags[i]);
+        predicates[i].m_TagCount = 1;
+        tag_masks[i] = dmRender::ConvertMaterialTagsToMask(predicates[i].m_Tags, predicates[i].m_TagCount);
+    }
+
+    const uint32_t entry_counts[] = { 1000, 20000 };
+    const uint32_t frame_count = 20;
+    for (uint32_t c = 0; c < sizeof(entry_counts)/sizeof(entry_counts[0]); ++c)
+    {
+        const uint32_t n = entry_counts[c];
+        BenchRenderListDispatchCtx ctx;
+
+        uint64_t elapsed = 0;
+        for (uint32_t frame = 0; frame < frame_count; ++frame)
+        {
+            dmRender::RenderListBegin(m_Context);
+            uint8_t dispatch = dmRender::RenderListMakeDispatch(m_Context, BenchRenderListDispatch, &ctx);
+
+            dmRender::RenderListEntry* out = dmRender::RenderListAlloc(m_Context, n);
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                dmRender::RenderListEntry& entry = out[i];
+                entry.m_WorldPosition = Point3(0, 0, (float)((i * 7919) % n));
+                entry.m_MajorOrder = dmRender::RENDER_ORDER_WORLD;
+                entry.m_MinorOrder = 0;
+                entry.m_TagMask = tag_masks[i % predicate_count];
+                entry.m_Order = 0;
+                entry.m_BatchKey = (i * 31) & 63;
+                entry.m_Dispatch = dispatch;
+                entry.m_UserData = 0;
+            }
+            dmRender::RenderListSubmit(m_Context, out, out + n);
+            dmRender::RenderListEnd(m_Context);
+
+            uint32_t entries_rendered = 0;
+            uint64_t start = dmTime::GetTime();
+            for (uint32_t p = 0; p < predicate_count; ++p)
+            {
+                memset(&ctx, 0, sizeof(ctx));
+                ctx.m_TagMask = tag_masks[p];
+                ctx.m_Z = -FLT_MAX;
+                ctx.m_Sorted = true;
+                ctx.m_Filtered = true;
+                dmRender::DrawRenderList(m_Context, &predicates[p], 0);
+                ASSERT_TRUE(ctx.m_Sorted);
+                ASSERT_TRUE(ctx.m_Filtered);
+                entries_rendered += ctx.m_EntriesRendered;
+            }
+            elapsed += dmTime::GetTime() - start;
+            ASSERT_EQ(n, entries_rendered);
+
+            dmRender::ClearRenderObjects(m_Context);
+        }
+
+        printf("DrawRenderList (%u entries, %u predicates): %.3f ms/frame\n", n, predicate_count, (elapsed / (double)frame_count) / 1000.0);
+    }
+}
+
 static float Metric(const char* text, int n)
 {
     return n * 4;
@@ -568,6 +848,119 @@ static inline float ExpectedHeight(float line_height, float num_lines, float lea
     return num_lines * (line_height * fabsf(leading)) - line_height * (fabsf(leading) - 1.0f);
 }
 
+static void DrawTextFrame(dmRender::HRenderContext render_context, dmRender::HFontMap font_map, const char* text)
+{
+    dmRender::DrawTextParams params;
+    params.m_Text = text;
+    params.m_Width = 100.0f;
+    dmRender::RenderListBegin(render_context);
+    dmRender::DrawText(render_context, font_map, 0, 0, params);
+    dmRender::FlushTexts(render_context, 0, 0, true);
+    dmRender::RenderListEnd(render_context);
+    ASSERT_EQ(dmRender::RESULT_OK, dmRender::DrawRenderList(render_context, 0, 0));
+    dmRender::ClearRenderObjects(render_context);
+}
+
+// Returns true if the rows [y_begin, y_end) of the texture data are equal to the expected rows
+static bool VerifyGlyphCacheRows(dmGraphics::HTexture texture, uint32_t width, uint32_t y_begin, uint32_t y_end, const uint8_t* expected)
+{
+    // The null device returns the texture data as the handle
+    uint8_t* data = 0;
+    dmGraphics::GetTextureHandle(texture, (void**)&data);
+    for (uint32_t y = y_begin; y < y_end; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            if (data[y * width + x] != expected[y * width + x])
+                return false;
+        }
+    }
+    return true;
+}
+
+TEST_F(dmRenderTest, GlyphCacheUpload)
+{
+    dmGraphics::ShaderDesc::Shader vp_shader = MakeDDFShader("foo", 3);
+    dmGraphics::HVertexProgram vp = dmGraphics::NewVertexProgram(m_GraphicsContext, &vp_shader);
+    dmGraphics::ShaderDesc::Shader fp_shader = MakeDDFShader("foo", 3);
+    dmGraphics::HFragmentProgram fp = dmGraphics::NewFragmentProgram(m_GraphicsContext, &fp_shader);
+    dmRender::HMaterial material = dmRender::NewMaterial(m_Context, vp, fp);
+
+    // A 16x16 cache with four 8x8 cells, and three 2x3 glyphs
+    const uint32_t cache_width = 16;
+    const uint32_t glyph_data_size = 1 + 2 * 3;
+    uint8_t* glyph_data = (uint8_t*)malloc(3 * glyph_data_size); // owned by the font map
+    dmRender::FontMapParams font_map_params;
+    font_map_params.m_CacheWidth = cache_width;
+    font_map_params.m_CacheHeight = 16;
+    font_map_params.m_CacheCellWidth = 8;
+    font_map_params.m_CacheCellHeight = 8;
+    font_map_params.m_CacheCellMaxAscent = 2;
+    font_map_params.m_MaxAscent = 2;
+    font_map_params.m_MaxDescent = 1;
+    font_map_params.m_Glyphs.SetCapacity(3);
+    font_map_params.m_Glyphs.SetSize(3);
+    memset((void*)&font_map_params.m_Glyphs[0], 0, sizeof(dmRender::Glyph)*3);
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        dmRender::Glyph& g = font_map_params.m_Glyphs[i];
+        g.m_Character = 'a' + i;
+        g.m_Width = 2;
+        g.m_Advance = 2;
+        g.m_Ascent = 2;
+        g.m_Descent = 1;
+        g.m_GlyphDataOffset = i * glyph_data_size;
+        g.m_GlyphDataSize = glyph_data_size;
+
+        uint8_t* data = &glyph_data[i * glyph_data_size];
+        data[0] = 0; // uncompressed
+        for (uint32_t j = 1; j < glyph_data_size; ++j)
+            data[j] = 10 * (i + 1) + j;
+    }
+    font_map_params.m_GlyphData = glyph_data;
+    dmRender::HFontMap font_map = dmRender::NewFontMap(m_GraphicsContext, font_map_params);
+    dmRender::SetFontMapMaterial(font_map, material);
+
+    // The glyphs are expected in the cells 0 (a), 1 (b) and 2 (c)
+    uint8_t expected[cache_width * 16] = {};
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        uint32_t cell_x = (i % 2) * 8;
+        uint32_t cell_y = (i / 2) * 8;
+        for (uint32_t y = 0; y < 3; ++y)
+        {
+            for (uint32_t x = 0; x < 2; ++x)
+                expected[(cell_y + y) * cache_width + cell_x + x] = glyph_data[i * glyph_data_size + 1 + y * 2 + x];
+        }
+    }
+
+    dmGraphics::HTexture texture = dmRender::GetFontMapTexture(font_map);
+
+    uint8_t cleared[cache_width * 16] = {};
+
+    // New glyphs are uploaded as one band of rows
+    DrawTextFrame(m_Context, font_map, "ab");
+    ASSERT_TRUE(VerifyGlyphCacheRows(texture, cache_width, 0, 8, expected));
+    ASSERT_TRUE(VerifyGlyphCacheRows(texture, cache_width, 8, 16, cleared));
+
+    // Cached glyphs are not uploaded again
+    uint8_t* texture_data = 0;
+    ASSERT_EQ(dmGraphics::HANDLE_RESULT_OK, dmGraphics::GetTextureHandle(texture, (void**)&texture_data));
+    memset(texture_data, 0, cache_width * 16);
+    DrawTextFrame(m_Context, font_map, "ab");
+    ASSERT_TRUE(VerifyGlyphCacheRows(texture, cache_width, 0, 16, cleared));
+
+    // Only the band of the new glyph is uploaded
+    DrawTextFrame(m_Context, font_map, "abc");
+    ASSERT_TRUE(VerifyGlyphCacheRows(texture, cache_width, 0, 8, cleared));
+    ASSERT_TRUE(VerifyGlyphCacheRows(texture, cache_width, 8, 16, expected));
+
+    dmRender::DeleteFontMap(font_map);
+    dmRender::DeleteMaterial(m_Context, material);
+    dmGraphics::DeleteVertexProgram(vp);
+    dmGraphics::DeleteFragmentProgram(fp);
+}
+
 TEST_F(dmRenderTest, GetTextMetrics)
 {
     dmRender::TextMetrics metrics;
@@ -621,6 +1014,44 @@ TEST_F(dmRenderTest, GetTextMetrics)
     ASSERT_EQ(ExpectedHeight(lineheight, numlines, leading), metrics.m_Height);
 }
 
+TEST_F(dmRenderTest, GetTextMetricsLayoutCache)
+{
+    dmRender::TextMetrics metrics;
+
+    const int charwidth     = 2;
+    const int lineheight    = 3;
+
+    // Same text and width, from the layout cache the second time
+    for (int i = 0; i < 2; ++i)
+    {
+        dmRender::GetTextMetrics(m_SystemFontMap, "Hello World Bonanza", 8*charwidth, true, 1.0f, 0.0f, &metrics);
+        ASSERT_EQ(charwidth*7, metrics.m_Width);
+        ASSERT_EQ(lineheight*3, metrics.m_Height);
+    }
+
+    // The width is part of the key
+    dmRender::GetTextMetrics(m_SystemFontMap, "Hello World Bonanza", 0, false, 1.0f, 0.0f, &metrics);
+    ASSERT_EQ(charwidth*19, metrics.m_Width);
+    ASSERT_EQ(lineheight*1, metrics.m_Height);
+
+    // Enough texts to fill up the cache several times
+    char text[32];
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        for (int i = 0; i < 2000; ++i)
+        {
+            int n = dmSnPrintf(text, sizeof(text), "%d %d", i, i * 7);
+            dmRender::GetTextMetrics(m_SystemFontMap, text, 0, false, 1.0f, 0.0f, &metrics);
+            ASSERT_EQ(charwidth*n, metrics.m_Width);
+            ASSERT_EQ(lineheight*1, metrics.m_Height);
+        }
+    }
+
+    dmRender::GetTextMetrics(m_SystemFontMap, "Hello World Bonanza", 8*charwidth, true, 1.0f, 0.0f, &metrics);
+    ASSERT_EQ(charwidth*7, metrics.m_Width);
+    ASSERT_EQ(lineheight*3, metrics.m_Height);
+}
+
 TEST_F(dmRenderTest, TextAlignment)
 {
     dmRender::TextMetrics metrics;
@@ -809,6 +809,39 @@ TEST_F(dmRenderScriptTest, TestLuaDraw_NoPredicate)
     dmRender::DeleteRenderScript(m_Context, render_script);
 }
 
+TEST_F(dmRenderScriptTest, TestLuaDraw_Options)
+{
+    const char* script =
+    "function init(self)\n"
+    "    self.test_pred = render.predicate({\"one\", \"two\"})\n"
+    "    local constants = render.constant_buffer()\n"
+    "    render.draw(self.test_pred)\n"
+    "    render.draw(self.test_pred, { frustum_culling = false, constants = constants })\n"
+    "end\n";
+    dmRender::HRenderScript render_script = dmRender::NewRenderScript(m_Context, LuaSourceFromString(script));
+    dmRender::HRenderScriptInstance render_script_instance = dmRender::NewRenderScriptInstance(m_Context, render_script);
+
+    ASSERT_EQ(dmRender::RENDER_SCRIPT_RESULT_OK, dmRender::InitRenderScriptInstance(render_script_instance));
+
+    dmArray<dmRender::Command>& commands = render_script_instance->m_CommandBuffer;
+    ASSERT_EQ(2u, commands.Size());
+
+    dmRender::Command* command = &commands[0];
+    ASSERT_EQ(dmRender::COMMAND_TYPE_DRAW, command->m_Type);
+    ASSERT_EQ(0u, command->m_Operands[1]);
+    ASSERT_EQ(1u, command->m_Operands[2]);
+
+    command = &commands[1];
+    ASSERT_EQ(dmRender::COMMAND_TYPE_DRAW, command->m_Type);
+    ASSERT_NE(0u, command->m_Operands[1]);
+    ASSERT_EQ(0u, command->m_Operands[2]);
+
+    dmRender::ParseCommands(m_Context, &commands[0], commands.Size());
+
+    dmRender::DeleteRenderScriptInstance(render_script_instance);
+    dmRender::DeleteRenderScript(m_Context, render_script);
+}
+
 TEST_F(dmRenderScriptTest, TestLuaWindowSize)
 {
     const char* script =
@@ -123,6 +123,32 @@ def entry_data_hash_cmp(a, b):
     else:
         return -1
 
+# Open addressing hash index on the first 8 bytes of the digest, see FindEntry in resource_archive.cpp
+def hash_index_key(hash):
+    key = struct.unpack('!Q', str(hash[0:8]))[0]
+    key ^= key >> 33
+    key = (key * 0xff51afd7ed558ccd) & 0xFFFFFFFFFFFFFFFF
+    key ^= key >> 33
+    return key
+
+def write_hash_index(out_index, entry_datas):
+    bucket_count = 2
+    while bucket_count < len(entry_datas) * 2:
+        bucket_count <<= 1
+    mask = bucket_count - 1
+    buckets = [(0, 0)] * bucket_count
+    for i,e in enumerate(entry_datas):
+        key = hash_index_key(e.hash)
+        bucket = key & mask
+        while buckets[bucket][1] != 0:
+            bucket = (bucket + 1) & mask
+        buckets[bucket] = (key >> 32, i + 1)
+
+    out_index.write(struct.pack('!I', bucket_count))
+    for tag, index in buckets:
+        out_index.write(struct.pack('!I', tag))
+        out_index.write(struct.pack('!I', index))
+
 def set_output_path(rel_path, full_path):
     return rel_path + os.path.basename(full_path)
 
@@ -139,7 +165,7 @@ def compile(input_files, options):
         # TODO magic number
         out_index.seek(0)
         out_index.write(struct.pack('!I', VERSION)) # Version
-        out_index.write(struct.pack('!I', 0)) # Pad
+        out_index.write(struct.pack('!I', 0)) # HashIndexOffset (placeholder, actual value written later)
         out_index.write(struct.pack('!Q', 0)) # Userdata
         out_index.write(struct.pack('!I', 0)) # EntryCount (placeholder, actual value written later)
         out_index.write(struct.pack('!I', 0)) # EntryOffset (placeholder, actual value written later)
@@ -190,9 +216,13 @@ def compile(input_files, options):
             out_index.write(struct.pack('!I', e.flags))
             i += 1
 
+        align_file(out_index, 4)
+        hash_index_offset = out_index.tell()
+        write_hash_index(out_index, entry_datas)
+
         out_index.seek(0)
         out_index.write(struct.pack('!I', VERSION)) # Version
-        out_index.write(struct.pack('!I', 0)) # Pad
+        out_index.write(struct.pack('!I', hash_index_offset)) # HashIndexOffset
         out_index.write(struct.pack('!Q', 0)) # Userdata
         out_index.write(struct.pack('!I', entry_count)) # EntryCount
         out_index.write(struct.pack('!I', entry_offset)) # EntryOffset
@@ -27,6 +27,15 @@ namespace dmLoadQueue
         RESULT_INVALID_PARAM = -2
     };
 
+    // Requests with higher priority are picked up by the loader before requests with lower priority.
+    // Requests with the same priority are loaded in the order they were added.
+    enum Priority
+    {
+        PRIORITY_HIGH   = 0,
+        PRIORITY_NORMAL = 1,
+        PRIORITY_LOW    = 2,
+    };
+
     typedef struct Queue* HQueue;
     typedef struct Request* HRequest;
 
@@ -35,6 +44,8 @@ namespace dmLoadQueue
         dmResource::FResourcePreload m_Function;
         dmResource::PreloadHintInfo m_HintInfo;
         void* m_Context;
+        // If not set, the function is never called concurrently with other functions that are not thread safe
+        bool m_ThreadSafe;
     };
 
     struct LoadResult
@@ -42,6 +53,8 @@ namespace dmLoadQueue
         dmResource::Result m_LoadResult;
         dmResource::Result m_PreloadResult;
         void* m_PreloadData;
+        // The buffer points into a memory mapped archive (see dmResourceArchive::GetMappedData)
+        bool m_IsBufferMapped;
     };
 
     HQueue CreateQueue(dmResource::HFactory factory);
@@ -49,10 +62,10 @@ namespace dmLoadQueue
 
     // If the queue does not want to accept any more requests at the moment, it returns 0
     // The name and canonical_path provided must have a lifetime that lasts until EndLoad is called
-    HRequest BeginLoad(HQueue queue, const char* name, const char* canonical_path, PreloadInfo* info);
+    HRequest BeginLoad(HQueue queue, const char* name, const char* canonical_path, PreloadInfo* info, Priority priority);
 
     // Actual load result will be put in load_result. Ptrs can be handled until FreeLoad has been called.
-    Result EndLoad(HQueue queue, HRequest request, void** buf, uint32_t* size, LoadResult* load_result);
+    Result EndLoad(HQueue queue, HRequest request, const void** buf, uint32_t* size, LoadResult* load_result);
 
     // Free once completed.
     void FreeLoad(HQueue queue, HRequest request);
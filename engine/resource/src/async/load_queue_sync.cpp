@@ -49,7 +49,7 @@ namespace dmLoadQueue
         delete queue;
     }
 
-    HRequest BeginLoad(HQueue queue, const char* name, const char* canonical_path, PreloadInfo* info)
+    HRequest BeginLoad(HQueue queue, const char* name, const char* canonical_path, PreloadInfo* info, Priority priority)
     {
         if (queue->m_ActiveRequest != 0)
         {
@@ -63,14 +63,14 @@ namespace dmLoadQueue
         return queue->m_ActiveRequest;
     }
 
-    Result EndLoad(HQueue queue, HRequest request, void** buf, uint32_t* size, LoadResult* load_result)
+    Result EndLoad(HQueue queue, HRequest request, const void** buf, uint32_t* size, LoadResult* load_result)
     {
         if (!queue || !request || queue->m_ActiveRequest != request)
         {
             return RESULT_INVALID_PARAM;
         }
 
-        load_result->m_LoadResult    = dmResource::LoadResource(queue->m_Factory, request->m_CanonicalPath, request->m_Name, buf, size);
+        load_result->m_LoadResult    = dmResource::LoadResource(queue->m_Factory, request->m_CanonicalPath, request->m_Name, buf, size, &load_result->m_IsBufferMapped);
         load_result->m_PreloadResult = dmResource::RESULT_PENDING;
         load_result->m_PreloadData   = 0;
 
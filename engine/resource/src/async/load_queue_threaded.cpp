@@ -21,64 +21,95 @@
 #include <dlib/mutex.h>
 #include <dlib/time.h>
 #include <dlib/condition_variable.h>
+#include <dlib/math.h>
 
 namespace dmLoadQueue
 {
-    // Implementation of dmLoadQueue with a thread that loads items in the order they are supplied,
+    // Implementation of dmLoadQueue with a pool of threads that load items in priority order,
+    // and in the order they are supplied within the same priority.
 
     // Default to small buffers since a lot of what is loaded are just small objects anyway.
     // That way we can have more in flight, but throttle when max pending data grows too large anyway
     const uint64_t DEFAULT_CAPACITY = 5 * 1024;
 
-    // Once the loader has this amount not picked up, it will stop loading more.
-    // This sets the bandwidth of the loader.
-    const uint64_t MAX_PENDING_DATA = 4 * 1024 * 1024;
-    const uint32_t QUEUE_SLOTS      = 16;
+    const uint32_t MAX_LOADER_THREADS = 8;
+
+    enum RequestState
+    {
+        REQUEST_STATE_FREE    = 0,
+        REQUEST_STATE_QUEUED  = 1,
+        REQUEST_STATE_LOADING = 2,
+        REQUEST_STATE_LOADED  = 3,
+    };
 
     struct Request
     {
         const char* m_Name;
         const char* m_CanonicalPath;
         dmResource::LoadBufferType m_Buffer;
+        // Set instead of m_Buffer if the data is used directly from a memory mapped archive
+        const void* m_MappedData;
+        uint32_t m_MappedSize;
         PreloadInfo m_PreloadInfo;
         LoadResult m_Result;
+        uint32_t m_Sequence;
+        uint8_t m_Priority;
+        uint8_t m_State;
     };
 
     struct Queue
     {
         dmResource::HFactory m_Factory;
         dmMutex::HMutex m_Mutex;
+        // Held while calling preload functions that are not thread safe
+        dmMutex::HMutex m_PreloadMutex;
         dmConditionVariable::HConditionVariable m_WakeupCond;
-        dmThread::Thread m_Thread;
-        Request m_Request[QUEUE_SLOTS];
-        uint32_t m_Front, m_Back, m_Loaded;
+        dmThread::Thread m_Threads[MAX_LOADER_THREADS];
+        // dmThread::New doesn't copy the name, so it must outlive the thread start
+        char m_ThreadNames[MAX_LOADER_THREADS][16];
+        uint32_t m_ThreadCount;
+        Request* m_Request;
+        uint32_t m_RequestCount;
+        // Number of requests not in REQUEST_STATE_FREE
+        uint32_t m_ActiveCount;
+        uint32_t m_NextSequence;
+        // Once the loader has this amount not picked up, it will stop loading more.
+        // This sets the bandwidth of the loader.
+        uint64_t m_MaxPendingData;
         uint64_t m_BytesWaiting;
         bool m_Shutdown;
-
-        // Circular queue with indexing as follow (exclusive end)
-        //
-        //          m_Back           m_Loaded   m_Front
-        // [N/A]   [loaded] [loaded] [to-load]  [N/A]
-        //
     };
 
+    static bool IsLoadedBefore(const Request* a, const Request* b)
+    {
+        if (a->m_Priority != b->m_Priority)
+        {
+            return a->m_Priority < b->m_Priority;
+        }
+        return (int32_t) (a->m_Sequence - b->m_Sequence) < 0;
+    }
+
     static Request* GetNextRequest(Queue* queue)
     {
         // Since we can be loading many things at once, track the total Capacity() for buffers
         // that are waiting to be picked up by the preloader. In the case of the queue being filled
         // with only large requests (say only 4Mb textures), this throttles a bit so memory consumption
         // does not run away.
-        if (queue->m_BytesWaiting >= MAX_PENDING_DATA)
+        if (queue->m_BytesWaiting >= queue->m_MaxPendingData)
         {
             return 0x0;
         }
 
-        if (queue->m_Loaded == queue->m_Front)
+        Request* next = 0x0;
+        for (uint32_t i = 0; i < queue->m_RequestCount; ++i)
         {
-            return 0x0;
+            Request* r = &queue->m_Request[i];
+            if (r->m_State == REQUEST_STATE_QUEUED && (next == 0x0 || IsLoadedBefore(r, next)))
+            {
+                next = r;
+            }
         }
-
-        return &queue->m_Request[queue->m_Loaded % QUEUE_SLOTS];
+        return next;
     }
 
     static void LoadThread(void* arg)
@@ -86,93 +117,125 @@ namespace dmLoadQueue
         Queue* queue     = (Queue*)arg;
         Request* current = 0;
         LoadResult result;
+        // Scratch memory for compressed archive data, decompressed on this thread
+        dmResource::LoadBufferType stored_buffer;
         while (true)
         {
             {
                 dmMutex::ScopedLock lk(queue->m_Mutex);
                 if (current != 0)
                 {
-                    // Just finished one (from previous iteratino)
+                    // Just finished one (from previous iteration)
                     queue->m_BytesWaiting += current->m_Buffer.Capacity();
-                    queue->m_Loaded++;
                     current->m_Result = result;
+                    current->m_State  = REQUEST_STATE_LOADED;
                     current           = 0;
                 }
-                if (queue->m_Shutdown)
-                {
-                    return;
-                }
 
-                current = GetNextRequest(queue);
-                if (current == 0x0)
+                while (!queue->m_Shutdown && (current = GetNextRequest(queue)) == 0x0)
                 {
                     // Nothing to do, reset any buffers of inactive requests that are not at default capacity
-                    for (uint32_t i = 0; i < QUEUE_SLOTS; ++i)
+                    for (uint32_t i = 0; i < queue->m_RequestCount; ++i)
                     {
                         Request* r = &queue->m_Request[i];
-                        if (r->m_Buffer.Size() == 0)
+                        if (r->m_State == REQUEST_STATE_FREE && r->m_Buffer.Capacity() > DEFAULT_CAPACITY)
                         {
-                            if (r->m_Buffer.Capacity() > DEFAULT_CAPACITY)
-                            {
-                                // Just free the memory here, no need to allocate while holding the mutex
-                                r->m_Buffer.SetCapacity(0);
-                            }
+                            // Just free the memory here, no need to allocate while holding the mutex
+                            r->m_Buffer.SetCapacity(0);
                         }
                     }
+                    if (stored_buffer.Capacity() > DEFAULT_CAPACITY)
+                    {
+                        stored_buffer.SetCapacity(0);
+                    }
                     dmConditionVariable::Wait(queue->m_WakeupCond, queue->m_Mutex);
-                    current = GetNextRequest(queue);
                 }
-            }
-
-            if (current)
-            {
-                // We use the temporary result object here to fill in the data so it can be written with the mutex held.
-                uint32_t size;
 
-                assert(current->m_Buffer.Size() == 0);
-                if (current->m_Buffer.Capacity() != DEFAULT_CAPACITY)
+                if (queue->m_Shutdown)
                 {
-                    current->m_Buffer.SetCapacity(DEFAULT_CAPACITY);
+                    return;
                 }
-                result.m_LoadResult    = DoLoadResource(queue->m_Factory, current->m_CanonicalPath, current->m_Name, &size, &current->m_Buffer);
-                result.m_PreloadResult = dmResource::RESULT_PENDING;
-                result.m_PreloadData   = 0;
+                current->m_State = REQUEST_STATE_LOADING;
+            }
 
-                if (result.m_LoadResult == dmResource::RESULT_OK)
+            // We use the temporary result object here to fill in the data so it can be written with the mutex held.
+            uint32_t size = 0;
+
+            assert(current->m_Buffer.Size() == 0);
+            if (current->m_Buffer.Capacity() != DEFAULT_CAPACITY)
+            {
+                current->m_Buffer.SetCapacity(DEFAULT_CAPACITY);
+            }
+            const void* mapped_data = 0;
+            result.m_LoadResult     = DoLoadResource(queue->m_Factory, current->m_CanonicalPath, current->m_Name, &size, &current->m_Buffer, &stored_buffer, &mapped_data);
+            result.m_PreloadResult  = dmResource::RESULT_PENDING;
+            result.m_PreloadData    = 0;
+            result.m_IsBufferMapped = mapped_data != 0;
+            current->m_MappedData   = mapped_data;
+            current->m_MappedSize   = mapped_data ? size : 0;
+
+            if (result.m_LoadResult == dmResource::RESULT_OK)
+            {
+                assert(mapped_data || current->m_Buffer.Size() == size);
+                if (current->m_PreloadInfo.m_Function)
                 {
-                    assert(current->m_Buffer.Size() == size);
-                    if (current->m_PreloadInfo.m_Function)
+                    dmResource::ResourcePreloadParams params;
+                    params.m_Factory       = queue->m_Factory;
+                    params.m_Context       = current->m_PreloadInfo.m_Context;
+                    params.m_Buffer        = mapped_data ? mapped_data : current->m_Buffer.Begin();
+                    params.m_BufferSize    = size;
+                    params.m_HintInfo      = &current->m_PreloadInfo.m_HintInfo;
+                    params.m_PreloadData   = &result.m_PreloadData;
+                    if (current->m_PreloadInfo.m_ThreadSafe)
                     {
-                        dmResource::ResourcePreloadParams params;
-                        params.m_Factory       = queue->m_Factory;
-                        params.m_Context       = current->m_PreloadInfo.m_Context;
-                        params.m_Buffer        = current->m_Buffer.Begin();
-                        params.m_BufferSize    = current->m_Buffer.Size();
-                        params.m_HintInfo      = &current->m_PreloadInfo.m_HintInfo;
-                        params.m_PreloadData   = &result.m_PreloadData;
                         result.m_PreloadResult = current->m_PreloadInfo.m_Function(params);
                     }
                     else
                     {
-                        result.m_PreloadResult = dmResource::RESULT_OK;
+                        dmMutex::ScopedLock lk(queue->m_PreloadMutex);
+                        result.m_PreloadResult = current->m_PreloadInfo.m_Function(params);
                     }
                 }
+                else
+                {
+                    result.m_PreloadResult = dmResource::RESULT_OK;
+                }
             }
         }
     }
 
     HQueue CreateQueue(dmResource::HFactory factory)
     {
-        Queue* q          = new Queue();
-        q->m_Factory      = factory;
-        q->m_Front        = 0;
-        q->m_Back         = 0;
-        q->m_Loaded       = 0;
-        q->m_Shutdown     = false;
-        q->m_BytesWaiting = 0;
-        q->m_Mutex        = dmMutex::New();
-        q->m_WakeupCond   = dmConditionVariable::New();
-        q->m_Thread       = dmThread::New(&LoadThread, 65536, q, "AsyncLoad");
+        dmResource::LoadQueueParams params;
+        dmResource::GetLoadQueueParams(factory, &params);
+
+        Queue* q            = new Queue();
+        q->m_Factory        = factory;
+        q->m_RequestCount   = dmMath::Max(1u, params.m_QueueSize);
+        q->m_Request        = new Request[q->m_RequestCount];
+        q->m_ActiveCount    = 0;
+        q->m_NextSequence   = 0;
+        q->m_Shutdown       = false;
+        q->m_MaxPendingData = params.m_MaxPendingData;
+        q->m_BytesWaiting   = 0;
+        q->m_Mutex          = dmMutex::New();
+        q->m_PreloadMutex   = dmMutex::New();
+        q->m_WakeupCond     = dmConditionVariable::New();
+
+        for (uint32_t i = 0; i < q->m_RequestCount; ++i)
+        {
+            Request* r = &q->m_Request[i];
+            r->m_Name          = 0x0;
+            r->m_CanonicalPath = 0x0;
+            r->m_State         = REQUEST_STATE_FREE;
+        }
+
+        q->m_ThreadCount = dmMath::Clamp(params.m_ThreadCount, 1u, MAX_LOADER_THREADS);
+        for (uint32_t i = 0; i < q->m_ThreadCount; ++i)
+        {
+            dmSnPrintf(q->m_ThreadNames[i], sizeof(q->m_ThreadNames[i]), "AsyncLoad%u", i);
+            q->m_Threads[i] = dmThread::New(&LoadThread, 65536, q, q->m_ThreadNames[i]);
+        }
 
         return q;
     }
@@ -182,16 +245,21 @@ namespace dmLoadQueue
         {
             dmMutex::ScopedLock lk(queue->m_Mutex);
             queue->m_Shutdown = true;
-            // Wake up the worker so it can exit and allow us to join
-            dmConditionVariable::Signal(queue->m_WakeupCond);
+            // Wake up the workers so they can exit and allow us to join
+            dmConditionVariable::Broadcast(queue->m_WakeupCond);
+        }
+        for (uint32_t i = 0; i < queue->m_ThreadCount; ++i)
+        {
+            dmThread::Join(queue->m_Threads[i]);
         }
-        dmThread::Join(queue->m_Thread);
         dmConditionVariable::Delete(queue->m_WakeupCond);
+        dmMutex::Delete(queue->m_PreloadMutex);
         dmMutex::Delete(queue->m_Mutex);
+        delete[] queue->m_Request;
         delete queue;
     }
 
-    HRequest BeginLoad(HQueue queue, const char* name, const char* canonical_path, PreloadInfo* info)
+    HRequest BeginLoad(HQueue queue, const char* name, const char* canonical_path, PreloadInfo* info, Priority priority)
     {
         assert(name != 0);
         assert(name[0] != 0);
@@ -201,33 +269,46 @@ namespace dmLoadQueue
         dmMutex::ScopedLock lk(queue->m_Mutex);
 
         // Refuse more if full.
-        if ((queue->m_Front - queue->m_Back) == QUEUE_SLOTS)
+        if (queue->m_ActiveCount == queue->m_RequestCount)
             return 0;
 
-        if (queue->m_Loaded == queue->m_Front)
+        Request* req = 0;
+        for (uint32_t i = 0; i < queue->m_RequestCount; ++i)
         {
-            // The worker is sleeping waiting for request, wake it up
-            dmConditionVariable::Signal(queue->m_WakeupCond);
+            if (queue->m_Request[i].m_State == REQUEST_STATE_FREE)
+            {
+                req = &queue->m_Request[i];
+                break;
+            }
         }
+        assert(req != 0);
+        ++queue->m_ActiveCount;
 
-        Request* req         = &queue->m_Request[(queue->m_Front++) % QUEUE_SLOTS];
         req->m_Name          = name;
         req->m_CanonicalPath = canonical_path;
+        req->m_Priority      = (uint8_t) priority;
+        req->m_Sequence      = queue->m_NextSequence++;
+        req->m_State         = REQUEST_STATE_QUEUED;
+        req->m_MappedData    = 0;
+        req->m_MappedSize    = 0;
 
         req->m_PreloadInfo         = *info;
         req->m_Result.m_LoadResult = dmResource::RESULT_PENDING;
 
+        // Wake up a sleeping worker, if any
+        dmConditionVariable::Signal(queue->m_WakeupCond);
+
         return req;
     }
 
-    Result EndLoad(HQueue queue, HRequest request, void** buf, uint32_t* size, LoadResult* load_result)
+    Result EndLoad(HQueue queue, HRequest request, const void** buf, uint32_t* size, LoadResult* load_result)
     {
         dmMutex::ScopedLock lk(queue->m_Mutex);
-        if (request->m_Result.m_LoadResult == dmResource::RESULT_PENDING)
+        if (request->m_State != REQUEST_STATE_LOADED)
             return RESULT_PENDING;
 
-        *buf         = request->m_Buffer.Begin();
-        *size        = request->m_Buffer.Size();
+        *buf         = request->m_MappedData ? request->m_MappedData : request->m_Buffer.Begin();
+        *size        = request->m_MappedData ? request->m_MappedSize : request->m_Buffer.Size();
         *load_result = request->m_Result;
 
         return RESULT_OK;
@@ -237,28 +318,30 @@ namespace dmLoadQueue
     {
         dmMutex::ScopedLock lk(queue->m_Mutex);
 
-        uint32_t old_bytes_waiting = queue->m_BytesWaiting;
+        assert(request->m_State == REQUEST_STATE_LOADED);
+
+        uint64_t old_bytes_waiting = queue->m_BytesWaiting;
 
         // Make sure we don't copy any data if we reallocate the buffer
         request->m_Buffer.SetSize(0);
 
         uint32_t buffer_capacity = request->m_Buffer.Capacity();
         queue->m_BytesWaiting -= buffer_capacity;
-        // If we either have blocked further processing by exceeding MAX_PENDING_DATA or
-        // the buffer has a non-default capacity, we want to wake up the worker
-        if (buffer_capacity != DEFAULT_CAPACITY || (old_bytes_waiting >= MAX_PENDING_DATA && queue->m_BytesWaiting < MAX_PENDING_DATA))
+        if (old_bytes_waiting >= queue->m_MaxPendingData && queue->m_BytesWaiting < queue->m_MaxPendingData)
+        {
+            // We were blocked by exceeding the max pending data, wake up all workers as we can now fit new requests
+            dmConditionVariable::Broadcast(queue->m_WakeupCond);
+        }
+        else if (buffer_capacity != DEFAULT_CAPACITY)
         {
-            // Wake up thread, we can now fit a new request
+            // Wake up a worker so it can trim the buffer
             dmConditionVariable::Signal(queue->m_WakeupCond);
         }
 
         // Clean up picked up requests
         request->m_Name          = 0x0;
         request->m_CanonicalPath = 0x0;
-
-        while (queue->m_Back != queue->m_Loaded && queue->m_Request[queue->m_Back % QUEUE_SLOTS].m_Name == 0x0)
-        {
-            queue->m_Back++;
-        }
+        request->m_State         = REQUEST_STATE_FREE;
+        --queue->m_ActiveCount;
     }
 } // namespace dmLoadQueue
@@ -128,7 +128,7 @@ namespace dmResource
             }
         }
 
-        dmResourceArchive::Result res = WrapArchiveBuffer(index_map, data_map, lu_data_path, lu_data_map, lu_data_file, archive);
+        dmResourceArchive::Result res = WrapArchiveBuffer(index_map, index_size, data_map, lu_data_path, lu_data_map, lu_data_file, archive);
         if (res != dmResourceArchive::RESULT_OK)
         {
             munmap(index_map, index_size);
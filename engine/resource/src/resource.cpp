@@ -127,6 +127,11 @@ struct SResourceFactory
     // Resource manifest
     Manifest*                                    m_Manifest;
     void*                                        m_ArchiveMountInfo;
+    // Number of resources created from memory mapped archive data. They may still reference it, so the archive isn't unmounted while nonzero
+    uint32_t                                     m_MappedResourceCount;
+
+    // Settings for the threaded load queue used by the preloader
+    LoadQueueParams                              m_LoadQueueParams;
 
     uint8_t                                      m_UseLiveUpdate : 1;
 };
@@ -189,6 +194,9 @@ void SetDefaultNewFactoryParams(struct NewFactoryParams* params)
 {
     params->m_MaxResources = 1024;
     params->m_Flags = RESOURCE_FACTORY_FLAGS_EMPTY;
+    params->m_LoadQueueThreadCount = 2;
+    params->m_LoadQueueSize = 16;
+    params->m_LoadQueueMaxPendingData = 4 * 1024 * 1024;
 
     params->m_ArchiveManifest.m_Data = 0;
     params->m_ArchiveManifest.m_Size = 0;
@@ -377,6 +385,8 @@ Result LoadArchiveIndex(const char* bundle_dir, HFactory factory)
         int archive_id_cmp = dmResourceArchive::CmpArchiveIdentifier(factory->m_Manifest->m_ArchiveIndex, factory->m_Manifest->m_DDF->m_ArchiveIdentifier.m_Data, factory->m_Manifest->m_DDF->m_ArchiveIdentifier.m_Count);
         if (archive_id_cmp != 0)
         {
+            // The reload unmounts the current archive, nothing can be referencing its data yet
+            assert(factory->m_MappedResourceCount == 0);
             dmResourceArchive::Result reload_res = ReloadBundledArchiveIndex(archive_index_path, archive_resource_path, liveupdate_index_path, liveupdate_resource_path, factory->m_Manifest->m_ArchiveIndex, factory->m_ArchiveMountInfo);
 
             if (reload_res != dmResourceArchive::RESULT_OK)
@@ -626,6 +636,9 @@ HFactory NewFactory(NewFactoryParams* params, const char* uri)
     memset(factory, 0, sizeof(*factory));
     factory->m_Socket = socket;
     factory->m_UseLiveUpdate = params->m_Flags & RESOURCE_FACTORY_FLAGS_LIVE_UPDATE ? 1 : 0;
+    factory->m_LoadQueueParams.m_ThreadCount = params->m_LoadQueueThreadCount;
+    factory->m_LoadQueueParams.m_QueueSize = params->m_LoadQueueSize;
+    factory->m_LoadQueueParams.m_MaxPendingData = params->m_LoadQueueMaxPendingData;
 
     dmURI::Result uri_result = dmURI::Parse(uri, &factory->m_UriParts);
     if (uri_result != dmURI::RESULT_OK)
@@ -847,7 +860,7 @@ HFactory NewFactory(NewFactoryParams* params, const char* uri)
         else
         {
             res = dmDDF::LoadMessage(factory->m_BuiltinsManifest->m_DDF->m_Data.m_Data, factory->m_BuiltinsManifest->m_DDF->m_Data.m_Count, dmLiveUpdateDDF::ManifestData::m_DDFDescriptor, (void**)&factory->m_BuiltinsManifest->m_DDFData);
-            dmResourceArchive::WrapArchiveBuffer(params->m_ArchiveIndex.m_Data, params->m_ArchiveData.m_Data, 0x0, 0x0, 0x0, &factory->m_BuiltinsManifest->m_ArchiveIndex);
+            dmResourceArchive::WrapArchiveBuffer(params->m_ArchiveIndex.m_Data, params->m_ArchiveIndex.m_Size, params->m_ArchiveData.m_Data, 0x0, 0x0, 0x0, &factory->m_BuiltinsManifest->m_ArchiveIndex);
         }
     }
 
@@ -889,7 +902,12 @@ void DeleteFactory(HFactory factory)
             factory->m_Manifest->m_DDFData = 0x0;
         }
 
-        if (factory->m_Manifest->m_ArchiveIndex)
+        if (factory->m_MappedResourceCount > 0)
+        {
+            // Leak the archive rather than unmapping data that is still referenced
+            dmLogWarning("%u resources still reference the memory mapped archive, it will not be unmounted", factory->m_MappedResourceCount);
+        }
+        else if (factory->m_Manifest->m_ArchiveIndex)
         {
             if (factory->m_ArchiveMountInfo)
                 UnmountArchiveInternal(factory->m_Manifest->m_ArchiveIndex, factory->m_ArchiveMountInfo);
@@ -979,12 +997,33 @@ Result RegisterType(HFactory factory,
     resource_type.m_PostCreateFunction = post_create_function;
     resource_type.m_DestroyFunction = destroy_function;
     resource_type.m_RecreateFunction = recreate_function;
+    resource_type.m_LoadPriority = LOAD_PRIORITY_NORMAL;
 
     factory->m_ResourceTypes[factory->m_ResourceTypesCount++] = resource_type;
 
     return RESULT_OK;
 }
 
+Result SetPreloadThreadSafe(HFactory factory, const char* extension, bool thread_safe)
+{
+    SResourceType* resource_type = FindResourceType(factory, extension);
+    if (resource_type == 0)
+        return RESULT_UNKNOWN_RESOURCE_TYPE;
+
+    resource_type->m_PreloadThreadSafe = thread_safe;
+    return RESULT_OK;
+}
+
+Result SetLoadPriority(HFactory factory, const char* extension, LoadPriority priority)
+{
+    SResourceType* resource_type = FindResourceType(factory, extension);
+    if (resource_type == 0)
+        return RESULT_UNKNOWN_RESOURCE_TYPE;
+
+    resource_type->m_LoadPriority = priority;
+    return RESULT_OK;
+}
+
 // Finds the specific entry in a sorted list of entries
 static int FindEntryIndex(const Manifest* manifest, dmhash_t path_hash)
 {
@@ -1042,7 +1081,20 @@ Result VerifyResourcesBundled(HFactory factory, Manifest* manifest)
     return VerifyResourcesBundled(entries, entry_count, factory->m_Manifest->m_ArchiveIndex);
 }
 
-static Result LoadFromManifest(const Manifest* manifest, const char* path, uint32_t* resource_size, LoadBufferType* buffer)
+// Archive entry that has been read while holding m_LoadMutex, but is decrypted and decompressed after the lock is released
+struct DeferredDecode
+{
+    // Scratch buffer for compressed data
+    LoadBufferType*              m_StoredBuffer;
+    // Buffer holding the stored data once read, m_StoredBuffer or the resource buffer itself
+    LoadBufferType*              m_Stored;
+    dmResourceArchive::EntryData m_Entry;
+    bool                         m_Pending;
+};
+
+// If mapped_data is set, and the entry is stored as is in a memory mapped archive, the data isn't copied
+// to the buffer. Instead mapped_data points to the data in the archive (see dmResourceArchive::GetMappedData)
+static Result LoadFromManifest(const Manifest* manifest, const char* path, uint32_t* resource_size, LoadBufferType* buffer, DeferredDecode* deferred, const void** mapped_data)
 {
     dmhash_t path_hash = dmHashString64(path);
 
@@ -1057,16 +1109,45 @@ static Result LoadFromManifest(const Manifest* manifest, const char* path, uint3
     if (res == dmResourceArchive::RESULT_OK)
     {
         uint32_t file_size = ed.m_ResourceSize;
+        if (mapped_data && dmResourceArchive::GetMappedData(manifest->m_ArchiveIndex, &ed, mapped_data) == dmResourceArchive::RESULT_OK)
+        {
+            buffer->SetSize(0);
+            *resource_size = file_size;
+            return RESULT_OK;
+        }
+
         if (buffer->Capacity() < file_size)
         {
             buffer->SetCapacity(file_size);
         }
 
         buffer->SetSize(0);
-        dmResourceArchive::Result read_result = dmResourceArchive::Read(manifest->m_ArchiveIndex, &ed, buffer->Begin());
-        if (read_result != dmResourceArchive::RESULT_OK)
+        if (deferred)
         {
-            return RESULT_IO_ERROR;
+            // Uncompressed entries are read straight into the resource buffer
+            LoadBufferType* stored = (ed.m_ResourceCompressedSize == 0xFFFFFFFF) ? buffer : deferred->m_StoredBuffer;
+            uint32_t stored_size = dmResourceArchive::GetStoredSize(&ed);
+            if (stored->Capacity() < stored_size)
+            {
+                stored->SetCapacity(stored_size);
+            }
+            stored->SetSize(0);
+            if (dmResourceArchive::ReadStored(manifest->m_ArchiveIndex, &ed, stored->Begin()) != dmResourceArchive::RESULT_OK)
+            {
+                return RESULT_IO_ERROR;
+            }
+            stored->SetSize(stored_size);
+            deferred->m_Stored = stored;
+            deferred->m_Entry = ed;
+            deferred->m_Pending = true;
+        }
+        else
+        {
+            dmResourceArchive::Result read_result = dmResourceArchive::Read(manifest->m_ArchiveIndex, &ed, buffer->Begin());
+            if (read_result != dmResourceArchive::RESULT_OK)
+            {
+                return RESULT_IO_ERROR;
+            }
         }
 
         buffer->SetSize(file_size);
@@ -1084,12 +1165,19 @@ static Result LoadFromManifest(const Manifest* manifest, const char* path, uint3
 }
 
 // Assumes m_LoadMutex is already held
-static Result DoLoadResourceLocked(HFactory factory, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer)
+// If deferred is set, archive entries are only read and must be decoded by the caller (see DoLoadResource)
+// If mapped_data is set, it is set to the data if it was borrowed from a memory mapped archive, otherwise 0
+static Result DoLoadResourceLocked(HFactory factory, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer, DeferredDecode* deferred, const void** mapped_data)
 {
     DM_PROFILE(Resource, "LoadResource");
+    if (mapped_data)
+    {
+        *mapped_data = 0;
+    }
+
     if (factory->m_BuiltinsManifest)
     {
-        if (LoadFromManifest(factory->m_BuiltinsManifest, original_name, resource_size, buffer) == RESULT_OK)
+        if (LoadFromManifest(factory->m_BuiltinsManifest, original_name, resource_size, buffer, deferred, mapped_data) == RESULT_OK)
         {
             return RESULT_OK;
         }
@@ -1143,7 +1231,7 @@ static Result DoLoadResourceLocked(HFactory factory, const char* path, const cha
     }
     else if (factory->m_Manifest)
     {
-        Result r = LoadFromManifest(factory->m_Manifest, original_name, resource_size, buffer);
+        Result r = LoadFromManifest(factory->m_Manifest, original_name, resource_size, buffer, deferred, mapped_data);
         return r;
     }
     else
@@ -1188,23 +1276,44 @@ static Result DoLoadResourceLocked(HFactory factory, const char* path, const cha
 }
 
 // Takes the lock.
-Result DoLoadResource(HFactory factory, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer)
+Result DoLoadResource(HFactory factory, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer, LoadBufferType* stored_buffer, const void** mapped_data)
 {
-    // Called from async queue so we wrap around a lock
-    dmMutex::ScopedLock lk(factory->m_LoadMutex);
-    return DoLoadResourceLocked(factory, path, original_name, resource_size, buffer);
+    DeferredDecode deferred;
+    deferred.m_StoredBuffer = stored_buffer;
+    deferred.m_Stored = 0;
+    deferred.m_Pending = false;
+
+    Result r;
+    {
+        // Called from async queue so we wrap around a lock
+        dmMutex::ScopedLock lk(factory->m_LoadMutex);
+        r = DoLoadResourceLocked(factory, path, original_name, resource_size, buffer, stored_buffer ? &deferred : 0, mapped_data);
+    }
+
+    if (r == RESULT_OK && deferred.m_Pending)
+    {
+        // Decrypt and decompress outside of the lock, which lets several loader threads decode in parallel
+        DM_PROFILE(Resource, "DecodeResource");
+        if (dmResourceArchive::DecodeStored(&deferred.m_Entry, deferred.m_Stored->Begin(), buffer->Begin()) != dmResourceArchive::RESULT_OK)
+        {
+            return RESULT_IO_ERROR;
+        }
+    }
+    return r;
 }
 
 // Assumes m_LoadMutex is already held
-Result LoadResource(HFactory factory, const char* path, const char* original_name, void** buffer, uint32_t* resource_size)
+Result LoadResource(HFactory factory, const char* path, const char* original_name, const void** buffer, uint32_t* resource_size, bool* buffer_mapped)
 {
     if (factory->m_Buffer.Capacity() != DEFAULT_BUFFER_SIZE) {
         factory->m_Buffer.SetCapacity(DEFAULT_BUFFER_SIZE);
     }
     factory->m_Buffer.SetSize(0);
-    Result r = DoLoadResourceLocked(factory, path, original_name, resource_size, &factory->m_Buffer);
+    const void* mapped_data = 0;
+    Result r = DoLoadResourceLocked(factory, path, original_name, resource_size, &factory->m_Buffer, 0, &mapped_data);
+    *buffer_mapped = mapped_data != 0;
     if (r == RESULT_OK)
-        *buffer = factory->m_Buffer.Begin();
+        *buffer = mapped_data ? mapped_data : factory->m_Buffer.Begin();
     else
         *buffer = 0;
     return r;
@@ -1269,9 +1378,10 @@ static Result DoGet(HFactory factory, const char* name, void** resource)
             return RESULT_UNKNOWN_RESOURCE_TYPE;
         }
 
-        void *buffer;
+        const void* buffer;
         uint32_t file_size;
-        Result result = LoadResource(factory, canonical_path, name, &buffer, &file_size);
+        bool buffer_mapped;
+        Result result = LoadResource(factory, canonical_path, name, &buffer, &file_size, &buffer_mapped);
         if (result != RESULT_OK) {
             if (result == RESULT_RESOURCE_NOT_FOUND) {
                 dmLogWarning("Resource not found: %s", name);
@@ -1279,7 +1389,7 @@ static Result DoGet(HFactory factory, const char* name, void** resource)
             return result;
         }
 
-        assert(buffer == factory->m_Buffer.Begin());
+        assert(buffer_mapped || buffer == factory->m_Buffer.Begin());
 
         // TODO: We should *NOT* allocate SResource dynamically...
         SResourceDescriptor tmp_resource;
@@ -1308,6 +1418,7 @@ static Result DoGet(HFactory factory, const char* name, void** resource)
         {
             tmp_resource.m_ResourceSizeOnDisc = file_size;
             tmp_resource.m_ResourceSize = 0; // Not everything will report a size (but instead rely on the disc size, sinze it's close enough)
+            tmp_resource.m_BufferMapped = buffer_mapped;
 
             ResourceCreateParams params;
             params.m_Factory = factory;
@@ -1317,6 +1428,7 @@ static Result DoGet(HFactory factory, const char* name, void** resource)
             params.m_PreloadData = preload_data;
             params.m_Resource = &tmp_resource;
             params.m_Filename = name;
+            params.m_IsBufferMapped = buffer_mapped;
             create_error = resource_type->m_CreateFunction(params);
         }
 
@@ -1439,6 +1551,10 @@ Result InsertResource(HFactory factory, const char* path, uint64_t canonical_pat
 
     factory->m_Resources->Put(canonical_path_hash, *descriptor);
     factory->m_ResourceToHash->Put((uintptr_t) descriptor->m_Resource, canonical_path_hash);
+    if (descriptor->m_BufferMapped)
+    {
+        factory->m_MappedResourceCount++;
+    }
     if (factory->m_ResourceHashToFilename)
     {
         char canonical_path[RESOURCE_PATH_MAX];
@@ -1469,12 +1585,13 @@ Result GetRaw(HFactory factory, const char* name, void** resource, uint32_t* res
     char canonical_path[RESOURCE_PATH_MAX];
     GetCanonicalPath(name, canonical_path);
 
-    void* buffer;
+    const void* buffer;
     uint32_t file_size;
-    Result result = LoadResource(factory, canonical_path, name, &buffer, &file_size);
+    bool buffer_mapped;
+    Result result = LoadResource(factory, canonical_path, name, &buffer, &file_size, &buffer_mapped);
     if (result == RESULT_OK) {
         *resource = malloc(file_size);
-        assert(buffer == factory->m_Buffer.Begin());
+        assert(buffer_mapped || buffer == factory->m_Buffer.Begin());
         memcpy(*resource, buffer, file_size);
         *resource_size = file_size;
     }
@@ -1500,13 +1617,14 @@ static Result DoReloadResource(HFactory factory, const char* name, SResourceDesc
     if (!resource_type->m_RecreateFunction)
         return RESULT_NOT_SUPPORTED;
 
-    void* buffer;
+    const void* buffer;
     uint32_t file_size;
-    Result result = LoadResource(factory, canonical_path, name, &buffer, &file_size);
+    bool buffer_mapped;
+    Result result = LoadResource(factory, canonical_path, name, &buffer, &file_size, &buffer_mapped);
     if (result != RESULT_OK)
         return result;
 
-    assert(buffer == factory->m_Buffer.Begin());
+    assert(buffer_mapped || buffer == factory->m_Buffer.Begin());
 
     ResourceRecreateParams params;
     params.m_Factory = factory;
@@ -1521,6 +1639,12 @@ static Result DoReloadResource(HFactory factory, const char* name, SResourceDesc
     if (create_result == RESULT_OK)
     {
         params.m_Resource->m_ResourceSizeOnDisc = file_size;
+        // Recreate functions always get a transient buffer, so the resource no longer references mapped data
+        if (rd->m_BufferMapped)
+        {
+            rd->m_BufferMapped = 0;
+            factory->m_MappedResourceCount--;
+        }
         if (factory->m_ResourceReloadedCallbacks)
         {
             for (uint32_t i = 0; i < factory->m_ResourceReloadedCallbacks->Size(); ++i)
@@ -1847,6 +1971,12 @@ void Release(HFactory factory, void* resource)
         params.m_Resource = rd;
         resource_type->m_DestroyFunction(params);
 
+        if (rd->m_BufferMapped)
+        {
+            assert(factory->m_MappedResourceCount > 0);
+            factory->m_MappedResourceCount--;
+        }
+
         factory->m_ResourceToHash->Erase((uintptr_t) resource);
         factory->m_Resources->Erase(*resource_hash);
         if (factory->m_ResourceHashToFilename)
@@ -1907,6 +2037,11 @@ Result GetPath(HFactory factory, const void* resource, uint64_t* hash)
     return RESULT_RESOURCE_NOT_FOUND;
 }
 
+void GetLoadQueueParams(HFactory factory, LoadQueueParams* params)
+{
+    *params = factory->m_LoadQueueParams;
+}
+
 dmMutex::HMutex GetLoadMutex(const dmResource::HFactory factory)
 {
     return factory->m_LoadMutex;
@@ -91,6 +91,17 @@ namespace dmResource
         KIND_POINTER, //!< KIND_POINTER
     };
 
+    /**
+     * Load priority of a resource type. The preloader loads resources with a higher priority first
+     * @see SetLoadPriority
+     */
+    enum LoadPriority
+    {
+        LOAD_PRIORITY_HIGH   = 0,
+        LOAD_PRIORITY_NORMAL = 1,
+        LOAD_PRIORITY_LOW    = 2,
+    };
+
     struct Manifest
     {
         Manifest()
@@ -128,6 +139,9 @@ namespace dmResource
 
         /// Resource kind
         Kind     m_ResourceKind;
+
+        /// For internal use only. Set if the resource was created from a memory mapped archive buffer (see ResourceCreateParams::m_IsBufferMapped)
+        uint8_t  m_BufferMapped : 1;
     };
 
     /**
@@ -170,6 +184,10 @@ namespace dmResource
      * PreloadHint can be called with the supplied hint_info handle.
      * If RESULT_OK is returned, the resource Create function is guaranteed to be called
      * with the preload_data value supplied.
+     * The preloader may use several loading threads. Preload functions are still called one at a time,
+     * unless the resource type is flagged with SetPreloadThreadSafe. A thread safe preload function can be called
+     * concurrently with itself and with other preload functions, so any state it shares, such as the
+     * resource context, must be synchronized by the function itself.
      * @param param Resource preloading parameters
      * @return RESULT_OK on success
      */
@@ -194,6 +212,9 @@ namespace dmResource
         void* m_PreloadData;
         /// Resource descriptor to fill in
         SResourceDescriptor* m_Resource;
+        /// True if m_Buffer points into a memory mapped archive. The data is then read-only and stays
+        /// valid until the resource is destroyed, so the resource may reference it instead of copying it
+        bool m_IsBufferMapped;
     };
 
     /**
@@ -354,7 +375,14 @@ namespace dmResource
         EmbeddedResource m_ArchiveData;
         EmbeddedResource m_ArchiveManifest;
 
-        uint32_t m_Reserved[5];
+        /// Number of loader threads used by each preloader. Default is 2
+        uint32_t m_LoadQueueThreadCount;
+        /// Max number of load requests in flight for each preloader. Default is 16
+        uint32_t m_LoadQueueSize;
+        /// Amount of loaded data, in bytes, not yet picked up by the preloader before loading is throttled. Default is 4 MB
+        uint32_t m_LoadQueueMaxPendingData;
+
+        uint32_t m_Reserved[2];
 
         NewFactoryParams()
         {
@@ -403,6 +431,27 @@ namespace dmResource
                                FResourceDestroy destroy_function,
                                FResourceRecreate recreate_function);
 
+    /**
+     * Flag whether the preload function of a resource type can be called from several loading threads at once.
+     * Preload functions are serialized by default.
+     * @param factory Factory handle
+     * @param extension File extension of a registered resource type
+     * @param thread_safe If the preload function is thread safe
+     * @return RESULT_OK on success
+     * @see FResourcePreload
+     */
+    Result SetPreloadThreadSafe(HFactory factory, const char* extension, bool thread_safe);
+
+    /**
+     * Set the priority the preloader loads resources of a resource type with.
+     * Resource types have LOAD_PRIORITY_NORMAL by default.
+     * @param factory Factory handle
+     * @param extension File extension of a registered resource type
+     * @param priority Load priority
+     * @return RESULT_OK on success
+     */
+    Result SetLoadPriority(HFactory factory, const char* extension, LoadPriority priority);
+
     /**
      * Get a resource from factory
      * @param factory Factory handle
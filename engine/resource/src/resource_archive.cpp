@@ -51,16 +51,131 @@ namespace dmResourceArchive
     const static uint64_t FILE_LOADED_INDICATOR = 1337;
     const char* KEY = "aQj8CScgNP4VsfXK";
 
-    Result WrapArchiveBuffer(const void* index_buffer, const void* resource_data, const char* lu_resource_filename, const void* lu_resource_data, FILE* f_lu_resource_data, HArchiveIndexContainer* archive)
+    /*
+     * The archive index can optionally carry a hash index (written by the archive builder) at m_HashIndexOffset:
+     *
+     *   uint32_t bucket_count (power of two, at least twice the entry count)
+     *   bucket_count * { uint32_t tag, uint32_t entry_index + 1 } (0 marks an empty bucket)
+     *
+     * All values are big endian. The key is the first 8 bytes of the digest, mixed and split into a start
+     * bucket (low bits) and a tag (high 32 bits). Collisions are resolved with linear probing.
+     * Archives without a valid hash index (older archives, or indices rebuilt by liveupdate) get one built in memory.
+     */
+    static inline uint64_t GetHashIndexKey(const uint8_t* hash)
     {
-        *archive = new ArchiveIndexContainer;
-        (*archive)->m_IsMemMapped = true;
+        uint64_t key = 0;
+        for (uint32_t i = 0; i < 8; ++i)
+        {
+            key = (key << 8) | hash[i];
+        }
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return key;
+    }
+
+    static uint32_t GetHashIndexBucketCount(uint32_t entry_count)
+    {
+        uint32_t bucket_count = 2;
+        while (bucket_count < entry_count * 2)
+        {
+            bucket_count <<= 1;
+        }
+        return bucket_count;
+    }
+
+    uint32_t GetHashIndexSize(uint32_t entry_count)
+    {
+        return 1 + 2 * GetHashIndexBucketCount(entry_count);
+    }
+
+    void BuildHashIndex(const uint8_t* hashes, uint32_t entry_count, uint32_t* hash_index)
+    {
+        uint32_t bucket_count = GetHashIndexBucketCount(entry_count);
+        uint32_t mask = bucket_count - 1;
+        memset(hash_index, 0, GetHashIndexSize(entry_count) * sizeof(uint32_t));
+        hash_index[0] = C_TO_JAVA(bucket_count);
+        uint32_t* buckets = hash_index + 1;
+        for (uint32_t i = 0; i < entry_count; ++i)
+        {
+            uint64_t key = GetHashIndexKey(hashes + DMRESOURCE_MAX_HASH * i);
+            uint32_t bucket = (uint32_t)key & mask;
+            while (buckets[bucket * 2 + 1] != 0)
+            {
+                bucket = (bucket + 1) & mask;
+            }
+            buckets[bucket * 2 + 0] = C_TO_JAVA((uint32_t)(key >> 32));
+            buckets[bucket * 2 + 1] = C_TO_JAVA(i + 1);
+        }
+    }
+
+    static void SetHashIndex(HArchiveIndexContainer archive, uint32_t* hash_index, bool mem_mapped)
+    {
+        if (!archive->m_HashIndexMemMapped)
+        {
+            delete[] archive->m_HashIndex;
+        }
+        archive->m_HashIndex = hash_index;
+        archive->m_HashIndexMemMapped = mem_mapped;
+    }
+
+    // Builds the hash index from the current archive index, e.g. after liveupdate has replaced it
+    static void RebuildHashIndex(HArchiveIndexContainer archive)
+    {
+        uint32_t entry_count = JAVA_TO_C(archive->m_ArchiveIndex->m_EntryDataCount);
+        const uint8_t* hashes = archive->m_IsMemMapped ? (const uint8_t*)((uintptr_t)archive->m_ArchiveIndex + JAVA_TO_C(archive->m_ArchiveIndex->m_HashOffset)) : archive->m_Hashes;
+        uint32_t* hash_index = new uint32_t[GetHashIndexSize(entry_count)];
+        BuildHashIndex(hashes, entry_count, hash_index);
+        SetHashIndex(archive, hash_index, false);
+    }
+
+    // Returns the hash index stored in a mem-mapped archive index, or 0 if it's missing or doesn't fit within the index buffer
+    static uint32_t* GetMappedHashIndex(const ArchiveIndex* a, uint32_t index_buffer_size)
+    {
+        uint32_t hash_index_offset = JAVA_TO_C(a->m_HashIndexOffset);
+        uint32_t entry_count = JAVA_TO_C(a->m_EntryDataCount);
+        if (hash_index_offset == 0 || (((uintptr_t)a + hash_index_offset) & 3) != 0)
+        {
+            return 0;
+        }
+
+        uint64_t hash_index_end = (uint64_t)hash_index_offset + GetHashIndexSize(entry_count) * sizeof(uint32_t);
+        if (hash_index_end > index_buffer_size)
+        {
+            return 0;
+        }
+
+        uint32_t* hash_index = (uint32_t*)((uintptr_t)a + hash_index_offset);
+        if (JAVA_TO_C(hash_index[0]) != GetHashIndexBucketCount(entry_count))
+        {
+            return 0;
+        }
+        return hash_index;
+    }
+
+    Result WrapArchiveBuffer(const void* index_buffer, uint32_t index_buffer_size, const void* resource_data, const char* lu_resource_filename, const void* lu_resource_data, FILE* f_lu_resource_data, HArchiveIndexContainer* archive)
+    {
+        *archive = 0;
         ArchiveIndex* a = (ArchiveIndex*) index_buffer;
+        if (index_buffer_size < sizeof(ArchiveIndex))
+        {
+            return RESULT_IO_ERROR;
+        }
         uint32_t version = JAVA_TO_C(a->m_Version);
         if (version != VERSION)
         {
             return RESULT_VERSION_MISMATCH;
         }
+        uint64_t entry_count = JAVA_TO_C(a->m_EntryDataCount);
+        if (JAVA_TO_C(a->m_HashOffset) + entry_count * DMRESOURCE_MAX_HASH > index_buffer_size ||
+            JAVA_TO_C(a->m_EntryDataOffset) + entry_count * sizeof(EntryData) > index_buffer_size)
+        {
+            dmLogError("Archive index entries exceed the index size (%u bytes)", index_buffer_size);
+            return RESULT_IO_ERROR;
+        }
+
+        *archive = new ArchiveIndexContainer;
+        (*archive)->m_IsMemMapped = true;
         (*archive)->m_ResourceData = (uint8_t*)resource_data;
         (*archive)->m_ResourcesMemMapped = true;
         (*archive)->m_LiveUpdateResourceData = (uint8_t*)lu_resource_data;
@@ -78,6 +193,20 @@ namespace dmResourceArchive
 
         (*archive)->m_ArchiveIndex = a;
 
+        uint32_t* hash_index = GetMappedHashIndex(a, index_buffer_size);
+        if (hash_index)
+        {
+            SetHashIndex(*archive, hash_index, true);
+        }
+        else
+        {
+            if (a->m_HashIndexOffset != 0)
+            {
+                dmLogWarning("Invalid archive hash index, rebuilding it");
+            }
+            RebuildHashIndex(*archive);
+        }
+
         return RESULT_OK;
     }
 
@@ -219,6 +348,7 @@ namespace dmResourceArchive
 
         bundled_archive_container->m_ArchiveIndex = reloaded_index;
         bundled_archive_container->m_IsMemMapped = true;
+        RebuildHashIndex(bundled_archive_container);
 
         // reloaded_index is now the union of bundled archive index and liveupdate entries
         // use it as runtime index, and write it to liveupdate.arci.tmp
@@ -283,6 +413,13 @@ namespace dmResourceArchive
                 delete archive->m_ArchiveIndex;
             }
 
+            delete[] archive->m_Hashes;
+            delete[] archive->m_Entries;
+            if (!archive->m_HashIndexMemMapped)
+            {
+                delete[] archive->m_HashIndex;
+            }
+
             delete archive;
         }
     }
@@ -357,6 +494,25 @@ namespace dmResourceArchive
             return RESULT_IO_ERROR;
         }
 
+        uint32_t hash_index_offset = JAVA_TO_C(ai->m_HashIndexOffset);
+        uint32_t hash_index_size = GetHashIndexSize(entry_count);
+        aic->m_HashIndex = new uint32_t[hash_index_size];
+        if (hash_index_offset != 0)
+        {
+            uint32_t hash_index_total_size = hash_index_size * sizeof(uint32_t);
+            fseek(f_index, hash_index_offset, SEEK_SET);
+            if (fread(aic->m_HashIndex, 1, hash_index_total_size, f_index) != hash_index_total_size || JAVA_TO_C(aic->m_HashIndex[0]) != GetHashIndexBucketCount(entry_count))
+            {
+                dmLogWarning("Invalid archive hash index, rebuilding it");
+                hash_index_offset = 0;
+            }
+        }
+
+        if (hash_index_offset == 0)
+        {
+            BuildHashIndex(aic->m_Hashes, entry_count, aic->m_HashIndex);
+        }
+
         // Mark that this archive was loaded from file, and not memory-mapped
         ai->m_Userdata = FILE_LOADED_INDICATOR;
 
@@ -408,6 +564,11 @@ namespace dmResourceArchive
             delete[] archive->m_Hashes;
         }
 
+        if (archive->m_HashIndex && !archive->m_HashIndexMemMapped)
+        {
+            delete[] archive->m_HashIndex;
+        }
+
         if (archive->m_FileResourceData)
         {
             fclose(archive->m_FileResourceData);
@@ -528,6 +689,9 @@ namespace dmResourceArchive
         {
             dst->m_EntryDataOffset = C_TO_JAVA(JAVA_TO_C(dst->m_EntryDataOffset) + DMRESOURCE_MAX_HASH * extra_entries_alloc);
         }
+
+        // The copy is modified (and written) by liveupdate without the hash index
+        dst->m_HashIndexOffset = 0;
     }
 
     Result WriteResourceToArchive(HArchiveIndexContainer& archive, const uint8_t* buf, size_t buf_len, uint32_t& bytes_written, uint32_t& offset)
@@ -568,6 +732,7 @@ namespace dmResourceArchive
     {
         assert(insertion_index >= 0);
         ArchiveIndex* archive = (ai == 0x0) ? archive_container->m_ArchiveIndex : ai;
+        archive->m_HashIndexOffset = 0; // the hash index is invalidated by the insertion
         uint8_t* hashes = (uint8_t*)((uintptr_t)archive + JAVA_TO_C(archive->m_HashOffset));
         EntryData* entries = (EntryData*)((uintptr_t)archive + JAVA_TO_C(archive->m_EntryDataOffset));
 
@@ -625,6 +790,10 @@ namespace dmResourceArchive
 
         memcpy((void*)entries_shift_src, (void*)&entry, sizeof(EntryData));
         archive->m_EntryDataCount = C_TO_JAVA(JAVA_TO_C(archive->m_EntryDataCount) + 1);
+        if (ai == 0x0)
+        {
+            RebuildHashIndex(archive_container);
+        }
         return RESULT_OK;
     }
 
@@ -733,6 +902,18 @@ namespace dmResourceArchive
         archive_container->m_ArchiveIndex = new_index;
         // Since we store data sequentially when doing the deep-copy we want to access it in that fashion
         archive_container->m_IsMemMapped = mem_mapped;
+        RebuildHashIndex(archive_container);
+    }
+
+    static inline void CopyEntry(const EntryData* e, EntryData* entry)
+    {
+        if (entry != NULL)
+        {
+            entry->m_ResourceDataOffset = JAVA_TO_C(e->m_ResourceDataOffset);
+            entry->m_ResourceSize = JAVA_TO_C(e->m_ResourceSize);
+            entry->m_ResourceCompressedSize = JAVA_TO_C(e->m_ResourceCompressedSize);
+            entry->m_Flags = JAVA_TO_C(e->m_Flags);
+        }
     }
 
     Result FindEntry(HArchiveIndexContainer archive, const uint8_t* hash, EntryData* entry)
@@ -756,6 +937,33 @@ namespace dmResourceArchive
             entries = (EntryData*)((uintptr_t)archive->m_ArchiveIndex + entry_offset);
         }
 
+        const uint32_t* hash_index = archive->m_HashIndex;
+        uint32_t bucket_count = hash_index ? JAVA_TO_C(hash_index[0]) : 0;
+        uint32_t mask = bucket_count - 1;
+        if (bucket_count != 0 && (bucket_count & mask) == 0)
+        {
+            const uint32_t* buckets = hash_index + 1;
+            uint64_t key = GetHashIndexKey(hash);
+            uint32_t tag = C_TO_JAVA((uint32_t)(key >> 32));
+            uint32_t bucket = (uint32_t)key & mask;
+            for (uint32_t i = 0; i < bucket_count; ++i)
+            {
+                uint32_t index = JAVA_TO_C(buckets[bucket * 2 + 1]);
+                if (index == 0)
+                {
+                    break;
+                }
+                --index;
+                if (buckets[bucket * 2 + 0] == tag && index < entry_count && memcmp(hash, hashes + DMRESOURCE_MAX_HASH * index, hash_len) == 0)
+                {
+                    CopyEntry(&entries[index], entry);
+                    return RESULT_OK;
+                }
+                bucket = (bucket + 1) & mask;
+            }
+            return RESULT_NOT_FOUND;
+        }
+
         // Search for hash with binary search (entries are sorted on hash)
         int first = 0;
         int last = (int)entry_count-1;
@@ -767,15 +975,7 @@ namespace dmResourceArchive
             int cmp = memcmp(hash, h, hash_len);
             if (cmp == 0)
             {
-                if (entry != NULL)
-                {
-                    EntryData* e = &entries[mid];
-                    entry->m_ResourceDataOffset = JAVA_TO_C(e->m_ResourceDataOffset);
-                    entry->m_ResourceSize = JAVA_TO_C(e->m_ResourceSize);
-                    entry->m_ResourceCompressedSize = JAVA_TO_C(e->m_ResourceCompressedSize);
-                    entry->m_Flags = JAVA_TO_C(e->m_Flags);
-                }
-
+                CopyEntry(&entries[mid], entry);
                 return RESULT_OK;
             }
             else if (cmp > 0)
@@ -931,6 +1131,80 @@ namespace dmResourceArchive
         }
     }
 
+    uint32_t GetStoredSize(const EntryData* entry_data)
+    {
+        uint32_t compressed_size = entry_data->m_ResourceCompressedSize;
+        return (compressed_size != 0xFFFFFFFF) ? compressed_size : entry_data->m_ResourceSize;
+    }
+
+    Result ReadStored(HArchiveIndexContainer archive, const EntryData* entry_data, void* buffer)
+    {
+        uint32_t stored_size = GetStoredSize(entry_data);
+
+        bool loaded_with_liveupdate = (entry_data->m_Flags & ENTRY_FLAG_LIVEUPDATE_DATA);
+        bool resource_memmapped = loaded_with_liveupdate ? archive->m_LiveUpdateResourcesMemMapped : archive->m_ResourcesMemMapped;
+
+        if (!resource_memmapped)
+        {
+            FILE* resource_file = loaded_with_liveupdate ? archive->m_LiveUpdateFileResourceData : archive->m_FileResourceData;
+
+            fseek(resource_file, entry_data->m_ResourceDataOffset, SEEK_SET);
+            if (fread(buffer, 1, stored_size, resource_file) != stored_size)
+            {
+                return RESULT_IO_ERROR;
+            }
+        }
+        else
+        {
+            const void* data = loaded_with_liveupdate ? archive->m_LiveUpdateResourceData : archive->m_ResourceData;
+            memcpy(buffer, (const void*) ((uintptr_t) data + entry_data->m_ResourceDataOffset), stored_size);
+        }
+        return RESULT_OK;
+    }
+
+    Result DecodeStored(const EntryData* entry_data, void* stored, void* buffer)
+    {
+        uint32_t size = entry_data->m_ResourceSize;
+        uint32_t compressed_size = entry_data->m_ResourceCompressedSize;
+
+        if (entry_data->m_Flags & ENTRY_FLAG_ENCRYPTED)
+        {
+            dmCrypt::Result cr = dmCrypt::Decrypt(dmCrypt::ALGORITHM_XTEA, (uint8_t*) stored, GetStoredSize(entry_data), (const uint8_t*) KEY, strlen(KEY));
+            if (cr != dmCrypt::RESULT_OK)
+            {
+                return RESULT_UNKNOWN;
+            }
+        }
+
+        if (compressed_size != 0xFFFFFFFF)
+        {
+            dmLZ4::Result r = dmLZ4::DecompressBufferFast(stored, compressed_size, buffer, size);
+            return (r == dmLZ4::RESULT_OK) ? RESULT_OK : RESULT_OUTBUFFER_TOO_SMALL;
+        }
+
+        if (stored != buffer)
+        {
+            memcpy(buffer, stored, size);
+        }
+        return RESULT_OK;
+    }
+
+    Result GetMappedData(HArchiveIndexContainer archive, const EntryData* entry_data, const void** data)
+    {
+        // Liveupdate data is remapped when new resources are stored, so only the bundled data can be borrowed
+        bool can_map = archive->m_ResourcesMemMapped &&
+                       (entry_data->m_Flags & (ENTRY_FLAG_ENCRYPTED | ENTRY_FLAG_LIVEUPDATE_DATA)) == 0 &&
+                       entry_data->m_ResourceCompressedSize == 0xFFFFFFFF;
+        if (!can_map)
+        {
+            *data = 0;
+            return RESULT_NOT_FOUND;
+        }
+
+        *data = (const void*) ((uintptr_t) archive->m_ResourceData + entry_data->m_ResourceDataOffset);
+        return RESULT_OK;
+    }
+
     uint32_t GetEntryCount(HArchiveIndexContainer archive)
     {
         return JAVA_TO_C(archive->m_ArchiveIndex->m_EntryDataCount);
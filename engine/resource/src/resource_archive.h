@@ -93,8 +93,8 @@ namespace dmResourceArchive
     };
 
     /**
-     * Wrap an archive index and data file already loaded in memory. Calling Delete() on wrapped
-     * archive is not needed.
+     * Wrap an archive index and data file already loaded in memory. The hash index stored in the
+     * archive index is used if it fits within index_buffer_size, otherwise one is built in memory.
      * @param index_buffer archive index memory to wrap
      * @param index_buffer_size archive index size
      * @param resource_data resource data
@@ -102,7 +102,7 @@ namespace dmResourceArchive
      * @param archive archive index container handle
      * @return RESULT_OK on success
      */
-    Result WrapArchiveBuffer(const void* index_buffer, const void* resource_data, const char* lu_resource_filename, const void* lu_resource_data, FILE* f_lu_resource_data, HArchiveIndexContainer* archive);
+    Result WrapArchiveBuffer(const void* index_buffer, uint32_t index_buffer_size, const void* resource_data, const char* lu_resource_filename, const void* lu_resource_data, FILE* f_lu_resource_data, HArchiveIndexContainer* archive);
 
     /**
      * Load archive from filename. Only the index data is loaded into memory.
@@ -131,6 +131,44 @@ namespace dmResourceArchive
      */
     Result Read(HArchiveIndexContainer archive, EntryData* entry_data, void* buffer);
 
+    /**
+     * Get the size of the resource data as stored in the archive, i.e. compressed size if compressed
+     * @param entry_data entry data
+     * @return stored size in bytes
+     */
+    uint32_t GetStoredSize(const EntryData* entry_data);
+
+    /**
+     * Read resource data as stored in the archive, without decrypting or decompressing it.
+     * Use DecodeStored() to get the actual resource data. This allows the decoding to be done
+     * without access to the archive, e.g. on a loader thread.
+     * @param archive archive index handle
+     * @param entry_data entry data
+     * @param buffer buffer to load to. Must be at least GetStoredSize() bytes
+     * @return RESULT_OK on success
+     */
+    Result ReadStored(HArchiveIndexContainer archive, const EntryData* entry_data, void* buffer);
+
+    /**
+     * Decrypt and decompress resource data read with ReadStored()
+     * @param entry_data entry data
+     * @param stored stored data. Decrypted in place if the entry is encrypted
+     * @param buffer buffer to decode to. Must be at least m_ResourceSize bytes. May be the same as stored if the entry is uncompressed
+     * @return RESULT_OK on success
+     */
+    Result DecodeStored(const EntryData* entry_data, void* stored, void* buffer);
+
+    /**
+     * Get a pointer to the resource data in a memory mapped archive, without copying it.
+     * Only possible for uncompressed and unencrypted entries in the bundled archive data.
+     * The data is read-only and stays valid until the archive is deleted (i.e. unmounted)
+     * @param archive archive index handle
+     * @param entry_data entry data
+     * @param data pointer to the resource data, or 0 if the entry can't be mapped
+     * @return RESULT_OK on success, RESULT_NOT_FOUND if the data must be read with Read()
+     */
+    Result GetMappedData(HArchiveIndexContainer archive, const EntryData* entry_data, const void** data);
+
     /**
      * Delete archive index. Only required for archives created with LoadArchive function
      * @param archive archive index handle
@@ -38,7 +38,7 @@ namespace dmResourceArchive
         }
 
         uint32_t m_Version;
-        uint32_t m_Pad;
+        uint32_t m_HashIndexOffset; // 0 if the archive has no hash index (see FindEntry)
         uint64_t m_Userdata;
         uint32_t m_EntryDataCount;
         uint32_t m_EntryDataOffset;
@@ -58,10 +58,12 @@ namespace dmResourceArchive
         bool m_IsMemMapped;
         bool m_ResourcesMemMapped;
         bool m_LiveUpdateResourcesMemMapped;
+        bool m_HashIndexMemMapped; // m_HashIndex points into the mem-mapped index and isn't owned
 
         /// Used if the archive is loaded from file (bundled archive)
         uint8_t* m_Hashes;
         EntryData* m_Entries;
+        uint32_t* m_HashIndex; // hash index used by FindEntry, 0 to use binary search
         uint8_t* m_ResourceData; // mem-mapped game.arcd
         FILE* m_FileResourceData; // game.arcd file handle
 
@@ -108,5 +110,11 @@ namespace dmResourceArchive
 
     void Delete(ArchiveIndex* archive);
 
+    /// Number of uint32_t words needed to store a hash index for entry_count entries
+    uint32_t GetHashIndexSize(uint32_t entry_count);
+
+    /// Builds the hash index for a sorted, DMRESOURCE_MAX_HASH strided, hash array. Same layout as written by the archive builder.
+    void BuildHashIndex(const uint8_t* hashes, uint32_t entry_count, uint32_t* hash_index);
+
 }
 #endif // RESOURCE_ARCHIVE_PRIVATE_H
\ No newline at end of file
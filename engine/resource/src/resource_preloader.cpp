@@ -98,8 +98,10 @@ namespace dmResource
         dmLoadQueue::HRequest m_LoadRequest;
 
         // Set for items that are pending and waiting for children to complete
-        void* m_Buffer;
+        const void* m_Buffer;
         uint32_t m_BufferSize;
+        // The buffer points into a memory mapped archive and isn't owned by the request
+        bool m_IsBufferMapped;
 
         // Set once preload function has run
         void* m_PreloadData;
@@ -233,6 +235,16 @@ namespace dmResource
         return 0;
     }
 
+    static dmLoadQueue::Priority GetLoadPriority(const SResourceType* resource_type)
+    {
+        switch (resource_type->m_LoadPriority)
+        {
+            case LOAD_PRIORITY_HIGH: return dmLoadQueue::PRIORITY_HIGH;
+            case LOAD_PRIORITY_LOW:  return dmLoadQueue::PRIORITY_LOW;
+            default:                 return dmLoadQueue::PRIORITY_NORMAL;
+        }
+    }
+
     Result MakePathDescriptor(ResourcePreloader* preloader, const char* name, PathDescriptor& out_path_descriptor)
     {
         if (name == 0x0)
@@ -511,7 +523,7 @@ namespace dmResource
     //   2) Having failed, (or created and destroyed), leaving => RESULT_SOME_ERROR + everything free:d
     //
     // If buffer is null it means to use the items internal buffer
-    static void CreateResource(HPreloader preloader, PreloadRequest* req, void* buffer, uint32_t buffer_size)
+    static void CreateResource(HPreloader preloader, PreloadRequest* req, const void* buffer, uint32_t buffer_size, bool buffer_mapped)
     {
         assert(req->m_LoadResult == RESULT_PENDING);
         assert(req->m_PendingChildCount == 0);
@@ -541,19 +553,26 @@ namespace dmResource
             tmp_resource.m_ResourceSizeOnDisc = req->m_BufferSize;
             params.m_Buffer                   = req->m_Buffer;
             params.m_BufferSize               = req->m_BufferSize;
+            params.m_IsBufferMapped           = req->m_IsBufferMapped;
             req->m_LoadResult                 = resource_type->m_CreateFunction(params);
 
-            dmBlockAllocator::Free(preloader->m_BlockAllocator, req->m_Buffer, req->m_BufferSize);
+            if (!req->m_IsBufferMapped)
+            {
+                dmBlockAllocator::Free(preloader->m_BlockAllocator, (void*)req->m_Buffer, req->m_BufferSize);
+            }
 
-            req->m_Buffer = 0;
+            req->m_Buffer         = 0;
+            req->m_IsBufferMapped = false;
         }
         else
         {
             tmp_resource.m_ResourceSizeOnDisc = buffer_size;
             params.m_Buffer                   = buffer;
             params.m_BufferSize               = buffer_size;
+            params.m_IsBufferMapped           = buffer_mapped;
             req->m_LoadResult                 = resource_type->m_CreateFunction(params);
         }
+        tmp_resource.m_BufferMapped = params.m_IsBufferMapped;
 
         if (req->m_LoadResult == RESULT_OK)
         {
@@ -680,7 +699,7 @@ namespace dmResource
         {
             return false;
         }
-        CreateResource(preloader, parent_req, 0, 0);
+        CreateResource(preloader, parent_req, 0, 0, false);
         UnmarkPathInProgress(preloader, &parent_req->m_PathDescriptor);
         PreloaderTryPruneParent(preloader, parent_req);
         return true;
@@ -691,7 +710,7 @@ namespace dmResource
     // copy the loaded buffer for later use when all the children has been created.
     //
     // Returns true if the resource was created
-    static bool FinishLoad(HPreloader preloader, PreloadRequest* req, dmLoadQueue::LoadResult& load_result, void* buffer, uint32_t buffer_size)
+    static bool FinishLoad(HPreloader preloader, PreloadRequest* req, dmLoadQueue::LoadResult& load_result, const void* buffer, uint32_t buffer_size)
     {
         // Pop any hints the load/preload of the item that may have been generated
         PopHints(preloader);
@@ -723,7 +742,7 @@ namespace dmResource
             if (req->m_LoadResult == RESULT_PENDING)
             {
                 // Create the resource using the loading buffer directly.
-                CreateResource(preloader, req, buffer, buffer_size);
+                CreateResource(preloader, req, buffer, buffer_size, load_result.m_IsBufferMapped);
                 created_resource = true;
             }
             UnmarkPathInProgress(preloader, &req->m_PathDescriptor);
@@ -734,10 +753,20 @@ namespace dmResource
         }
         else
         {
-            // Keep the loaded bytes until we have loaded all children
-            req->m_Buffer = dmBlockAllocator::Allocate(preloader->m_BlockAllocator, buffer_size);
-            memcpy(req->m_Buffer, buffer, buffer_size);
-            req->m_BufferSize = buffer_size;
+            // Keep the loaded bytes until we have loaded all children. Data in a memory mapped archive
+            // stays valid, so there is no need to copy it
+            if (load_result.m_IsBufferMapped)
+            {
+                req->m_Buffer = buffer;
+            }
+            else
+            {
+                void* copy = dmBlockAllocator::Allocate(preloader->m_BlockAllocator, buffer_size);
+                memcpy(copy, buffer, buffer_size);
+                req->m_Buffer = copy;
+            }
+            req->m_BufferSize     = buffer_size;
+            req->m_IsBufferMapped = load_result.m_IsBufferMapped;
             dmLoadQueue::FreeLoad(preloader->m_LoadQueue, req->m_LoadRequest);
             req->m_LoadRequest = 0;
         }
@@ -797,7 +826,7 @@ namespace dmResource
         // If loading it must finish first before trying to go down to children
         if (req->m_LoadRequest)
         {
-            void* buffer;
+            const void* buffer;
             uint32_t buffer_size;
 
             // Can hold the buffer till we FreeLoad it
@@ -859,10 +888,11 @@ namespace dmResource
         info.m_HintInfo.m_Parent    = index;
         info.m_Function             = req->m_PathDescriptor.m_ResourceType->m_PreloadFunction;
         info.m_Context              = req->m_PathDescriptor.m_ResourceType->m_Context;
+        info.m_ThreadSafe           = req->m_PathDescriptor.m_ResourceType->m_PreloadThreadSafe;
 
         // If we can't add the request to the load queue it is because the queue is full
         // We will try again once we completed loading of an item via dmLoadQueue::EndLoad
-        if ((req->m_LoadRequest = dmLoadQueue::BeginLoad(preloader->m_LoadQueue, req->m_PathDescriptor.m_InternalizedName, req->m_PathDescriptor.m_InternalizedCanonicalPath, &info)))
+        if ((req->m_LoadRequest = dmLoadQueue::BeginLoad(preloader->m_LoadQueue, req->m_PathDescriptor.m_InternalizedName, req->m_PathDescriptor.m_InternalizedCanonicalPath, &info, GetLoadPriority(req->m_PathDescriptor.m_ResourceType))))
         {
             MarkPathInProgress(preloader, &req->m_PathDescriptor);
             return true;
@@ -40,6 +40,10 @@ namespace dmResource
         FResourcePostCreate m_PostCreateFunction;
         FResourceDestroy    m_DestroyFunction;
         FResourceRecreate   m_RecreateFunction;
+        // If the preload function can be called concurrently, see SetPreloadThreadSafe
+        bool                m_PreloadThreadSafe;
+        // See SetLoadPriority
+        LoadPriority        m_LoadPriority;
     };
 
     typedef dmArray<char> LoadBufferType;
@@ -49,9 +53,23 @@ namespace dmResource
     Result CheckSuppliedResourcePath(const char* name);
 
     // load with default internal buffer and its management, returns buffer ptr in 'buffer'
-    Result LoadResource(HFactory factory, const char* path, const char* original_name, void** buffer, uint32_t* resource_size);
-    // load with own buffer
-    Result DoLoadResource(HFactory factory, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer);
+    // buffer_mapped is set if 'buffer' points into a memory mapped archive instead of the internal buffer
+    Result LoadResource(HFactory factory, const char* path, const char* original_name, const void** buffer, uint32_t* resource_size, bool* buffer_mapped);
+    // load with own buffer. If stored_buffer is set, archive entries are decrypted and decompressed
+    // after the load mutex is released, using stored_buffer as scratch memory for the compressed data
+    // If mapped_data is set, data that can be used directly from a memory mapped archive isn't copied to the buffer,
+    // mapped_data is then set to point to it (otherwise 0)
+    Result DoLoadResource(HFactory factory, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer, LoadBufferType* stored_buffer, const void** mapped_data);
+
+    struct LoadQueueParams
+    {
+        uint32_t m_ThreadCount;
+        uint32_t m_QueueSize;
+        uint32_t m_MaxPendingData;
+    };
+
+    // Settings for the threaded load queue used by the preloader
+    void GetLoadQueueParams(HFactory factory, LoadQueueParams* params);
 
     Result InsertResource(HFactory factory, const char* path, uint64_t canonical_path_hash, SResourceDescriptor* descriptor);
     uint32_t GetCanonicalPath(const char* relative_dir, char* buf);
@@ -12,6 +12,7 @@
 
 #include <dlib/log.h>
 
+#include <dlib/atomic.h>
 #include <dlib/dstrings.h>
 #include <dlib/hash.h>
 #include <dlib/log.h>
@@ -837,6 +838,82 @@ TEST_P(GetResourceTest, PreloadGetManyRefs)
 }
 
 
+TEST_P(GetResourceTest, PreloadGetLoadQueueParams)
+{
+    dmResource::DeleteFactory(m_Factory);
+
+    // Many loader threads competing for a single slot, and throttled after each load
+    dmResource::NewFactoryParams params;
+    params.m_MaxResources = 16;
+    params.m_LoadQueueThreadCount = 4;
+    params.m_LoadQueueSize = 1;
+    params.m_LoadQueueMaxPendingData = 1;
+    m_Factory = dmResource::NewFactory(&params, GetParam());
+    ASSERT_NE((void*) 0, m_Factory);
+
+    dmResource::Result e;
+    e = dmResource::RegisterType(m_Factory, "cont", this, &ResourceContainerPreload, &ResourceContainerCreate, 0, &ResourceContainerDestroy, 0);
+    ASSERT_EQ(dmResource::RESULT_OK, e);
+    e = dmResource::RegisterType(m_Factory, "foo", this, 0, &FooResourceCreate, &FooResourcePostCreate, &FooResourceDestroy, 0);
+    ASSERT_EQ(dmResource::RESULT_OK, e);
+
+    TestResourceContainer* resource = 0;
+    e = PreloaderGet(m_Factory, m_ResourceName, (void**) &resource);
+    ASSERT_EQ(dmResource::RESULT_OK, e);
+    ASSERT_NE((void*) 0, resource);
+    ASSERT_EQ((uint32_t) 1, m_ResourceContainerCreateCallCount);
+    ASSERT_EQ((uint32_t) resource->m_Resources.size(), m_FooResourceCreateCallCount);
+
+    dmResource::Release(m_Factory, resource);
+}
+
+static int32_atomic_t g_ActiveFooPreloads = 0;
+static int32_atomic_t g_OverlappingFooPreloads = 0;
+
+static dmResource::Result FooResourceSlowPreload(const dmResource::ResourcePreloadParams& params)
+{
+    if (dmAtomicIncrement32(&g_ActiveFooPreloads) != 0)
+    {
+        dmAtomicIncrement32(&g_OverlappingFooPreloads);
+    }
+    dmTime::Sleep(5000);
+    dmAtomicDecrement32(&g_ActiveFooPreloads);
+    return dmResource::RESULT_OK;
+}
+
+TEST_P(GetResourceTest, PreloadGetSerializedPreload)
+{
+    dmResource::DeleteFactory(m_Factory);
+
+    // Preload functions not flagged as thread safe are called one at a time, even with several loader threads
+    dmResource::NewFactoryParams params;
+    params.m_MaxResources = 16;
+    params.m_LoadQueueThreadCount = 4;
+    m_Factory = dmResource::NewFactory(&params, GetParam());
+    ASSERT_NE((void*) 0, m_Factory);
+
+    dmResource::Result e;
+    e = dmResource::RegisterType(m_Factory, "cont", this, &ResourceContainerPreload, &ResourceContainerCreate, 0, &ResourceContainerDestroy, 0);
+    ASSERT_EQ(dmResource::RESULT_OK, e);
+    e = dmResource::RegisterType(m_Factory, "foo", this, &FooResourceSlowPreload, &FooResourceCreate, &FooResourcePostCreate, &FooResourceDestroy, 0);
+    ASSERT_EQ(dmResource::RESULT_OK, e);
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::SetPreloadThreadSafe(m_Factory, "cont", true));
+    ASSERT_EQ(dmResource::RESULT_UNKNOWN_RESOURCE_TYPE, dmResource::SetPreloadThreadSafe(m_Factory, "bar", true));
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::SetLoadPriority(m_Factory, "cont", dmResource::LOAD_PRIORITY_HIGH));
+    ASSERT_EQ(dmResource::RESULT_OK, dmResource::SetLoadPriority(m_Factory, "foo", dmResource::LOAD_PRIORITY_LOW));
+    ASSERT_EQ(dmResource::RESULT_UNKNOWN_RESOURCE_TYPE, dmResource::SetLoadPriority(m_Factory, "bar", dmResource::LOAD_PRIORITY_LOW));
+
+    g_OverlappingFooPreloads = 0;
+    TestResourceContainer* resource = 0;
+    e = PreloaderGet(m_Factory, m_ResourceName, (void**) &resource);
+    ASSERT_EQ(dmResource::RESULT_OK, e);
+    ASSERT_NE((void*) 0, resource);
+    ASSERT_EQ((uint32_t) resource->m_Resources.size(), m_FooResourceCreateCallCount);
+    ASSERT_EQ(0, g_OverlappingFooPreloads);
+
+    dmResource::Release(m_Factory, resource);
+}
+
 TEST_P(GetResourceTest, PreloadGetAbort)
 {
     // Must not leak or crash
@@ -968,6 +1045,52 @@ TEST(dmResource, Builtins)
     dmResource::DeleteFactory(factory);
 }
 
+static dmResource::Result MappedAdResourceCreate(const dmResource::ResourceCreateParams& params)
+{
+    // The builtins archive is wrapped in memory, so the create function gets the data in place
+    const uint8_t* buffer = (const uint8_t*) params.m_Buffer;
+    bool in_archive = buffer >= RESOURCES_ARCD && buffer + params.m_BufferSize <= RESOURCES_ARCD + RESOURCES_ARCD_SIZE;
+    if (!params.m_IsBufferMapped || !in_archive)
+    {
+        return dmResource::RESULT_INVALID_DATA;
+    }
+    params.m_Resource->m_Resource = (void*) params.m_Buffer;
+    return dmResource::RESULT_OK;
+}
+
+static dmResource::Result MappedAdResourceDestroy(const dmResource::ResourceDestroyParams& params)
+{
+    return dmResource::RESULT_OK;
+}
+
+TEST(dmResource, BuiltinsMapped)
+{
+    dmResource::NewFactoryParams params;
+    params.m_MaxResources = 16;
+
+    params.m_ArchiveIndex.m_Data    = (const void*) RESOURCES_ARCI;
+    params.m_ArchiveIndex.m_Size    = RESOURCES_ARCI_SIZE;
+
+    params.m_ArchiveData.m_Data     = (const void*) RESOURCES_ARCD;
+    params.m_ArchiveData.m_Size     = RESOURCES_ARCD_SIZE;
+
+    params.m_ArchiveManifest.m_Data = (const void*) RESOURCES_DMANIFEST;
+    params.m_ArchiveManifest.m_Size = RESOURCES_DMANIFEST_SIZE;
+
+    dmResource::HFactory factory = dmResource::NewFactory(&params, ".");
+    ASSERT_NE((void*) 0, factory);
+
+    dmResource::RegisterType(factory, "adc", 0, 0, MappedAdResourceCreate, 0, MappedAdResourceDestroy, 0);
+
+    void* resource;
+    dmResource::Result result = dmResource::Get(factory, "/archive_data/file3.adc", &resource);
+    ASSERT_EQ(dmResource::RESULT_OK, result);
+    ASSERT_EQ(0, memcmp("file3_data", resource, 10));
+    dmResource::Release(factory, resource);
+
+    dmResource::DeleteFactory(factory);
+}
+
 struct ReloadData {
     ReloadData(): m_Old(0), m_New(0) {}
     int m_Old;
@@ -1391,7 +1514,7 @@ TEST_F(ResourceTest, ManifestBundledResourcesVerification)
     ASSERT_EQ(dmResource::RESULT_OK, result);
 
     dmResourceArchive::ArchiveIndexContainer* archive = 0;
-    dmResourceArchive::Result r = dmResourceArchive::WrapArchiveBuffer(RESOURCES_ARCI, RESOURCES_ARCD, 0x0, 0x0, 0x0, &archive);
+    dmResourceArchive::Result r = dmResourceArchive::WrapArchiveBuffer(RESOURCES_ARCI, RESOURCES_ARCI_SIZE, RESOURCES_ARCD, 0x0, 0x0, 0x0, &archive);
     ASSERT_EQ(dmResourceArchive::RESULT_OK, r);
 
     result = dmResource::VerifyResourcesBundled(manifest->m_DDFData->m_Resources.m_Data, manifest->m_DDFData->m_Resources.m_Count, archive);
@@ -1410,7 +1533,7 @@ TEST_F(ResourceTest, ManifestBundledResourcesVerificationFail)
     ASSERT_EQ(dmResource::RESULT_OK, result);
 
     dmResourceArchive::ArchiveIndexContainer* archive = 0;
-    dmResourceArchive::Result r = dmResourceArchive::WrapArchiveBuffer(RESOURCES_ARCI, RESOURCES_ARCD, 0x0, 0x0, 0x0, &archive);
+    dmResourceArchive::Result r = dmResourceArchive::WrapArchiveBuffer(RESOURCES_ARCI, RESOURCES_ARCI_SIZE, RESOURCES_ARCD, 0x0, 0x0, 0x0, &archive);
     ASSERT_EQ(dmResourceArchive::RESULT_OK, r);
 
     // Deep-copy current manifest resource entries with space for an extra resource entry
@@ -11,9 +11,12 @@
 // specific language governing permissions and limitations under the License.
 
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include "../resource.h"
 #include "../resource_archive_private.h"
 #include <dlib/dstrings.h>
+#include <dlib/time.h>
 
 // TODO: replace with dmEndian
 #if defined(_WIN32)
@@ -100,6 +103,11 @@ static const uint8_t compressed_content_hash[][20] = {
 
 static const uint32_t ENTRY_SIZE = sizeof(dmResourceArchive::EntryData) + DMRESOURCE_MAX_HASH;
 
+static int CompareHash(const void* a, const void* b)
+{
+    return memcmp(a, b, DMRESOURCE_MAX_HASH);
+}
+
 
 static const char* MakeHostPath(char* dst, uint32_t dst_len, const char* path)
 {
@@ -149,7 +157,7 @@ void GetMutableBundledIndexData(void*& arci_data, uint32_t& arci_size, uint32_t
     arci_data = malloc(RESOURCES_ARCI_SIZE - ENTRY_SIZE * num_lu_entries);
     // Init archive container including LU resources
     dmResourceArchive::ArchiveIndexContainer* archive = 0;
-    dmResourceArchive::Result result = dmResourceArchive::WrapArchiveBuffer(RESOURCES_ARCI, RESOURCES_ARCD, 0x0, 0x0, 0x0, &archive);
+    dmResourceArchive::Result result = dmResourceArchive::WrapArchiveBuffer(RESOURCES_ARCI, RESOURCES_ARCI_SIZE, RESOURCES_ARCD, 0x0, 0x0, 0x0, &archive);
     ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
 
     uint32_t entry_count = JAVA_TO_C(archive->m_ArchiveIndex->m_EntryDataCount);
@@ -185,6 +193,7 @@ void GetMutableBundledIndexData(void*& arci_data, uint32_t& arci_size, uint32_t
     dmResourceArchive::ArchiveIndex* ai = (dmResourceArchive::ArchiveIndex*)arci_data;
     ai->m_EntryDataOffset = C_TO_JAVA(entries_offset - num_lu_entries * DMRESOURCE_MAX_HASH);
     ai->m_EntryDataCount = C_TO_JAVA(entry_count - num_lu_entries);
+    ai->m_HashIndexOffset = 0; // The hash index isn't copied
 
     arci_size = sizeof(dmResourceArchive::ArchiveIndex) + JAVA_TO_C(ai->m_EntryDataCount) * (ENTRY_SIZE);
 
@@ -214,7 +223,7 @@ void CreateBundledArchive(dmResourceArchive::HArchiveIndexContainer& bundled_arc
     bundled_archive_index = 0;
     uint32_t bundled_archive_size = 0;
     GetMutableBundledIndexData((void*&)bundled_archive_index, bundled_archive_size, num_entries_to_keep);
-    dmResourceArchive::Result result = dmResourceArchive::WrapArchiveBuffer((void*&) bundled_archive_index, RESOURCES_ARCD, 0x0, 0x0, 0x0, &bundled_archive_container);
+    dmResourceArchive::Result result = dmResourceArchive::WrapArchiveBuffer((void*&) bundled_archive_index, bundled_archive_size, RESOURCES_ARCD, 0x0, 0x0, 0x0, &bundled_archive_container);
     ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
     ASSERT_EQ(5U + num_entries_to_keep, dmResourceArchive::GetEntryCount(bundled_archive_container));
 }
@@ -246,7 +255,7 @@ TEST(dmResourceArchive, ShiftInsertResource)
 
     // Init archive container
     dmResourceArchive::HArchiveIndexContainer archive = 0;
-    dmResourceArchive::Result result = dmResourceArchive::WrapArchiveBuffer((void*) arci_copy, RESOURCES_ARCD, resource_filename, 0x0, resource_file, &archive);
+    dmResourceArchive::Result result = dmResourceArchive::WrapArchiveBuffer((void*) arci_copy, RESOURCES_ARCI_SIZE, RESOURCES_ARCD, resource_filename, 0x0, resource_file, &archive);
     ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
     uint32_t entry_count_before = dmResourceArchive::GetEntryCount(archive);
     ASSERT_EQ(7U, entry_count_before);
@@ -278,7 +287,7 @@ TEST(dmResourceArchive, NewArchiveIndexFromCopy)
     uint32_t single_entry_offset = DMRESOURCE_MAX_HASH;
 
     dmResourceArchive::HArchiveIndexContainer archive_container = 0;
-    dmResourceArchive::Result result = dmResourceArchive::WrapArchiveBuffer((void*) RESOURCES_ARCI, RESOURCES_ARCD, 0x0, 0x0, 0x0, &archive_container);
+    dmResourceArchive::Result result = dmResourceArchive::WrapArchiveBuffer((void*) RESOURCES_ARCI, RESOURCES_ARCI_SIZE, RESOURCES_ARCD, 0x0, 0x0, 0x0, &archive_container);
     ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
     ASSERT_EQ(496U, dmResourceArchive::GetEntryDataOffset(archive_container));
 
@@ -303,7 +312,7 @@ TEST(dmResourceArchive, CacheLiveUpdateEntries)
     dmResourceArchive::ArchiveIndex* bundled_archive_index;
 
     dmResourceArchive::HArchiveIndexContainer archive_container = 0;
-    dmResourceArchive::Result result = dmResourceArchive::WrapArchiveBuffer((void*) RESOURCES_ARCI, RESOURCES_ARCD, 0x0, 0x0, 0x0, &archive_container);
+    dmResourceArchive::Result result = dmResourceArchive::WrapArchiveBuffer((void*) RESOURCES_ARCI, RESOURCES_ARCI_SIZE, RESOURCES_ARCD, 0x0, 0x0, 0x0, &archive_container);
     ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
     ASSERT_EQ(7U, dmResourceArchive::GetEntryCount(archive_container));
 
@@ -329,7 +338,7 @@ TEST(dmResourceArchive, CacheLiveUpdateEntries)
 TEST(dmResourceArchive, GetInsertionIndex)
 {
     dmResourceArchive::HArchiveIndexContainer archive = 0;
-    dmResourceArchive::Result result = dmResourceArchive::WrapArchiveBuffer((void*) RESOURCES_ARCI, RESOURCES_ARCD, 0x0, 0x0, 0x0, &archive);
+    dmResourceArchive::Result result = dmResourceArchive::WrapArchiveBuffer((void*) RESOURCES_ARCI, RESOURCES_ARCI_SIZE, RESOURCES_ARCD, 0x0, 0x0, 0x0, &archive);
     ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
     ASSERT_EQ(7U, dmResourceArchive::GetEntryCount(archive));
 
@@ -614,7 +623,7 @@ TEST(dmResourceArchive, ResourceEntries_Compressed)
 TEST(dmResourceArchive, Wrap)
 {
     dmResourceArchive::HArchiveIndexContainer archive = 0;
-    dmResourceArchive::Result result = dmResourceArchive::WrapArchiveBuffer((void*) RESOURCES_ARCI, RESOURCES_ARCD, 0x0, 0x0, 0x0, &archive);
+    dmResourceArchive::Result result = dmResourceArchive::WrapArchiveBuffer((void*) RESOURCES_ARCI, RESOURCES_ARCI_SIZE, RESOURCES_ARCD, 0x0, 0x0, 0x0, &archive);
     ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
     ASSERT_EQ(7U, dmResourceArchive::GetEntryCount(archive));
 
@@ -644,7 +653,7 @@ TEST(dmResourceArchive, Wrap)
 TEST(dmResourceArchive, Wrap_Compressed)
 {
     dmResourceArchive::HArchiveIndexContainer archive = 0;
-    dmResourceArchive::Result result = dmResourceArchive::WrapArchiveBuffer((void*) RESOURCES_COMPRESSED_ARCI, (void*) RESOURCES_COMPRESSED_ARCD, 0x0, 0x0, 0x0, &archive);
+    dmResourceArchive::Result result = dmResourceArchive::WrapArchiveBuffer((void*) RESOURCES_COMPRESSED_ARCI, RESOURCES_COMPRESSED_ARCI_SIZE, (void*) RESOURCES_COMPRESSED_ARCD, 0x0, 0x0, 0x0, &archive);
     ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
     ASSERT_EQ(7U, dmResourceArchive::GetEntryCount(archive));
 
@@ -671,6 +680,218 @@ TEST(dmResourceArchive, Wrap_Compressed)
     dmResourceArchive::Delete(archive);
 }
 
+TEST(dmResourceArchive, GetMappedData)
+{
+    dmResourceArchive::HArchiveIndexContainer archive = 0;
+    dmResourceArchive::Result result = dmResourceArchive::WrapArchiveBuffer((void*) RESOURCES_ARCI, RESOURCES_ARCI_SIZE, RESOURCES_ARCD, 0x0, 0x0, 0x0, &archive);
+    ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
+
+    uint32_t mapped_count = 0;
+    dmResourceArchive::EntryData entry;
+    for (uint32_t i = 0; i < (sizeof(path_hash) / sizeof(path_hash[0])); ++i)
+    {
+        if (IsLiveUpdateResource(path_hash[i])) continue;
+
+        result = dmResourceArchive::FindEntry(archive, content_hash[i], &entry);
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
+
+        const void* data = 0;
+        result = dmResourceArchive::GetMappedData(archive, &entry, &data);
+        if (entry.m_Flags & dmResourceArchive::ENTRY_FLAG_ENCRYPTED)
+        {
+            ASSERT_EQ(dmResourceArchive::RESULT_NOT_FOUND, result);
+            ASSERT_EQ((const void*) 0, data);
+            continue;
+        }
+
+        // Uncompressed data is used in place, without copying
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
+        ASSERT_EQ((const void*) (RESOURCES_ARCD + entry.m_ResourceDataOffset), data);
+        ASSERT_EQ(strlen(content[i]), entry.m_ResourceSize);
+        ASSERT_EQ(0, memcmp(content[i], data, entry.m_ResourceSize));
+        ++mapped_count;
+    }
+    ASSERT_LT(0U, mapped_count);
+
+    dmResourceArchive::Delete(archive);
+
+    // Archives loaded from file aren't mapped
+    const char* archive_path = MOUNTFS "build/default/src/test/resources.arci";
+    const char* resource_path = MOUNTFS "build/default/src/test/resources.arcd";
+    result = dmResourceArchive::LoadArchive(archive_path, resource_path, 0x0, &archive);
+    ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
+
+    result = dmResourceArchive::FindEntry(archive, content_hash[0], &entry);
+    ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
+    const void* data = 0;
+    ASSERT_EQ(dmResourceArchive::RESULT_NOT_FOUND, dmResourceArchive::GetMappedData(archive, &entry, &data));
+
+    dmResourceArchive::Delete(archive);
+}
+
+TEST(dmResourceArchive, HashIndex)
+{
+    // The archive builder writes a hash index that must match the one built at runtime
+    const dmResourceArchive::ArchiveIndex* ai = (const dmResourceArchive::ArchiveIndex*) RESOURCES_ARCI;
+    uint32_t hash_index_offset = JAVA_TO_C(ai->m_HashIndexOffset);
+    ASSERT_NE(0U, hash_index_offset);
+
+    uint32_t entry_count = JAVA_TO_C(ai->m_EntryDataCount);
+    uint32_t hash_index_size = dmResourceArchive::GetHashIndexSize(entry_count);
+    ASSERT_LE(hash_index_offset + hash_index_size * sizeof(uint32_t), RESOURCES_ARCI_SIZE);
+
+    uint32_t* hash_index = new uint32_t[hash_index_size];
+    dmResourceArchive::BuildHashIndex(RESOURCES_ARCI + JAVA_TO_C(ai->m_HashOffset), entry_count, hash_index);
+    ASSERT_EQ(0, memcmp(hash_index, RESOURCES_ARCI + hash_index_offset, hash_index_size * sizeof(uint32_t)));
+    delete[] hash_index;
+}
+
+// Archive index in memory with random hashes, with or without a hash index
+static uint8_t* CreateArchiveIndex(uint32_t entry_count, uint32_t hash_len, bool with_hash_index, uint32_t& size)
+{
+    uint32_t hash_offset = sizeof(dmResourceArchive::ArchiveIndex);
+    uint32_t entry_offset = hash_offset + entry_count * DMRESOURCE_MAX_HASH;
+    uint32_t hash_index_offset = entry_offset + entry_count * sizeof(dmResourceArchive::EntryData);
+    size = hash_index_offset + (with_hash_index ? dmResourceArchive::GetHashIndexSize(entry_count) * sizeof(uint32_t) : 0);
+
+    uint8_t* buffer = (uint8_t*) malloc(size);
+    memset(buffer, 0, size);
+
+    uint8_t* hashes = buffer + hash_offset;
+    uint32_t seed = 4711;
+    for (uint32_t i = 0; i < entry_count * DMRESOURCE_MAX_HASH; ++i)
+    {
+        seed = seed * 1664525 + 1013904223;
+        if ((i % DMRESOURCE_MAX_HASH) < hash_len)
+            hashes[i] = (uint8_t) (seed >> 24);
+    }
+    qsort(hashes, entry_count, DMRESOURCE_MAX_HASH, CompareHash);
+
+    dmResourceArchive::EntryData* entries = (dmResourceArchive::EntryData*) (buffer + entry_offset);
+    for (uint32_t i = 0; i < entry_count; ++i)
+    {
+        entries[i].m_ResourceDataOffset = C_TO_JAVA(i);
+        entries[i].m_ResourceSize = C_TO_JAVA(i);
+        entries[i].m_ResourceCompressedSize = C_TO_JAVA(0xFFFFFFFF);
+        entries[i].m_Flags = 0;
+    }
+
+    dmResourceArchive::ArchiveIndex* ai = (dmResourceArchive::ArchiveIndex*) buffer;
+    ai->m_Version = C_TO_JAVA(dmResourceArchive::VERSION);
+    ai->m_EntryDataCount = C_TO_JAVA(entry_count);
+    ai->m_EntryDataOffset = C_TO_JAVA(entry_offset);
+    ai->m_HashOffset = C_TO_JAVA(hash_offset);
+    ai->m_HashLength = C_TO_JAVA(hash_len);
+    if (with_hash_index)
+    {
+        ai->m_HashIndexOffset = C_TO_JAVA(hash_index_offset);
+        dmResourceArchive::BuildHashIndex(hashes, entry_count, (uint32_t*) (buffer + hash_index_offset));
+    }
+    return buffer;
+}
+
+TEST(dmResourceArchive, HashIndexBounds)
+{
+    const uint32_t entry_count = 1000;
+    uint32_t size = 0;
+    uint8_t* buffer = CreateArchiveIndex(entry_count, 20, true, size);
+    const uint8_t* hashes = buffer + sizeof(dmResourceArchive::ArchiveIndex);
+    dmResourceArchive::ArchiveIndex* ai = (dmResourceArchive::ArchiveIndex*) buffer;
+    uint32_t hash_index_offset = ai->m_HashIndexOffset;
+
+    // 0: valid, 1: truncated by the index size, 2: offset out of range, 3: unaligned offset, 4: wrong bucket count
+    for (int corruption = 0; corruption < 5; ++corruption)
+    {
+        ai->m_HashIndexOffset = hash_index_offset;
+        uint32_t wrap_size = size;
+        uint32_t bucket_count = ((uint32_t*) (buffer + JAVA_TO_C(hash_index_offset)))[0];
+        if (corruption == 1)
+            wrap_size -= sizeof(uint32_t);
+        else if (corruption == 2)
+            ai->m_HashIndexOffset = C_TO_JAVA(0xFFFFFFF0);
+        else if (corruption == 3)
+            ai->m_HashIndexOffset = C_TO_JAVA(JAVA_TO_C(hash_index_offset) + 1);
+        else if (corruption == 4)
+            ((uint32_t*) (buffer + JAVA_TO_C(hash_index_offset)))[0] = C_TO_JAVA(JAVA_TO_C(bucket_count) * 2);
+
+        dmResourceArchive::HArchiveIndexContainer archive = 0;
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, dmResourceArchive::WrapArchiveBuffer(buffer, wrap_size, RESOURCES_ARCD, 0x0, 0x0, 0x0, &archive));
+        ASSERT_EQ(corruption == 0, archive->m_HashIndexMemMapped);
+        ASSERT_NE((uint32_t*) 0, archive->m_HashIndex);
+
+        dmResourceArchive::EntryData entry;
+        for (uint32_t i = 0; i < entry_count; ++i)
+        {
+            ASSERT_EQ(dmResourceArchive::RESULT_OK, dmResourceArchive::FindEntry(archive, hashes + DMRESOURCE_MAX_HASH * i, &entry));
+            ASSERT_EQ(i, entry.m_ResourceDataOffset);
+        }
+        dmResourceArchive::Delete(archive);
+        ((uint32_t*) (buffer + JAVA_TO_C(hash_index_offset)))[0] = bucket_count;
+    }
+
+    // The entries themselves must fit within the index
+    dmResourceArchive::HArchiveIndexContainer archive = 0;
+    ASSERT_EQ(dmResourceArchive::RESULT_IO_ERROR, dmResourceArchive::WrapArchiveBuffer(buffer, JAVA_TO_C(ai->m_EntryDataOffset), RESOURCES_ARCD, 0x0, 0x0, 0x0, &archive));
+    ASSERT_EQ((dmResourceArchive::HArchiveIndexContainer) 0, archive);
+
+    free(buffer);
+}
+
+TEST(dmResourceArchive, BenchFindEntry)
+{
+    const uint32_t entry_count = 65536;
+    const uint32_t hash_len = 20;
+    const uint32_t lookup_count = 1000000;
+
+    // 0: binary search, 1: hash index built when wrapped, 2: hash index written with the archive
+    const char* mode_names[] = { "binary search", "built hash index", "mapped hash index" };
+    for (int mode = 0; mode < 3; ++mode)
+    {
+        uint32_t size = 0;
+        uint8_t* buffer = CreateArchiveIndex(entry_count, hash_len, mode == 2, size);
+        const uint8_t* hashes = buffer + sizeof(dmResourceArchive::ArchiveIndex);
+
+        dmResourceArchive::HArchiveIndexContainer archive = 0;
+        dmResourceArchive::Result result = dmResourceArchive::WrapArchiveBuffer(buffer, size, RESOURCES_ARCD, 0x0, 0x0, 0x0, &archive);
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
+        ASSERT_EQ(mode == 2, archive->m_HashIndexMemMapped);
+        if (mode == 0)
+        {
+            delete[] archive->m_HashIndex;
+            archive->m_HashIndex = 0;
+        }
+
+        dmResourceArchive::EntryData entry;
+        for (uint32_t i = 0; i < entry_count; ++i)
+        {
+            result = dmResourceArchive::FindEntry(archive, hashes + DMRESOURCE_MAX_HASH * i, &entry);
+            ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
+            ASSERT_EQ(i, entry.m_ResourceDataOffset);
+        }
+
+        uint8_t missing_hash[DMRESOURCE_MAX_HASH];
+        memcpy(missing_hash, hashes, DMRESOURCE_MAX_HASH);
+        missing_hash[hash_len - 1] ^= 0xFF;
+        ASSERT_EQ(dmResourceArchive::RESULT_NOT_FOUND, dmResourceArchive::FindEntry(archive, missing_hash, &entry));
+
+        uint32_t found = 0;
+        uint64_t start = dmTime::GetTime();
+        for (uint32_t i = 0; i < lookup_count; ++i)
+        {
+            uint32_t index = (i * 7919) % entry_count;
+            found += dmResourceArchive::FindEntry(archive, hashes + DMRESOURCE_MAX_HASH * index, &entry) == dmResourceArchive::RESULT_OK;
+        }
+        uint64_t end = dmTime::GetTime();
+        ASSERT_EQ(lookup_count, found);
+
+        double elapsed = (end - start) / 1000000.0;
+        printf("FindEntry (%s, %u entries): %.2f M lookups/s\n", mode_names[mode], entry_count, (lookup_count / elapsed) / 1000000.0);
+
+        dmResourceArchive::Delete(archive);
+        free(buffer);
+    }
+}
+
 TEST(dmResourceArchive, LoadFromDisk)
 {
     dmResourceArchive::HArchiveIndexContainer archive = 0;
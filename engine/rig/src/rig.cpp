@@ -15,6 +15,14 @@
 #include <dlib/log.h>
 #include <dlib/profile.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define DM_RIG_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define DM_RIG_NEON
+#endif
+
 namespace dmRig
 {
 
@@ -26,7 +34,11 @@ namespace dmRig
 
     static const float white[] = {1.0f, 1.0f, 1.0, 1.0f};
 
-    static void DoAnimate(HRigContext context, RigInstance* instance, float dt);
+    // Number of instances per job when animating and generating vertex data on the worker pool
+    static const uint32_t ANIMATE_BATCH_SIZE = 16;
+    static const uint32_t VERTEX_DATA_BATCH_SIZE = 8;
+
+    static void DoAnimate(RigScratch* scratch, RigInstance* instance, float dt);
     static bool DoPostUpdate(RigInstance* instance);
     static void UpdateSlotDrawOrder(dmArray<int32_t>& draw_order, dmArray<int32_t>& deltas, int changed, dmArray<int32_t>& unchanged);
 
@@ -39,8 +51,9 @@ namespace dmRig
         }
 
         context->m_Instances.SetCapacity(params.m_MaxRigInstanceCount);
-        context->m_ScratchPoseTransformBuffer.SetCapacity(0);
-        context->m_ScratchPoseMatrixBuffer.SetCapacity(0);
+        context->m_WorkerPool = params.m_WorkerPool;
+        context->m_Scratch.SetCapacity(1);
+        context->m_Scratch.Push(new RigScratch());
 
         return dmRig::RESULT_OK;
     }
@@ -48,10 +61,59 @@ namespace dmRig
     void DeleteContext(HRigContext context)
     {
         if (context) {
+            for (uint32_t i = 0; i < context->m_Scratch.Size(); ++i)
+            {
+                delete context->m_Scratch[i];
+            }
             delete context;
         }
     }
 
+    // Makes sure there is one scratch buffer set per batch, when the work is split over the worker pool
+    static void EnsureScratch(HRigContext context, uint32_t count, uint32_t batch_size)
+    {
+        uint32_t scratch_count = 1;
+        if (dmWorkerPool::GetWorkerCount(context->m_WorkerPool) > 0)
+        {
+            scratch_count = dmMath::Max(1u, (count + batch_size - 1) / batch_size);
+        }
+        dmArray<RigScratch*>& scratch = context->m_Scratch;
+        if (scratch.Capacity() < scratch_count)
+        {
+            scratch.OffsetCapacity(scratch_count - scratch.Capacity());
+        }
+        while (scratch.Size() < scratch_count)
+        {
+            scratch.Push(new RigScratch());
+        }
+    }
+
+    static void PushEvent(RigScratch* scratch, HRigInstance instance, RigEventType type, const void* event_data, uint32_t event_data_size)
+    {
+        dmArray<RigEvent>& events = scratch->m_Events;
+        if (events.Full())
+        {
+            events.OffsetCapacity(dmMath::Max(16u, events.Capacity()));
+        }
+        events.SetSize(events.Size() + 1);
+        RigEvent& event = events.Back();
+        event.m_Instance = instance;
+        event.m_Type = type;
+        memcpy(&event.m_Completed, event_data, event_data_size);
+    }
+
+    static void SendEvents(RigScratch* scratch)
+    {
+        dmArray<RigEvent>& events = scratch->m_Events;
+        for (uint32_t i = 0; i < events.Size(); ++i)
+        {
+            RigEvent& event = events[i];
+            HRigInstance instance = event.m_Instance;
+            instance->m_EventCallback(event.m_Type, (void*)&event.m_Completed, instance->m_EventCBUserData1, instance->m_EventCBUserData2);
+        }
+        events.SetSize(0);
+    }
+
     static const dmRigDDF::RigAnimation* FindAnimation(const dmRigDDF::AnimationSet* anim_set, dmhash_t animation_id)
     {
         if(anim_set == 0x0)
@@ -270,7 +332,7 @@ namespace dmRig
         return duration;
     }
 
-    static void PostEventsInterval(HRigInstance instance, const dmRigDDF::RigAnimation* animation, float start_cursor, float end_cursor, float duration, bool backwards, float blend_weight)
+    static void PostEventsInterval(RigScratch* scratch, HRigInstance instance, const dmRigDDF::RigAnimation* animation, float start_cursor, float end_cursor, float duration, bool backwards, float blend_weight)
     {
         const uint32_t track_count = animation->m_EventTracks.m_Count;
         for (uint32_t ti = 0; ti < track_count; ++ti)
@@ -294,13 +356,13 @@ namespace dmRig
                     event_data.m_Float = key->m_Float;
                     event_data.m_String = key->m_String;
 
-                    instance->m_EventCallback(RIG_EVENT_TYPE_KEYFRAME, (void*)&event_data, instance->m_EventCBUserData1, instance->m_EventCBUserData2);
+                    PushEvent(scratch, instance, RIG_EVENT_TYPE_KEYFRAME, &event_data, sizeof(event_data));
                 }
             }
         }
     }
 
-    static void PostEvents(HRigInstance instance, RigPlayer* player, const dmRigDDF::RigAnimation* animation, float dt, float prev_cursor, float duration, bool completed, float blend_weight)
+    static void PostEvents(RigScratch* scratch, HRigInstance instance, RigPlayer* player, const dmRigDDF::RigAnimation* animation, float dt, float prev_cursor, float duration, bool completed, float blend_weight)
     {
         float cursor = player->m_Cursor;
         // Since the intervals are defined as t0 <= t < t1, make sure we include the end of the animation, i.e. when t1 == duration
@@ -316,8 +378,8 @@ namespace dmRig
             {
                 prev_backwards = !player->m_Backwards;
             }
-            PostEventsInterval(instance, animation, prev_cursor, duration, duration, prev_backwards, blend_weight);
-            PostEventsInterval(instance, animation, 0.0f, cursor, duration, player->m_Backwards, blend_weight);
+            PostEventsInterval(scratch, instance, animation, prev_cursor, duration, duration, prev_backwards, blend_weight);
+            PostEventsInterval(scratch, instance, animation, 0.0f, cursor, duration, player->m_Backwards, blend_weight);
         }
         else
         {
@@ -328,22 +390,22 @@ namespace dmRig
                 // If the previous cursor was still in the forward direction, treat it as two distinct intervals: [start_cursor,half_duration) and [half_duration, end_cursor)
                 if (prev_cursor < half_duration)
                 {
-                    PostEventsInterval(instance, animation, prev_cursor, half_duration, duration, false, blend_weight);
-                    PostEventsInterval(instance, animation, half_duration, cursor, duration, true, blend_weight);
+                    PostEventsInterval(scratch, instance, animation, prev_cursor, half_duration, duration, false, blend_weight);
+                    PostEventsInterval(scratch, instance, animation, half_duration, cursor, duration, true, blend_weight);
                 }
                 else
                 {
-                    PostEventsInterval(instance, animation, prev_cursor, cursor, duration, true, blend_weight);
+                    PostEventsInterval(scratch, instance, animation, prev_cursor, cursor, duration, true, blend_weight);
                 }
             }
             else
             {
-                PostEventsInterval(instance, animation, prev_cursor, cursor, duration, player->m_Backwards, blend_weight);
+                PostEventsInterval(scratch, instance, animation, prev_cursor, cursor, duration, player->m_Backwards, blend_weight);
             }
         }
     }
 
-    static void UpdatePlayer(RigInstance* instance, RigPlayer* player, float dt, float blend_weight)
+    static void UpdatePlayer(RigScratch* scratch, RigInstance* instance, RigPlayer* player, float dt, float blend_weight)
     {
         const dmRigDDF::RigAnimation* animation = player->m_Animation;
         if (animation == 0x0 || !player->m_Playing)
@@ -396,7 +458,7 @@ namespace dmRig
 
         if (prev_cursor != player->m_Cursor && instance->m_EventCallback)
         {
-            PostEvents(instance, player, animation, dt, prev_cursor, duration, completed, blend_weight);
+            PostEvents(scratch, instance, player, animation, dt, prev_cursor, duration, completed, blend_weight);
         }
 
         if (completed)
@@ -409,7 +471,7 @@ namespace dmRig
                 event_data.m_AnimationId = player->m_AnimationId;
                 event_data.m_Playback = player->m_Playback;
 
-                instance->m_EventCallback(RIG_EVENT_TYPE_COMPLETED, (void*)&event_data, instance->m_EventCBUserData1, instance->m_EventCBUserData2);
+                PushEvent(scratch, instance, RIG_EVENT_TYPE_COMPLETED, &event_data, sizeof(event_data));
             }
         }
 
@@ -598,20 +660,44 @@ namespace dmRig
         }
     }
 
+    struct AnimateContext
+    {
+        HRigContext m_Context;
+        float       m_DT;
+    };
+
+    static void AnimateRange(void* _ctx, uint32_t begin, uint32_t end)
+    {
+        DM_PROFILE(Rig, "AnimateRange");
+        AnimateContext* ctx = (AnimateContext*) _ctx;
+        RigScratch* scratch = ctx->m_Context->m_Scratch[begin / ANIMATE_BATCH_SIZE];
+        const dmArray<RigInstance*>& instances = ctx->m_Context->m_Instances.m_Objects;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            DoAnimate(scratch, instances[i], ctx->m_DT);
+        }
+    }
+
     static void Animate(HRigContext context, float dt)
     {
         DM_PROFILE(Rig, "Animate");
 
-        const dmArray<RigInstance*>& instances = context->m_Instances.m_Objects;
-        uint32_t n = instances.Size();
-        for (uint32_t i = 0; i < n; ++i)
+        uint32_t n = context->m_Instances.m_Objects.Size();
+        EnsureScratch(context, n, ANIMATE_BATCH_SIZE);
+
+        AnimateContext ctx;
+        ctx.m_Context = context;
+        ctx.m_DT = dt;
+        dmWorkerPool::ParallelFor(context->m_WorkerPool, AnimateRange, &ctx, n, ANIMATE_BATCH_SIZE);
+
+        // The batches are in instance order, so the events are sent in the same order as when animating sequentially
+        for (uint32_t i = 0; i < context->m_Scratch.Size(); ++i)
         {
-            RigInstance* instance = instances[i];
-            DoAnimate(context, instance, dt);
+            SendEvents(context->m_Scratch[i]);
         }
     }
 
-    static void DoAnimate(HRigContext context, RigInstance* instance, float dt)
+    static void DoAnimate(RigScratch* scratch, RigInstance* instance, float dt)
     {
             // NOTE we previously checked for (!instance->m_Enabled || !instance->m_AddedToUpdate) here also
             if (instance->m_Pose.Empty() || !instance->m_Enabled)
@@ -650,15 +736,15 @@ namespace dmRig
             // Make sure we have enough space in the draw order deltas scratch buffer.
             uint32_t slot_count = instance->m_MeshSet->m_SlotCount;
             int slot_changed = 0;
-            if (context->m_ScratchDrawOrderDeltas.Capacity() < slot_count) {
-                context->m_ScratchDrawOrderDeltas.OffsetCapacity(slot_count - context->m_ScratchDrawOrderDeltas.Capacity());
+            if (scratch->m_DrawOrderDeltas.Capacity() < slot_count) {
+                scratch->m_DrawOrderDeltas.OffsetCapacity(slot_count - scratch->m_DrawOrderDeltas.Capacity());
             }
-            context->m_ScratchDrawOrderDeltas.SetSize(slot_count);
+            scratch->m_DrawOrderDeltas.SetSize(slot_count);
 
             // Reset draw order deltas to "unchanged" constant.
             for (uint32_t i = 0; i < slot_count; i++) {
                 instance->m_DrawOrder[i] = i;
-                context->m_ScratchDrawOrderDeltas[i] = SIGNAL_DELTA_UNCHANGED;
+                scratch->m_DrawOrderDeltas[i] = SIGNAL_DELTA_UNCHANGED;
             }
 
             if (instance->m_Blending)
@@ -683,9 +769,9 @@ namespace dmRig
                         ResetMeshSlotPose(instance);
                     }
 
-                    UpdatePlayer(instance, p, dt, blend_weight);
+                    UpdatePlayer(scratch, instance, p, dt, blend_weight);
                     bool draw_order = player == p ? fade_rate >= 0.5f : fade_rate < 0.5f;
-                    ApplyAnimation(p, pose, track_idx_to_pose, ik_animation, instance->m_MeshSlotPose, draw_order, context->m_ScratchDrawOrderDeltas, slot_changed, alpha);
+                    ApplyAnimation(p, pose, track_idx_to_pose, ik_animation, instance->m_MeshSlotPose, draw_order, scratch->m_DrawOrderDeltas, slot_changed, alpha);
                     if (player == p)
                     {
                         alpha = 1.0f - fade_rate;
@@ -698,13 +784,13 @@ namespace dmRig
             }
             else
             {
-                UpdatePlayer(instance, player, dt, 1.0f);
-                ApplyAnimation(player, pose, track_idx_to_pose, ik_animation, instance->m_MeshSlotPose, true, context->m_ScratchDrawOrderDeltas, slot_changed, 1.0f);
+                UpdatePlayer(scratch, instance, player, dt, 1.0f);
+                ApplyAnimation(player, pose, track_idx_to_pose, ik_animation, instance->m_MeshSlotPose, true, scratch->m_DrawOrderDeltas, slot_changed, 1.0f);
             }
 
             // Update draw order after animation
             if (slot_changed > 0) {
-                UpdateSlotDrawOrder(instance->m_DrawOrder, context->m_ScratchDrawOrderDeltas, slot_changed, context->m_ScratchDrawOrderUnchanged);
+                UpdateSlotDrawOrder(instance->m_DrawOrder, scratch->m_DrawOrderDeltas, slot_changed, scratch->m_DrawOrderUnchanged);
             }
 
             for (uint32_t bi = 0; bi < bone_count; ++bi)
@@ -1039,6 +1125,63 @@ namespace dmRig
         return vertex_count;
     }
 
+    // Minimal four-wide float helpers for the skinning.
+    // A vector holds one matrix column or one transformed position (x, y, z, w).
+#if defined(DM_RIG_SSE)
+    typedef __m128 RigVec4;
+
+    static inline RigVec4 VecLoad(const float* p)                           { return _mm_loadu_ps(p); }
+    static inline RigVec4 VecZero()                                         { return _mm_setzero_ps(); }
+    static inline RigVec4 VecSplat(float f)                                 { return _mm_set1_ps(f); }
+    static inline RigVec4 VecSplatX(RigVec4 v)                              { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)); }
+    static inline RigVec4 VecSplatY(RigVec4 v)                              { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)); }
+    static inline RigVec4 VecSplatZ(RigVec4 v)                              { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)); }
+    static inline RigVec4 VecMulAdd(RigVec4 a, RigVec4 b, RigVec4 c)        { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    static inline void    VecStore3(float* out, RigVec4 v)                  { float t[4]; _mm_storeu_ps(t, v); out[0] = t[0]; out[1] = t[1]; out[2] = t[2]; }
+#elif defined(DM_RIG_NEON)
+    typedef float32x4_t RigVec4;
+
+    static inline RigVec4 VecLoad(const float* p)                           { return vld1q_f32(p); }
+    static inline RigVec4 VecZero()                                         { return vdupq_n_f32(0.0f); }
+    static inline RigVec4 VecSplat(float f)                                 { return vdupq_n_f32(f); }
+    static inline RigVec4 VecSplatX(RigVec4 v)                              { return vdupq_lane_f32(vget_low_f32(v), 0); }
+    static inline RigVec4 VecSplatY(RigVec4 v)                              { return vdupq_lane_f32(vget_low_f32(v), 1); }
+    static inline RigVec4 VecSplatZ(RigVec4 v)                              { return vdupq_lane_f32(vget_high_f32(v), 0); }
+    static inline RigVec4 VecMulAdd(RigVec4 a, RigVec4 b, RigVec4 c)        { return vmlaq_f32(c, a, b); }
+    static inline void    VecStore3(float* out, RigVec4 v)                  { vst1_f32(out, vget_low_f32(v)); out[2] = vgetq_lane_f32(v, 2); }
+#else
+    typedef Vector4 RigVec4;
+
+    static inline RigVec4 VecLoad(const float* p)                           { return Vector4(p[0], p[1], p[2], p[3]); }
+    static inline RigVec4 VecZero()                                         { return Vector4(0.0f); }
+    static inline RigVec4 VecSplat(float f)                                 { return Vector4(f); }
+    static inline RigVec4 VecSplatX(RigVec4 v)                              { return Vector4(v.getX()); }
+    static inline RigVec4 VecSplatY(RigVec4 v)                              { return Vector4(v.getY()); }
+    static inline RigVec4 VecSplatZ(RigVec4 v)                              { return Vector4(v.getZ()); }
+    static inline RigVec4 VecMulAdd(RigVec4 a, RigVec4 b, RigVec4 c)        { return mulPerElem(a, b) + c; }
+    static inline void    VecStore3(float* out, RigVec4 v)                  { out[0] = v.getX(); out[1] = v.getY(); out[2] = v.getZ(); }
+#endif
+
+    // Blends the first column_count columns of the (up to) four influence matrices of a vertex.
+    // The influences are sorted by weight, the first zero weight ends the list.
+    static inline void BlendInfluences(const Matrix4* matrices, const uint32_t* bone_indices, const float* bone_weights, uint32_t column_count, RigVec4* out_columns)
+    {
+        for (uint32_t c = 0; c < column_count; ++c)
+        {
+            out_columns[c] = VecZero();
+        }
+        for (uint32_t i = 0; i < 4 && bone_weights[i]; ++i)
+        {
+            // Matrix4 is stored as four consecutive columns
+            const float* m = (const float*) &matrices[bone_indices[i]];
+            RigVec4 w = VecSplat(bone_weights[i]);
+            for (uint32_t c = 0; c < column_count; ++c)
+            {
+                out_columns[c] = VecMulAdd(VecLoad(m + c * 4), w, out_columns[c]);
+            }
+        }
+    }
+
     static float* GenerateNormalData(const dmRigDDF::Mesh* mesh, const Matrix4& normal_matrix, const dmArray<Matrix4>& pose_matrices, float* out_buffer)
     {
         const float* normals_in = mesh->m_Normals.m_Data;
@@ -1066,40 +1209,25 @@ namespace dmRig
         const uint32_t* indices = mesh->m_BoneIndices.m_Data;
         const float* weights = mesh->m_Weights.m_Data;
         const uint32_t* vertex_indices = mesh->m_PositionIndices.m_Data;
+        const float* n = (const float*) &normal_matrix;
+        const RigVec4 n0 = VecLoad(n + 0);
+        const RigVec4 n1 = VecLoad(n + 4);
+        const RigVec4 n2 = VecLoad(n + 8);
         for (uint32_t ii = 0; ii < index_count; ++ii)
         {
             const uint32_t ni = normal_indices[ii]*3;
-            const Vector3 normal_in(normals_in[ni+0], normals_in[ni+1], normals_in[ni+2]);
-            Vector4 normal_out(0.0f, 0.0f, 0.0f, 0.0f);
-
             const uint32_t bi_offset = vertex_indices[ii] << 2;
-            const uint32_t* bone_indices = &indices[bi_offset];
-            const float* bone_weights = &weights[bi_offset];
 
-            if (bone_weights[0])
-            {
-                normal_out += (pose_matrices[bone_indices[0]] * normal_in) * bone_weights[0];
-                if (bone_weights[1])
-                {
-                    normal_out += (pose_matrices[bone_indices[1]] * normal_in) * bone_weights[1];
-                    if (bone_weights[2])
-                    {
-                        normal_out += (pose_matrices[bone_indices[2]] * normal_in) * bone_weights[2];
-                        if (bone_weights[3])
-                        {
-                            normal_out += (pose_matrices[bone_indices[3]] * normal_in) * bone_weights[3];
-                        }
-                    }
-                }
-            }
+            // Blending the rotation part of the influence matrices first is the same as blending the transformed normals
+            RigVec4 columns[3];
+            BlendInfluences(pose_matrices.Begin(), &indices[bi_offset], &weights[bi_offset], 3, columns);
+            RigVec4 normal_out = VecMulAdd(columns[0], VecSplat(normals_in[ni+0]),
+                                 VecMulAdd(columns[1], VecSplat(normals_in[ni+1]),
+                                 VecMulAdd(columns[2], VecSplat(normals_in[ni+2]), VecZero())));
 
-            v = normal_matrix * Vector3(normal_out.getX(), normal_out.getY(), normal_out.getZ());
-            if (lengthSqr(v) > 0.0f) {
-                normalize(v);
-            }
-            *out_buffer++ = v[0];
-            *out_buffer++ = v[1];
-            *out_buffer++ = v[2];
+            RigVec4 v = VecMulAdd(n0, VecSplatX(normal_out), VecMulAdd(n1, VecSplatY(normal_out), VecMulAdd(n2, VecSplatZ(normal_out), VecZero())));
+            VecStore3(out_buffer, v);
+            out_buffer += 3;
         }
 
         return out_buffer;
@@ -1128,40 +1256,27 @@ namespace dmRig
 
         const uint32_t* indices = mesh->m_BoneIndices.m_Data;
         const float* weights = mesh->m_Weights.m_Data;
+        const float* m = (const float*) &model_matrix;
+        const RigVec4 m0 = VecLoad(m + 0);
+        const RigVec4 m1 = VecLoad(m + 4);
+        const RigVec4 m2 = VecLoad(m + 8);
+        const RigVec4 m3 = VecLoad(m + 12);
         for (uint32_t i = 0; i < vertex_count; ++i)
         {
-            Vector4 in_v;
-            in_v.setX(*positions++);
-            in_v.setY(*positions++);
-            in_v.setZ(*positions++);
-            in_v.setW(1.0f);
-
-            Vector4 out_p(0.0f, 0.0f, 0.0f, 0.0f);
             const uint32_t bi_offset = i << 2;
-            const uint32_t* bone_indices = &indices[bi_offset];
-            const float* bone_weights = &weights[bi_offset];
 
-            if(bone_weights[0])
-            {
-                out_p += pose_matrices[bone_indices[0]] * in_v * bone_weights[0];
-                if(bone_weights[1])
-                {
-                    out_p += pose_matrices[bone_indices[1]] * in_v * bone_weights[1];
-                    if(bone_weights[2])
-                    {
-                        out_p += pose_matrices[bone_indices[2]] * in_v * bone_weights[2];
-                        if(bone_weights[3])
-                        {
-                            out_p += pose_matrices[bone_indices[3]] * in_v * bone_weights[3];
-                        }
-                    }
-                }
-            }
+            // Blending the influence matrices first is the same as blending the transformed positions
+            RigVec4 columns[4];
+            BlendInfluences(pose_matrices.Begin(), &indices[bi_offset], &weights[bi_offset], 4, columns);
+            RigVec4 out_p = VecMulAdd(columns[0], VecSplat(positions[0]),
+                            VecMulAdd(columns[1], VecSplat(positions[1]),
+                            VecMulAdd(columns[2], VecSplat(positions[2]), columns[3])));
+            positions += 3;
 
-            v = model_matrix * Point3(out_p.getX(), out_p.getY(), out_p.getZ());
-            *out_buffer++ = v[0];
-            *out_buffer++ = v[1];
-            *out_buffer++ = v[2];
+            // The skinned position is transformed as a point, the blended w is ignored
+            RigVec4 v = VecMulAdd(m0, VecSplatX(out_p), VecMulAdd(m1, VecSplatY(out_p), VecMulAdd(m2, VecSplatZ(out_p), m3)));
+            VecStore3(out_buffer, v);
+            out_buffer += 3;
         }
         return out_buffer;
     }
@@ -1313,7 +1428,7 @@ namespace dmRig
         return out_write_ptr;
     }
 
-    void* GenerateVertexData(dmRig::HRigContext context, dmRig::HRigInstance instance, const Matrix4& model_matrix, const Matrix4& normal_matrix, const Vector4 color, RigVertexFormat vertex_format, void* vertex_data_out)
+    static void* DoGenerateVertexData(RigScratch* scratch, dmRig::HRigInstance instance, const Matrix4& model_matrix, const Matrix4& normal_matrix, const Vector4 color, RigVertexFormat vertex_format, void* vertex_data_out)
     {
         const dmRigDDF::MeshEntry* mesh_entry = instance->m_MeshEntry;
         if (!instance->m_MeshEntry || !instance->m_DoRender) {
@@ -1332,10 +1447,10 @@ namespace dmRig
             }
         }
 
-        dmArray<Matrix4>& pose_matrices      = context->m_ScratchPoseMatrixBuffer;
-        dmArray<Matrix4>& influence_matrices = context->m_ScratchInfluenceMatrixBuffer;
-        dmArray<Vector3>& positions          = context->m_ScratchPositionBuffer;
-        dmArray<Vector3>& normals            = context->m_ScratchNormalBuffer;
+        dmArray<Matrix4>& pose_matrices      = scratch->m_PoseMatrixBuffer;
+        dmArray<Matrix4>& influence_matrices = scratch->m_InfluenceMatrixBuffer;
+        dmArray<Vector3>& positions          = scratch->m_PositionBuffer;
+        dmArray<Vector3>& normals            = scratch->m_NormalBuffer;
 
         // If the rig has bones, update the pose to be local-to-model
         uint32_t bone_count = GetBoneCount(instance);
@@ -1365,7 +1480,7 @@ namespace dmRig
             const dmRigDDF::Skeleton* skeleton = instance->m_Skeleton;
             if (skeleton->m_LocalBoneScaling) {
 
-                dmArray<dmTransform::Transform>& pose_transforms = context->m_ScratchPoseTransformBuffer;
+                dmArray<dmTransform::Transform>& pose_transforms = scratch->m_PoseTransformBuffer;
                 if (pose_transforms.Capacity() < bone_count) {
                     pose_transforms.OffsetCapacity(bone_count - pose_transforms.Capacity());
                 }
@@ -1474,6 +1589,42 @@ namespace dmRig
         return vertex_data_out;
     }
 
+    void* GenerateVertexData(dmRig::HRigContext context, dmRig::HRigInstance instance, const Matrix4& model_matrix, const Matrix4& normal_matrix, const Vector4 color, RigVertexFormat vertex_format, void* vertex_data_out)
+    {
+        return DoGenerateVertexData(context->m_Scratch[0], instance, model_matrix, normal_matrix, color, vertex_format, vertex_data_out);
+    }
+
+    struct GenerateVertexDataContext
+    {
+        HRigContext                     m_Context;
+        const GenerateVertexDataParams* m_Params;
+        RigVertexFormat                 m_VertexFormat;
+    };
+
+    static void GenerateVertexDataRange(void* _ctx, uint32_t begin, uint32_t end)
+    {
+        DM_PROFILE(Rig, "GenerateVertexDataRange");
+        GenerateVertexDataContext* ctx = (GenerateVertexDataContext*) _ctx;
+        RigScratch* scratch = ctx->m_Context->m_Scratch[begin / VERTEX_DATA_BATCH_SIZE];
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            const GenerateVertexDataParams& params = ctx->m_Params[i];
+            DoGenerateVertexData(scratch, params.m_Instance, params.m_ModelMatrix, params.m_NormalMatrix, params.m_Color, ctx->m_VertexFormat, params.m_VertexDataOut);
+        }
+    }
+
+    void GenerateVertexDataBatch(HRigContext context, const GenerateVertexDataParams* params, uint32_t count, RigVertexFormat vertex_format)
+    {
+        DM_PROFILE(Rig, "GenerateVertexDataBatch");
+        EnsureScratch(context, count, VERTEX_DATA_BATCH_SIZE);
+
+        GenerateVertexDataContext ctx;
+        ctx.m_Context = context;
+        ctx.m_Params = params;
+        ctx.m_VertexFormat = vertex_format;
+        dmWorkerPool::ParallelFor(context->m_WorkerPool, GenerateVertexDataRange, &ctx, count, VERTEX_DATA_BATCH_SIZE);
+    }
+
     static uint32_t FindIKIndex(HRigInstance instance, dmhash_t ik_constraint_id)
     {
         const dmRigDDF::Skeleton* skeleton = instance->m_Skeleton;
@@ -1639,7 +1790,9 @@ namespace dmRig
         // before that happens, for example cloning a GUI spine node happens in script update,
         // which comes after the regular dmRig::Update.
         if (params.m_ForceAnimatePose) {
-            DoAnimate(context, instance, 0.0f);
+            RigScratch* scratch = context->m_Scratch[0];
+            DoAnimate(scratch, instance, 0.0f);
+            SendEvents(scratch);
         }
 
         return dmRig::RESULT_OK;
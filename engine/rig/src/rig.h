@@ -20,6 +20,7 @@
 #include <dlib/vmath.h>
 #include <dlib/align.h>
 #include <dlib/transform.h>
+#include <dlib/worker_pool.h>
 
 #include <render/render.h>
 
@@ -202,26 +203,52 @@ namespace dmRig
         float nz;
     };
 
-    struct RigContext
+    struct RigEvent
     {
-        dmObjectPool<HRigInstance>      m_Instances;
-        // Temporary scratch buffers used for store pose as transform and matrices
+        HRigInstance m_Instance;
+        RigEventType m_Type;
+        union
+        {
+            RigCompletedEventData m_Completed;
+            RigKeyframeEventData  m_Keyframe;
+        };
+    };
+
+    // Temporary scratch buffers used while animating or generating vertex data.
+    // There is one set per batch of instances processed on the worker pool.
+    struct RigScratch
+    {
+        // Pose as transform and matrices
         // (avoids modifying the real pose transform data during rendering).
-        dmArray<dmTransform::Transform> m_ScratchPoseTransformBuffer;
-        dmArray<Matrix4>                m_ScratchInfluenceMatrixBuffer;
-        dmArray<Matrix4>                m_ScratchPoseMatrixBuffer;
-        // Temporary scratch buffers used when transforming the vertex buffer,
+        dmArray<dmTransform::Transform> m_PoseTransformBuffer;
+        dmArray<Matrix4>                m_InfluenceMatrixBuffer;
+        dmArray<Matrix4>                m_PoseMatrixBuffer;
+        // Used when transforming the vertex buffer,
         // used to creating primitives from indices.
-        dmArray<Vector3>                m_ScratchPositionBuffer;
-        dmArray<Vector3>                m_ScratchNormalBuffer;
-        // Temporary scratch buffers to handle draw order changes.
-        dmArray<int32_t>                m_ScratchDrawOrderDeltas;
-        dmArray<int32_t>                m_ScratchDrawOrderUnchanged;
+        dmArray<Vector3>                m_PositionBuffer;
+        dmArray<Vector3>                m_NormalBuffer;
+        // Used to handle draw order changes.
+        dmArray<int32_t>                m_DrawOrderDeltas;
+        dmArray<int32_t>                m_DrawOrderUnchanged;
+        // Events raised while animating, sent on the calling thread once all instances are animated
+        dmArray<RigEvent>               m_Events;
+    };
+
+    struct RigContext
+    {
+        dmObjectPool<HRigInstance>      m_Instances;
+        dmWorkerPool::HWorkerPool       m_WorkerPool;
+        // Index 0 is always allocated and used when not running on the worker pool
+        dmArray<RigScratch*>            m_Scratch;
     };
 
     struct NewContextParams {
         HRigContext* m_Context;
         uint32_t     m_MaxRigInstanceCount;
+        /// If set, instances are animated and skinned in parallel. Note that IK target
+        /// callbacks are then called from the worker threads. Event and pose callbacks
+        /// are always called from the thread calling Update.
+        dmWorkerPool::HWorkerPool m_WorkerPool;
     };
 
     typedef void (*RigEventCallback)(RigEventType, void*, void*, void*);
@@ -316,6 +343,19 @@ namespace dmRig
     dmhash_t GetAnimation(HRigInstance instance);
 
     void* GenerateVertexData(HRigContext context, HRigInstance instance, const Matrix4& model_matrix, const Matrix4& normal_matrix, const Vector4 color, RigVertexFormat vertex_format, void* vertex_data_out);
+
+    struct GenerateVertexDataParams
+    {
+        HRigInstance m_Instance;
+        Matrix4      m_ModelMatrix;
+        Matrix4      m_NormalMatrix;
+        Vector4      m_Color;
+        /// Where to write the vertex data, room for GetVertexCount(m_Instance) vertices
+        void*        m_VertexDataOut;
+    };
+
+    // Same as GenerateVertexData for several instances, split over the worker pool of the context
+    void GenerateVertexDataBatch(HRigContext context, const GenerateVertexDataParams* params, uint32_t count, RigVertexFormat vertex_format);
     uint32_t GetVertexCount(HRigInstance instance);
 
     Result SetMesh(HRigInstance instance, dmhash_t mesh_id);
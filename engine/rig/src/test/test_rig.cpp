@@ -13,6 +13,8 @@
 #define JC_TEST_IMPLEMENTATION
 #include <jc_test/jc_test.h>
 #include <dlib/log.h>
+#include <dlib/time.h>
+#include <dlib/worker_pool.h>
 
 #include <../rig.h>
 
@@ -1444,19 +1446,19 @@ TEST_F(RigInstanceTest, PlayValidAnimation)
 
 TEST_F(RigInstanceTest, MaxBoneCount)
 {
-    // Call GenerateVertedData to setup m_ScratchInfluenceMatrixBuffer
+    // Call GenerateVertedData to setup the influence matrix scratch buffer
     ASSERT_EQ(dmRig::RESULT_OK, dmRig::Update(m_Context, 1.0/60.0));
     dmRig::RigModelVertex data[4];
     dmRig::RigModelVertex* data_end = data + 4;
     ASSERT_EQ(data_end, dmRig::GenerateVertexData(m_Context, m_Instance, Matrix4::identity(), Matrix4::identity(), Vector4(1.0), dmRig::RIG_VERTEX_FORMAT_MODEL, (void*)data));
 
-    // m_ScratchInfluenceMatrixBuffer should be able to contain the instance max bone count, which is the max of the used skeleton and meshset
+    // The influence matrix scratch buffer should be able to contain the instance max bone count, which is the max of the used skeleton and meshset
     // MaxBoneCount is set to BoneCount + 1 for testing.
-    ASSERT_EQ(m_Context->m_ScratchInfluenceMatrixBuffer.Size(), dmRig::GetMaxBoneCount(m_Instance));
-    ASSERT_EQ(m_Context->m_ScratchInfluenceMatrixBuffer.Size(), dmRig::GetBoneCount(m_Instance) + 1);
+    ASSERT_EQ(m_Context->m_Scratch[0]->m_InfluenceMatrixBuffer.Size(), dmRig::GetMaxBoneCount(m_Instance));
+    ASSERT_EQ(m_Context->m_Scratch[0]->m_InfluenceMatrixBuffer.Size(), dmRig::GetBoneCount(m_Instance) + 1);
 
-    // Setting the m_ScratchInfluenceMatrixBuffer to zero ensures it have to be resized to max bone count
-    m_Context->m_ScratchInfluenceMatrixBuffer.SetCapacity(0);
+    // Setting the influence matrix scratch buffer to zero ensures it have to be resized to max bone count
+    m_Context->m_Scratch[0]->m_InfluenceMatrixBuffer.SetCapacity(0);
     // If this isn't done correctly, it'll assert out of bounds
     ASSERT_EQ(dmRig::RESULT_OK, dmRig::Update(m_Context, 1.0/60.0));
 }
@@ -2493,6 +2495,154 @@ PlaybackCursorTestParams playback_cursor_test_params[] = {
 };
 INSTANTIATE_TEST_CASE_P(Rig, PlaybackCursorTest, jc_test_values_in(playback_cursor_test_params));
 
+static void RecordEventCallback(dmRig::RigEventType event_type, void* event_data, void* user_data1, void* user_data2)
+{
+    dmArray<uintptr_t>* events = (dmArray<uintptr_t>*)user_data1;
+    if (events->Full())
+        events->OffsetCapacity(64);
+    events->Push((uintptr_t)user_data2);
+}
+
+// Animates and skins instance_count instances over frame_count frames, returns the vertex data of the last frame
+// and the instance index of each completed event, in the order they were sent
+static void RunRigInstances(dmWorkerPool::HWorkerPool pool, uint32_t instance_count, uint32_t frame_count, dmArray<dmRig::RigModelVertex>& vertices, dmArray<uintptr_t>& events, bool print)
+{
+    dmRig::HRigContext context;
+    dmRig::NewContextParams params = {0};
+    params.m_Context = &context;
+    params.m_MaxRigInstanceCount = instance_count;
+    params.m_WorkerPool = pool;
+    ASSERT_EQ(dmRig::RESULT_OK, dmRig::NewContext(params));
+
+    dmRigDDF::Skeleton*     skeleton      = new dmRigDDF::Skeleton();
+    dmRigDDF::MeshSet*      mesh_set      = new dmRigDDF::MeshSet();
+    dmRigDDF::AnimationSet* animation_set = new dmRigDDF::AnimationSet();
+    dmArray<dmRig::RigBone> bind_pose;
+    dmArray<uint32_t>       pose_to_influence;
+    dmArray<uint32_t>       track_idx_to_pose;
+    SetUpSimpleRig(bind_pose, skeleton, mesh_set, animation_set, pose_to_influence, track_idx_to_pose);
+
+    dmArray<dmRig::HRigInstance> instances;
+    instances.SetCapacity(instance_count);
+    instances.SetSize(instance_count);
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        dmRig::InstanceCreateParams create_params = {0};
+        create_params.m_Context            = context;
+        create_params.m_Instance           = &instances[i];
+        create_params.m_BindPose           = &bind_pose;
+        create_params.m_Skeleton           = skeleton;
+        create_params.m_MeshSet            = mesh_set;
+        create_params.m_AnimationSet       = animation_set;
+        create_params.m_TrackIdxToPose     = &track_idx_to_pose;
+        create_params.m_PoseIdxToInfluence = &pose_to_influence;
+        create_params.m_MeshId             = dmHashString64("test");
+        create_params.m_DefaultAnimation   = dmHashString64("");
+        create_params.m_EventCallback      = RecordEventCallback;
+        create_params.m_EventCBUserData1   = &events;
+        create_params.m_EventCBUserData2   = (void*)(uintptr_t)i;
+        ASSERT_EQ(dmRig::RESULT_OK, dmRig::InstanceCreate(create_params));
+        // Spread the offsets so the instances complete on different frames
+        float offset = (float)i / instance_count;
+        ASSERT_EQ(dmRig::RESULT_OK, dmRig::PlayAnimation(instances[i], dmHashString64("valid"), dmRig::PLAYBACK_ONCE_FORWARD, 0.0f, offset, 1.0f));
+    }
+
+    dmArray<dmRig::GenerateVertexDataParams> vertex_params;
+    vertex_params.SetCapacity(instance_count);
+    vertex_params.SetSize(instance_count);
+
+    uint64_t update_time = 0;
+    uint64_t vertex_time = 0;
+    for (uint32_t frame = 0; frame < frame_count; ++frame)
+    {
+        uint64_t start = dmTime::GetTime();
+        dmRig::Update(context, 0.1f);
+        uint64_t end = dmTime::GetTime();
+        update_time += end - start;
+
+        uint32_t vertex_count = 0;
+        for (uint32_t i = 0; i < instance_count; ++i)
+        {
+            vertex_count += dmRig::GetVertexCount(instances[i]);
+        }
+        vertices.SetCapacity(vertex_count);
+        vertices.SetSize(vertex_count);
+
+        dmRig::RigModelVertex* write_ptr = vertices.Begin();
+        for (uint32_t i = 0; i < instance_count; ++i)
+        {
+            dmRig::GenerateVertexDataParams& p = vertex_params[i];
+            p.m_Instance = instances[i];
+            p.m_ModelMatrix = Matrix4::translation(Vector3((float)i, 0.0f, 0.0f));
+            p.m_NormalMatrix = Matrix4::identity();
+            p.m_Color = Vector4(1.0f);
+            p.m_VertexDataOut = write_ptr;
+            write_ptr += dmRig::GetVertexCount(instances[i]);
+        }
+
+        start = dmTime::GetTime();
+        dmRig::GenerateVertexDataBatch(context, vertex_params.Begin(), instance_count, dmRig::RIG_VERTEX_FORMAT_MODEL);
+        end = dmTime::GetTime();
+        vertex_time += end - start;
+    }
+
+    if (print)
+    {
+        uint32_t total = instance_count * frame_count;
+        printf("%u workers: animate %.1f instances/ms, skin %.1f instances/ms\n", dmWorkerPool::GetWorkerCount(pool),
+            total * 1000.0f / (float)dmMath::Max(update_time, (uint64_t)1), total * 1000.0f / (float)dmMath::Max(vertex_time, (uint64_t)1));
+    }
+
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        dmRig::InstanceDestroyParams destroy_params = {0};
+        destroy_params.m_Context = context;
+        destroy_params.m_Instance = instances[i];
+        ASSERT_EQ(dmRig::RESULT_OK, dmRig::InstanceDestroy(destroy_params));
+    }
+    DeleteRigData(mesh_set, skeleton, animation_set);
+    dmRig::DeleteContext(context);
+}
+
+TEST(RigWorkerPool, MatchesSequential)
+{
+    const uint32_t instance_count = 200;
+    dmArray<dmRig::RigModelVertex> sequential_vertices;
+    dmArray<uintptr_t> sequential_events;
+    RunRigInstances(0, instance_count, 40, sequential_vertices, sequential_events, false);
+
+    dmWorkerPool::HWorkerPool pool = dmWorkerPool::New(3, "rig_worker");
+    dmArray<dmRig::RigModelVertex> parallel_vertices;
+    dmArray<uintptr_t> parallel_events;
+    RunRigInstances(pool, instance_count, 40, parallel_vertices, parallel_events, false);
+    dmWorkerPool::Delete(pool);
+
+    // Every instance completes once, and the events are sent in instance order each frame
+    ASSERT_EQ(instance_count, sequential_events.Size());
+    ASSERT_EQ(sequential_events.Size(), parallel_events.Size());
+    for (uint32_t i = 0; i < sequential_events.Size(); ++i)
+    {
+        ASSERT_EQ(sequential_events[i], parallel_events[i]);
+    }
+
+    ASSERT_EQ(sequential_vertices.Size(), parallel_vertices.Size());
+    ASSERT_EQ(0, memcmp(sequential_vertices.Begin(), parallel_vertices.Begin(), sequential_vertices.Size() * sizeof(dmRig::RigModelVertex)));
+}
+
+TEST(RigWorkerPool, Benchmark)
+{
+    const uint32_t instance_count = 256;
+    const uint32_t worker_counts[] = {0, 1, 3};
+    for (uint32_t i = 0; i < sizeof(worker_counts) / sizeof(worker_counts[0]); ++i)
+    {
+        dmWorkerPool::HWorkerPool pool = dmWorkerPool::New(worker_counts[i], "rig_worker");
+        dmArray<dmRig::RigModelVertex> vertices;
+        dmArray<uintptr_t> events;
+        RunRigInstances(pool, instance_count, 100, vertices, events, true);
+        dmWorkerPool::Delete(pool);
+    }
+}
+
 #undef ASSERT_VEC3
 #undef ASSERT_VEC4
 #undef ASSERT_VEC4_NEAR
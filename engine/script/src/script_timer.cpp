@@ -37,14 +37,23 @@ namespace dmScript
      */
 
     /*
-        The timers are stored in a flat array with no holes which we scan sequenctially on each update.
+        The timers are stored in a flat array with no holes.
 
         When a timer is removed the last timer in the list may change location (EraseSwap).
 
-        This is to keep the array sweep fast and handle cases where multiple short lived timers are
-        created followed by one long-lived timer. If we did not re-shuffle and keep holes we would keep
-        scanning the array to the end where the only live timer exists skipping all the holes.
-        How much of an issue this is guesswork at this point.
+        Live timers are also scheduled in a binary min-heap ordered on their deadline, timers with
+        the same deadline are ordered by when they were scheduled. UpdateTimers only pops the timers
+        that are due, so the cost of an update scales with the number of triggered timers rather than
+        the number of live timers. Projects can have thousands of long-lived timers where only a few
+        trigger each frame.
+
+        The deadlines are absolute times on the timer world clock which is advanced by UpdateTimers.
+        The heap refers to timers by their lookup index and each timer keeps its position in the heap
+        so that a cancelled or killed timer can be unscheduled directly.
+
+        Timers that are added or repeated from inside a timer callback are put on a pending list and
+        scheduled when the update is done, so they never trigger in the same update. Timers that die
+        during the update are freed when the update is done.
 
         The timer identity is an index into an indirection layer combined with a generation counter,
         this makes it possible to reuse the index for the indirection layer without risk of using
@@ -67,19 +76,29 @@ namespace dmScript
         // Store complete timer handle with generation here to identify stale timer handles
         HTimer          m_Handle;
 
-        // How much time remaining until the timer fires
-        float           m_Remaining;
-
         // The timer delay, we need to keep this for repeating timers
         float           m_Delay;
 
+        // Position in the schedule heap, INVALID_HEAP_INDEX if the timer is not scheduled
+        uint32_t        m_HeapIndex;
+
         // Flag if the timer should repeat
         uint32_t        m_Repeat : 1;
         // Flag if the timer is alive
         uint32_t        m_IsAlive : 1;
     };
 
+    struct ScheduledTimer
+    {
+        // The time on the timer world clock when the timer fires
+        double          m_Deadline;
+        // Schedule order, keeps timers with the same deadline in the order they were scheduled
+        uint32_t        m_Sequence;
+        uint16_t        m_LookupIndex;
+    };
+
     #define INVALID_TIMER_LOOKUP_INDEX  0xffffu
+    #define INVALID_HEAP_INDEX          0xffffffffu
     #define INITIAL_TIMER_CAPACITY      8u
     #define MAX_TIMER_CAPACITY          65000u  // Needs to be less that 65535 since 65535 is reserved for invalid index
     #define TIMER_CAPACITY_GROWTH       16u
@@ -89,6 +108,11 @@ namespace dmScript
         dmArray<Timer>                      m_Timers;
         dmArray<uint16_t>                   m_IndexLookup;
         dmIndexPool<uint16_t>               m_IndexPool;
+        dmArray<ScheduledTimer>             m_Heap;      // Scheduled timers, min-heap on deadline
+        dmArray<ScheduledTimer>             m_Pending;   // Timers added or repeated during UpdateTimers
+        dmArray<uint16_t>                   m_Dead;      // Lookup indexes of timers that died during UpdateTimers
+        double                              m_Time;
+        uint32_t                            m_Sequence;
         uint16_t                            m_Version;   // Incremented to avoid collisions each time we push timer indexes back to the m_IndexPool
         uint16_t                            m_InUpdate : 1;
     };
@@ -103,6 +127,118 @@ namespace dmScript
         return (((uint32_t)generation) << 16) | (lookup_index);
     }
 
+    static inline bool IsScheduledBefore(const ScheduledTimer& a, const ScheduledTimer& b)
+    {
+        if (a.m_Deadline != b.m_Deadline)
+        {
+            return a.m_Deadline < b.m_Deadline;
+        }
+        return (int32_t)(a.m_Sequence - b.m_Sequence) < 0;
+    }
+
+    static inline void SetHeapEntry(HTimerWorld timer_world, uint32_t heap_index, const ScheduledTimer& scheduled)
+    {
+        timer_world->m_Heap[heap_index] = scheduled;
+        uint16_t timer_index = timer_world->m_IndexLookup[scheduled.m_LookupIndex];
+        timer_world->m_Timers[timer_index].m_HeapIndex = heap_index;
+    }
+
+    static void SiftUp(HTimerWorld timer_world, uint32_t heap_index)
+    {
+        dmArray<ScheduledTimer>& heap = timer_world->m_Heap;
+        ScheduledTimer scheduled = heap[heap_index];
+        while (heap_index > 0)
+        {
+            uint32_t parent = (heap_index - 1) / 2;
+            if (!IsScheduledBefore(scheduled, heap[parent]))
+            {
+                break;
+            }
+            SetHeapEntry(timer_world, heap_index, heap[parent]);
+            heap_index = parent;
+        }
+        SetHeapEntry(timer_world, heap_index, scheduled);
+    }
+
+    static void SiftDown(HTimerWorld timer_world, uint32_t heap_index)
+    {
+        dmArray<ScheduledTimer>& heap = timer_world->m_Heap;
+        ScheduledTimer scheduled = heap[heap_index];
+        uint32_t size = heap.Size();
+        while (true)
+        {
+            uint32_t child = heap_index * 2 + 1;
+            if (child >= size)
+            {
+                break;
+            }
+            if (child + 1 < size && IsScheduledBefore(heap[child + 1], heap[child]))
+            {
+                ++child;
+            }
+            if (!IsScheduledBefore(heap[child], scheduled))
+            {
+                break;
+            }
+            SetHeapEntry(timer_world, heap_index, heap[child]);
+            heap_index = child;
+        }
+        SetHeapEntry(timer_world, heap_index, scheduled);
+    }
+
+    static void PushHeap(HTimerWorld timer_world, const ScheduledTimer& scheduled)
+    {
+        // The heap never holds more entries than there are timers, see AllocateTimer
+        timer_world->m_Heap.Push(scheduled);
+        SiftUp(timer_world, timer_world->m_Heap.Size() - 1);
+    }
+
+    static void ScheduleTimer(HTimerWorld timer_world, uint16_t lookup_index, double deadline)
+    {
+        ScheduledTimer scheduled;
+        scheduled.m_Deadline = deadline;
+        scheduled.m_Sequence = timer_world->m_Sequence++;
+        scheduled.m_LookupIndex = lookup_index;
+
+        if (timer_world->m_InUpdate)
+        {
+            timer_world->m_Pending.Push(scheduled);
+        }
+        else
+        {
+            PushHeap(timer_world, scheduled);
+        }
+    }
+
+    static void UnscheduleTimer(HTimerWorld timer_world, Timer& timer)
+    {
+        uint32_t heap_index = timer.m_HeapIndex;
+        if (heap_index == INVALID_HEAP_INDEX)
+        {
+            return;
+        }
+        timer.m_HeapIndex = INVALID_HEAP_INDEX;
+
+        dmArray<ScheduledTimer>& heap = timer_world->m_Heap;
+        uint32_t last = heap.Size() - 1;
+        ScheduledTimer moved = heap[last];
+        heap.SetSize(last);
+        if (heap_index == last)
+        {
+            return;
+        }
+
+        heap[heap_index] = moved;
+        if (heap_index > 0 && IsScheduledBefore(moved, heap[(heap_index - 1) / 2]))
+        {
+            SiftUp(timer_world, heap_index);
+        }
+        else
+        {
+            SiftDown(timer_world, heap_index);
+        }
+    }
+
     static Timer* AllocateTimer(HTimerWorld timer_world, uintptr_t owner)
     {
         assert(timer_world != 0x0);
@@ -130,12 +266,17 @@ namespace dmScript
             uint32_t capacity = timer_world->m_Timers.Capacity();
             capacity = dmMath::Min(capacity + TIMER_CAPACITY_GROWTH, MAX_TIMER_CAPACITY);
             timer_world->m_Timers.SetCapacity(capacity);
+            // Each timer is at most once in each of these
+            timer_world->m_Heap.SetCapacity(capacity);
+            timer_world->m_Pending.SetCapacity(capacity);
+            timer_world->m_Dead.SetCapacity(capacity);
         }
 
         timer_world->m_Timers.SetSize(timer_count + 1);
         Timer& timer = timer_world->m_Timers[timer_count];
         timer.m_Handle = handle;
         timer.m_Owner = owner;
+        timer.m_HeapIndex = INVALID_HEAP_INDEX;
 
         uint16_t lookup_index = GetLookupIndex(handle);
 
@@ -161,6 +302,8 @@ namespace dmScript
         assert(timer_world != 0x0);
         assert(timer.m_IsAlive == 0);
 
+        UnscheduleTimer(timer_world, timer);
+
         uint16_t lookup_index = GetLookupIndex(timer.m_Handle);
         uint16_t timer_index = timer_world->m_IndexLookup[lookup_index];
         timer_world->m_IndexPool.Push(lookup_index);
@@ -168,6 +311,17 @@ namespace dmScript
         EraseTimer(timer_world, timer_index);
     }
 
+    // Marks a live timer as dead, the timer is freed directly or at the end of UpdateTimers
+    static void KillTimer(HTimerWorld timer_world, Timer& timer)
+    {
+        timer.m_IsAlive = 0;
+        UnscheduleTimer(timer_world, timer);
+        if (timer_world->m_InUpdate)
+        {
+            timer_world->m_Dead.Push(GetLookupIndex(timer.m_Handle));
+        }
+    }
+
     HTimerWorld NewTimerWorld()
     {
         TimerWorld* timer_world = new TimerWorld();
@@ -176,6 +330,11 @@ namespace dmScript
         timer_world->m_IndexLookup.SetSize(INITIAL_TIMER_CAPACITY);
         memset(&timer_world->m_IndexLookup[0], 0u, INITIAL_TIMER_CAPACITY * sizeof(uint16_t));
         timer_world->m_IndexPool.SetCapacity(INITIAL_TIMER_CAPACITY);
+        timer_world->m_Heap.SetCapacity(INITIAL_TIMER_CAPACITY);
+        timer_world->m_Pending.SetCapacity(INITIAL_TIMER_CAPACITY);
+        timer_world->m_Dead.SetCapacity(INITIAL_TIMER_CAPACITY);
+        timer_world->m_Time = 0.0;
+        timer_world->m_Sequence = 0;
         timer_world->m_Version = 0;
         timer_world->m_InUpdate = 0;
         return timer_world;
@@ -193,34 +352,31 @@ namespace dmScript
         DM_PROFILE(TimerWorld, "Update");
 
         timer_world->m_InUpdate = 1;
+        timer_world->m_Time += dt;
+        const double now = timer_world->m_Time;
 
-        // We only scan timers for trigger if the timer *existed at entry to UpdateTimers*, any timers added
-        // in a trigger callback will always be added at the end of m_Timers and not triggered in this scope.
-        uint32_t size = timer_world->m_Timers.Size();
-        DM_COUNTER("timerc", size);
+        DM_COUNTER("timerc", timer_world->m_Timers.Size());
 
-        for (uint32_t i = 0; i < size; ++i)
+        // Any timers added or repeated in a trigger callback are put in m_Pending and not triggered in this scope.
+        dmArray<ScheduledTimer>& heap = timer_world->m_Heap;
+        while (!heap.Empty() && heap[0].m_Deadline <= now)
         {
-            Timer* timer = &timer_world->m_Timers[i];
-            if (timer->m_IsAlive == 0)
-            {
-                continue;
-            }
+            ScheduledTimer scheduled = heap[0];
 
-            timer->m_Remaining -= dt;
-            if (timer->m_Remaining > 0.0f)
-            {
-                continue;
-            }
+            // No timers are freed during the update so the timer index is stable
+            uint16_t timer_index = timer_world->m_IndexLookup[scheduled.m_LookupIndex];
+            Timer* timer = &timer_world->m_Timers[timer_index];
+            UnscheduleTimer(timer_world, *timer);
 
-            float elapsed_time = timer->m_Delay - timer->m_Remaining;
+            float remaining = (float)(scheduled.m_Deadline - now);
+            float elapsed_time = timer->m_Delay - remaining;
 
             TimerEventType eventType = timer->m_Repeat == 0 ? TIMER_EVENT_TRIGGER_WILL_DIE : TIMER_EVENT_TRIGGER_WILL_REPEAT;
 
             timer->m_Callback(timer_world, eventType, timer->m_Handle, elapsed_time, timer->m_Owner, timer->m_UserData);
 
             // The array might have been reallocated here! So grab the pointer again...
-            timer = &timer_world->m_Timers[i];
+            timer = &timer_world->m_Timers[timer_index];
 
             if (timer->m_IsAlive == 0)
             {
@@ -229,42 +385,45 @@ namespace dmScript
 
             if (timer->m_Repeat == 0)
             {
-                timer->m_IsAlive = 0;
+                KillTimer(timer_world, *timer);
                 continue;
             }
 
             if (timer->m_Delay == 0.0f)
             {
-                timer->m_Remaining = 0.0f;
+                ScheduleTimer(timer_world, scheduled.m_LookupIndex, now);
                 continue;
             }
 
-            float wrapped_count = ((-timer->m_Remaining) / timer->m_Delay) + 1.f;
-            float offset_to_next_trigger  = floor(wrapped_count) * timer->m_Delay;
-            timer->m_Remaining += offset_to_next_trigger;
-            assert(timer->m_Remaining >= 0.f);
+            double wrapped_count = ((now - scheduled.m_Deadline) / timer->m_Delay) + 1.0;
+            double offset_to_next_trigger  = floor(wrapped_count) * timer->m_Delay;
+            double next_deadline = dmMath::Max(scheduled.m_Deadline + offset_to_next_trigger, now);
+            ScheduleTimer(timer_world, scheduled.m_LookupIndex, next_deadline);
         }
 
         timer_world->m_InUpdate = 0;
 
-        size = timer_world->m_Timers.Size();
-        uint32_t original_size = size;
-        uint32_t i = 0;
-        while (i < size)
+        uint32_t pending_count = timer_world->m_Pending.Size();
+        for (uint32_t i = 0; i < pending_count; ++i)
         {
-            Timer& timer = timer_world->m_Timers[i];
-            if (timer.m_IsAlive == 0)
+            const ScheduledTimer& scheduled = timer_world->m_Pending[i];
+            uint16_t timer_index = timer_world->m_IndexLookup[scheduled.m_LookupIndex];
+            if (timer_world->m_Timers[timer_index].m_IsAlive)
             {
-                FreeTimer(timer_world, timer);
-                --size;
-            }
-            else
-            {
-                ++i;
+                PushHeap(timer_world, scheduled);
             }
         }
+        timer_world->m_Pending.SetSize(0);
 
-        if (size != original_size)
+        uint32_t dead_count = timer_world->m_Dead.Size();
+        for (uint32_t i = 0; i < dead_count; ++i)
+        {
+            uint16_t timer_index = timer_world->m_IndexLookup[timer_world->m_Dead[i]];
+            FreeTimer(timer_world, timer_world->m_Timers[timer_index]);
+        }
+        timer_world->m_Dead.SetSize(0);
+
+        if (dead_count != 0)
         {
             ++timer_world->m_Version;
         }
@@ -287,12 +446,13 @@ namespace dmScript
         }
 
         timer->m_Delay = delay;
-        timer->m_Remaining = delay;
         timer->m_UserData = userdata;
         timer->m_Callback = timer_callback;
         timer->m_Repeat = repeat;
         timer->m_IsAlive = 1;
 
+        ScheduleTimer(timer_world, GetLookupIndex(timer->m_Handle), timer_world->m_Time + delay);
+
         return timer->m_Handle;
     }
 
@@ -322,12 +482,13 @@ namespace dmScript
             return false;
         }
 
-        timer.m_IsAlive = 0;
+        KillTimer(timer_world, timer);
         timer.m_Callback(timer_world, TIMER_EVENT_CANCELLED, timer.m_Handle, 0.f, timer.m_Owner, timer.m_UserData);
 
         if (timer_world->m_InUpdate == 0)
         {
-            FreeTimer(timer_world, timer);
+            // The callback may have added timers, look the timer up again
+            FreeTimer(timer_world, timer_world->m_Timers[timer_world->m_IndexLookup[lookup_index]]);
             ++timer_world->m_Version;
         }
         return true;
@@ -351,7 +512,7 @@ namespace dmScript
 
             if (timer.m_IsAlive == 1)
             {
-                timer.m_IsAlive = 0;
+                KillTimer(timer_world, timer);
                 ++cancelled_count;
             }
 
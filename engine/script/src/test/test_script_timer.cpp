@@ -12,6 +12,7 @@
 
 #define JC_TEST_IMPLEMENTATION
 #include <jc_test/jc_test.h>
+#include <dlib/time.h>
 #include "../script.h"
 #include "../script_timer_private.h"
 
@@ -724,6 +725,58 @@ TEST_F(ScriptTimerTest, TestKillTimers)
     dmScript::DeleteTimerWorld(timer_world);
 }
 
+TEST_F(ScriptTimerTest, TestManyTimersPerformance)
+{
+    // A timer world holds at most 65000 timers, so the 100k timers are spread over two worlds
+    const uint32_t world_count = 2;
+    const uint32_t timers_per_world = 50000;
+    const uint32_t update_count = 600;
+    const float dt = 1.0f / 60.0f;
+
+    dmScript::HTimerWorld timer_worlds[world_count];
+    for (uint32_t w = 0; w < world_count; ++w)
+    {
+        timer_worlds[w] = dmScript::NewTimerWorld();
+        for (uint32_t i = 0; i < timers_per_world; ++i)
+        {
+            // Long-lived timers, only the first 1000 in each world trigger during the 10 simulated seconds
+            dmScript::HTimer handle = dmScript::AddTimer(timer_worlds[w], 0.005f + i * 0.01f, false, TestCallback, i % 64, 0x0);
+            ASSERT_NE(dmScript::INVALID_TIMER_HANDLE, handle);
+        }
+        // A few repeating timers that trigger every update
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            ASSERT_NE(dmScript::INVALID_TIMER_HANDLE, dmScript::AddTimer(timer_worlds[w], 0.0f, true, TestCallback, 0x1000, 0x0));
+        }
+    }
+
+    uint64_t start = dmTime::GetTime();
+    for (uint32_t u = 0; u < update_count; ++u)
+    {
+        for (uint32_t w = 0; w < world_count; ++w)
+        {
+            dmScript::UpdateTimers(timer_worlds[w], dt);
+        }
+    }
+    uint64_t end = dmTime::GetTime();
+
+    printf("%u timers, %u updates: %.4f ms/update\n", world_count * timers_per_world, update_count, (end - start) / (1000.0 * update_count));
+
+    ASSERT_EQ(world_count * (1000 + 16 * update_count), TimerTestCallback::callback_count);
+
+    for (uint32_t w = 0; w < world_count; ++w)
+    {
+        ASSERT_EQ(timers_per_world - 1000 + 16, GetAliveTimers(timer_worlds[w]));
+        ASSERT_EQ(16u, dmScript::KillTimers(timer_worlds[w], 0x1000));
+        for (uint32_t owner = 0; owner < 64; ++owner)
+        {
+            dmScript::KillTimers(timer_worlds[w], owner);
+        }
+        ASSERT_EQ(0u, GetAliveTimers(timer_worlds[w]));
+        dmScript::DeleteTimerWorld(timer_worlds[w]);
+    }
+}
+
 static bool RunString(lua_State* L, const char* script)
 {
     luaL_loadstring(L, script);
@@ -100,6 +100,9 @@ namespace dmSound
 
     // Thread safe
     Result NewSoundData(const void* sound_buffer, uint32_t sound_buffer_size, SoundDataType type, HSoundData* sound_data, dmhash_t name);
+    // Same as NewSoundData, but the sound buffer is referenced instead of copied.
+    // The buffer must stay valid and unchanged until the sound data is deleted or replaced with SetSoundData
+    Result NewSoundDataNoCopy(const void* sound_buffer, uint32_t sound_buffer_size, SoundDataType type, HSoundData* sound_data, dmhash_t name);
     Result SetSoundData(HSoundData sound_data, const void* sound_buffer, uint32_t sound_buffer_size);
     uint32_t GetSoundResourceSize(HSoundData sound_data);
     Result DeleteSoundData(HSoundData sound_data);
@@ -64,6 +64,11 @@ namespace dmSound
         return result;
     }
 
+    Result NewSoundDataNoCopy(const void* sound_buffer, uint32_t sound_buffer_size, SoundDataType type, HSoundData* sound_data, dmhash_t name)
+    {
+        return NewSoundData(sound_buffer, sound_buffer_size, type, sound_data, name);
+    }
+
     Result SetSoundData(HSoundData sound_data, const void* sound_buffer, uint32_t sound_buffer_size)
     {
         if (sound_data->m_Buffer != 0x0)